@@ -26,39 +26,20 @@
 #ifndef STARMATHPP_PIPELINE_ACTION_WRITE_H_
 #define STARMATHPP_PIPELINE_ACTION_WRITE_H_ STARMATHPP_PIPELINE_ACTION_WRITE_H_
 
-#include <cstdio>
 #include <filesystem>
+#include <memory>
 
 #include <range/v3/all.hpp> // TODO: REMOVE - Needed for rages::forward
 
 #include <range/v3/action/transform.hpp>
 
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/io/filename_sequencer.hpp>
 #include <libstarmathpp/io/image_writer.hpp>
 
 #define STARMATHPP_PIPELINE_ACTION_WRITE_DEBUG 0
 
 namespace starmathpp::pipeline::actions {
-  /**
-   * NOTE: With C++20, the filename can be easily composed like:
-   * std::string filename = std::format(imageFilenamePattern, counter++);
-   * The template looks slightly different: "img_{:03}.fit"
-   * See https://stackoverflow.com/questions/2342162/stdstring-formatting-like-sprintf
-   *
-   * #include <format>
-   *
-   * TODO: Compose filename from internal, static counter... ? Better idea? How to reset?
-   */
-  static std::string compose_filename_from_pattern(const std::string &pattern) {
-    char buffer[100];
-
-    static unsigned int counter = 0;
-
-    std::snprintf(buffer, sizeof(buffer), pattern.c_str(), counter++);
-
-    return std::string(buffer);
-  }
-
   /**
    *
    */
@@ -67,19 +48,23 @@ namespace starmathpp::pipeline::actions {
              const std::string &image_filename_pattern = "img_%03d.fit",
              bool allow_override = true) {
 
-    return ranges::make_action_closure([directory, image_filename_pattern, allow_override](auto&& range) {
-        int index = 0;
+    // NOTE: The filenames are numbered per pipeline.
+    auto sequencer = std::make_shared<starmathpp::io::FilenameSequencer>(
+        image_filename_pattern);
+
+    return ranges::make_action_closure([directory, sequencer, allow_override](auto&& range) {
         for (auto&& image : range) {
 //            std::ostringstream oss;
 //            oss << directory << '/' << fmt::format(format, index++) << ".jpeg";
 //            image->save(oss.str().c_str());
-                    DEBUG_IMAGE_DISPLAY(*image, "pipeline_action_write_in",
+                    DEBUG_IMAGE_DISPLAY(image, "pipeline_action_write_in",
                                         STARMATHPP_PIPELINE_ACTION_WRITE_DEBUG);
 
                     std::filesystem::path filepath = directory
-                        / compose_filename_from_pattern(image_filename_pattern);
+                        / sequencer->next();
 
-                    starmathpp::io::write(*image, filepath, allow_override);
+                    // NOTE: Binds to const&&, i.e. the image is not modified.
+                    starmathpp::io::write(std::move(image), filepath, allow_override);
 
         }
         return std::forward<decltype(range)>(range); // Ensure we forward the range correctly
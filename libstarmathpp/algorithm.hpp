@@ -27,9 +27,14 @@
 #define LIBSTARMATHPP_ALGORITHM_HPP_
 
 #include <libstarmathpp/algorithm/average.hpp>
+#include <libstarmathpp/algorithm/average_stacker.hpp>
+#include <libstarmathpp/algorithm/band_stacker.hpp>
 #include <libstarmathpp/algorithm/bad_pixel_median_interpolator.hpp>
+#include <libstarmathpp/algorithm/frame_quality.hpp>
 #include <libstarmathpp/algorithm/fwhm.hpp>
 #include <libstarmathpp/algorithm/hfd.hpp>
+#include <libstarmathpp/algorithm/live_stacker.hpp>
+#include <libstarmathpp/algorithm/quality_weighted_stacker.hpp>
 #include <libstarmathpp/algorithm/snr.hpp>
 #include <libstarmathpp/algorithm/star_cluster_algorithm.hpp>
 
@@ -26,66 +26,30 @@
 #ifndef STARMATHPP_ALGORITHM_AVERAGE_HPP_
 #define STARMATHPP_ALGORITHM_AVERAGE_HPP_ STARMATHPP_ALGORITHM_AVERAGE_HPP_
 
-#include <memory>
-#include <string>
-
-#include <range/v3/empty.hpp>
-
 #include <libstarmathpp/image.hpp>
-#include <libstarmathpp/inconsistent_image_dimensions_exception.hpp>
+#include <libstarmathpp/thread_pool.hpp>
+#include <libstarmathpp/algorithm/average_stacker.hpp>
 
 namespace starmathpp::algorithm {
 
 /**
+ * Calculate the pixel-wise average of all images in the range.
  *
- */
-namespace detail {
-void throw_if_inconsistent_image_dimensions(unsigned int current_width,
-                                            unsigned int current_height,
-                                            unsigned int first_width,
-                                            unsigned int first_height) {
-
-  if (current_width != first_width || current_height != first_height) {
-    std::stringstream ss;
-
-    ss << "Inconsistent images dimensions. Initial image dimension: " << "("
-        << first_width << ", " << first_height << "), "
-        << "new image dimension: (" << current_width << ", " << current_height
-        << ").";
-
-    throw InconsistentImageDimensionsException(ss.str());
-  }
-}
-}
-
-/**
- * TODO: Document ...
- *
- * Throws ... if image sizes are different.
+ * Throws InconsistentImageDimensionsException if image sizes are different.
  * First image in range defines expected image size.
+ *
+ * NOTE: The range is traversed exactly once. Therefore, also single-pass
+ *       ranges (e.g. the result of parallel_transform()) can be averaged.
+ * NOTE: The images are accumulated in double precision on num_threads
+ *       threads (see AverageStacker). The result does not depend on the
+ *       number of threads.
+ * NOTE: num_threads defaults to 1 since the range is usually produced by
+ *       a pipeline which already runs on several threads (e.g. read_ahead()).
+ *       Pass default_num_workers() to spread each image over all cores.
  */
 template<class Rng>
-auto average(const Rng &rng) {
-
-  if (ranges::empty(rng)) {
-    return Image();
-  }
-
-  Image sum_image(*ranges::begin(rng), "xy", 0);
-
-  size_t image_count = 0;
-
-  for (const auto &img : rng) {
-    detail::throw_if_inconsistent_image_dimensions(img.width(), img.height(),
-                                                   sum_image.width(),
-                                                   sum_image.height());
-    sum_image += *img;
-    ++image_count;
-  }
-
-  sum_image /= image_count;
-
-  return sum_image;
+auto average(Rng &&rng, size_t num_threads = 1) {
+  return AverageStacker(num_threads).add_all(std::forward<Rng>(rng)).result();
 }
 
 }  // namespace starmathpp::algorithm
@@ -97,4 +97,35 @@ BOOST_AUTO_TEST_CASE(algorithm_average_different_image_sizes_exception_test)
     BOOST_CHECK(result_image.is_empty());
   }
 
+  /**
+   * The result does not depend on the number of threads, also if average()
+   * is called by the threads of a parallel pipeline stage (nested).
+   */
+  BOOST_AUTO_TEST_CASE(algorithm_average_num_threads_test)
+  {
+    std::vector<Image> input_images;
+
+    for (int i = 0; i < 5; ++i) {
+      Image image(512, 300, 1, 1, 0);
+      cimg_forXY(image, x, y) {
+        image(x, y) = (float) (x + 3 * y + 17 * i);
+      }
+      input_images.push_back(image);
+    }
+
+    auto expected_image = starmathpp::algorithm::average(input_images);
+
+    std::vector<Image> results(4);
+
+    parallel_for(0, results.size(), [&](size_t begin, size_t end) {
+      for (size_t idx = begin; idx < end; ++idx) {
+        results[idx] = starmathpp::algorithm::average(input_images, 3 /*num_threads*/);
+      }
+    }, results.size());
+
+    for (const auto &result : results) {
+      BOOST_TEST((result == expected_image));
+    }
+  }
+
   BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,220 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_ALGORITHM_AVERAGE_STACKER_HPP_
+#define STARMATHPP_ALGORITHM_AVERAGE_STACKER_HPP_ STARMATHPP_ALGORITHM_AVERAGE_STACKER_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include <libstarmathpp/exception.hpp>
+#include <libstarmathpp/frame.hpp>
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/inconsistent_image_dimensions_exception.hpp>
+#include <libstarmathpp/thread_pool.hpp>
+
+namespace starmathpp::algorithm {
+
+DEF_Exception(AverageStacker);
+
+/**
+ * Pixel-wise (weighted) average of a stream of frames.
+ *
+ * The frames are accumulated in double precision. Therefore, even hundreds
+ * of 16 bit frames can be stacked without loss of precision (a float has
+ * only 24 bits of mantissa).
+ *
+ * The rows of a frame are distributed over num_threads threads. The stacker
+ * owns a pool of num_threads - 1 workers. The calling thread processes
+ * one part of each frame as well. Each pixel is always summed up
+ * sequentially in the order the frames were added. Therefore, the result
+ * is bit-identical for any number of threads.
+ *
+ * Only the accumulator is held by the stacker. The frames can be released
+ * as soon as they were added.
+ *
+ * Usage:
+ *
+ * AverageStacker stacker;
+ *
+ * for (const auto &frame : files("lights", "(.*\\.fit)") | read()) {
+ *   stacker.add(frame);
+ * }
+ * Image master = stacker.result();
+ */
+class AverageStacker {
+ public:
+  explicit AverageStacker(size_t num_threads = default_num_workers())
+      :
+      thread_pool_(
+          num_threads > 1 ? std::make_unique<ThreadPool>(num_threads - 1) : nullptr),
+      width_(0),
+      height_(0),
+      depth_(0),
+      spectrum_(0),
+      count_(0),
+      total_weight_(0.0) {
+  }
+
+  /**
+   * Add the frame with the given weight to the stack.
+   *
+   * Throws InconsistentImageDimensionsException if the dimensions differ
+   * from the dimensions of the first frame and AverageStackerException if
+   * the weight is not positive.
+   */
+  template<typename ImageType>
+  void add(const cimg_library::CImg<ImageType> &frame, double weight = 1.0) {
+    if (!(weight > 0.0) || !std::isfinite(weight)) {
+      std::stringstream ss;
+      ss << "Invalid frame weight " << weight << ". Expected weight > 0.";
+      throw AverageStackerException(ss.str());
+    }
+
+    if (count_ == 0) {
+      width_ = frame.width();
+      height_ = frame.height();
+      depth_ = frame.depth();
+      spectrum_ = frame.spectrum();
+      sums_.assign(frame.size(), 0.0);
+    } else {
+      throw_if_inconsistent_dimensions(frame);
+    }
+
+    const ImageType *pixels = frame.data();
+    double *sums = sums_.data();
+
+    for_each_row_chunk([pixels, sums, weight](size_t begin, size_t end) {
+      // NOTE: Simple loop over contiguous memory which is vectorized
+      //       by the compiler. A weight of 1 does not change the sum.
+      for (size_t idx = begin; idx < end; ++idx) {
+        sums[idx] += weight * static_cast<double>(pixels[idx]);
+      }
+    });
+
+    ++count_;
+    total_weight_ += weight;
+  }
+
+  /**
+   * Add the frame with its native pixel type, i.e. a 16 bit frame is not
+   * promoted to float.
+   */
+  void add(const Frame &frame, double weight = 1.0) {
+    visit_frame([this, weight](const auto &image) {
+      add(image, weight);
+    }, frame);
+  }
+
+  /**
+   * Add all frames of the range. The range is traversed exactly once.
+   */
+  template<typename Rng>
+  AverageStacker& add_all(Rng &&rng) {
+    for (auto &&frame : rng) {
+      add(frame);
+    }
+    return *this;
+  }
+
+  [[nodiscard]] size_t count() const {
+    return count_;
+  }
+
+  [[nodiscard]] double total_weight() const {
+    return total_weight_;
+  }
+
+  /**
+   * Weighted average of all frames added so far. An empty image is returned if no
+   * frame was added.
+   */
+  template<typename ResultType = float>
+  [[nodiscard]] cimg_library::CImg<ResultType> result() const {
+    if (count_ == 0) {
+      return {};
+    }
+
+    cimg_library::CImg<ResultType> average_image(width_, height_, depth_,
+                                                 spectrum_);
+    ResultType *pixels = average_image.data();
+    const double *sums = sums_.data();
+    double total_weight = total_weight_;
+
+    for_each_row_chunk([pixels, sums, total_weight](size_t begin, size_t end) {
+      for (size_t idx = begin; idx < end; ++idx) {
+        pixels[idx] = static_cast<ResultType>(sums[idx] / total_weight);
+      }
+    });
+
+    return average_image;
+  }
+
+ private:
+  std::unique_ptr<ThreadPool> thread_pool_;
+  int width_;
+  int height_;
+  int depth_;
+  int spectrum_;
+  size_t count_;
+  double total_weight_;
+  std::vector<double> sums_;
+
+  /**
+   * Call fun(begin, end) for contiguous pixel index ranges which consist of
+   * complete rows (see starmathpp::for_each_row_chunk()).
+   */
+  template<typename Fun>
+  void for_each_row_chunk(Fun &&fun) const {
+    starmathpp::for_each_row_chunk(thread_pool_.get(), sums_.size(),
+                                   static_cast<size_t>(width_),
+                                   std::forward<Fun>(fun));
+  }
+
+  template<typename ImageType>
+  void throw_if_inconsistent_dimensions(
+      const cimg_library::CImg<ImageType> &frame) const {
+
+    if (frame.width() != width_ || frame.height() != height_
+        || frame.depth() != depth_ || frame.spectrum() != spectrum_) {
+      std::stringstream ss;
+
+      ss << "Inconsistent images dimensions. Initial image dimension: " << "("
+         << width_ << ", " << height_ << ", " << depth_ << ", " << spectrum_
+         << "), new image dimension: (" << frame.width() << ", "
+         << frame.height() << ", " << frame.depth() << ", " << frame.spectrum()
+         << ").";
+
+      throw InconsistentImageDimensionsException(ss.str());
+    }
+  }
+};
+
+}  // namespace starmathpp::algorithm
+
+#endif // STARMATHPP_ALGORITHM_AVERAGE_STACKER_HPP_
@@ -0,0 +1,176 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "algorithm average stacker unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <cstdint>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/algorithm/average_stacker.hpp>
+#include <libstarmathpp/floating_point_equality.hpp>
+#include <libstarmathpp/inconsistent_image_dimensions_exception.hpp>
+
+BOOST_AUTO_TEST_SUITE (algorithm_average_stacker_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::algorithm;
+
+/**
+ * Image with a different value for each pixel.
+ */
+static Image generate_test_image(int width, int height, float offset) {
+  Image image(width, height, 1, 1, 0);
+
+  cimg_forXY(image, x, y)
+  {
+    image(x, y) = offset + 0.1F * (float) ((x * 31 + y * 17) % 97);
+  }
+  return image;
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(algorithm_average_stacker_average_test)
+{
+  AverageStacker stacker;
+
+  stacker.add(Image(5, 5, 1, 1, 13));
+  stacker.add(Image(5, 5, 1, 1, 10));
+  stacker.add(Image(5, 5, 1, 1, -5));
+
+  BOOST_TEST(stacker.count() == 3);
+  BOOST_TEST(is_almost_equal(stacker.result(), Image(5, 5, 1, 1, 6), 0.00001));
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(algorithm_average_stacker_weighted_average_test)
+{
+  AverageStacker stacker;
+
+  stacker.add(Image(5, 5, 1, 1, 2), 1.0);
+  stacker.add(Image(5, 5, 1, 1, 8), 3.0);
+
+  BOOST_TEST(stacker.count() == 2);
+  BOOST_TEST(stacker.total_weight() == 4.0);
+  BOOST_TEST(is_almost_equal(stacker.result(), Image(5, 5, 1, 1, 6.5), 0.00001));
+
+  BOOST_CHECK_THROW(stacker.add(Image(5, 5, 1, 1, 2), 0.0),
+                    AverageStackerException);
+  BOOST_CHECK_THROW(stacker.add(Image(5, 5, 1, 1, 2), -1.0),
+                    AverageStackerException);
+}
+
+/**
+ * Frames are stacked with their native pixel type.
+ */
+BOOST_AUTO_TEST_CASE(algorithm_average_stacker_frame_test)
+{
+  AverageStacker stacker;
+
+  stacker.add(Frame(Image16(5, 5, 1, 1, 65535)));
+  stacker.add(Frame(Image(5, 5, 1, 1, 1.5F)));
+
+  BOOST_TEST(stacker.count() == 2);
+  BOOST_TEST(is_almost_equal(stacker.result(), Image(5, 5, 1, 1, 32768.25F), 0.00001));
+}
+
+/**
+ * Stacking many 16 bit frames exceeds the precision of a float sum
+ * (24 bits of mantissa). The double accumulator is exact.
+ */
+BOOST_AUTO_TEST_CASE(algorithm_average_stacker_precision_test)
+{
+  AverageStacker stacker;
+
+  cimg_library::CImg<uint16_t> bright_frame(4, 4, 1, 1, 65535);
+  cimg_library::CImg<uint16_t> dark_frame(4, 4, 1, 1, 1);
+
+  for (int i = 0; i < 500; ++i) {
+    stacker.add(i % 2 == 0 ? bright_frame : dark_frame);
+  }
+
+  auto average_image = stacker.result();
+
+  BOOST_TEST(average_image(0, 0) == 32768.0F);
+  BOOST_TEST(average_image(3, 3) == 32768.0F);
+}
+
+/**
+ * The result must be bit-identical for any number of threads.
+ */
+BOOST_AUTO_TEST_CASE(algorithm_average_stacker_deterministic_test)
+{
+  std::vector<Image> frames;
+
+  for (int i = 0; i < 10; ++i) {
+    frames.push_back(generate_test_image(301, 257, 1000.0F * (float) i));
+  }
+
+  auto expected_image = AverageStacker(1).add_all(frames).result();
+
+  for (size_t num_threads : { 2, 3, 7, 16 }) {
+    auto average_image = AverageStacker(num_threads).add_all(frames).result();
+
+    BOOST_TEST((average_image == expected_image));
+  }
+}
+
+/**
+ * The frames must have the same width, height, depth and spectrum.
+ */
+BOOST_AUTO_TEST_CASE(algorithm_average_stacker_inconsistent_dimensions_test)
+{
+  AverageStacker stacker;
+
+  stacker.add(Image(5, 5, 1, 1, 0));
+
+  BOOST_CHECK_THROW(stacker.add(Image(4, 5, 1, 1, 0)),
+                    InconsistentImageDimensionsException);
+  BOOST_CHECK_THROW(stacker.add(Image(5, 5, 1, 3, 0)),
+                    InconsistentImageDimensionsException);
+  BOOST_TEST(stacker.count() == 1);
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(algorithm_average_stacker_empty_test)
+{
+  AverageStacker stacker;
+
+  BOOST_TEST(stacker.count() == 0);
+  BOOST_TEST(stacker.result().is_empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,457 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_ALGORITHM_BAND_STACKER_HPP_
+#define STARMATHPP_ALGORITHM_BAND_STACKER_HPP_ STARMATHPP_ALGORITHM_BAND_STACKER_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+#include <libstarmathpp/enum_helper.hpp>
+#include <libstarmathpp/exception.hpp>
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/inconsistent_image_dimensions_exception.hpp>
+#include <libstarmathpp/thread_pool.hpp>
+
+namespace starmathpp::algorithm {
+
+DEF_Exception(BandStacker);
+
+/**
+ * Method used to combine the values of one pixel of all frames.
+ */
+struct CombineMethod {
+  enum TypeE {
+    AVERAGE,
+    MEDIAN,
+    KAPPA_SIGMA,       // Iterative rejection around the median
+    WINSORIZED_SIGMA,  // Like KAPPA_SIGMA, but with a robust sigma
+    LINEAR_FIT,        // Rejection around a line fitted to the sorted values
+    _Count
+  };
+
+  static const char* asStr(const TypeE &inType) {
+    switch (inType) {
+      case AVERAGE:
+        return "AVERAGE";
+      case MEDIAN:
+        return "MEDIAN";
+      case KAPPA_SIGMA:
+        return "KAPPA_SIGMA";
+      case WINSORIZED_SIGMA:
+        return "WINSORIZED_SIGMA";
+      case LINEAR_FIT:
+        return "LINEAR_FIT";
+      default:
+        return "<?>";
+    }
+  }
+
+  MAC_AS_TYPE(Type, E, _Count)
+  ;
+};
+
+/**
+ * Result of a stack. The rejection maps contain the number of values which
+ * were rejected below / above per pixel. They are only filled if requested
+ * (see BandStacker::set_rejection_maps()).
+ */
+struct StackResult {
+  Image image;
+  cimg_library::CImg<uint16_t> rejected_low;
+  cimg_library::CImg<uint16_t> rejected_high;
+};
+
+namespace detail {
+
+/**
+ * Combined value of one pixel and the number of rejected values.
+ */
+struct CombinedPixel {
+  float value;
+  size_t num_rejected_low;
+  size_t num_rejected_high;
+};
+
+/**
+ * NOTE: The values in [begin, end) must be sorted.
+ */
+inline float sorted_median(const std::vector<float> &values, size_t begin,
+                           size_t end) {
+  size_t n = end - begin;
+  size_t mid = begin + n / 2;
+
+  return (n % 2 == 1 ? values[mid] : 0.5F * (values[mid - 1] + values[mid]));
+}
+
+inline double mean(const std::vector<float> &values, size_t begin,
+                   size_t end) {
+  double sum = 0;
+
+  for (size_t idx = begin; idx < end; ++idx) {
+    sum += values[idx];
+  }
+  return sum / (double) (end - begin);
+}
+
+inline double standard_deviation(const std::vector<float> &values,
+                                 size_t begin, size_t end) {
+  double m = mean(values, begin, end);
+  double sum_sq = 0;
+
+  for (size_t idx = begin; idx < end; ++idx) {
+    sum_sq += (values[idx] - m) * (values[idx] - m);
+  }
+  return std::sqrt(sum_sq / (double) (end - begin));
+}
+
+/**
+ * Robust standard deviation: The values are clipped to
+ * median +/- 1.5 sigma until sigma converges.
+ */
+inline double winsorized_standard_deviation(const std::vector<float> &values,
+                                            size_t begin, size_t end,
+                                            float median,
+                                            std::vector<float> &scratch) {
+  scratch.assign(values.begin() + (long) begin, values.begin() + (long) end);
+
+  double sigma = standard_deviation(scratch, 0, scratch.size());
+
+  for (int iteration = 0; iteration < 10 && sigma > 0; ++iteration) {
+    auto low = (float) (median - 1.5 * sigma);
+    auto high = (float) (median + 1.5 * sigma);
+
+    for (auto &value : scratch) {
+      value = std::clamp(value, low, high);
+    }
+
+    // NOTE: 1.134 corrects the bias of the clipped normal distribution.
+    double new_sigma = 1.134 * standard_deviation(scratch, 0, scratch.size());
+
+    if (std::abs(new_sigma - sigma) <= 0.0005 * sigma) {
+      return new_sigma;
+    }
+    sigma = new_sigma;
+  }
+  return sigma;
+}
+
+/**
+ * Combine the values of one pixel.
+ *
+ * NOTE: values is sorted in place.
+ */
+inline CombinedPixel combine(CombineMethod::TypeE method, float kappa_low,
+                             float kappa_high, size_t max_iterations,
+                             std::vector<float> &values,
+                             std::vector<float> &scratch) {
+  size_t num_values = values.size();
+
+  if (method == CombineMethod::AVERAGE) {
+    return CombinedPixel { (float) mean(values, 0, num_values), 0, 0 };
+  }
+
+  std::sort(values.begin(), values.end());
+
+  if (method == CombineMethod::MEDIAN) {
+    return CombinedPixel { sorted_median(values, 0, num_values), 0, 0 };
+  }
+
+  // NOTE: Since the values are sorted, rejected values are always at the
+  //       beginning or at the end. The remaining values are [begin, end).
+  size_t begin = 0;
+  size_t end = num_values;
+
+  for (size_t iteration = 0; iteration < max_iterations && end - begin > 2;
+      ++iteration) {
+
+    size_t new_begin = begin;
+    size_t new_end = end;
+
+    if (method == CombineMethod::LINEAR_FIT) {
+      // Least squares fit of value = a + b * idx
+      double n = (double) (end - begin);
+      double sum_i = 0, sum_v = 0, sum_ii = 0, sum_iv = 0;
+
+      for (size_t idx = begin; idx < end; ++idx) {
+        sum_i += (double) idx;
+        sum_v += values[idx];
+        sum_ii += (double) idx * (double) idx;
+        sum_iv += (double) idx * values[idx];
+      }
+
+      double denominator = n * sum_ii - sum_i * sum_i;
+      double b = (denominator != 0 ? (n * sum_iv - sum_i * sum_v) / denominator : 0);
+      double a = (sum_v - b * sum_i) / n;
+
+      double mean_deviation = 0;
+
+      for (size_t idx = begin; idx < end; ++idx) {
+        mean_deviation += std::abs(values[idx] - (a + b * (double) idx));
+      }
+      mean_deviation /= n;
+
+      if (mean_deviation == 0) {
+        break;
+      }
+
+      while (new_begin < new_end
+          && values[new_begin]
+              < a + b * (double) new_begin - kappa_low * mean_deviation) {
+        ++new_begin;
+      }
+
+      while (new_end > new_begin
+          && values[new_end - 1]
+              > a + b * (double) (new_end - 1) + kappa_high * mean_deviation) {
+        --new_end;
+      }
+    } else {
+      float median = sorted_median(values, begin, end);
+      double sigma = (
+          method == CombineMethod::WINSORIZED_SIGMA ?
+              winsorized_standard_deviation(values, begin, end, median,
+                                            scratch) :
+              standard_deviation(values, begin, end));
+
+      if (sigma == 0) {
+        break;
+      }
+
+      while (new_begin < new_end
+          && values[new_begin] < median - kappa_low * sigma) {
+        ++new_begin;
+      }
+
+      while (new_end > new_begin
+          && values[new_end - 1] > median + kappa_high * sigma) {
+        --new_end;
+      }
+    }
+
+    if (new_begin == begin && new_end == end) {
+      break;
+    }
+
+    begin = new_begin;
+    end = new_end;
+  }
+
+  if (begin == end) {
+    // NOTE: Should not happen since at least the median is kept. Fall back
+    //       to the median of all values.
+    return CombinedPixel { sorted_median(values, 0, num_values), 0, 0 };
+  }
+
+  return CombinedPixel { (float) mean(values, begin, end), begin, num_values
+      - end };
+}
+
+}  // namespace detail
+
+/**
+ * Combines a set of frames pixel by pixel while only holding horizontal
+ * bands of the frames in memory.
+ *
+ * The frames are provided by a band reader (see io/band_reader.hpp). The
+ * frame set is processed band by band: The band of every frame is read,
+ * the values of each pixel are combined (with outlier rejection) and the
+ * result is written to the corresponding rows of the stacked image.
+ *
+ * The height of the bands is chosen so that the bands which are processed
+ * at the same time fit into the memory budget. The bands are distributed
+ * over num_threads threads. The result does not depend on the memory
+ * budget or on the number of threads.
+ *
+ * Usage:
+ *
+ * BandStacker stacker(CombineMethod::KAPPA_SIGMA, 3.0F, 3.0F);
+ * stacker.set_memory_budget(2UL << 30);
+ *
+ * auto result = stacker.stack(io::FileBandReader(filepaths));
+ *
+ * NOTE: The memory budget only covers the bands. The stacked image (and
+ *       the rejection maps) are held in addition.
+ *
+ * NOTE: Only single channel frames are supported. A BandStackerException is
+ *       thrown for colour frames.
+ */
+class BandStacker {
+ public:
+  explicit BandStacker(CombineMethod::TypeE method = CombineMethod::KAPPA_SIGMA,
+                       float kappa_low = 3.0F, float kappa_high = 3.0F,
+                       size_t max_iterations = 5)
+      :
+      method_(method),
+      kappa_low_(kappa_low),
+      kappa_high_(kappa_high),
+      max_iterations_(max_iterations),
+      memory_budget_(DEFAULT_MEMORY_BUDGET),
+      num_threads_(default_num_workers()),
+      rejection_maps_(false) {
+
+    if (method_ >= CombineMethod::_Count) {
+      throw BandStackerException("Unsupported combine method.");
+    }
+
+    if (kappa_low_ <= 0 || kappa_high_ <= 0) {
+      std::stringstream ss;
+      ss << "Kappa must be positive (low=" << kappa_low_ << ", high="
+         << kappa_high_ << ").";
+      throw BandStackerException(ss.str());
+    }
+  }
+
+  /**
+   * Maximum number of bytes held by the bands of all threads.
+   */
+  void set_memory_budget(size_t memory_budget_bytes) {
+    memory_budget_ = memory_budget_bytes;
+  }
+
+  void set_num_threads(size_t num_threads) {
+    num_threads_ = std::max<size_t>(1, num_threads);
+  }
+
+  /**
+   * If enabled, the number of rejected values per pixel is returned.
+   */
+  void set_rejection_maps(bool rejection_maps) {
+    rejection_maps_ = rejection_maps;
+  }
+
+  /**
+   * Number of rows per band for the given frame set.
+   */
+  [[nodiscard]] int band_height(size_t num_frames, int width, int height) const {
+    size_t bytes_per_row = std::max<size_t>(1, num_frames) * (size_t) width
+        * sizeof(float) * num_threads_;
+    size_t rows = std::max<size_t>(1, memory_budget_ / std::max<size_t>(1, bytes_per_row));
+
+    return (int) std::min<size_t>(rows, (size_t) std::max(1, height));
+  }
+
+  template<typename BandReader>
+  [[nodiscard]] StackResult stack(const BandReader &reader) const {
+    size_t num_frames = reader.num_frames();
+
+    if (num_frames == 0) {
+      throw BandStackerException("At least one frame is required.");
+    }
+
+    int width = reader.frame_size().width();
+    int height = reader.frame_size().height();
+    int rows_per_band = band_height(num_frames, width, height);
+    size_t num_bands = (size_t) ((height + rows_per_band - 1) / rows_per_band);
+
+    StackResult result { Image(width, height, 1, 1, 0), { }, { } };
+
+    if (rejection_maps_) {
+      result.rejected_low.assign(width, height, 1, 1, 0);
+      result.rejected_high.assign(width, height, 1, 1, 0);
+    }
+
+    parallel_for(0, num_bands, [&](size_t band_begin, size_t band_end) {
+      std::vector<Image> bands(num_frames);
+      std::vector<float> values(num_frames);
+      std::vector<float> scratch;
+
+      for (size_t band = band_begin; band < band_end; ++band) {
+        int first_row = (int) band * rows_per_band;
+        int num_rows = std::min(rows_per_band, height - first_row);
+
+        for (size_t frame = 0; frame < num_frames; ++frame) {
+          bands[frame] = reader.read_band(frame, first_row, num_rows);
+          throw_if_inconsistent_band(bands[frame], width, num_rows);
+        }
+
+        for (int y = 0; y < num_rows; ++y) {
+          for (int x = 0; x < width; ++x) {
+            for (size_t frame = 0; frame < num_frames; ++frame) {
+              values[frame] = bands[frame](x, y);
+            }
+
+            auto pixel = detail::combine(method_, kappa_low_, kappa_high_,
+                                         max_iterations_, values, scratch);
+
+            result.image(x, first_row + y) = pixel.value;
+
+            if (rejection_maps_) {
+              result.rejected_low(x, first_row + y) = (uint16_t) std::min<size_t>(
+                  pixel.num_rejected_low, std::numeric_limits<uint16_t>::max());
+              result.rejected_high(x, first_row + y) = (uint16_t) std::min<size_t>(
+                  pixel.num_rejected_high, std::numeric_limits<uint16_t>::max());
+            }
+          }
+        }
+      }
+    }, num_threads_);
+
+    return result;
+  }
+
+ private:
+  static constexpr size_t DEFAULT_MEMORY_BUDGET = 512UL * 1024UL * 1024UL;
+
+  CombineMethod::TypeE method_;
+  float kappa_low_;
+  float kappa_high_;
+  size_t max_iterations_;
+  size_t memory_budget_;
+  size_t num_threads_;
+  bool rejection_maps_;
+
+  static void throw_if_inconsistent_band(const Image &band, int width,
+                                         int num_rows) {
+    // NOTE: Only the first channel would be stacked. The other channels of
+    //       a colour frame would be dropped silently.
+    if (band.depth() != 1 || band.spectrum() != 1) {
+      std::stringstream ss;
+
+      ss << "Only single channel frames can be stacked. Read: depth="
+         << band.depth() << ", channels=" << band.spectrum() << ".";
+
+      throw BandStackerException(ss.str());
+    }
+
+    if (band.width() != width || band.height() != num_rows) {
+      std::stringstream ss;
+
+      ss << "Inconsistent band dimensions. Expected: (" << width << ", "
+         << num_rows << "), read: (" << band.width() << ", " << band.height()
+         << ").";
+
+      throw InconsistentImageDimensionsException(ss.str());
+    }
+  }
+};
+
+}  // namespace starmathpp::algorithm
+
+#endif // STARMATHPP_ALGORITHM_BAND_STACKER_HPP_
@@ -0,0 +1,204 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "algorithm band stacker unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/algorithm/band_stacker.hpp>
+#include <libstarmathpp/algorithm/average_stacker.hpp>
+#include <libstarmathpp/io/band_reader.hpp>
+#include <libstarmathpp/floating_point_equality.hpp>
+
+BOOST_AUTO_TEST_SUITE (algorithm_band_stacker_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::algorithm;
+using namespace starmathpp::io;
+
+/**
+ * Frames with a noisy background (deterministic pseudo-random values
+ * around 1000) and one hot pixel at (5, 7) in frame 3.
+ */
+static std::vector<Image> generate_frames(size_t num_frames, int width,
+                                          int height) {
+  std::vector<Image> frames;
+
+  for (size_t i = 0; i < num_frames; ++i) {
+    Image frame(width, height, 1, 1, 0);
+
+    cimg_forXY(frame, x, y)
+    {
+      frame(x, y) = 1000.0F + (float) ((x * 31 + y * 17 + (int) i * 13) % 21) - 10.0F;
+    }
+
+    if (i == 3) {
+      frame(5, 7) = 65535.0F;
+    }
+    frames.push_back(std::move(frame));
+  }
+  return frames;
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(algorithm_band_stacker_combine_test)
+{
+  std::vector<float> scratch;
+
+  std::vector<float> values = { 10, 11, 9, 10, 1000, 10, 11, 9, 10, 10 };
+  auto pixel = algorithm::detail::combine(CombineMethod::KAPPA_SIGMA, 2.0F, 2.0F, 5,
+                               values, scratch);
+
+  BOOST_TEST(pixel.value == 10.0F);
+  BOOST_TEST(pixel.num_rejected_low == 0);
+  BOOST_TEST(pixel.num_rejected_high == 1);
+
+  values = { 10, 11, 9, 10, 1000 };
+  pixel = algorithm::detail::combine(CombineMethod::MEDIAN, 3.0F, 3.0F, 5, values,
+                          scratch);
+  BOOST_TEST(pixel.value == 10.0F);
+
+  values = { 1, 2, 3, 4 };
+  pixel = algorithm::detail::combine(CombineMethod::AVERAGE, 3.0F, 3.0F, 5, values,
+                          scratch);
+  BOOST_TEST(pixel.value == 2.5F);
+}
+
+/**
+ * The hot pixel must be rejected by all rejecting methods and must be
+ * counted in the rejection map.
+ */
+BOOST_AUTO_TEST_CASE(algorithm_band_stacker_rejection_test)
+{
+  auto frames = generate_frames(12, 32, 24);
+
+  for (auto method : { CombineMethod::KAPPA_SIGMA,
+      CombineMethod::WINSORIZED_SIGMA, CombineMethod::LINEAR_FIT }) {
+
+    BandStacker stacker(method, 3.0F, 3.0F);
+    stacker.set_rejection_maps(true);
+
+    auto result = stacker.stack(ImageBandReader(frames));
+
+    BOOST_TEST_CONTEXT("method: " << CombineMethod::asStr(method)) {
+      BOOST_TEST(result.image(5, 7) < 1100.0F);
+      BOOST_TEST(result.rejected_high(5, 7) >= 1);
+      BOOST_TEST(result.rejected_high.width() == 32);
+    }
+  }
+}
+
+/**
+ * The result must not depend on the band height (memory budget) or on
+ * the number of threads.
+ */
+BOOST_AUTO_TEST_CASE(algorithm_band_stacker_deterministic_test)
+{
+  auto frames = generate_frames(9, 40, 33);
+
+  BandStacker reference_stacker(CombineMethod::WINSORIZED_SIGMA);
+  reference_stacker.set_num_threads(1);
+  auto expected_image = reference_stacker.stack(ImageBandReader(frames)).image;
+
+  for (size_t memory_budget : { 1UL, 9UL * 40UL * 4UL * 5UL, 100000000UL }) {
+    for (size_t num_threads : { 1, 3, 8 }) {
+      BandStacker stacker(CombineMethod::WINSORIZED_SIGMA);
+      stacker.set_memory_budget(memory_budget);
+      stacker.set_num_threads(num_threads);
+
+      auto result = stacker.stack(ImageBandReader(frames));
+
+      BOOST_TEST((result.image == expected_image));
+    }
+  }
+}
+
+/**
+ * The band height is derived from the memory budget.
+ */
+BOOST_AUTO_TEST_CASE(algorithm_band_stacker_band_height_test)
+{
+  BandStacker stacker;
+  stacker.set_num_threads(2);
+  stacker.set_memory_budget(300 * 1000 * sizeof(float) * 2 * 10);
+
+  BOOST_TEST(stacker.band_height(300, 1000, 5000) == 10);
+  BOOST_TEST(stacker.band_height(300, 1000, 4) == 4);
+
+  stacker.set_memory_budget(1);
+  BOOST_TEST(stacker.band_height(300, 1000, 5000) == 1);
+}
+
+/**
+ * AVERAGE is the same as the AverageStacker.
+ */
+BOOST_AUTO_TEST_CASE(algorithm_band_stacker_average_test)
+{
+  auto frames = generate_frames(5, 16, 16);
+
+  BandStacker stacker(CombineMethod::AVERAGE);
+  stacker.set_memory_budget(5 * 16 * 4 * 3);
+
+  auto result = stacker.stack(ImageBandReader(frames));
+  auto expected_image = AverageStacker().add_all(frames).result();
+
+  BOOST_TEST(is_almost_equal(result.image, expected_image, 0.001));
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(algorithm_band_stacker_inconsistent_frames_test)
+{
+  std::vector<Image> frames = { Image(10, 10, 1, 1, 0), Image(10, 12, 1, 1, 0) };
+
+  BOOST_CHECK_THROW(BandStacker().stack(ImageBandReader(frames)),
+                    BandReaderException);
+
+  std::vector<Image> no_frames;
+  BOOST_CHECK_THROW(BandStacker().stack(ImageBandReader(no_frames)),
+                    BandStackerException);
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(algorithm_band_stacker_colour_frames_test)
+{
+  std::vector<Image> frames = { Image(10, 10, 1, 3, 0), Image(10, 10, 1, 3, 0) };
+
+  BOOST_CHECK_THROW(BandStacker().stack(ImageBandReader(frames)),
+                    BandStackerException);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
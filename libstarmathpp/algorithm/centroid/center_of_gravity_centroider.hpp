@@ -57,7 +57,7 @@ class CenterOfGravityCentroider : public Centroider<ImageType> {
    * TODO: auto as return value?
    */
   [[nodiscard]] std::optional<Point<float>> calculate_centroid(
-      const cimg_library::CImg<ImageType> &input_image) const override {
+      const ImageView<ImageType> &input_image) const override {
 
     if (input_image.width() <= 0 || input_image.height() <= 0) {
       throw CentroiderException("No image supplied.");
@@ -73,7 +73,7 @@ class CenterOfGravityCentroider : public Centroider<ImageType> {
     // However, for the calculation 1..M is expected.
     // Therefore, +1 is needed. Otherwise, the first I2x
     // and I2y are not counted.
-    cimg_forXY(input_image, x, y)
+    image_view_forXY(input_image, x, y)
     {
       ix += input_image(x, y) * ((float) x + 1.0F);
       iy += input_image(x, y) * ((float) y + 1.0F);
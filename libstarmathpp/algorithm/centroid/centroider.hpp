@@ -31,6 +31,7 @@
 
 #include <libstarmathpp/point.hpp>
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/image_view.hpp>
 #include <libstarmathpp/exception.hpp>
 
 namespace starmathpp::algorithm {
@@ -47,7 +48,7 @@ class Centroider {
   [[nodiscard]] virtual std::string get_name() const = 0;
 
   [[nodiscard]] virtual std::optional<Point<float>> calculate_centroid(
-      const cimg_library::CImg<ImageType> &input_image) const = 0;
+      const ImageView<ImageType> &input_image) const = 0;
 };
 
 }  // namespace starmathpp::algorithm
@@ -60,7 +60,7 @@ class IntensityWeightedCentroider : public Centroider<ImageType> {
    * TODO: auto as return value?
    */
   [[nodiscard]] std::optional<Point<float>> calculate_centroid(
-      const cimg_library::CImg<ImageType> &input_image) const override {
+      const ImageView<ImageType> &input_image) const override {
 
     if (input_image.width() <= 0 || input_image.height() <= 0) {
       throw CentroiderException("No image supplied.");
@@ -77,7 +77,7 @@ class IntensityWeightedCentroider : public Centroider<ImageType> {
     // However, for the calculation 1..M is expected.
     // Therefore, +1 is needed. Otherwise, the first I2x
     // and I2y are not counted.
-    cimg_forXY(input_image, x, y)
+    image_view_forXY(input_image, x, y)
     {
       I2 = std::pow(input_image(x, y), 2.0);
       I2x += I2 * (x + 1);
@@ -0,0 +1,263 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_ALGORITHM_FRAME_QUALITY_HPP_
+#define STARMATHPP_ALGORITHM_FRAME_QUALITY_HPP_ STARMATHPP_ALGORITHM_FRAME_QUALITY_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/image_view.hpp>
+#include <libstarmathpp/instrumentation.hpp>
+#include <libstarmathpp/rect.hpp>
+
+#include <libstarmathpp/algorithm/hfd.hpp>
+#include <libstarmathpp/algorithm/snr.hpp>
+#include <libstarmathpp/algorithm/star_cluster_algorithm.hpp>
+#include <libstarmathpp/algorithm/threshold/thresholder.hpp>
+
+namespace starmathpp::algorithm {
+
+/**
+ * Quality metrics of one frame. Metrics which were not measured are NaN
+ * (num_stars is 0).
+ */
+struct FrameQuality {
+  size_t num_stars = 0;
+  double median_hfd = NAN;
+  double background_noise = NAN;
+  double snr = NAN;
+};
+
+inline std::ostream& operator<<(std::ostream &os, const FrameQuality &quality) {
+  return os << "FrameQuality(num_stars=" << quality.num_stars
+            << ", median_hfd=" << quality.median_hfd << ", background_noise="
+            << quality.background_noise << ", snr=" << quality.snr << ")";
+}
+
+/**
+ * Weight of a frame calculated from its quality metrics:
+ *
+ *   weight = num_stars^a * median_hfd^-b * background_noise^-c * snr^d
+ *
+ * An exponent of 0 disables the corresponding metric. The default
+ * (c = 2) weights the frames by their inverse noise variance.
+ *
+ * The background noise is at least MIN_BACKGROUND_NOISE. Hence, a frame
+ * without measurable noise (e.g. constant or synthetic data) gets a large,
+ * finite weight instead of being rejected. If another enabled metric is
+ * missing (NaN) or 0, the weight is 0.
+ */
+struct QualityWeighting {
+  static constexpr double MIN_BACKGROUND_NOISE = 1e-6;
+
+  double star_count_exponent = 0.0;
+  double median_hfd_exponent = 0.0;
+  double background_noise_exponent = 2.0;
+  double snr_exponent = 0.0;
+
+  [[nodiscard]] bool requires_stars() const {
+    return star_count_exponent != 0.0 || median_hfd_exponent != 0.0;
+  }
+
+  [[nodiscard]] bool requires_noise() const {
+    return background_noise_exponent != 0.0 || snr_exponent != 0.0;
+  }
+
+  [[nodiscard]] double weight(const FrameQuality &quality) const {
+    double weight = 1.0;
+
+    if (star_count_exponent != 0.0) {
+      weight *= std::pow((double) quality.num_stars, star_count_exponent);
+    }
+    if (median_hfd_exponent != 0.0) {
+      weight *= std::pow(quality.median_hfd, -median_hfd_exponent);
+    }
+    if (background_noise_exponent != 0.0) {
+      // NOTE: std::max() keeps NaN (not measured) as first argument.
+      weight *= std::pow(std::max(quality.background_noise, MIN_BACKGROUND_NOISE),
+                         -background_noise_exponent);
+    }
+    if (snr_exponent != 0.0) {
+      weight *= std::pow(quality.snr, snr_exponent);
+    }
+
+    return (std::isfinite(weight) && weight > 0.0 ? weight : 0.0);
+  }
+};
+
+/**
+ * Minimum quality a frame must have to be stacked. By default, all frames
+ * pass.
+ */
+struct QualityCut {
+  size_t min_num_stars = 0;
+  double max_median_hfd = std::numeric_limits<double>::infinity();
+  double max_background_noise = std::numeric_limits<double>::infinity();
+  double min_snr = 0.0;
+
+  [[nodiscard]] bool requires_stars() const {
+    return min_num_stars > 0 || std::isfinite(max_median_hfd);
+  }
+
+  [[nodiscard]] bool requires_noise() const {
+    return std::isfinite(max_background_noise) || min_snr > 0.0;
+  }
+
+  /**
+   * NOTE: A metric which is NaN fails every limit which is set.
+   */
+  [[nodiscard]] bool accepts(const FrameQuality &quality) const {
+    return quality.num_stars >= min_num_stars
+        && (!std::isfinite(max_median_hfd)
+            || quality.median_hfd <= max_median_hfd)
+        && (!std::isfinite(max_background_noise)
+            || quality.background_noise <= max_background_noise)
+        && (min_snr <= 0.0 || quality.snr >= min_snr);
+  }
+};
+
+namespace detail {
+
+/**
+ * Background noise and SNR of the frame. Both share the noise estimation.
+ */
+template<typename ImageType>
+FrameQuality measure_noise(const cimg_library::CImg<ImageType> &frame) {
+  FrameQuality quality;
+  double variance_of_noise = frame.variance_noise(0);
+
+  quality.background_noise = std::sqrt(variance_of_noise);
+  quality.snr = snr(frame.variance(0), variance_of_noise);
+
+  return quality;
+}
+
+}  // namespace detail
+
+/**
+ * Measures the quality metrics of a frame.
+ *
+ * The stars are detected the same way as by detect_stars(). The HFD of
+ * each star which is completely inside the frame is measured on its
+ * cutout after subtracting the median of the cutout. The background noise
+ * is the standard deviation of the noise estimated by CImg
+ * (variance_noise()). The SNR is calculated as by snr().
+ *
+ * Star detection is the expensive part. It only runs if measure_stars is
+ * set. The noise estimation is another pass over the frame. It only runs
+ * if measure_noise is set. Metrics which are not measured are NaN.
+ *
+ * NOTE: The thresholder is held by reference. It must outlive the
+ *       estimator.
+ */
+template<typename ImageType = float>
+class FrameQualityEstimator {
+ public:
+  explicit FrameQualityEstimator(const Thresholder<ImageType> &thresholder,
+                                 int cluster_radius = 3,
+                                 unsigned int border = 3)
+      :
+      thresholder_(thresholder),
+      cluster_radius_(cluster_radius),
+      border_(border) {
+  }
+
+  [[nodiscard]] FrameQuality measure(const cimg_library::CImg<ImageType> &frame,
+                                     bool measure_stars = true,
+                                     bool measure_noise = true) const {
+
+    STARMATHPP_INSTRUMENT_SCOPE("algorithm::FrameQualityEstimator::measure");
+    STARMATHPP_INSTRUMENT_PIXELS(frame.size());
+
+    FrameQuality quality =
+        measure_noise ? detail::measure_noise(frame) : FrameQuality();
+
+    if (measure_stars) {
+      measure_stars_of(frame, &quality);
+    }
+
+    return quality;
+  }
+
+ private:
+  const Thresholder<ImageType> &thresholder_;
+  int cluster_radius_;
+  unsigned int border_;
+
+  void measure_stars_of(const cimg_library::CImg<ImageType> &frame,
+                        FrameQuality *quality) const {
+
+    float threshold = std::ceil(thresholder_.calculate_threshold(frame));
+
+    // NOTE: CImg threshold function uses >=
+    auto binary_img = frame.get_threshold(threshold + 1.0F);
+
+    StarClusterAlgorithm star_cluster_algorithm(cluster_radius_);
+    auto pixel_clusters = star_cluster_algorithm.cluster(binary_img);
+
+    Rect<int> frame_bounds(0, 0, frame.width(), frame.height());
+    ImageView<ImageType> frame_view(frame);
+    std::vector<double> hfds;
+
+    for (const auto &pixel_cluster : pixel_clusters) {
+      Rect<int> star_rect = pixel_cluster.get_bounds().expand_to_square().grow(
+          (int) border_);
+
+      if (!frame_bounds.contains(star_rect)) {
+        continue;
+      }
+
+      auto cutout = frame_view.sub_view(star_rect).to_image();
+      ImageType background = cutout.median();
+
+      for (auto &value : cutout) {
+        value = (value > background ? value - background : ImageType(0));
+      }
+
+      double star_hfd = hfd(cutout, (unsigned int) cutout.width());
+
+      if (std::isfinite(star_hfd)) {
+        hfds.push_back(star_hfd);
+      }
+    }
+
+    quality->num_stars = pixel_clusters.size();
+
+    if (!hfds.empty()) {
+      auto median_it = hfds.begin() + (long) hfds.size() / 2;
+      std::nth_element(hfds.begin(), median_it, hfds.end());
+      quality->median_hfd = *median_it;
+    }
+  }
+};
+
+}  // namespace starmathpp::algorithm
+
+#endif // STARMATHPP_ALGORITHM_FRAME_QUALITY_HPP_
@@ -43,6 +43,7 @@
 #include <range/v3/view/iota.hpp>
 
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/image_view.hpp>
 #include <libstarmathpp/exception.hpp>
 #include <libstarmathpp/point.hpp>
 
@@ -82,13 +83,16 @@ struct GaussianResidual {
  */
 template<typename ImageType>
 std::vector<ImageType> extract_row(
-    const cimg_library::CImg<ImageType> &input_image, size_t row_idx) {
+    const ImageView<ImageType> &input_image, size_t row_idx) {
 
-  // TODO: Check if row_idx is valid...
-  std::vector<float> row_values(input_image.width());
-  auto row_img = input_image.get_row(row_idx);
+  // NOTE: Same as CImg get_row(), i.e. a row outside the image is 0.
+  std::vector<float> row_values(input_image.width(), 0);
 
-  std::copy(row_img.begin(), row_img.end(), row_values.begin());
+  if (row_idx < (size_t) input_image.height()) {
+    std::copy(input_image.row(row_idx),
+              input_image.row(row_idx) + input_image.width(),
+              row_values.begin());
+  }
   return row_values;
 }
 
@@ -97,14 +101,16 @@ std::vector<ImageType> extract_row(
  */
 template<typename ImageType>
 std::vector<ImageType> extract_col(
-    const cimg_library::CImg<ImageType> &input_image, size_t col_idx) {
-
-  // TODO: Check if col_idx is valid...
+    const ImageView<ImageType> &input_image, size_t col_idx) {
 
-  std::vector<float> col_values(input_image.height());
-  auto col_img = input_image.get_column(col_idx);
+  // NOTE: Same as CImg get_column(), i.e. a column outside the image is 0.
+  std::vector<float> col_values(input_image.height(), 0);
 
-  std::copy(col_img.begin(), col_img.end(), col_values.begin());
+  if (col_idx < (size_t) input_image.width()) {
+    for (int y = 0; y < input_image.height(); ++y) {
+      col_values[y] = input_image(col_idx, y);
+    }
+  }
   return col_values;
 }
 
@@ -213,7 +219,7 @@ std::optional<double> fwhm_1d_internal(Rng x_data,
  */
 template<typename ImageType>
 std::optional<double> fwhm_internal(
-    const cimg_library::CImg<ImageType> &input_image,
+    const ImageView<ImageType> &input_image,
     const Point<float> &star_center, float scale_factor) {
 
   if (input_image.is_empty()) {
@@ -246,7 +252,7 @@ std::optional<double> fwhm_internal(
  *
  */
 template<typename ImageType>
-std::optional<double> fwhm(const cimg_library::CImg<ImageType> &input_image,
+std::optional<double> fwhm(const ImageView<ImageType> &input_image,
                            const Point<float> &star_center, float scale_factor =
                                1.0F) {
 
@@ -257,7 +263,7 @@ std::optional<double> fwhm(const cimg_library::CImg<ImageType> &input_image,
  *
  */
 template<typename ImageType>
-std::optional<double> fwhm(const cimg_library::CImg<ImageType> &input_image,
+std::optional<double> fwhm(const ImageView<ImageType> &input_image,
                            float scale_factor = 1.0F) {
 
   Point<float> star_center((float) input_image.width() / 2,
@@ -266,6 +272,27 @@ std::optional<double> fwhm(const cimg_library::CImg<ImageType> &input_image,
   return detail::fwhm_internal(input_image, star_center, scale_factor);
 }
 
+/*+
+ *
+ */
+template<typename ImageType>
+std::optional<double> fwhm(const cimg_library::CImg<ImageType> &input_image,
+                           const Point<float> &star_center, float scale_factor =
+                               1.0F) {
+
+  return fwhm(ImageView<ImageType>(input_image), star_center, scale_factor);
+}
+
+/*+
+ *
+ */
+template<typename ImageType>
+std::optional<double> fwhm(const cimg_library::CImg<ImageType> &input_image,
+                           float scale_factor = 1.0F) {
+
+  return fwhm(ImageView<ImageType>(input_image), scale_factor);
+}
+
 }  // namespace starmathpp::algorithm
 
 #endif // STARMATHPP_ALGORITHM_FWHM_HPP_
@@ -35,6 +35,7 @@
 #include <range/v3/empty.hpp>
 
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/image_view.hpp>
 #include <libstarmathpp/point.hpp>
 #include <libstarmathpp/rect.hpp>
 #include <libstarmathpp/size.hpp>
@@ -52,6 +53,44 @@ static double getMaxHfdLimit(unsigned int inOuterHfdDiameter) {
 }
 
 namespace detail {
+
+/**
+ * Calculate the HFD of all pixels inside the circle with the given
+ * radius around the center of the image.
+ */
+template<typename ImageType>
+double hfd_of_circle_internal(const ImageView<ImageType> &sub_img,
+                              double outer_radius, float scale_factor) {
+
+  // Sum up all pixel values in whole circle
+  Point<double> star_center_sub_image_px((double) sub_img.width() / 2.0,
+                                         (double) sub_img.height() / 2.0);
+
+  double sum_pixel_values = 0;
+  double sum_weighted_dist = 0;
+
+  image_view_forXY(sub_img, x, y)
+  {
+    double pixel_distance_to_center = std::hypot(
+        x + 0.5 - star_center_sub_image_px.x(),
+        y + 0.5 - star_center_sub_image_px.y());
+    bool is_inside_circle = (pixel_distance_to_center <= outer_radius);
+
+    if (is_inside_circle) {
+      sum_pixel_values += sub_img(x, y);
+      sum_weighted_dist += sub_img(x, y) * pixel_distance_to_center;
+    }
+  }
+
+  // NOTE: Multiplying with 2 is required since actually just the HFR is calculated above
+  // NOTE: One exception is the case when there is no flux at all (i.e. a totally black image).
+  //       In that case the HFD actually does not exist since there would be a division by 0.
+  //       Therefore, in that situation NaN is returned.
+  return (
+      sum_pixel_values > 0.0 ?
+          (2.0 * sum_weighted_dist / sum_pixel_values) / scale_factor : NAN);
+}
+
 /**
  * HDF calculation
  * https://www.lost-infinity.com/night-sky-image-processing-part-6-measuring-the-half-flux-diameter-hfd-of-a-star-a-simple-c-implementation/
@@ -92,7 +131,7 @@ namespace detail {
  * @return
  */
 template<typename ImageType>
-double hfd_internal(const cimg_library::CImg<ImageType> &input_image,
+double hfd_internal(const ImageView<ImageType> &input_image,
                     const Point<float> &star_center,
                     unsigned int outer_hfd_diameter_px, float scale_factor) {
 
@@ -122,11 +161,19 @@ double hfd_internal(const cimg_library::CImg<ImageType> &input_image,
     throw HfdException(ss.str());
   }
 
-  // Finally, make a copy of the part of the image which is used to calculate the HFD.
-  Image sub_img = input_image.get_crop(
-      (int) sub_image_rect.x() /*x0*/, (int) sub_image_rect.y() /*y0*/,
-      (int) (sub_image_rect.x() + sub_image_rect.width() - 1) /*x1*/,
-      (int) (sub_image_rect.y() + sub_image_rect.height() - 1) /*y1*/);
+  double scaled_outer_radius = scale_factor * outer_hfd_diameter_px / 2.0;
+
+  // NOTE: The part of the image which is used to calculate the HFD is
+  //       just a view, i.e. it is not copied. Only if it needs to be
+  //       scaled, a copy is required.
+  auto sub_img_view = input_image.sub_view(sub_image_rect);
+
+  if (scale_factor == 1.0F) {
+    return hfd_of_circle_internal(sub_img_view, scaled_outer_radius,
+                                  scale_factor);
+  }
+
+  Image sub_img = sub_img_view.to_image();
 
   /**
    * interpolation_type - see https://cimg.eu/reference/structcimg__library_1_1CImg.html
@@ -144,34 +191,8 @@ double hfd_internal(const cimg_library::CImg<ImageType> &input_image,
                  (int) (scale_factor * (double) sub_img.height()),
                  -100 /*size_z*/, -100 /*size_c*/, 1 /*interpolation_type*/);
 
-  // Sum up all pixel values in whole circle
-  Point<double> scaled_star_center_sub_image_px(
-      (double) sub_img.width() / 2.0, (double) sub_img.height() / 2.0);
-
-  double scaled_outer_radius = scale_factor * outer_hfd_diameter_px / 2.0;
-  double sum_pixel_values = 0;
-  double sum_weighted_dist = 0;
-
-  cimg_forXY(sub_img, x, y)
-  {
-    double pixel_distance_to_center = std::hypot(
-        x + 0.5 - scaled_star_center_sub_image_px.x(),
-        y + 0.5 - scaled_star_center_sub_image_px.y());
-    bool is_inside_circle = (pixel_distance_to_center <= scaled_outer_radius);
-
-    if (is_inside_circle) {
-      sum_pixel_values += sub_img(x, y);
-      sum_weighted_dist += sub_img(x, y) * pixel_distance_to_center;
-    }
-  }
-
-  // NOTE: Multiplying with 2 is required since actually just the HFR is calculated above
-  // NOTE: One exception is the case when there is no flux at all (i.e. a totally black image).
-  //       In that case the HFD actually does not exist since there would be a division by 0.
-  //       Therefore, in that situation NaN is returned.
-  return (
-      sum_pixel_values > 0.0 ?
-          (2.0 * sum_weighted_dist / sum_pixel_values) / scale_factor : NAN);
+  return hfd_of_circle_internal(ImageView<ImageType>(sub_img),
+                                scaled_outer_radius, scale_factor);
 }
 }  // namespace detail
 
@@ -179,7 +200,7 @@ double hfd_internal(const cimg_library::CImg<ImageType> &input_image,
  *
  */
 template<typename ImageType>
-double hfd(const cimg_library::CImg<ImageType> &input_image,
+double hfd(const ImageView<ImageType> &input_image,
            const Point<float> &star_center, unsigned int outer_hfd_diameter_px,
            float scale_factor = 1.0F) {
   return detail::hfd_internal(input_image, star_center, outer_hfd_diameter_px,
@@ -190,7 +211,7 @@ double hfd(const cimg_library::CImg<ImageType> &input_image,
  *
  */
 template<typename ImageType>
-double hfd(const cimg_library::CImg<ImageType> &input_image,
+double hfd(const ImageView<ImageType> &input_image,
            unsigned int outer_hfd_diameter_px, float scale_factor = 1.0F) {
 
   Point<float> star_center((float) input_image.width() / 2.0F,
@@ -204,7 +225,7 @@ double hfd(const cimg_library::CImg<ImageType> &input_image,
  *
  */
 template<typename ImageType>
-double hfd(const cimg_library::CImg<ImageType> &input_image,
+double hfd(const ImageView<ImageType> &input_image,
            float scale_factor = 1.0F) {
 
   unsigned int outer_hfd_diameter_px = std::min(input_image.width(), input_image.height());
@@ -216,6 +237,36 @@ double hfd(const cimg_library::CImg<ImageType> &input_image,
                               scale_factor);
 }
 
+/*+
+ *
+ */
+template<typename ImageType>
+double hfd(const cimg_library::CImg<ImageType> &input_image,
+           const Point<float> &star_center, unsigned int outer_hfd_diameter_px,
+           float scale_factor = 1.0F) {
+  return hfd(ImageView<ImageType>(input_image), star_center,
+             outer_hfd_diameter_px, scale_factor);
+}
+
+/**
+ *
+ */
+template<typename ImageType>
+double hfd(const cimg_library::CImg<ImageType> &input_image,
+           unsigned int outer_hfd_diameter_px, float scale_factor = 1.0F) {
+  return hfd(ImageView<ImageType>(input_image), outer_hfd_diameter_px,
+             scale_factor);
+}
+
+/**
+ *
+ */
+template<typename ImageType>
+double hfd(const cimg_library::CImg<ImageType> &input_image,
+           float scale_factor = 1.0F) {
+  return hfd(ImageView<ImageType>(input_image), scale_factor);
+}
+
 }  // namespace starmathpp::algorithm
 
 #endif // STARMATHPP_ALGORITHM_HFD_HPP_
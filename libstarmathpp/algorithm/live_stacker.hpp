@@ -0,0 +1,339 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_ALGORITHM_LIVE_STACKER_HPP_
+#define STARMATHPP_ALGORITHM_LIVE_STACKER_HPP_ STARMATHPP_ALGORITHM_LIVE_STACKER_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include <libstarmathpp/exception.hpp>
+#include <libstarmathpp/frame.hpp>
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/inconsistent_image_dimensions_exception.hpp>
+#include <libstarmathpp/point.hpp>
+#include <libstarmathpp/thread_pool.hpp>
+
+namespace starmathpp::algorithm {
+
+DEF_Exception(LiveStacker);
+
+/**
+ * State of a LiveStacker after a certain number of frames.
+ *
+ * mean and variance are the weighted mean and the weighted (population)
+ * variance of each pixel. weight is the sum of the weights which
+ * contributed to a pixel. It is 0 for pixels which were not covered by
+ * any (shifted) frame. Their mean and variance are 0 as well.
+ */
+struct LiveStackSnapshot {
+  Image mean;
+  Image variance;
+  Image weight;
+  size_t num_frames = 0;
+};
+
+/**
+ * Incremental (online) stacking of frames as they arrive, e.g. from a
+ * camera during an EAA session.
+ *
+ * push() updates a running weighted mean and variance of each pixel
+ * (West's incremental algorithm) in double precision. The cost of one
+ * push() only depends on the frame size - not on the number of frames
+ * stacked so far.
+ *
+ * Each frame may be pushed with a registration offset (dx, dy), i.e. the
+ * position of the reference frame's origin within the frame. Frame pixel
+ * (x, y) is accumulated at (x - dx, y - dy). Pixels shifted outside of the
+ * stack are dropped.
+ *
+ * After each push() the new mean and variance are published as a
+ * snapshot. snapshot() never blocks and never waits for a running push().
+ * It returns the most recently published snapshot. The snapshots are
+ * exchanged through three pre-allocated buffers (triple buffering). Hence,
+ * after the first push() neither push() nor snapshot() allocate memory.
+ *
+ * NOTE: push() must only be called by one thread (the processing thread)
+ *       and snapshot() by one other thread (e.g. the display thread). The
+ *       snapshot returned by snapshot() stays valid until the next call of
+ *       snapshot().
+ *
+ * Usage:
+ *
+ * LiveStacker stacker;
+ *
+ * // Processing thread
+ * stacker.push(frame, Point<int>(dx, dy), weight);
+ *
+ * // Display thread
+ * const LiveStackSnapshot &snapshot = stacker.snapshot();
+ * display(snapshot.mean);
+ */
+class LiveStacker {
+ public:
+  explicit LiveStacker(size_t num_threads = default_num_workers())
+      :
+      thread_pool_(
+          num_threads > 1 ? std::make_unique<ThreadPool>(num_threads - 1) : nullptr),
+      width_(0),
+      height_(0),
+      depth_(0),
+      spectrum_(0),
+      num_frames_(0),
+      back_index_(0),
+      shared_state_(1),
+      front_index_(2) {
+  }
+
+  LiveStacker(const LiveStacker&) = delete;
+  LiveStacker& operator=(const LiveStacker&) = delete;
+
+  /**
+   * Add the frame with the given registration offset and weight to the
+   * stack and publish the new snapshot.
+   *
+   * Throws InconsistentImageDimensionsException if the dimensions differ
+   * from the dimensions of the first frame and LiveStackerException if the
+   * weight is not positive.
+   */
+  template<typename ImageType>
+  void push(const cimg_library::CImg<ImageType> &frame,
+            const Point<int> &offset = Point<int>(0, 0), double weight = 1.0) {
+
+    if (!(weight > 0.0) || !std::isfinite(weight)) {
+      std::stringstream ss;
+      ss << "Invalid frame weight " << weight << ". Expected weight > 0.";
+      throw LiveStackerException(ss.str());
+    }
+
+    if (num_frames_ == 0) {
+      init(frame);
+    } else {
+      throw_if_inconsistent_dimensions(frame);
+    }
+
+    LiveStackSnapshot &back = buffers_[back_index_];
+
+    if (back.mean.size() != means_.size()) {
+      // NOTE: Each buffer is allocated once when it is used for the first time.
+      back.mean.assign(width_, height_, depth_, spectrum_);
+      back.variance.assign(width_, height_, depth_, spectrum_);
+      back.weight.assign(width_, height_, depth_, spectrum_);
+    }
+
+    // Range of stack columns [x_begin, x_end) covered by the shifted frame
+    const int dx = offset.x();
+    const int dy = offset.y();
+    const int x_begin = std::clamp(-dx, 0, width_);
+    const int x_end = std::clamp(width_ - dx, 0, width_);
+
+    const size_t num_rows = (size_t) height_ * depth_ * spectrum_;
+    const size_t row_length = (size_t) width_;
+
+    for_each_row_chunk(thread_pool_.get(), num_rows * row_length, row_length,
+                       [&](size_t begin, size_t end) {
+      for (size_t row = begin / row_length; row < end / row_length; ++row) {
+        const int y = (int) (row % height_);
+        const int frame_y = y + dy;
+        const size_t row_offset = row * row_length;
+
+        if (frame_y >= 0 && frame_y < height_ && x_begin < x_end) {
+          const ImageType *pixels = frame.data() + (long) row_offset
+              + (long) (frame_y - y) * width_ + x_begin + dx;
+
+          update_row(pixels, weight, row_offset + x_begin,
+                     row_offset + x_end);
+        }
+
+        publish_row(back, row_offset, row_offset + row_length);
+      }
+    });
+
+    ++num_frames_;
+    back.num_frames = num_frames_;
+
+    // NOTE: Hand the back buffer over and take the previously shared one.
+    //       Release makes the buffer contents visible to the reader.
+    back_index_ = shared_state_.exchange(back_index_ | NEW_DATA_FLAG,
+                                         std::memory_order_acq_rel)
+        & INDEX_MASK;
+  }
+
+  /**
+   * Push the frame with its native pixel type, i.e. a 16 bit frame is not
+   * promoted to float.
+   */
+  void push(const Frame &frame, const Point<int> &offset = Point<int>(0, 0),
+            double weight = 1.0) {
+    visit_frame([&](const auto &image) {
+      push(image, offset, weight);
+    }, frame);
+  }
+
+  /**
+   * Push all frames of the range with offset (0, 0) and weight 1.
+   */
+  template<typename Rng>
+  LiveStacker& push_all(Rng &&rng) {
+    for (auto &&frame : rng) {
+      push(frame);
+    }
+    return *this;
+  }
+
+  /**
+   * Most recently published snapshot. The snapshot is empty (num_frames
+   * = 0) until the first push() completed.
+   *
+   * NOTE: Lock-free. Only one thread must call snapshot().
+   */
+  const LiveStackSnapshot& snapshot() {
+    if (shared_state_.load(std::memory_order_relaxed) & NEW_DATA_FLAG) {
+      front_index_ = shared_state_.exchange(front_index_,
+                                            std::memory_order_acq_rel)
+          & INDEX_MASK;
+    }
+    return buffers_[front_index_];
+  }
+
+  /**
+   * Number of frames pushed so far. Must only be called by the pushing
+   * thread.
+   */
+  [[nodiscard]] size_t count() const {
+    return num_frames_;
+  }
+
+ private:
+  static constexpr uint8_t INDEX_MASK = 0x3;
+  static constexpr uint8_t NEW_DATA_FLAG = 0x4;
+
+  /**
+   * The workers and the pushing thread update the rows of a frame. The
+   * pool is started once, not per frame. nullptr for a single thread.
+   */
+  std::unique_ptr<ThreadPool> thread_pool_;
+  int width_;
+  int height_;
+  int depth_;
+  int spectrum_;
+  size_t num_frames_;
+
+  std::vector<double> means_;
+  std::vector<double> m2s_;
+  std::vector<double> weights_;
+
+  std::array<LiveStackSnapshot, 3> buffers_;
+
+  // Owned by the pushing thread
+  uint8_t back_index_;
+
+  // Index of the buffer which is exchanged between both threads
+  std::atomic<uint8_t> shared_state_;
+
+  // Owned by the reading thread
+  uint8_t front_index_;
+
+  template<typename ImageType>
+  void init(const cimg_library::CImg<ImageType> &frame) {
+    width_ = frame.width();
+    height_ = frame.height();
+    depth_ = frame.depth();
+    spectrum_ = frame.spectrum();
+
+    means_.assign(frame.size(), 0.0);
+    m2s_.assign(frame.size(), 0.0);
+    weights_.assign(frame.size(), 0.0);
+  }
+
+  /**
+   * Update the running mean and variance of the stack pixels [begin, end)
+   * with the corresponding frame pixels.
+   */
+  template<typename ImageType>
+  void update_row(const ImageType *pixels, double weight, size_t begin,
+                  size_t end) {
+    double *means = means_.data() + begin;
+    double *m2s = m2s_.data() + begin;
+    double *weights = weights_.data() + begin;
+    const size_t num_pixels = end - begin;
+
+    // NOTE: Simple loop over contiguous memory without branches which is
+    //       vectorized by the compiler.
+    for (size_t idx = 0; idx < num_pixels; ++idx) {
+      const double new_weight = weights[idx] + weight;
+      const double delta = static_cast<double>(pixels[idx]) - means[idx];
+      const double r = delta * weight / new_weight;
+
+      means[idx] += r;
+      m2s[idx] += weights[idx] * delta * r;
+      weights[idx] = new_weight;
+    }
+  }
+
+  void publish_row(LiveStackSnapshot &snapshot, size_t begin,
+                   size_t end) const {
+    float *means = snapshot.mean.data();
+    float *variances = snapshot.variance.data();
+    float *weights = snapshot.weight.data();
+
+    for (size_t idx = begin; idx < end; ++idx) {
+      const double weight = weights_[idx];
+
+      means[idx] = static_cast<float>(means_[idx]);
+      variances[idx] = static_cast<float>(
+          weight > 0.0 ? m2s_[idx] / weight : 0.0);
+      weights[idx] = static_cast<float>(weight);
+    }
+  }
+
+  template<typename ImageType>
+  void throw_if_inconsistent_dimensions(
+      const cimg_library::CImg<ImageType> &frame) const {
+
+    if (frame.width() != width_ || frame.height() != height_
+        || frame.depth() != depth_ || frame.spectrum() != spectrum_) {
+      std::stringstream ss;
+
+      ss << "Inconsistent images dimensions. Initial image dimension: " << "("
+         << width_ << ", " << height_ << ", " << depth_ << ", " << spectrum_
+         << "), new image dimension: (" << frame.width() << ", "
+         << frame.height() << ", " << frame.depth() << ", " << frame.spectrum()
+         << ").";
+
+      throw InconsistentImageDimensionsException(ss.str());
+    }
+  }
+};
+
+}  // namespace starmathpp::algorithm
+
+#endif // STARMATHPP_ALGORITHM_LIVE_STACKER_HPP_
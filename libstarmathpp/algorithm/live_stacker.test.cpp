@@ -0,0 +1,227 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "algorithm live stacker unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/algorithm/live_stacker.hpp>
+#include <libstarmathpp/floating_point_equality.hpp>
+#include <libstarmathpp/inconsistent_image_dimensions_exception.hpp>
+
+BOOST_AUTO_TEST_SUITE (algorithm_live_stacker_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::algorithm;
+
+/**
+ * Image with a different value for each pixel.
+ */
+static Image generate_test_image(int width, int height, float offset) {
+  Image image(width, height, 1, 1, 0);
+
+  cimg_forXY(image, x, y)
+  {
+    image(x, y) = offset + 0.1F * (float) ((x * 31 + y * 17) % 97);
+  }
+  return image;
+}
+
+/**
+ * Mean and variance must be equal to the values calculated from all frames.
+ */
+BOOST_AUTO_TEST_CASE(live_stacker_mean_and_variance_test)
+{
+  std::vector<Image> frames = { generate_test_image(40, 30, 1.0F),
+      generate_test_image(40, 30, 7.0F), generate_test_image(40, 30, 2.5F) };
+
+  LiveStacker stacker(2);
+
+  BOOST_TEST(stacker.snapshot().num_frames == 0);
+
+  for (const auto &frame : frames) {
+    stacker.push(frame);
+  }
+
+  const LiveStackSnapshot &snapshot = stacker.snapshot();
+
+  BOOST_TEST(snapshot.num_frames == 3);
+  BOOST_TEST(stacker.count() == 3);
+
+  Image expected_mean(40, 30, 1, 1, 0);
+  Image expected_variance(40, 30, 1, 1, 0);
+
+  cimg_forXY(expected_mean, x, y)
+  {
+    double sum = 0;
+    for (const auto &frame : frames) {
+      sum += frame(x, y);
+    }
+    double mean = sum / 3.0;
+
+    double squared_sum = 0;
+    for (const auto &frame : frames) {
+      squared_sum += (frame(x, y) - mean) * (frame(x, y) - mean);
+    }
+
+    expected_mean(x, y) = (float) mean;
+    expected_variance(x, y) = (float) (squared_sum / 3.0);
+  }
+
+  BOOST_TEST(is_almost_equal(snapshot.mean, expected_mean, 0.0001));
+  BOOST_TEST(is_almost_equal(snapshot.variance, expected_variance, 0.0001));
+  BOOST_TEST(snapshot.weight(5, 5) == 3.0F);
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(live_stacker_weighted_mean_test)
+{
+  LiveStacker stacker(1);
+
+  stacker.push(Image(10, 10, 1, 1, 2.0F), Point<int>(0, 0), 1.0);
+  stacker.push(Image(10, 10, 1, 1, 8.0F), Point<int>(0, 0), 3.0);
+
+  const LiveStackSnapshot &snapshot = stacker.snapshot();
+
+  // (1 * 2 + 3 * 8) / 4 = 6.5
+  BOOST_TEST(snapshot.mean(3, 4) == 6.5F);
+
+  // (1 * 4.5^2 + 3 * 1.5^2) / 4 = 6.75
+  BOOST_TEST(snapshot.variance(3, 4) == 6.75F);
+  BOOST_TEST(snapshot.weight(3, 4) == 4.0F);
+}
+
+/**
+ * Frame pixel (x, y) is accumulated at (x - dx, y - dy). Pixels which are
+ * not covered by the shifted frame keep their previous values.
+ */
+BOOST_AUTO_TEST_CASE(live_stacker_offset_test)
+{
+  LiveStacker stacker(1);
+
+  Image reference(10, 8, 1, 1, 1.0F);
+  Image shifted(10, 8, 1, 1, 0.0F);
+
+  cimg_forXY(shifted, x, y)
+  {
+    shifted(x, y) = (float) (10 * y + x);
+  }
+
+  stacker.push(reference);
+  stacker.push(shifted, Point<int>(2, -1));
+
+  const LiveStackSnapshot &snapshot = stacker.snapshot();
+
+  // Covered: x in [0, 8), y in [1, 8)
+  BOOST_TEST(snapshot.weight(0, 1) == 2.0F);
+  BOOST_TEST(snapshot.mean(0, 1) == (1.0F + 2.0F) / 2.0F);
+  BOOST_TEST(snapshot.mean(7, 7) == (1.0F + 69.0F) / 2.0F);
+
+  BOOST_TEST(snapshot.weight(8, 3) == 1.0F);
+  BOOST_TEST(snapshot.mean(8, 3) == 1.0F);
+  BOOST_TEST(snapshot.weight(3, 0) == 1.0F);
+  BOOST_TEST(snapshot.variance(3, 0) == 0.0F);
+}
+
+/**
+ * A snapshot taken while frames are pushed must always be consistent,
+ * i.e. belong to exactly one frame count.
+ */
+BOOST_AUTO_TEST_CASE(live_stacker_concurrent_snapshot_test)
+{
+  const size_t num_frames = 50;
+  LiveStacker stacker(2);
+  std::atomic<bool> done { false };
+  size_t num_inconsistent_snapshots = 0;
+  size_t last_num_frames = 0;
+  bool num_frames_decreased = false;
+
+  std::thread reader([&]() {
+    while (!done) {
+      const LiveStackSnapshot &snapshot = stacker.snapshot();
+
+      if (snapshot.num_frames == 0) {
+        continue;
+      }
+
+      // Frame i has value i. Hence, the mean is (n - 1) / 2 everywhere.
+      const float expected = (float) (snapshot.num_frames - 1) / 2.0F;
+
+      const float *pixels = snapshot.mean.data();
+
+      if (std::any_of(pixels, pixels + snapshot.mean.size(),
+                      [expected](float value) {
+                        return value != expected;
+                      })) {
+        ++num_inconsistent_snapshots;
+      }
+
+      num_frames_decreased |= (snapshot.num_frames < last_num_frames);
+      last_num_frames = snapshot.num_frames;
+    }
+  });
+
+  for (size_t i = 0; i < num_frames; ++i) {
+    stacker.push(Image(300, 200, 1, 1, (float) i));
+  }
+  done = true;
+  reader.join();
+
+  BOOST_TEST(num_inconsistent_snapshots == 0);
+  BOOST_TEST(!num_frames_decreased);
+  BOOST_TEST(stacker.snapshot().num_frames == num_frames);
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(live_stacker_invalid_input_test)
+{
+  LiveStacker stacker(1);
+
+  stacker.push(Image(10, 10, 1, 1, 1.0F));
+
+  BOOST_CHECK_THROW(stacker.push(Image(11, 10, 1, 1, 1.0F)),
+                    InconsistentImageDimensionsException);
+  BOOST_CHECK_THROW(stacker.push(Image(10, 10, 1, 1, 1.0F), Point<int>(0, 0),
+                                 0.0),
+                    LiveStackerException);
+
+  BOOST_TEST(stacker.count() == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,184 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_ALGORITHM_QUALITY_WEIGHTED_STACKER_HPP_
+#define STARMATHPP_ALGORITHM_QUALITY_WEIGHTED_STACKER_HPP_ STARMATHPP_ALGORITHM_QUALITY_WEIGHTED_STACKER_HPP_
+
+#include <optional>
+#include <vector>
+
+#include <libstarmathpp/exception.hpp>
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/thread_pool.hpp>
+
+#include <libstarmathpp/algorithm/average_stacker.hpp>
+#include <libstarmathpp/algorithm/frame_quality.hpp>
+#include <libstarmathpp/algorithm/threshold/thresholder.hpp>
+
+namespace starmathpp::algorithm {
+
+DEF_Exception(QualityWeightedStacker);
+
+/**
+ * Outcome of adding one frame to a QualityWeightedStacker.
+ */
+struct StackedFrameInfo {
+  FrameQuality quality;
+  double weight = 0.0;
+  bool accepted = false;
+};
+
+/**
+ * Weighted average of a stream of frames. The weight of each frame is
+ * calculated from its quality metrics (see QualityWeighting).
+ *
+ * The metrics are measured by add() right before the frame is accumulated.
+ * Hence, the frames are traversed only once. Frames which do not pass the
+ * quality cut (or which get a weight of 0) are rejected before they touch
+ * the accumulator.
+ *
+ * The stars are only detected if the weighting or the cut needs the star
+ * count or the HFD. Only then a thresholder is required. Likewise, the
+ * noise is only estimated if the background noise or the SNR is used.
+ *
+ * Usage:
+ *
+ * OtsuThresholder<float> thresholder(16);
+ *
+ * QualityWeighting weighting;
+ * weighting.median_hfd_exponent = 2.0;
+ *
+ * QualityCut cut;
+ * cut.min_num_stars = 10;
+ *
+ * QualityWeightedStacker<float> stacker(weighting, cut, &thresholder);
+ *
+ * for (const auto &frame : files("lights", "(.*\\.fit)") | read()) {
+ *   stacker.add(frame);
+ * }
+ * Image master = stacker.result();
+ */
+template<typename ImageType = float>
+class QualityWeightedStacker {
+ public:
+  /**
+   * NOTE: The thresholder is held by reference. It must outlive the
+   *       stacker.
+   */
+  explicit QualityWeightedStacker(
+      const QualityWeighting &weighting = QualityWeighting(),
+      const QualityCut &cut = QualityCut(),
+      const Thresholder<ImageType> *thresholder = nullptr,
+      size_t num_threads = default_num_workers())
+      :
+      weighting_(weighting),
+      cut_(cut),
+      measure_stars_(weighting.requires_stars() || cut.requires_stars()),
+      measure_noise_(weighting.requires_noise() || cut.requires_noise()),
+      stacker_(num_threads) {
+
+    if (measure_stars_) {
+      if (thresholder == nullptr) {
+        throw QualityWeightedStackerException(
+            "Weighting by stars requires a thresholder.");
+      }
+      estimator_.emplace(*thresholder);
+    }
+  }
+
+  /**
+   * Measure the quality of the frame and add it with the resulting weight
+   * if it passes the quality cut.
+   */
+  StackedFrameInfo add(const cimg_library::CImg<ImageType> &frame) {
+    StackedFrameInfo info;
+
+    info.quality = measure(frame);
+    info.weight = weighting_.weight(info.quality);
+    info.accepted = (info.weight > 0.0 && cut_.accepts(info.quality));
+
+    if (info.accepted) {
+      stacker_.add(frame, info.weight);
+    }
+
+    frame_infos_.push_back(info);
+
+    return info;
+  }
+
+  /**
+   * Add all frames of the range. The range is traversed exactly once.
+   */
+  template<typename Rng>
+  QualityWeightedStacker& add_all(Rng &&rng) {
+    for (auto &&frame : rng) {
+      add(frame);
+    }
+    return *this;
+  }
+
+  /**
+   * Quality, weight and acceptance of all frames in the order they were
+   * added.
+   */
+  [[nodiscard]] const std::vector<StackedFrameInfo>& frame_infos() const {
+    return frame_infos_;
+  }
+
+  [[nodiscard]] size_t num_accepted() const {
+    return stacker_.count();
+  }
+
+  /**
+   * Weighted average of all accepted frames. An empty image is returned if
+   * no frame was accepted.
+   */
+  template<typename ResultType = float>
+  [[nodiscard]] cimg_library::CImg<ResultType> result() const {
+    return stacker_.template result<ResultType>();
+  }
+
+ private:
+  QualityWeighting weighting_;
+  QualityCut cut_;
+  bool measure_stars_;
+  bool measure_noise_;
+  AverageStacker stacker_;
+  std::optional<FrameQualityEstimator<ImageType>> estimator_;
+  std::vector<StackedFrameInfo> frame_infos_;
+
+  FrameQuality measure(const cimg_library::CImg<ImageType> &frame) const {
+    if (estimator_.has_value()) {
+      return estimator_->measure(frame, true /*measure stars*/, measure_noise_);
+    }
+
+    // NOTE: Noise and SNR do not need a thresholder.
+    return measure_noise_ ? detail::measure_noise(frame) : FrameQuality();
+  }
+};
+
+}  // namespace starmathpp::algorithm
+
+#endif // STARMATHPP_ALGORITHM_QUALITY_WEIGHTED_STACKER_HPP_
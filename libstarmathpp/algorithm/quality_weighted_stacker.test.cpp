@@ -0,0 +1,216 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "algorithm quality weighted stacker unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/algorithm/quality_weighted_stacker.hpp>
+#include <libstarmathpp/algorithm/threshold/mean_thresholder.hpp>
+#include <libstarmathpp/floating_point_equality.hpp>
+
+BOOST_AUTO_TEST_SUITE (algorithm_quality_weighted_stacker_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::algorithm;
+
+/**
+ * Constant background with gaussian noise of the given standard deviation.
+ */
+static Image generate_noise_image(float background, float sigma,
+                                  unsigned int seed) {
+  std::mt19937 generator(seed);
+  std::normal_distribution<float> distribution(0.0F, sigma);
+
+  Image image(200, 150, 1, 1, 0);
+
+  cimg_forXY(image, x, y)
+  {
+    image(x, y) = background + distribution(generator);
+  }
+  return image;
+}
+
+/**
+ * Gaussian stars of the given sigma on a constant background.
+ */
+static Image generate_star_image(const std::vector<Point<int>> &star_positions,
+                                 float star_sigma) {
+  Image image(200, 150, 1, 1, 100);
+
+  for (const auto &pos : star_positions) {
+    cimg_forXY(image, x, y)
+    {
+      float dx = (float) (x - pos.x());
+      float dy = (float) (y - pos.y());
+
+      image(x, y) += 5000.0F
+          * std::exp(-(dx * dx + dy * dy) / (2.0F * star_sigma * star_sigma));
+    }
+  }
+  return image;
+}
+
+/**
+ * By default, the frames are weighted by their inverse noise variance.
+ */
+BOOST_AUTO_TEST_CASE(quality_weighted_stacker_noise_weighting_test)
+{
+  QualityWeightedStacker<float> stacker;
+
+  auto low_noise_info = stacker.add(generate_noise_image(100, 2, 1));
+  auto high_noise_info = stacker.add(generate_noise_image(200, 4, 2));
+
+  BOOST_TEST(low_noise_info.accepted);
+  BOOST_TEST(high_noise_info.accepted);
+  BOOST_TEST(low_noise_info.quality.background_noise > 1.5);
+  BOOST_TEST(low_noise_info.quality.background_noise < 2.5);
+  BOOST_TEST(low_noise_info.quality.num_stars == 0);
+
+  // Weights are about 1/4 and 1/16, i.e. 4:1.
+  double weight_ratio = low_noise_info.weight / high_noise_info.weight;
+  BOOST_TEST(weight_ratio > 3.0);
+  BOOST_TEST(weight_ratio < 5.5);
+
+  double expected_mean = (low_noise_info.weight * 100.0
+      + high_noise_info.weight * 200.0)
+      / (low_noise_info.weight + high_noise_info.weight);
+
+  BOOST_TEST(std::abs(stacker.result().mean() - expected_mean) < 0.1);
+  BOOST_TEST(stacker.num_accepted() == 2);
+}
+
+/**
+ * Frames which fail the quality cut must not be accumulated.
+ */
+BOOST_AUTO_TEST_CASE(quality_weighted_stacker_quality_cut_test)
+{
+  QualityCut cut;
+  cut.max_background_noise = 3.0;
+
+  QualityWeightedStacker<float> stacker(QualityWeighting(), cut);
+
+  Image good_frame = generate_noise_image(100, 2, 3);
+
+  stacker.add(good_frame);
+  auto bad_info = stacker.add(generate_noise_image(500, 10, 4));
+
+  BOOST_TEST(!bad_info.accepted);
+  BOOST_TEST(stacker.num_accepted() == 1);
+  BOOST_TEST(stacker.frame_infos().size() == 2);
+  BOOST_TEST(is_almost_equal(stacker.result(), good_frame, 0.0001));
+}
+
+/**
+ * Sharp frames must get a higher weight than blurred ones if weighted by
+ * the HFD. Frames with too few stars are rejected.
+ */
+BOOST_AUTO_TEST_CASE(quality_weighted_stacker_star_weighting_test)
+{
+  std::vector<Point<int>> star_positions = { Point<int>(40, 40), Point<int>(
+      150, 30), Point<int>(100, 100), Point<int>(30, 120) };
+
+  MeanThresholder<float> thresholder;
+
+  QualityWeighting weighting;
+  weighting.median_hfd_exponent = 2.0;
+  weighting.background_noise_exponent = 0.0;
+
+  QualityCut cut;
+  cut.min_num_stars = 3;
+
+  QualityWeightedStacker<float> stacker(weighting, cut, &thresholder);
+
+  auto sharp_info = stacker.add(generate_star_image(star_positions, 1.5F));
+  auto blurred_info = stacker.add(generate_star_image(star_positions, 3.0F));
+  auto few_stars_info = stacker.add(
+      generate_star_image( { Point<int>(100, 100) }, 1.5F));
+
+  BOOST_TEST(sharp_info.quality.num_stars == 4);
+  BOOST_TEST(blurred_info.quality.num_stars == 4);
+  BOOST_TEST(sharp_info.quality.median_hfd < blurred_info.quality.median_hfd);
+  BOOST_TEST(sharp_info.weight > blurred_info.weight);
+
+  BOOST_TEST(few_stars_info.quality.num_stars == 1);
+  BOOST_TEST(!few_stars_info.accepted);
+  BOOST_TEST(stacker.num_accepted() == 2);
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(quality_weighted_stacker_missing_thresholder_test)
+{
+  QualityWeighting weighting;
+  weighting.star_count_exponent = 1.0;
+
+  BOOST_CHECK_THROW(QualityWeightedStacker<float> stacker(weighting),
+                    QualityWeightedStackerException);
+}
+
+/**
+ * Frames without measurable noise (constant data) must be stacked by the
+ * default weighting instead of being rejected with an infinite weight.
+ */
+BOOST_AUTO_TEST_CASE(quality_weighted_stacker_noise_free_frames_test)
+{
+  QualityWeightedStacker<float> stacker;
+
+  auto info1 = stacker.add(Image(200, 150, 1, 1, 100));
+  auto info2 = stacker.add(Image(200, 150, 1, 1, 300));
+
+  BOOST_TEST(info1.accepted);
+  BOOST_TEST(info2.accepted);
+  BOOST_TEST(std::isfinite(info1.weight));
+  BOOST_TEST(is_almost_equal(stacker.result(), Image(200, 150, 1, 1, 200), 0.0001));
+}
+
+/**
+ * The noise is not estimated if neither the weighting nor the cut uses it.
+ */
+BOOST_AUTO_TEST_CASE(quality_weighted_stacker_noise_not_measured_test)
+{
+  QualityWeighting weighting;
+  weighting.background_noise_exponent = 0.0;
+
+  QualityWeightedStacker<float> stacker(weighting);
+
+  auto info = stacker.add(generate_noise_image(100, 2, 5));
+
+  BOOST_TEST(info.accepted);
+  BOOST_TEST(info.weight == 1.0);
+  BOOST_TEST(std::isnan(info.quality.background_noise));
+  BOOST_TEST(std::isnan(info.quality.snr));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -31,8 +31,8 @@
 #include <range/v3/empty.hpp>
 
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/image_view.hpp>
 #include <libstarmathpp/inconsistent_image_dimensions_exception.hpp>
-#include <libstarmathpp/image.hpp>
 
 namespace starmathpp::algorithm {
 
@@ -64,18 +64,36 @@ namespace starmathpp::algorithm {
  *       values which were required on the way to the actual SNR calculation as well as the
  *       corresponding image.
  */
+inline double snr(double variance_of_image,
+                  double estimated_variance_of_noise) {
+  double q = variance_of_image / estimated_variance_of_noise;
+  double q_clip = (q > 1 ? q : 1);
+
+  // The simulated variance of the noise will be different from the noise in the real image.
+  // Therefore it can happen that q becomes < 1. If that happens it should be limited to 1.
+  return std::sqrt(q_clip - 1);
+}
+
+/**
+ * SNR of the image. See above.
+ */
 template<typename ImageType>
 double snr(const cimg_library::CImg<ImageType> &input_image) {
   // 0 = Calc. variance  as "second moment" according to
   // https://kogs-www.informatik.uni-hamburg.de/~neumann/BV-WS-2010/Folien/BV-4-10.pdf
   double variance_of_image = input_image.variance(0);
   double estimated_variance_of_noise = input_image.variance_noise(0);
-  double q = variance_of_image / estimated_variance_of_noise;
-  double q_clip = (q > 1 ? q : 1);
 
-  // The simulated variance of the noise will be different from the noise in the real image.
-  // Therefore it can happen that q becomes < 1. If that happens it should be limited to 1.
-  return std::sqrt(q_clip - 1);
+  return snr(variance_of_image, estimated_variance_of_noise);
+}
+
+/**
+ * NOTE: The noise estimation of CImg (variance_noise()) requires an image.
+ *       Therefore, the pixels of the view are copied.
+ */
+template<typename ImageType>
+double snr(const ImageView<ImageType> &input_image) {
+  return snr(input_image.to_image());
 }
 
 }  // namespace starmathpp::algorithm
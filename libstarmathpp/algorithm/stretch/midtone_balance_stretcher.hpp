@@ -26,6 +26,11 @@
 #ifndef STARMATHPP_ALGORITHM_MIDTONE_BALANCE_STRETCHER_HPP_
 #define STARMATHPP_ALGORITHM_MIDTONE_BALANCE_STRETCHER_HPP_ STARMATHPP_ALGORITHM_MIDTONE_BALANCE_STRETCHER_HPP_
 
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <vector>
+
 #include <libstarmathpp/algorithm/stretch/stretcher.hpp>
 #include <libstarmathpp/image.hpp>
 
@@ -89,23 +94,68 @@ class MidtoneBalanceStretcher : public Stretcher {
     return (v < 0.0F ? 0.0F : v);
   }
 
+  /**
+   * Same as CImg get_normalize(0, 1) but for a single pixel value.
+   */
+  static float normalize(float v, float min_value, float max_value) {
+    return (min_value == max_value ? 0.0F : (v - min_value) / (max_value - min_value));
+  }
+
+  /**
+   * Same as CImg median() but re-uses the given values instead of
+   * copying them. The order of the values is changed.
+   */
+  static float median_in_place(std::vector<float> &values) {
+    auto mid = values.begin() + values.size() / 2;
+
+    std::nth_element(values.begin(), mid, values.end());
+
+    float median = *mid;
+
+    if (values.size() % 2 == 0) {
+      median = (median + *std::max_element(values.begin(), mid)) / 2.0F;
+    }
+    return median;
+  }
+
   /**
    *
    */
   std::tuple<float, float, float> find_midtones_balance(
-      const cimg_library::CImg<float> &input_image, float target_background =
-          0.25F) const {
+      const ImageView<float> &input_image, float min_value,
+      float max_value, float target_background = 0.25F) const {
 
 #define shadowsClipping -2.80f /* Shadows clipping point measured in sigma units from the main histogram peak. */
     //#define targetBackground 0.25f /* final "luminance" of the image for autostretch in the [0,1] range */
 
     using namespace cimg_library;
 
+    // NOTE: Calculating the median requires a copy of the normalized pixel
+    //       values. The buffer is kept per thread, so that it is allocated
+    //       only once and not for every image.
+    thread_local std::vector<float> values;
+
+    values.resize(input_image.size());
+
+    auto values_it = values.begin();
+
+    for (int y = 0; y < input_image.height(); ++y) {
+      values_it = std::transform(input_image.row(y),
+                                 input_image.row(y) + input_image.width(),
+                                 values_it, [=](float v) {
+                                   return normalize(v, min_value, max_value);
+                                 });
+    }
+
     // The MAD is defined as the median of the absolute deviations from the
     // data's median: MAD = median (| Xi − median(X) |)
-    auto median = input_image.median();
-    auto median_diff_image = input_image - median;
-    auto mad = median_diff_image.abs().median();
+    auto median = median_in_place(values);
+
+    for (float &v : values) {
+      v = std::abs(v - median);
+    }
+
+    auto mad = median_in_place(values);
 
     // this is a guard to avoid breakdown point
     if (mad == 0.0F) {
@@ -142,7 +192,7 @@ class MidtoneBalanceStretcher : public Stretcher {
    */
   [[nodiscard]]
   cimg_library::CImg<uint8_t> stretch(
-      const cimg_library::CImg<float> &input_image) const override {
+      const ImageView<float> &input_image) const override {
 
     if (input_image.width() <= 0 || input_image.height() <= 0) {
       throw StretcherException("No image supplied.");
@@ -150,27 +200,31 @@ class MidtoneBalanceStretcher : public Stretcher {
 
     using namespace cimg_library;
 
-    DEBUG_IMAGE_DISPLAY(input_image, "midtone_balance_stretcher_in",
+    DEBUG_IMAGE_DISPLAY(input_image.to_image(), "midtone_balance_stretcher_in",
                         STARMATHPP_ALGORITHM_MIDTONE_BALANCE_STRETCHER_DEBUG);
 
-    CImg<float> normalized_image = input_image.get_normalize(0.0F, 1.0F);
+    // NOTE: The image is normalized to [0, 1] on the fly instead of
+    //       creating a normalized copy.
+    float min_value = 0.0F;
+    float max_value = input_image.max_min(min_value);
+
     auto [midtone, shadows, highlights] = find_midtones_balance(
-        normalized_image, target_background_);
+        input_image, min_value, max_value, target_background_);
 
     CImg<uint8_t> dest_image(input_image.width(), input_image.height(), 1, 1,
                              0);
 
-    cimg_forXY(normalized_image, x, y)
+    image_view_forXY(input_image, x, y)
     {
       dest_image(x, y) = 255
-          * midtone_transfer_function(normalized_image(x, y), midtone, shadows,
-                                      highlights);
+          * midtone_transfer_function(
+              normalize(input_image(x, y), min_value, max_value), midtone,
+              shadows, highlights);
     }
 
     DEBUG_IMAGE_DISPLAY(dest_image, "midtone_balance_stretcher_out",
                         STARMATHPP_ALGORITHM_MIDTONE_BALANCE_STRETCHER_DEBUG);
 
-    // TODO: Avoid copy.... maybe move semantics?
     return dest_image;
   }
 
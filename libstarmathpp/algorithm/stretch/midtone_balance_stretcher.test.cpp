@@ -58,6 +58,43 @@ BOOST_AUTO_TEST_CASE(algorithm_midtone_balance_stretcher_test) {
 //  TODO: BOOST_TEST(is_almost_equal(threshold, 5.0F));
 }
 
+/**
+ * Test if stretching an image gives the same result as the straight forward
+ * implementation based on a normalized copy of the image.
+ */
+BOOST_AUTO_TEST_CASE(algorithm_midtone_balance_stretcher_reference_test) {
+  Image input_image(64, 48, 1, 1, 0);
+
+  cimg_forXY(input_image, x, y)
+  {
+    input_image(x, y) = (float) ((x * 7919 + y * 104729) % 1000) + 100.0F;
+  }
+
+  // Reference implementation
+  Image normalized_image = input_image.get_normalize(0.0F, 1.0F);
+  float median = normalized_image.median();
+  float mad = (normalized_image - median).abs().median();
+  float shadows = std::max(0.0F, median - 2.80F * mad);
+  float xp = median - shadows;
+  float m = ((0.25F - 1.0F) * xp) / (((2.0F * 0.25F - 1.0F) * xp) - 0.25F);
+
+  cimg_library::CImg<uint8_t> expected_image(input_image.width(),
+                                             input_image.height(), 1, 1, 0);
+
+  cimg_forXY(normalized_image, x, y)
+  {
+    float v = normalized_image(x, y);
+    float xv = (v - shadows) / (1.0F - shadows);
+    expected_image(x, y) = (
+        v <= shadows ? 0 :
+        v >= 1.0F ? 255 : 255 * (((m - 1.0F) * xv) / (((2.0F * m - 1.0F) * xv) - m)));
+  }
+
+  MidtoneBalanceStretcher midtone_balance_stretcher(0.25F);
+
+  BOOST_TEST(midtone_balance_stretcher.stretch(input_image) == expected_image);
+}
+
 // TODO: Test empty image...
 // TODO: Add further tests
 
@@ -29,6 +29,7 @@
 #include <string>
 
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/image_view.hpp>
 #include <libstarmathpp/exception.hpp>
 
 namespace starmathpp::algorithm {
@@ -42,7 +43,7 @@ class Stretcher {
 
   [[nodiscard]]
   virtual cimg_library::CImg<uint8_t> stretch(
-      const cimg_library::CImg<float> &input_image) const = 0;
+      const ImageView<float> &input_image) const = 0;
 
 //  [[nodiscard]]
 //  virtual cimg_library::CImg<uint8_t> map(
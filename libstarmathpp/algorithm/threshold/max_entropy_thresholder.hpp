@@ -54,7 +54,7 @@ class MaxEntropyThresholder : public Thresholder<ImageType> {
    *
    */
   [[nodiscard]] float calculate_threshold(
-      const cimg_library::CImg<ImageType> &input_image) const override {
+      const ImageView<ImageType> &input_image) const override {
 
     if (input_image.width() <= 0 || input_image.height() <= 0) {
       throw ThresholderException("No image supplied.");
@@ -74,7 +74,7 @@ class MaxEntropyThresholder : public Thresholder<ImageType> {
      * histogram. In order to get the threshold for the initial float image, this transformation needs to be reverted
      * later (see comment below).
      */
-    cimg_forXY(input_image, x, y)
+    image_view_forXY(input_image, x, y)
     {
       int idx = (int) ((float) (num_bins - 1) * (input_image(x, y) - min)
           / (max - min + 1));
@@ -47,7 +47,7 @@ class MeanThresholder : public Thresholder<ImageType> {
    *
    */
   [[nodiscard]] float calculate_threshold(
-      const cimg_library::CImg<ImageType> &input_image) const override {
+      const ImageView<ImageType> &input_image) const override {
 
     if (input_image.width() <= 0 || input_image.height() <= 0) {
       throw ThresholderException("No image supplied.");
@@ -86,7 +86,7 @@ class OtsuThresholder : public Thresholder<ImageType> {
    *
    */
   [[nodiscard]] float calculate_threshold(
-      const cimg_library::CImg<ImageType> &input_image) const override {
+      const ImageView<ImageType> &input_image) const override {
 
     if (input_image.width() <= 0 || input_image.height() <= 0) {
       throw ThresholderException("No image supplied.");
@@ -103,7 +103,7 @@ class OtsuThresholder : public Thresholder<ImageType> {
     float threshold2 = 0.0F;
 
     // Calculate histogram - for some reason inImg.get_histogram() behaves unexpectedly.
-    cimg_forXY(input_image, x, y)
+    image_view_forXY(input_image, x, y)
     {
       int value = (int) input_image(x, y);
       ++hist[value];
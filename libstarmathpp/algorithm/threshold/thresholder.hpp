@@ -29,6 +29,7 @@
 #include <string>
 
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/image_view.hpp>
 #include <libstarmathpp/exception.hpp>
 
 namespace starmathpp::algorithm {
@@ -42,7 +43,7 @@ class Thresholder {
   [[nodiscard]] virtual std::string get_name() const = 0;
 
   [[nodiscard]] virtual float calculate_threshold(
-      const cimg_library::CImg<ImageType> &input_image) const = 0;
+      const ImageView<ImageType> &input_image) const = 0;
 };
 
 }  // namespace starmathpp::algorithm
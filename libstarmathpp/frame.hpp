@@ -0,0 +1,131 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_FRAME_HPP_
+#define STARMATHPP_FRAME_HPP_ STARMATHPP_FRAME_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include <libstarmathpp/enum_helper.hpp>
+#include <libstarmathpp/image.hpp>
+
+namespace starmathpp {
+
+/**
+ * Image with 16 bit unsigned integer pixels - the native format of most
+ * astronomical cameras. It needs half the memory of an Image.
+ */
+using Image16 = cimg_library::CImg<uint16_t>;
+
+/**
+ * An image whose pixel type is only known at runtime, i.e. after the file
+ * was read (see io::read_frame()).
+ *
+ * 16 bit data stays 16 bit until an operation actually requires floating
+ * point values (e.g. the division by a flat). Stages which support both
+ * pixel types dispatch to a kernel for the concrete type (see
+ * visit_frame()). Other stages promote the frame with to_image().
+ */
+using Frame = std::variant<Image16, Image>;
+
+/**
+ * Pixel type of a Frame. The values correspond to the variant index.
+ */
+struct PixelType {
+  enum TypeE {
+    UINT16,
+    FLOAT32,
+    _Count
+  };
+
+  static const char* asStr(const TypeE &inType) {
+    switch (inType) {
+      case UINT16:
+        return "UINT16";
+      case FLOAT32:
+        return "FLOAT32";
+      default:
+        return "<?>";
+    }
+  }
+
+  MAC_AS_TYPE(Type, E, _Count)
+  ;
+};
+
+inline PixelType::TypeE pixel_type(const Frame &frame) {
+  return static_cast<PixelType::TypeE>(frame.index());
+}
+
+inline size_t num_pixels(const Frame &frame) {
+  return std::visit([](const auto &image) -> size_t {
+    return image.size();
+  }, frame);
+}
+
+/**
+ * Call fun with the image of the concrete pixel type.
+ */
+template<typename Fun, typename FrameType,
+    typename = std::enable_if_t<std::is_same_v<std::decay_t<FrameType>, Frame>>>
+decltype(auto) visit_frame(Fun &&fun, FrameType &&frame) {
+  return std::visit(std::forward<Fun>(fun), std::forward<FrameType>(frame));
+}
+
+/**
+ * Convert the frame to an image with the given pixel type. If the frame
+ * already has this pixel type, the image is moved out of the frame, i.e.
+ * no pixels are copied.
+ */
+template<typename ImageType = float>
+cimg_library::CImg<ImageType> to_image(Frame &&frame) {
+  return std::visit([](auto &&image) -> cimg_library::CImg<ImageType> {
+    using FrameImageType = std::decay_t<decltype(image)>;
+
+    if constexpr (std::is_same_v<FrameImageType, cimg_library::CImg<ImageType>>) {
+      return std::move(image);
+    } else {
+      return cimg_library::CImg<ImageType>(image);
+    }
+  }, std::move(frame));
+}
+
+/**
+ * Same as above, but the pixels are always copied.
+ */
+template<typename ImageType = float>
+cimg_library::CImg<ImageType> to_image(const Frame &frame) {
+  return std::visit([](const auto &image) {
+    return cimg_library::CImg<ImageType>(image);
+  }, frame);
+}
+
+}  // namespace starmathpp
+
+#endif // STARMATHPP_FRAME_HPP_
@@ -0,0 +1,96 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "frame unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <cstdint>
+#include <type_traits>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/frame.hpp>
+
+BOOST_AUTO_TEST_SUITE (frame_tests)
+
+using namespace starmathpp;
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(frame_pixel_type_test)
+{
+  Frame frame_16 = Image16(4, 3, 1, 1, 7);
+  Frame frame_32 = Image(4, 3, 1, 1, 0.5F);
+
+  BOOST_TEST(pixel_type(frame_16) == PixelType::UINT16);
+  BOOST_TEST(pixel_type(frame_32) == PixelType::FLOAT32);
+  BOOST_TEST(num_pixels(frame_16) == 12);
+}
+
+/**
+ * A 16 bit frame is converted, a float frame is moved out of the frame.
+ */
+BOOST_AUTO_TEST_CASE(frame_to_image_test)
+{
+  Frame frame_16 = Image16(4, 3, 1, 1, 65535);
+  Image image_16 = to_image(std::move(frame_16));
+
+  BOOST_TEST(image_16(3, 2) == 65535.0F);
+
+  Frame frame_32 = Image(4, 3, 1, 1, 0.5F);
+  const float *pixels = std::get<Image>(frame_32).data();
+
+  Image image_32 = to_image(std::move(frame_32));
+
+  BOOST_TEST(image_32(0, 0) == 0.5F);
+  BOOST_TEST(image_32.data() == pixels);
+
+  // A const frame is copied
+  const Frame const_frame = Image(2, 2, 1, 1, 3.0F);
+  Image copied_image = to_image(const_frame);
+
+  BOOST_TEST(copied_image.data() != std::get<Image>(const_frame).data());
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(frame_visit_test)
+{
+  Frame frame = Image16(4, 3, 1, 1, 7);
+
+  size_t pixel_size = visit_frame([](const auto &image) {
+    using ImageType = typename std::decay_t<decltype(image)>::value_type;
+    return sizeof(ImageType);
+  }, frame);
+
+  BOOST_TEST(pixel_size == sizeof(uint16_t));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
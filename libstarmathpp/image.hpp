@@ -85,10 +85,8 @@ namespace starmathpp {
  * a compromise between accuracy and memory consumption. This way all
  * possible bit depths (2, 8, 16 and 32 bit) are supported.
  *
- * IDEA: Two options to potentially improve this are:
- *
- * Boost any: https://www.boost.org/doc/libs/1_54_0/doc/html/any/s02.html
- * Boost variant: https://www.boost.org/doc/libs/1_54_0/doc/html/variant.html
+ * NOTE: If the native pixel type of the file should be kept (e.g. 16 bit
+ *       sensor data), use Frame (see frame.hpp) and io::read_frame().
  */
 using Image = cimg_library::CImg<float>;
 using ImagePtr = std::unique_ptr<Image>;
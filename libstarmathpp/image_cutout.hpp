@@ -0,0 +1,152 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_IMAGE_CUTOUT_HPP_
+#define STARMATHPP_IMAGE_CUTOUT_HPP_ STARMATHPP_IMAGE_CUTOUT_HPP_
+
+#include <memory>
+#include <utility>
+
+#include <libstarmathpp/exception.hpp>
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/image_view.hpp>
+#include <libstarmathpp/rect.hpp>
+
+namespace starmathpp {
+
+DEF_Exception(ImageCutout);
+
+/**
+ * Shared, immutable, reference-counted handle to an image (e.g. a frame
+ * of a pipeline). Copying the handle does not copy the pixels. The image
+ * is released together with the last handle.
+ */
+template<typename ImageType = float>
+using SharedImage = std::shared_ptr<const cimg_library::CImg<ImageType>>;
+
+template<typename ImageType = float>
+SharedImage<ImageType> make_shared_image(
+    cimg_library::CImg<ImageType> &&image) {
+  return std::make_shared<const cimg_library::CImg<ImageType>>(
+      std::move(image));
+}
+
+/**
+ * A region of a shared image which is only copied ("materialized") when
+ * it is needed.
+ *
+ * Each cutout holds a reference to the image it was cut from. Materializing
+ * an rvalue cutout releases this reference. Therefore, the image is released
+ * as soon as the last of its cutouts was materialized (or destroyed).
+ *
+ * A cutout implicitly converts to a CImg. Therefore, it can be passed to
+ * all pipeline views which expect an image.
+ *
+ * NOTE: After views::move, each element must only be read once. Views
+ *       which read an element more than once (e.g. views::filter reads it
+ *       for the predicate and again for the result) need a
+ *       ranges::views::cache1 in front. Otherwise, the second read finds
+ *       a released cutout and throws an ImageCutoutException.
+ */
+template<typename ImageType = float>
+class ImageCutout {
+ public:
+  ImageCutout() = default;
+
+  ImageCutout(SharedImage<ImageType> image, const Rect<int> &region)
+      :
+      image_(std::move(image)),
+      region_(region) {
+  }
+
+  [[nodiscard]] const Rect<int>& region() const {
+    return region_;
+  }
+
+  [[nodiscard]] const SharedImage<ImageType>& image() const {
+    return image_;
+  }
+
+  [[nodiscard]] bool is_materializable() const {
+    return image_ != nullptr;
+  }
+
+  /**
+   * View of the region without copying the pixels. The region must be
+   * completely inside the image (see ImageView).
+   *
+   * NOTE: The view is only valid as long as this cutout holds the image.
+   */
+  [[nodiscard]] ImageView<ImageType> view() const {
+    throw_if_released();
+    return ImageView<ImageType>(*image_, region_);
+  }
+
+  /**
+   * Copy the region into a new image. Pixels outside the image are 0
+   * (same as CImg get_crop()).
+   */
+  [[nodiscard]] cimg_library::CImg<ImageType> materialize() const & {
+    throw_if_released();
+
+    // See https://github.com/GreycLab/CImg/issues/110
+    return image_->get_crop(region_.x() /*x0*/, region_.y() /*y0*/,
+                            region_.x() + (int) region_.width() - 1/*x1*/,
+                            region_.y() + (int) region_.height() - 1/*y1*/);
+  }
+
+  /**
+   * Same as above but releases the reference to the image afterwards.
+   */
+  [[nodiscard]] cimg_library::CImg<ImageType> materialize() && {
+    auto image = static_cast<const ImageCutout&>(*this).materialize();
+    image_.reset();
+    return image;
+  }
+
+  operator cimg_library::CImg<ImageType>() const & {  // NOLINT(google-explicit-constructor)
+    return materialize();
+  }
+
+  operator cimg_library::CImg<ImageType>() && {  // NOLINT(google-explicit-constructor)
+    return std::move(*this).materialize();
+  }
+
+ private:
+  SharedImage<ImageType> image_;
+  Rect<int> region_;
+
+  void throw_if_released() const {
+    if (image_ == nullptr) {
+      throw ImageCutoutException(
+          "Cutout has no image. It was either default constructed or already "
+          "materialized as rvalue (e.g. read twice after views::move).");
+    }
+  }
+};
+
+}  // namespace starmathpp
+
+#endif // STARMATHPP_IMAGE_CUTOUT_HPP_
@@ -0,0 +1,167 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "image cutout unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <memory>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <range/v3/algorithm/none_of.hpp>
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/cache1.hpp>
+#include <range/v3/view/filter.hpp>
+#include <range/v3/view/move.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <libstarmathpp/image_cutout.hpp>
+
+using namespace starmathpp;
+
+BOOST_AUTO_TEST_SUITE(image_cutout_tests)
+
+/**
+ * Test if a cutout refers to the shared image and if materializing it
+ * gives the same result as CImg get_crop().
+ */
+BOOST_AUTO_TEST_CASE(image_cutout_materialize_test) {
+  Image image(20, 10, 1, 1, 0);
+  image(5, 5) = 100;
+
+  Image expected_image = image.get_crop(3, 3, 7, 7);
+
+  auto shared_image = make_shared_image(std::move(image));
+  ImageCutout<float> cutout(shared_image, Rect<int>(3, 3, 5, 5));
+
+  BOOST_TEST(cutout.image() == shared_image);
+  BOOST_TEST(cutout.view().data() == shared_image->data(3, 3));
+  BOOST_TEST(cutout.materialize() == expected_image);
+
+  // Materializing an lvalue keeps the reference to the image
+  BOOST_TEST(cutout.is_materializable());
+}
+
+/**
+ * Test if a cutout which exceeds the image is filled with 0 when it
+ * is materialized.
+ */
+BOOST_AUTO_TEST_CASE(image_cutout_outside_image_test) {
+  Image image(20, 10, 1, 1, 1);
+  Image expected_image = image.get_crop(-2, -2, 2, 2);
+
+  ImageCutout<float> cutout(make_shared_image(std::move(image)),
+                            Rect<int>(-2, -2, 5, 5));
+
+  BOOST_TEST(cutout.materialize() == expected_image);
+  BOOST_CHECK_THROW(auto view = cutout.view(), ImageViewException);
+}
+
+/**
+ * Test if the image is released as soon as the last cutout
+ * was materialized.
+ */
+BOOST_AUTO_TEST_CASE(image_cutout_release_test) {
+  std::vector<ImageCutout<float>> cutouts;
+  std::weak_ptr<const Image> weak_image;
+
+  {
+    auto shared_image = make_shared_image(Image(20, 10, 1, 1, 1));
+    weak_image = shared_image;
+
+    cutouts.emplace_back(shared_image, Rect<int>(0, 0, 5, 5));
+    cutouts.emplace_back(shared_image, Rect<int>(10, 5, 5, 5));
+  }
+
+  Image image1 = std::move(cutouts.at(0));
+  BOOST_TEST(!weak_image.expired());
+  BOOST_TEST(!cutouts.at(0).is_materializable());
+
+  Image image2 = std::move(cutouts.at(1));
+  BOOST_TEST(weak_image.expired());
+
+  BOOST_TEST(image1 == Image(5, 5, 1, 1, 1));
+  BOOST_TEST(image2 == Image(5, 5, 1, 1, 1));
+}
+
+/**
+ * views::filter reads each element twice. After views::move, the first read
+ * releases the image of the cutout. With views::cache1 in front of the
+ * filter, each cutout is materialized once. Without it, the second read
+ * throws instead of dereferencing the released image.
+ */
+BOOST_AUTO_TEST_CASE(image_cutout_move_filter_test) {
+  auto make_cutouts = []() {
+    auto shared_image = make_shared_image(Image(20, 10, 1, 1, 1));
+
+    return std::vector<ImageCutout<float>> {
+      ImageCutout<float>(shared_image, Rect<int>(0, 0, 5, 5)),
+      ImageCutout<float>(shared_image, Rect<int>(10, 5, 5, 5)),
+      ImageCutout<float>(shared_image, Rect<int>(18, 8, 5, 5))
+    };
+  };
+
+  // Like scale_up() and the other stages, the image is taken by value
+  auto stage = [](Image image) {
+    return image *= 2;
+  };
+
+  auto inside_image = [](const Image &image) {
+    return image.min() > 0;
+  };
+
+  auto cutouts = make_cutouts();
+
+  auto images = cutouts
+      | ranges::views::move
+      | ranges::views::transform(stage)
+      | ranges::views::cache1
+      | ranges::views::filter(inside_image)
+      | ranges::to<std::vector>();
+
+  BOOST_TEST(images.size() == 2);
+  BOOST_TEST(ranges::none_of(cutouts, [](const auto &cutout) {
+    return cutout.is_materializable();
+  }));
+
+  auto uncached_cutouts = make_cutouts();
+
+  BOOST_CHECK_THROW(
+      (void) (uncached_cutouts
+          | ranges::views::move
+          | ranges::views::transform(stage)
+          | ranges::views::filter(inside_image)
+          | ranges::to<std::vector>()),
+      ImageCutoutException);
+
+  BOOST_CHECK_THROW((void) ImageCutout<float>().materialize(),
+                    ImageCutoutException);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
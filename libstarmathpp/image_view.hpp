@@ -0,0 +1,256 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_IMAGE_VIEW_HPP_
+#define STARMATHPP_IMAGE_VIEW_HPP_ STARMATHPP_IMAGE_VIEW_HPP_
+
+#include <algorithm>
+#include <sstream>
+
+#include <libstarmathpp/exception.hpp>
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/rect.hpp>
+
+/**
+ * Loop over all pixels of an ImageView (same as cimg_forXY() for a CImg).
+ */
+#define image_view_forXY(view, x, y)            \
+  for (int y = 0; y < (view).height(); ++y)     \
+    for (int x = 0; x < (view).width(); ++x)
+
+namespace starmathpp {
+
+DEF_Exception(ImageView);
+
+/**
+ * Non-owning, read-only view of a rectangular region of an image.
+ *
+ * An ImageView just consists of a pointer to the first pixel, the width,
+ * the height and the row stride (number of pixels from one row to the next).
+ * Therefore, creating a view of a region (e.g. of each detected star) does
+ * not copy any pixels.
+ *
+ * Usage:
+ *
+ * Image image = ...;
+ * ImageView<float> star_view(image, Rect<int>(10, 20, 31, 31));
+ * auto centroid = centroider.calculate_centroid(star_view);
+ *
+ * NOTE: The view does not keep the image alive, i.e. the image must
+ *       outlive the view.
+ *
+ * NOTE: An ImageView can be implicitly created from a CImg. Therefore,
+ *       all functions which accept an ImageView also accept a CImg.
+ *
+ * NOTE: Only the first slice and channel of the image are considered.
+ */
+template<typename ImageType = float>
+class ImageView {
+ public:
+  using value_type = ImageType;
+
+  ImageView()
+      :
+      data_(nullptr),
+      width_(0),
+      height_(0),
+      row_stride_(0) {
+  }
+
+  ImageView(const ImageType *data, int width, int height, long row_stride)
+      :
+      data_(data),
+      width_(width),
+      height_(height),
+      row_stride_(row_stride) {
+  }
+
+  /**
+   * View of the whole image.
+   */
+  ImageView(const cimg_library::CImg<ImageType> &image)  // NOLINT(google-explicit-constructor)
+      :
+      ImageView(image.data(), image.width(), image.height(), image.width()) {
+  }
+
+  /**
+   * View of the given region of the image. The region must be completely
+   * inside the image. Otherwise, an ImageViewException is thrown.
+   */
+  ImageView(const cimg_library::CImg<ImageType> &image, const Rect<int> &region)
+      :
+      ImageView(ImageView(image).sub_view(region)) {
+  }
+
+  [[nodiscard]] int width() const {
+    return width_;
+  }
+
+  [[nodiscard]] int height() const {
+    return height_;
+  }
+
+  [[nodiscard]] long row_stride() const {
+    return row_stride_;
+  }
+
+  [[nodiscard]] size_t size() const {
+    return (size_t) width_ * (size_t) height_;
+  }
+
+  [[nodiscard]] bool is_empty() const {
+    return data_ == nullptr || width_ <= 0 || height_ <= 0;
+  }
+
+  [[nodiscard]] const ImageType* data() const {
+    return data_;
+  }
+
+  /**
+   * Pointer to the first pixel of row y.
+   */
+  [[nodiscard]] const ImageType* row(int y) const {
+    return data_ + (long) y * row_stride_;
+  }
+
+  const ImageType& operator()(int x, int y) const {
+    return data_[(long) y * row_stride_ + x];
+  }
+
+  /**
+   * View of the given region of this view. The region must be completely
+   * inside this view. Otherwise, an ImageViewException is thrown.
+   */
+  [[nodiscard]] ImageView sub_view(const Rect<int> &region) const {
+    Rect<int> bounds(0, 0, width_, height_);
+
+    if (!bounds.contains(region)) {
+      std::stringstream ss;
+      ss << "Region " << region << " is outside image bounds " << bounds
+         << ".";
+      throw ImageViewException(ss.str());
+    }
+
+    return ImageView(row(region.y()) + region.x(), (int) region.width(),
+                     (int) region.height(), row_stride_);
+  }
+
+  /**
+   * Returns the minimum pixel value and stores the maximum pixel value in
+   * max_value (same as CImg::min_max()).
+   */
+  template<typename T>
+  ImageType min_max(T &max_value) const {
+    throw_if_empty();
+
+    ImageType min_value = *data_;
+    ImageType max_value_ = *data_;
+
+    for (int y = 0; y < height_; ++y) {
+      const ImageType *ptr = row(y);
+
+      for (int x = 0; x < width_; ++x) {
+        min_value = std::min(min_value, ptr[x]);
+        max_value_ = std::max(max_value_, ptr[x]);
+      }
+    }
+    max_value = (T) max_value_;
+    return min_value;
+  }
+
+  /**
+   * Returns the maximum pixel value and stores the minimum pixel value in
+   * min_value (same as CImg::max_min()).
+   */
+  template<typename T>
+  ImageType max_min(T &min_value) const {
+    ImageType max_value;
+    min_value = (T) min_max(max_value);
+    return max_value;
+  }
+
+  /**
+   * Mean of all pixel values (same as CImg::mean()).
+   */
+  [[nodiscard]] double mean() const {
+    throw_if_empty();
+
+    double sum = 0;
+
+    for (int y = 0; y < height_; ++y) {
+      const ImageType *ptr = row(y);
+
+      for (int x = 0; x < width_; ++x) {
+        sum += (double) ptr[x];
+      }
+    }
+    return sum / (double) size();
+  }
+
+  /**
+   * Copy the given region into a new image. Same as CImg::get_crop(), i.e.
+   * the region may exceed the view. All pixels outside the view are 0
+   * (dirichlet boundary condition).
+   */
+  [[nodiscard]] cimg_library::CImg<ImageType> get_crop(int x0, int y0, int x1,
+                                                       int y1) const {
+    cimg_library::CImg<ImageType> cropped_image(x1 - x0 + 1, y1 - y0 + 1, 1, 1,
+                                                0);
+
+    int from_x = std::max(x0, 0);
+    int to_x = std::min(x1, width_ - 1);
+
+    for (int y = std::max(y0, 0); y <= std::min(y1, height_ - 1); ++y) {
+      if (from_x <= to_x) {
+        std::copy(row(y) + from_x, row(y) + to_x + 1,
+                  cropped_image.data(from_x - x0, y - y0));
+      }
+    }
+    return cropped_image;
+  }
+
+  /**
+   * Copy the pixels of this view into a new image.
+   */
+  [[nodiscard]] cimg_library::CImg<ImageType> to_image() const {
+    return get_crop(0, 0, width_ - 1, height_ - 1);
+  }
+
+ private:
+  const ImageType *data_;
+  int width_;
+  int height_;
+  long row_stride_;
+
+  void throw_if_empty() const {
+    if (is_empty()) {
+      throw ImageViewException("Empty image view.");
+    }
+  }
+};
+
+}  // namespace starmathpp
+
+#endif // STARMATHPP_IMAGE_VIEW_HPP_
@@ -0,0 +1,149 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "image view unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/image_view.hpp>
+#include <libstarmathpp/algorithm/centroid/center_of_gravity_centroider.hpp>
+#include <libstarmathpp/algorithm/hfd.hpp>
+
+using namespace starmathpp;
+
+BOOST_AUTO_TEST_SUITE(image_view_tests)
+
+namespace {
+/**
+ * 8x6 image where each pixel value is 10 * y + x.
+ */
+Image create_test_image() {
+  Image image(8, 6, 1, 1, 0);
+
+  cimg_forXY(image, x, y)
+  {
+    image(x, y) = (float) (10 * y + x);
+  }
+  return image;
+}
+}  // namespace
+
+/**
+ * Test if a view of the whole image refers to the pixels of the image.
+ */
+BOOST_AUTO_TEST_CASE(image_view_whole_image_test) {
+  Image image = create_test_image();
+  ImageView<float> view(image);
+
+  BOOST_TEST(view.width() == 8);
+  BOOST_TEST(view.height() == 6);
+  BOOST_TEST(view.row_stride() == 8);
+  BOOST_TEST(view.data() == image.data());
+  BOOST_TEST(view(3, 2) == 23.0F);
+}
+
+/**
+ * Test if a view of a region refers to the pixels of the image without
+ * copying them.
+ */
+BOOST_AUTO_TEST_CASE(image_view_sub_view_test) {
+  Image image = create_test_image();
+  ImageView<float> view(image, Rect<int>(2, 1, 3, 4));
+
+  BOOST_TEST(view.width() == 3);
+  BOOST_TEST(view.height() == 4);
+  BOOST_TEST(view.row_stride() == 8);
+  BOOST_TEST(view.data() == image.data(2, 1));
+  BOOST_TEST(view(0, 0) == 12.0F);
+  BOOST_TEST(view(2, 3) == 44.0F);
+
+  // A view of a view
+  auto sub_view = view.sub_view(Rect<int>(1, 1, 2, 2));
+  BOOST_TEST(sub_view(0, 0) == 23.0F);
+  BOOST_TEST(sub_view(1, 1) == 34.0F);
+
+  float max_value;
+  float min_value = view.min_max(max_value);
+  BOOST_TEST(min_value == 12.0F);
+  BOOST_TEST(max_value == 44.0F);
+  BOOST_TEST(view.mean() == 28.0);
+}
+
+/**
+ * Test if creating a view of a region outside the image fails.
+ */
+BOOST_AUTO_TEST_CASE(image_view_outside_image_test) {
+  Image image = create_test_image();
+
+  BOOST_CHECK_THROW(ImageView<float>(image, Rect<int>(6, 1, 3, 4)),
+                    ImageViewException);
+  BOOST_CHECK_THROW(ImageView<float>(image, Rect<int>(-1, 0, 3, 4)),
+                    ImageViewException);
+}
+
+/**
+ * Test if materializing a view and cropping a view gives the same
+ * result as CImg get_crop().
+ */
+BOOST_AUTO_TEST_CASE(image_view_get_crop_test) {
+  Image image = create_test_image();
+  ImageView<float> view(image);
+
+  BOOST_TEST(view.sub_view(Rect<int>(2, 1, 3, 4)).to_image() == image.get_crop(2, 1, 4, 4));
+  BOOST_TEST(view.get_crop(-2, -1, 3, 2) == image.get_crop(-2, -1, 3, 2));
+  BOOST_TEST(view.get_crop(5, 4, 9, 7) == image.get_crop(5, 4, 9, 7));
+}
+
+/**
+ * Test if algorithms give the same result for a view and a copy of
+ * the same region.
+ */
+BOOST_AUTO_TEST_CASE(image_view_algorithm_test) {
+  Image image(32, 32, 1, 1, 0);
+  image(20, 11) = 100;
+  image(21, 11) = 50;
+  image(20, 12) = 50;
+
+  Rect<int> star_region(12, 4, 15, 15);
+  ImageView<float> star_view(image, star_region);
+  Image star_image = image.get_crop(12, 4, 26, 18);
+
+  algorithm::CenterOfGravityCentroider<float> centroider;
+
+  auto centroid_from_view = centroider.calculate_centroid(star_view);
+  auto centroid_from_image = centroider.calculate_centroid(star_image);
+
+  BOOST_TEST(centroid_from_view.has_value());
+  BOOST_TEST(centroid_from_view.value().x() == centroid_from_image.value().x());
+  BOOST_TEST(centroid_from_view.value().y() == centroid_from_image.value().y());
+
+  BOOST_TEST(algorithm::hfd(star_view, 15U) == algorithm::hfd(star_image, 15U));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
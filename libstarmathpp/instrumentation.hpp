@@ -0,0 +1,320 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_INSTRUMENTATION_HPP_
+#define STARMATHPP_INSTRUMENTATION_HPP_ STARMATHPP_INSTRUMENTATION_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <libstarmathpp/exception.hpp>
+
+/**
+ * Pipeline instrumentation.
+ *
+ * Each probe records the wall time, the number of processed pixels, the
+ * number of bytes allocated (see STARMATHPP_INSTRUMENTATION_COUNT_ALLOCATIONS())
+ * and the thread of one processing step. The recorded events can be written
+ * as summary table and as Chrome trace-event JSON file which can be opened
+ * with chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Usage:
+ *
+ * auto images = files("*.fit")
+ *     | read()
+ *     | subtract(dark)
+ *     | instrument("calibrate")
+ *     | to<std::vector>();
+ *
+ * auto &recorder = starmathpp::instrumentation::Recorder::instance();
+ * recorder.write_summary(std::cout);
+ * recorder.write_chrome_trace("pipeline_trace.json");
+ *
+ * NOTE: The instrumentation is only compiled in if INSTRUMENTATION_SWITCH is
+ *       defined (cmake -DINSTRUMENTATION_SWITCH=ON). Otherwise, all probes
+ *       expand to nothing and no events are recorded.
+ */
+#ifdef INSTRUMENTATION_SWITCH
+  #define STARMATHPP_INSTRUMENTATION_ENABLED 1
+
+  /**
+   * Record the time from here to the end of the current scope.
+   * NOTE: Only one probe per scope is supported.
+   */
+  #define STARMATHPP_INSTRUMENT_SCOPE(name)                             \
+    ::starmathpp::instrumentation::ScopedProbe starmathpp_instrumentation_probe_(name)
+
+  /**
+   * Set the number of pixels processed in the current scope.
+   */
+  #define STARMATHPP_INSTRUMENT_PIXELS(num_pixels)                      \
+    starmathpp_instrumentation_probe_.set_num_pixels(num_pixels)
+#else
+  #define STARMATHPP_INSTRUMENTATION_ENABLED 0
+  #define STARMATHPP_INSTRUMENT_SCOPE(name) (void) 0
+  #define STARMATHPP_INSTRUMENT_PIXELS(num_pixels) (void) 0
+#endif
+
+namespace starmathpp::instrumentation {
+
+DEF_Exception(Instrumentation);
+
+/**
+ * One recorded processing step.
+ */
+struct Event {
+  std::string name;
+  std::thread::id thread_id;
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::duration duration;
+  size_t num_pixels;
+  size_t bytes_allocated;
+};
+
+namespace detail {
+
+/**
+ * Number of bytes allocated by the current thread. Only counted if
+ * STARMATHPP_INSTRUMENTATION_COUNT_ALLOCATIONS() is used.
+ */
+inline thread_local size_t allocated_bytes = 0;
+
+}  // namespace detail
+
+/**
+ * Collects the events of all threads.
+ */
+class Recorder {
+ public:
+  static Recorder& instance() {
+    static Recorder recorder;
+    return recorder;
+  }
+
+  void record(Event event) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.push_back(std::move(event));
+  }
+
+  [[nodiscard]] std::vector<Event> events() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_;
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.clear();
+    origin_ = std::chrono::steady_clock::now();
+  }
+
+  /**
+   * Write one line per probe name: number of events, total and mean wall
+   * time, pixel throughput and allocated bytes.
+   *
+   * NOTE: Probes may be nested (e.g. an instrument() view measures all
+   *       lazy views before it). The times are inclusive.
+   */
+  void write_summary(std::ostream &os) const {
+    struct Summary {
+      size_t count = 0;
+      std::chrono::steady_clock::duration duration { };
+      size_t num_pixels = 0;
+      size_t bytes_allocated = 0;
+    };
+
+    std::map<std::string, Summary> summaries;
+
+    for (const auto &event : events()) {
+      auto &summary = summaries[event.name];
+      ++summary.count;
+      summary.duration += event.duration;
+      summary.num_pixels += event.num_pixels;
+      summary.bytes_allocated += event.bytes_allocated;
+    }
+
+    os << std::left << std::setw(40) << "name" << std::right << std::setw(10)
+       << "count" << std::setw(14) << "total [ms]" << std::setw(14)
+       << "mean [ms]" << std::setw(14) << "MPixel/s" << std::setw(14)
+       << "alloc [MB]" << std::endl;
+
+    for (const auto& [name, summary] : summaries) {
+      double total_ms = std::chrono::duration<double, std::milli>(
+          summary.duration).count();
+      double mpixel_per_s = (
+          total_ms > 0 ? (double) summary.num_pixels / (total_ms * 1000.0) : 0);
+
+      os << std::left << std::setw(40) << name << std::right << std::setw(10)
+         << summary.count << std::fixed << std::setprecision(3)
+         << std::setw(14) << total_ms << std::setw(14)
+         << total_ms / (double) summary.count << std::setw(14) << mpixel_per_s
+         << std::setw(14) << (double) summary.bytes_allocated / (1024.0 * 1024.0)
+         << std::endl;
+    }
+  }
+
+  /**
+   * Write all events in the Chrome trace-event format.
+   *
+   * See https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+   */
+  void write_chrome_trace(std::ostream &os) const {
+    std::vector<Event> events_to_write;
+    std::chrono::steady_clock::time_point origin;
+
+    {
+      // NOTE: clear() resets the origin together with the events.
+      std::lock_guard<std::mutex> lock(mutex_);
+      events_to_write = events_;
+      origin = origin_;
+    }
+
+    std::map<std::thread::id, size_t> thread_numbers;
+
+    os << "{\"traceEvents\":[";
+
+    for (size_t idx = 0; idx < events_to_write.size(); ++idx) {
+      const auto &event = events_to_write[idx];
+
+      // Thread ids are numbered in the order of their first appearance.
+      auto thread_number = thread_numbers.emplace(event.thread_id,
+                                                  thread_numbers.size()).first->second;
+
+      os << (idx > 0 ? "," : "") << "\n{\"name\":\"" << escape(event.name)
+         << "\",\"cat\":\"starmathpp\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+         << thread_number << ",\"ts\":" << to_us(event.start - origin)
+         << ",\"dur\":" << to_us(event.duration) << ",\"args\":{\"pixels\":"
+         << event.num_pixels << ",\"bytes_allocated\":" << event.bytes_allocated
+         << "}}";
+    }
+    os << "\n]}" << std::endl;
+  }
+
+  void write_chrome_trace(const std::filesystem::path &filepath) const {
+    std::ofstream ofs(filepath);
+
+    if (!ofs) {
+      throw InstrumentationException(
+          "Unable to open trace file '" + filepath.string() + "'.");
+    }
+    write_chrome_trace(ofs);
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::vector<Event> events_;
+  std::chrono::steady_clock::time_point origin_ { std::chrono::steady_clock::now() };
+
+  Recorder() = default;
+
+  static int64_t to_us(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+  }
+
+  static std::string escape(const std::string &str) {
+    std::string escaped;
+
+    for (char c : str) {
+      if (c == '"' || c == '\\') {
+        escaped += '\\';
+      }
+      escaped += c;
+    }
+    return escaped;
+  }
+};
+
+/**
+ * Records one event from construction to destruction.
+ */
+class ScopedProbe {
+ public:
+  explicit ScopedProbe(std::string name, size_t num_pixels = 0)
+      :
+      name_(std::move(name)),
+      num_pixels_(num_pixels),
+      start_allocated_bytes_(detail::allocated_bytes),
+      start_(std::chrono::steady_clock::now()) {
+  }
+
+  ScopedProbe(const ScopedProbe&) = delete;
+  ScopedProbe& operator=(const ScopedProbe&) = delete;
+
+  ~ScopedProbe() {
+    auto end = std::chrono::steady_clock::now();
+
+    Recorder::instance().record(
+        Event { std::move(name_), std::this_thread::get_id(), start_, end
+            - start_, num_pixels_, detail::allocated_bytes
+            - start_allocated_bytes_ });
+  }
+
+  void set_num_pixels(size_t num_pixels) {
+    num_pixels_ = num_pixels;
+  }
+
+ private:
+  std::string name_;
+  size_t num_pixels_;
+  size_t start_allocated_bytes_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace starmathpp::instrumentation
+
+/**
+ * Count the bytes allocated per thread by replacing the global operator new.
+ * Use this macro in exactly one translation unit of the application
+ * (outside any namespace).
+ */
+#if STARMATHPP_INSTRUMENTATION_ENABLED
+  #define STARMATHPP_INSTRUMENTATION_COUNT_ALLOCATIONS()                      \
+    void* operator new(std::size_t size) {                                    \
+      ::starmathpp::instrumentation::detail::allocated_bytes += size;         \
+      void *ptr = std::malloc(size > 0 ? size : 1);                           \
+      if (ptr == nullptr) { throw std::bad_alloc(); }                         \
+      return ptr;                                                             \
+    }                                                                         \
+    void* operator new[](std::size_t size) { return operator new(size); }     \
+    void operator delete(void *ptr) noexcept { std::free(ptr); }              \
+    void operator delete[](void *ptr) noexcept { std::free(ptr); }            \
+    void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); } \
+    void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+#else
+  #define STARMATHPP_INSTRUMENTATION_COUNT_ALLOCATIONS()
+#endif
+
+#endif // STARMATHPP_INSTRUMENTATION_HPP_
@@ -0,0 +1,152 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "instrumentation unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+// NOTE: The instrumentation is tested independent of the build option.
+#ifndef INSTRUMENTATION_SWITCH
+#define INSTRUMENTATION_SWITCH
+#endif
+
+#include <sstream>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/instrumentation.hpp>
+
+STARMATHPP_INSTRUMENTATION_COUNT_ALLOCATIONS()
+
+BOOST_AUTO_TEST_SUITE (instrumentation_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::instrumentation;
+
+/**
+ * Process an image in an instrumented scope.
+ */
+static Image instrumented_scale(const Image &image) {
+  STARMATHPP_INSTRUMENT_SCOPE("test::scale");
+  STARMATHPP_INSTRUMENT_PIXELS(image.size());
+
+  return image.get_resize(2 * image.width(), 2 * image.height());
+}
+
+/**
+ * Test that a probe records one event with name, pixels, allocated
+ * bytes and thread.
+ */
+BOOST_AUTO_TEST_CASE(instrumentation_scoped_probe_test)
+{
+  Recorder::instance().clear();
+
+  Image image(100, 50, 1, 1, 1.0F);
+  Image result = instrumented_scale(image);
+
+  auto events = Recorder::instance().events();
+
+  BOOST_TEST(events.size() == 1);
+  BOOST_TEST(events.at(0).name == "test::scale");
+  BOOST_TEST(events.at(0).num_pixels == 100 * 50);
+  BOOST_TEST(events.at(0).bytes_allocated >= result.size() * sizeof(float));
+  BOOST_TEST((events.at(0).thread_id == std::this_thread::get_id()));
+}
+
+/**
+ * Test that the events of different threads are recorded.
+ */
+BOOST_AUTO_TEST_CASE(instrumentation_multiple_threads_test)
+{
+  Recorder::instance().clear();
+
+  Image image(10, 10, 1, 1, 1.0F);
+
+  std::thread worker([&]() {
+    instrumented_scale(image);
+  });
+  worker.join();
+
+  instrumented_scale(image);
+
+  auto events = Recorder::instance().events();
+
+  BOOST_TEST(events.size() == 2);
+  BOOST_TEST((events.at(0).thread_id != events.at(1).thread_id));
+  BOOST_TEST((events.at(1).thread_id == std::this_thread::get_id()));
+}
+
+/**
+ * Test the summary table.
+ */
+BOOST_AUTO_TEST_CASE(instrumentation_summary_test)
+{
+  Recorder::instance().clear();
+
+  Image image(10, 10, 1, 1, 1.0F);
+  instrumented_scale(image);
+  instrumented_scale(image);
+
+  std::stringstream ss;
+  Recorder::instance().write_summary(ss);
+
+  std::string header;
+  std::string name;
+  size_t count = 0;
+
+  std::getline(ss, header);
+  ss >> name >> count;
+
+  BOOST_TEST(name == "test::scale");
+  BOOST_TEST(count == 2);
+}
+
+/**
+ * Test the Chrome trace-event export.
+ */
+BOOST_AUTO_TEST_CASE(instrumentation_chrome_trace_test)
+{
+  Recorder::instance().clear();
+
+  Image image(10, 10, 1, 1, 1.0F);
+  instrumented_scale(image);
+
+  std::stringstream ss;
+  Recorder::instance().write_chrome_trace(ss);
+
+  std::string trace = ss.str();
+
+  BOOST_TEST(trace.find("{\"traceEvents\":[") == 0);
+  BOOST_TEST(trace.find("\"name\":\"test::scale\"") != std::string::npos);
+  BOOST_TEST(trace.find("\"ph\":\"X\"") != std::string::npos);
+  BOOST_TEST(trace.find("\"tid\":0") != std::string::npos);
+  BOOST_TEST(trace.find("\"pixels\":100") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -26,9 +26,18 @@
 #ifndef LIBSTARMATHPP_IO_HPP_
 #define LIBSTARMATHPP_IO_HPP_
 
+#include <libstarmathpp/io/async_image_writer.hpp>
+#include <libstarmathpp/io/band_reader.hpp>
 #include <libstarmathpp/io/cimg_fits_io.hpp>
+#include <libstarmathpp/io/file_scanner.hpp>
+#include <libstarmathpp/io/filename_sequencer.hpp>
+#include <libstarmathpp/io/fits_header.hpp>
 #include <libstarmathpp/io/filesystem_wrapper.hpp>
+#include <libstarmathpp/io/float_conversion.hpp>
 #include <libstarmathpp/io/image_reader.hpp>
 #include <libstarmathpp/io/image_writer.hpp>
+#include <libstarmathpp/io/mapped_fits_image.hpp>
+#include <libstarmathpp/io/master_frame_cache.hpp>
+#include <libstarmathpp/io/streaming_image_writer.hpp>
 
 #endif /* LIBSTARMATHPP_IO_HPP_ */
@@ -0,0 +1,204 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_IO_ASYNC_IMAGE_WRITER_HPP_
+#define STARMATHPP_IO_ASYNC_IMAGE_WRITER_HPP_ STARMATHPP_IO_ASYNC_IMAGE_WRITER_HPP_
+
+#include <condition_variable>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <utility>
+
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/image_cutout.hpp>
+#include <libstarmathpp/io/image_writer.hpp>
+#include <libstarmathpp/thread_pool.hpp>
+
+namespace starmathpp::io {
+
+/**
+ * Writes images on a pool of background threads.
+ *
+ * write() hands the image over to the pool and returns immediately. Only if
+ * max_pending images are already waiting to be written, write() blocks until
+ * one of them was written. This bounds the memory held by the writer.
+ *
+ * The first error which occurs in the background is re-thrown by the next
+ * call of write() or flush(). flush() waits until all images have been
+ * written.
+ *
+ * Usage:
+ *
+ * AsyncImageWriter writer(2);
+ *
+ * for (auto &image : images) {
+ *   writer.write(std::move(image), "img.fit");
+ * }
+ * writer.flush();  // Throws ImageWriterException if writing failed
+ *
+ * NOTE: The destructor waits until all pending images were written. It
+ *       cannot report errors. Call flush() to observe them.
+ */
+class AsyncImageWriter {
+ public:
+  /**
+   * If max_pending is 0, twice the number of workers is used.
+   */
+  explicit AsyncImageWriter(size_t num_workers = 1, size_t max_pending = 0)
+      :
+      max_pending_(max_pending == 0 ? 2 * num_workers : max_pending),
+      num_pending_(0),
+      thread_pool_(num_workers) {
+  }
+
+  AsyncImageWriter(const AsyncImageWriter&) = delete;
+  AsyncImageWriter& operator=(const AsyncImageWriter&) = delete;
+
+  ~AsyncImageWriter() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this]() {
+      return num_pending_ == 0;
+    });
+  }
+
+  /**
+   * Enqueue the image to be written to filepath.
+   *
+   * NOTE: The image is owned by the writer until it was written. Move the
+   *       image into the writer to avoid a copy.
+   */
+  template<typename ImageType>
+  void write(cimg_library::CImg<ImageType> image,
+             std::filesystem::path filepath, bool override = true) {
+    write(make_shared_image(std::move(image)), std::move(filepath), override);
+  }
+
+  /**
+   * Same as above, but the pixels are shared with the caller instead of
+   * being owned by the writer. The image must not be modified until it
+   * was written.
+   */
+  template<typename ImageType>
+  void write(SharedImage<ImageType> image, std::filesystem::path filepath,
+             bool override = true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      condition_.wait(lock, [this]() {
+        return num_pending_ < max_pending_ || error_;
+      });
+
+      rethrow_error(lock);
+
+      ++num_pending_;
+    }
+
+    thread_pool_.submit(
+        [this, image = std::move(image), filepath = std::move(filepath),
+         override]() mutable {
+          std::exception_ptr error;
+
+          try {
+            starmathpp::io::write(std::move(*image), filepath, override);
+          } catch (...) {
+            error = std::current_exception();
+          }
+
+          // NOTE: The image is released before the next image is accepted.
+          image.reset();
+
+          finish(error);
+        });
+  }
+
+  /**
+   * Wait until all pending images are written. Re-throws the first error
+   * which occurred since the last call of write() or flush().
+   */
+  void flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    condition_.wait(lock, [this]() {
+      return num_pending_ == 0;
+    });
+
+    rethrow_error(lock);
+  }
+
+  /**
+   * Same as flush(), but an error is not re-thrown. It is kept for the
+   * next call of write() or flush(). Used where no exception may be
+   * thrown (e.g. in destructors).
+   */
+  void wait() noexcept {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    condition_.wait(lock, [this]() {
+      return num_pending_ == 0;
+    });
+  }
+
+  [[nodiscard]] size_t max_pending() const {
+    return max_pending_;
+  }
+
+ private:
+  size_t max_pending_;
+  size_t num_pending_;
+  std::exception_ptr error_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+
+  // NOTE: Must be the last member. The pool is destroyed first and
+  //       waits for pending tasks which still refer to the members above.
+  ThreadPool thread_pool_;
+
+  void finish(std::exception_ptr error) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      if (error && !error_) {
+        error_ = std::move(error);
+      }
+      --num_pending_;
+    }
+    condition_.notify_all();
+  }
+
+  void rethrow_error(std::unique_lock<std::mutex> &lock) {
+    if (error_) {
+      std::exception_ptr error = std::move(error_);
+      error_ = nullptr;
+      lock.unlock();
+
+      std::rethrow_exception(error);
+    }
+  }
+};
+
+}  // namespace starmathpp::io
+
+#endif // STARMATHPP_IO_ASYNC_IMAGE_WRITER_HPP_
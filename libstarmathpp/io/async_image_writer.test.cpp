@@ -0,0 +1,86 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "async image writer unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/io/filesystem_wrapper.hpp>
+#include <libstarmathpp/io/async_image_writer.hpp>
+
+BOOST_AUTO_TEST_SUITE (async_image_writer_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::io;
+
+/**
+ * Test that all images were written when flush() returns.
+ */
+BOOST_AUTO_TEST_CASE(async_image_writer_flush_test)
+{
+  AsyncImageWriter writer(2 /*num_workers*/, 2 /*max_pending*/);
+
+  for (int i = 0; i < 6; ++i) {
+    writer.write(Image(20, 20, 1, 1, (float) i),
+                 "async_img_" + std::to_string(i) + ".fit", true);
+  }
+
+  writer.flush();
+
+  for (int i = 0; i < 6; ++i) {
+    std::string filename = "async_img_" + std::to_string(i) + ".fit";
+
+    BOOST_TEST(std::filesystem::exists(filename) == true);
+    BOOST_TEST(fs::file_size(filename) == 5760);
+  }
+}
+
+/**
+ * Test that an error which occurred in the background is re-thrown by
+ * flush() and that the writer can be used afterwards.
+ */
+BOOST_AUTO_TEST_CASE(async_image_writer_error_test)
+{
+  AsyncImageWriter writer;
+
+  // NOTE: A filename without extension is rejected by the image writer.
+  writer.write(Image(20, 20, 1, 1, 0.0F), "async_img_no_extension", true);
+
+  BOOST_CHECK_THROW(writer.flush(), ImageWriterException);
+
+  writer.write(Image(20, 20, 1, 1, 0.0F), "async_img_after_error.fit", true);
+  writer.flush();
+
+  BOOST_TEST(std::filesystem::exists("async_img_after_error.fit") == true);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,235 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_IO_BAND_READER_HPP_
+#define STARMATHPP_IO_BAND_READER_HPP_ STARMATHPP_IO_BAND_READER_HPP_
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+
+#include <libstarmathpp/exception.hpp>
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/size.hpp>
+#include <libstarmathpp/io/cimg_fits_io.hpp>
+#include <libstarmathpp/io/image_reader.hpp>
+
+namespace starmathpp::io {
+
+DEF_Exception(BandReader);
+
+/**
+ * A band reader provides horizontal bands (a number of complete rows) of
+ * a set of frames. This way, an algorithm which needs the same pixels of
+ * all frames (e.g. a median stack) only holds one band of each frame in
+ * memory at a time.
+ *
+ * A band reader provides:
+ *
+ * size_t num_frames() const;
+ * Size<int> frame_size() const;
+ * Image read_band(size_t frame_index, int first_row, int num_rows) const;
+ *
+ * read_band() may be called concurrently.
+ */
+
+/**
+ * Reads the bands from image files. Each file is opened once and stays
+ * open until the reader is destroyed. For FITS files, only the rows of the
+ * band are read.
+ *
+ * Files which cannot be read row-wise (gzip-compressed FITS files and all
+ * other formats) are decoded once when they are opened and stored as
+ * uncompressed FITS files in cache_directory. Their bands are read from
+ * there. The cached files are removed by the destructor. Hence, no file is
+ * decoded more than once and the memory held by the reader does not grow
+ * with the number of frames.
+ *
+ * All frames must have the size of the first frame. Otherwise, a
+ * BandReaderException is thrown.
+ */
+class FileBandReader {
+ public:
+  explicit FileBandReader(std::vector<std::filesystem::path> filepaths,
+                          std::filesystem::path cache_directory =
+                              std::filesystem::temp_directory_path())
+      :
+      filepaths_(std::move(filepaths)),
+      cache_directory_(std::move(cache_directory)),
+      cache_prefix_(
+          "starmathpp_band_cache_" + std::to_string(std::random_device { }())
+              + "_"),
+      open_flags_(std::make_unique<std::once_flag[]>(filepaths_.size())),
+      readers_(filepaths_.size()),
+      cache_files_(filepaths_.size()) {
+
+    if (!filepaths_.empty()) {
+      frame_size_ = reader(0).size();
+    }
+  }
+
+  FileBandReader(FileBandReader&&) = default;
+  FileBandReader& operator=(FileBandReader&&) = delete;
+
+  ~FileBandReader() {
+    // NOTE: The files are closed before the cached files are removed.
+    readers_.clear();
+
+    for (const auto &cache_file : cache_files_) {
+      if (!cache_file.empty()) {
+        std::error_code error;
+        std::filesystem::remove(cache_file, error);
+      }
+    }
+  }
+
+  [[nodiscard]] size_t num_frames() const {
+    return filepaths_.size();
+  }
+
+  [[nodiscard]] Size<int> frame_size() const {
+    return frame_size_;
+  }
+
+  [[nodiscard]] Image read_band(size_t frame_index, int first_row,
+                                int num_rows) const {
+    return reader(frame_index).read_rows(first_row, num_rows);
+  }
+
+ private:
+  std::vector<std::filesystem::path> filepaths_;
+  std::filesystem::path cache_directory_;
+  std::string cache_prefix_;
+  Size<int> frame_size_ { 0, 0 };
+
+  // NOTE: Each file is opened by the first read_band() call of the frame.
+  //       std::call_once() publishes the reader to all other threads.
+  std::unique_ptr<std::once_flag[]> open_flags_;
+  mutable std::vector<std::unique_ptr<fits::RowReader>> readers_;
+  mutable std::vector<std::filesystem::path> cache_files_;
+
+  static bool is_row_readable(const std::filesystem::path &filepath) {
+    const std::string filepath_lower = boost::algorithm::to_lower_copy(
+        filepath.string());
+
+    return fits::is_fits(filepath_lower);
+  }
+
+  const fits::RowReader& reader(size_t frame_index) const {
+    const auto &filepath = filepaths_.at(frame_index);
+
+    std::call_once(open_flags_[frame_index], [&]() {
+      std::filesystem::path row_readable_path = filepath;
+
+      if (!is_row_readable(filepath)) {
+        row_readable_path = cache_directory_
+            / (cache_prefix_ + std::to_string(frame_index) + ".fit");
+
+        fits::write(io::read(filepath), row_readable_path.string(),
+                    true /*override*/);
+        cache_files_[frame_index] = row_readable_path;
+      }
+
+      auto frame_reader = std::make_unique<fits::RowReader>(
+          row_readable_path.string());
+
+      // NOTE: The size of the first frame is not known while it is opened.
+      if (frame_index > 0) {
+        throw_if_inconsistent_size(filepath, frame_reader->size());
+      }
+      readers_[frame_index] = std::move(frame_reader);
+    });
+
+    return *readers_[frame_index];
+  }
+
+  void throw_if_inconsistent_size(const std::filesystem::path &filepath,
+                                  const Size<int> &size) const {
+    if (size.width() != frame_size_.width()
+        || size.height() != frame_size_.height()) {
+      std::stringstream ss;
+      ss << "Size of '" << filepath.string() << "' (" << size.width() << "x"
+         << size.height() << ") differs from the size of the first frame ("
+         << frame_size_.width() << "x" << frame_size_.height() << ").";
+      throw BandReaderException(ss.str());
+    }
+  }
+};
+
+/**
+ * Provides the bands of frames which are already in memory.
+ *
+ * NOTE: The frames are not copied. They must outlive the reader.
+ */
+class ImageBandReader {
+ public:
+  explicit ImageBandReader(const std::vector<Image> &frames)
+      :
+      frames_(&frames) {
+  }
+
+  [[nodiscard]] size_t num_frames() const {
+    return frames_->size();
+  }
+
+  [[nodiscard]] Size<int> frame_size() const {
+    return (frames_->empty() ?
+        Size<int>(0, 0) :
+        Size<int>(frames_->front().width(), frames_->front().height()));
+  }
+
+  [[nodiscard]] Image read_band(size_t frame_index, int first_row,
+                                int num_rows) const {
+    const Image &frame = frames_->at(frame_index);
+    const Image &first_frame = frames_->front();
+
+    if (frame.width() != first_frame.width()
+        || frame.height() != first_frame.height()) {
+      std::stringstream ss;
+      ss << "Size of frame " << frame_index << " (" << frame.width() << "x"
+         << frame.height() << ") differs from the size of the first frame ("
+         << first_frame.width() << "x" << first_frame.height() << ").";
+      throw BandReaderException(ss.str());
+    }
+
+    return frame.get_crop(0, first_row, frame.width() - 1,
+                          first_row + num_rows - 1);
+  }
+
+ private:
+  const std::vector<Image> *frames_;
+};
+
+}  // namespace starmathpp::io
+
+#endif // STARMATHPP_IO_BAND_READER_HPP_
@@ -0,0 +1,172 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "band reader unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <cstdint>
+#include <filesystem>
+#include <iterator>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/io/band_reader.hpp>
+#include <libstarmathpp/io/cimg_fits_io.hpp>
+#include <libstarmathpp/io/image_writer.hpp>
+#include <libstarmathpp/floating_point_equality.hpp>
+
+BOOST_AUTO_TEST_SUITE (band_reader_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::io;
+
+/**
+ * Write a FITS file with a different value for each row.
+ */
+static void write_test_fits(const std::string &filename, int width,
+                            int height) {
+  cimg_library::CImg<uint16_t> image(width, height, 1, 1, 0);
+
+  cimg_forXY(image, x, y)
+  {
+    image(x, y) = (uint16_t) (100 * y + x);
+  }
+
+  fits::write(image, filename, true /*override*/);
+}
+
+/**
+ * A band read from a FITS file must be equal to the same rows of the
+ * completely read image.
+ */
+BOOST_AUTO_TEST_CASE(band_reader_fits_band_test)
+{
+  write_test_fits("band_reader_test.fit", 20, 15);
+
+  FileBandReader reader( { "band_reader_test.fit", "band_reader_test.fit" });
+
+  BOOST_TEST(reader.num_frames() == 2);
+  BOOST_TEST(reader.frame_size().width() == 20);
+  BOOST_TEST(reader.frame_size().height() == 15);
+
+  Image full_image = fits::read("band_reader_test.fit");
+
+  for (int first_row : { 0, 4, 11 }) {
+    Image band = reader.read_band(1, first_row, 4);
+    Image expected_band = full_image.get_crop(0, first_row, 19,
+                                              first_row + 3);
+
+    BOOST_TEST(is_almost_equal(band, expected_band, 0.00001));
+  }
+
+  BOOST_CHECK_THROW(reader.read_band(0, 13, 4), fits::FitsIOException);
+}
+
+/**
+ * A gzip-compressed FITS file is decoded once into the cache directory.
+ * The cached file is removed together with the reader.
+ */
+BOOST_AUTO_TEST_CASE(band_reader_fits_gz_band_test)
+{
+  cimg_library::CImg<uint16_t> image(20, 15, 1, 1, 0);
+
+  cimg_forXY(image, x, y)
+  {
+    image(x, y) = (uint16_t) (100 * y + x);
+  }
+
+  io::write(cimg_library::CImg<uint16_t>(image), "band_reader_gz_test.fits.gz",
+            true /*override*/);
+
+  Image full_image = io::read("band_reader_gz_test.fits.gz");
+
+  std::filesystem::path cache_directory = "band_reader_cache";
+  std::filesystem::remove_all(cache_directory);
+  std::filesystem::create_directories(cache_directory);
+
+  auto num_cached_files = [&]() {
+    return std::distance(std::filesystem::directory_iterator(cache_directory),
+                         std::filesystem::directory_iterator());
+  };
+
+  {
+    FileBandReader reader( { "band_reader_gz_test.fits.gz" }, cache_directory);
+
+    BOOST_TEST(reader.frame_size().height() == 15);
+
+    for (int first_row : { 0, 4, 11 }) {
+      Image band = reader.read_band(0, first_row, 4);
+      Image expected_band = full_image.get_crop(0, first_row, 19,
+                                                first_row + 3);
+
+      BOOST_TEST(is_almost_equal(band, expected_band, 0.00001));
+    }
+
+    BOOST_TEST(num_cached_files() == 1);
+  }
+
+  BOOST_TEST(num_cached_files() == 0);
+}
+
+/**
+ * Frames of a different height are rejected.
+ */
+BOOST_AUTO_TEST_CASE(band_reader_inconsistent_height_test)
+{
+  write_test_fits("band_reader_height_15.fit", 20, 15);
+  write_test_fits("band_reader_height_10.fit", 20, 10);
+
+  FileBandReader reader( { "band_reader_height_15.fit",
+      "band_reader_height_10.fit" });
+
+  BOOST_CHECK_NO_THROW(reader.read_band(0, 0, 4));
+  BOOST_CHECK_THROW(reader.read_band(1, 0, 4), BandReaderException);
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(band_reader_image_band_test)
+{
+  std::vector<Image> frames = { Image(10, 8, 1, 1, 1), Image(10, 8, 1, 1, 2) };
+
+  ImageBandReader reader(frames);
+
+  BOOST_TEST(reader.num_frames() == 2);
+  BOOST_TEST(reader.frame_size().height() == 8);
+
+  Image band = reader.read_band(1, 2, 3);
+
+  BOOST_TEST(band.width() == 10);
+  BOOST_TEST(band.height() == 3);
+  BOOST_TEST(band(0, 0) == 2.0F);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -24,9 +24,19 @@
  ****************************************************************************/
 
 #include <CCfits/CCfits>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
 
 #include <libstarmathpp/io/cimg_fits_io.hpp>
+#include <libstarmathpp/thread_pool.hpp>
 
 namespace starmathpp::io::fits {
 
@@ -47,98 +57,728 @@ bool is_fits_gz(const std::string &filepath_lower) {
       || boost::algorithm::ends_with(filepath_lower, "fits.gz"));
 }
 
-Image read(const std::string &filename,
-                            std::stringstream *ss) {
+namespace detail {
+
+/**
+ * Minimum number of rows of a compressed image which are decompressed by
+ * one thread.
+ */
+constexpr size_t MIN_ROWS_PER_THREAD = 64;
+
+/**
+ * Convert a CFITSIO error status into a FitsIOException.
+ */
+void throw_if_error(int status, const std::string &what) {
+  if (status != 0) {
+    char error_text[FLEN_STATUS];
+    fits_get_errstatus(status, error_text);
+
+    std::stringstream ss;
+    ss << what << ": " << error_text << " (status " << status << ").";
+    throw FitsIOException(ss.str());
+  }
+}
+
+/**
+ * CFITSIO data type of the pixel type.
+ */
+template<typename ImageType>
+constexpr int fits_data_type() {
+  static_assert(std::is_same_v<ImageType, float> || std::is_same_v<ImageType, uint16_t>,
+                "Unsupported pixel type.");
+
+  return (std::is_same_v<ImageType, float> ? TFLOAT : TUSHORT);
+}
+
+/**
+ * Maximum capacity of the gzip buffers which are kept by a thread for the
+ * next file. Larger buffers are released when their file is closed.
+ */
+constexpr size_t MAX_CACHED_GZIP_BUFFER_BYTES = 256UL * 1024UL * 1024UL;
 
-  CCfits::FITS::setVerboseMode(ss != nullptr);
+/**
+ * Buffers of the gzip input path. A file which was opened from inflated
+ * memory owns its buffers until it is closed (see FitsFileCloser). Then the
+ * buffers are kept by the closing thread and reused for the next gzip file.
+ * Hence, reading a sequence of frames does not allocate (and page fault)
+ * new buffers of the size of the file for each frame.
+ *
+ * NOTE: Each thread keeps at most one set of buffers of at most
+ *       MAX_CACHED_GZIP_BUFFER_BYTES.
+ */
+struct GzipBuffers {
+  std::vector<unsigned char> compressed;
+  std::vector<unsigned char> inflated;
 
-  try {
-    std::unique_ptr < CCfits::FITS
-        > pInfile(new CCfits::FITS(filename, CCfits::Read, true));
-    CCfits::PHDU &fits_img = pInfile->pHDU();
+  [[nodiscard]] size_t capacity() const {
+    return compressed.capacity() + inflated.capacity();
+  }
+};
 
-    // read all user-specific, coordinate, and checksum keys in the image
-    fits_img.readAllKeys();
+std::unique_ptr<GzipBuffers>& cached_gzip_buffers() {
+  thread_local std::unique_ptr<GzipBuffers> buffers;
+  return buffers;
+}
+
+std::unique_ptr<GzipBuffers> acquire_gzip_buffers() {
+  auto &cached_buffers = cached_gzip_buffers();
+
+  return (cached_buffers ?
+      std::move(cached_buffers) : std::make_unique<GzipBuffers>());
+}
+
+void release_gzip_buffers(std::unique_ptr<GzipBuffers> buffers) {
+  if (buffers->capacity() <= MAX_CACHED_GZIP_BUFFER_BYTES) {
+    cached_gzip_buffers() = std::move(buffers);
+  }
+}
 
-    if (ss != nullptr) {
-      *ss << fits_img << std::endl;
+/**
+ * RAII wrapper of a fitsfile opened directly with CFITSIO.
+ */
+struct FitsFileCloser {
+  // NOTE: Only set if the file was opened from inflated gzip data. The
+  //       buffers must outlive the file.
+  std::unique_ptr<GzipBuffers> gzip_buffers;
+
+  void operator()(fitsfile *fptr) {
+    int status = 0;
+    fits_close_file(fptr, &status);
+
+    if (gzip_buffers) {
+      release_gzip_buffers(std::move(gzip_buffers));
     }
+  }
+};
+
+using FitsFilePtr = std::unique_ptr<fitsfile, FitsFileCloser>;
 
-    Image img((int) fits_img.axis(0), (int) fits_img.axis(1));
-
-    // TODO: Put a check here:   fitsImg.bitpix() <= sizeof(ImageT)
-    // -> When provided image type does not fit, an exception is thrown? Or a warning logged?
-    // Maybe exception is optional i.e. can be configured?
-    //std::cerr << "fitsImg.bitpix(): " << fitsImg.bitpix() << std::endl;
-    //std::cerr << "sizeof(ImageT): " << 8 * sizeof(typename Image::value_type)
-    //        << std::endl;
-
-    // HACK / FIXME: At this point we assume that there is only 1 layer!
-    std::valarray<typename Image::value_type> img_data;
-    fits_img.read(img_data);
-
-    // For now we create a copy... maybe there is a better way to directly read data into CImg, later...
-    cimg_forXY(img, x, y)
-    {
-      // TODO: Should this be parameterized? Or is it possible to find out automatically?
-      // Correct, when reading old, existing FITS files
-      // NOTE: ImageJ and Gimp both work this way for normal files.
-      //       -> For INDI/BLOB there must be a different solution.
-      img(x, img.height() - 1 - y) = img_data[img.offset(x, y)];
-
-      // Correct when reading the image directly after storing the BLOB file with INDI.
-      //(*outImg)(x, y) = imgData[outImg->offset(x, y)];
+/**
+ * Serialises all calls into CFITSIO if it is not built reentrant
+ * (see fits_is_reentrant()). Otherwise, it does nothing.
+ *
+ * NOTE: The lock has to be created before any FitsFilePtr so that the file
+ *       is also closed while it is held.
+ */
+class CfitsioLock {
+ public:
+  CfitsioLock() {
+    if (!fits_is_reentrant()) {
+      lock_ = std::unique_lock<std::mutex>(mutex());
     }
+  }
+
+ private:
+  static std::mutex& mutex() {
+    static std::mutex cfitsio_mutex;
+    return cfitsio_mutex;
+  }
 
-    return std::move(img);
+  std::unique_lock<std::mutex> lock_;
+};
+
+/**
+ * Move to the HDU which contains the image. This is the primary HDU of
+ * an uncompressed file. CFITSIO stores a tile-compressed image in an
+ * extension and leaves the primary HDU empty.
+ */
+void move_to_image_hdu(fitsfile *fptr) {
+  int status = 0;
+  int num_hdus = 0;
 
-  } catch (CCfits::FitsException &exc) {
-    throw FitsIOException(exc.message());
+  fits_get_num_hdus(fptr, &num_hdus, &status);
+  throw_if_error(status, "Reading the number of HDUs failed");
+
+  for (int hdu = 1; hdu <= num_hdus; ++hdu) {
+    int hdu_type = 0;
+    fits_movabs_hdu(fptr, hdu, &hdu_type, &status);
+    throw_if_error(status, "Moving to the HDU failed");
+
+    if (hdu_type != IMAGE_HDU && !fits_is_compressed_image(fptr, &status)) {
+      continue;
+    }
+
+    int naxis = 0;
+    fits_get_img_dim(fptr, &naxis, &status);
+    throw_if_error(status, "Reading the image dimension failed");
+
+    if (naxis >= 2) {
+      return;
+    }
   }
+
+  throw FitsIOException("The file does not contain an image.");
 }
 
 /**
+ * Width and height of the image in the current HDU.
+ */
+Size<int> image_size(fitsfile *fptr) {
+  long naxes[2] = { 0, 0 };
+  int status = 0;
+
+  fits_get_img_size(fptr, 2, naxes, &status);
+  throw_if_error(status, "Reading the image size failed");
+
+  return Size<int>((int) naxes[0], (int) naxes[1]);
+}
+
+/**
+ * Read the image rows [first_row, first_row + num_rows) of the current HDU
+ * directly into the rows of dst. The rows are counted like in the image
+ * returned by read(), i.e. row 0 is the top row. Of each row, width pixels
+ * starting at first_column are read.
  *
+ * NOTE: FITS stores the rows bottom-up. Each row is read by CFITSIO straight
+ *       into its flipped position in dst. Hence, neither a temporary
+ *       buffer of the frame nor a copy loop is required. The conversion
+ *       to the pixel type (including BSCALE / BZERO) is done by CFITSIO.
  */
-void write(const cimg_library::CImg<uint16_t> &input_image, const std::string &filename, bool override,
-           std::stringstream *ss) {
-  // TODO: Is it possible to pass a stream?
-  CCfits::FITS::setVerboseMode(ss != nullptr);
+template<typename ImageType>
+void read_flipped_rows(fitsfile *fptr, int width, int height,
+                       int first_row, int num_rows,
+                       ImageType *dst, int first_column = 0) {
+  int status = 0;
 
-  try {
-    long naxis = 2;
-    long naxes[2] = { input_image.width(), input_image.height() };
+  for (int y = 0; y < num_rows && status == 0; ++y) {
+    // NOTE: FITS pixel coordinates start at 1.
+    long first_pixel[2] = { first_column + 1, height - (first_row + y) };
+    int any_null = 0;
 
-    std::unique_ptr < CCfits::FITS > pFits;
+    fits_read_pix(fptr, fits_data_type<ImageType>(), first_pixel, width,
+                  nullptr, dst + (size_t) y * width, &any_null, &status);
+  }
+
+  throw_if_error(status, "Reading the pixels failed");
+}
+
+/**
+ * Read the complete file into dst.
+ */
+void read_file(const std::string &filename, std::vector<unsigned char> *dst) {
+  std::ifstream file(filename, std::ios::binary | std::ios::ate);
+
+  if (!file) {
+    throw FitsIOException("Unable to open '" + filename + "'.");
+  }
+
+  std::streamsize file_size = file.tellg();
+  file.seekg(0);
+
+  dst->resize(static_cast<size_t>(file_size));
+
+  if (!file.read(reinterpret_cast<char*>(dst->data()), file_size)) {
+    throw FitsIOException("Unable to read '" + filename + "'.");
+  }
+}
+
+/**
+ * Open the FITS file which is stored in memory. The memory is not copied
+ * and must stay valid until the returned file is closed.
+ *
+ * NOTE: In contrast to fits_open_file(), CFITSIO does not look up files
+ *       which are already open. Each call returns an independent handle,
+ *       even if the same memory is opened several times.
+ */
+FitsFilePtr open_memory(const std::string &filename, unsigned char *data,
+                        size_t size) {
+  fitsfile *fptr = nullptr;
+  int status = 0;
+
+  void *memory = data;
+  size_t memory_size = size;
+
+  fits_open_memfile(&fptr, filename.c_str(), READONLY, &memory, &memory_size,
+                    0, nullptr, &status);
+  throw_if_error(status, "Opening '" + filename + "' failed");
+
+  return FitsFilePtr(fptr);
+}
+
+/**
+ * Decompress the rows of a tile-compressed image in parallel by num_bands
+ * threads. Each thread reads a band of rows through its own file handle
+ * because a fitsfile must not be shared between threads. CFITSIO only
+ * decompresses the tiles which contain the requested rows.
+ *
+ * NOTE: fits_open_file() returns the handle of a file which is already
+ *       open in the process (see fits_already_open()), i.e. all threads
+ *       would share one fitsfile. Therefore, the file is read into memory
+ *       once and each thread opens an independent handle of this memory.
+ */
+template<typename ImageType>
+void read_compressed_rows(const std::string &filename, int width, int height,
+                          int first_row, int num_rows, ImageType *dst,
+                          size_t num_bands) {
+  std::vector<unsigned char> file_data;
+  read_file(filename, &file_data);
+
+  parallel_for(0, num_rows, [&](size_t band_begin, size_t band_end) {
+    FitsFilePtr fits_file = open_memory(filename, file_data.data(),
+                                        file_data.size());
+    move_to_image_hdu(fits_file.get());
+
+    read_flipped_rows(fits_file.get(), width, height,
+                      first_row + (int) band_begin,
+                      (int) (band_end - band_begin),
+                      dst + band_begin * width);
+  }, num_bands, MIN_ROWS_PER_THREAD);
+}
+
+/**
+ * Read the rows [first_row, first_row + num_rows) of the image in the
+ * current HDU. A tile-compressed image is decompressed by up to num_threads
+ * threads.
+ *
+ * NOTE: If the rows are read in parallel, the passed file is closed before.
+ */
+template<typename ImageType>
+void read_rows_internal(FitsFilePtr *fits_file, const std::string &filename,
+                        int width, int height, int first_row, int num_rows,
+                        cimg_library::CImg<ImageType> *dst,
+                        size_t num_threads) {
+  int status = 0;
+
+  size_t num_bands = std::min(num_threads,
+                              (size_t) num_rows / MIN_ROWS_PER_THREAD);
+
+  // NOTE: Concurrent access to different files requires a reentrant
+  //       (thread-safe) build of CFITSIO. A gzip-compressed file is
+  //       read from memory and cannot be opened again by other threads.
+  if (num_bands > 1 && fits_is_compressed_image(fits_file->get(), &status)
+      && fits_is_reentrant()
+      && !is_fits_gz(boost::algorithm::to_lower_copy(filename))) {
+    fits_file->reset();
+
+    read_compressed_rows(filename, width, height, first_row, num_rows,
+                         dst->data(), num_bands);
+  } else {
+    read_flipped_rows(fits_file->get(), width, height, first_row, num_rows,
+                      dst->data());
+  }
+}
 
-    // NOTE: The "!" should automatically override an existing file...
-    //       See https://heasarc.gsfc.nasa.gov/fitsio/ccfits/html/writeimage.html
-    std::string filepath = (override ? "!" : "") + filename;
+/**
+ * Read the complete image with the given pixel type.
+ */
+template<typename ImageType>
+cimg_library::CImg<ImageType> read_image(FitsFilePtr *fits_file,
+                                         const std::string &filename,
+                                         size_t num_threads) {
+  Size<int> size = image_size(fits_file->get());
+
+  cimg_library::CImg<ImageType> img(size.width(), size.height());
+
+  // HACK / FIXME: At this point we assume that there is only 1 layer!
+
+  // TODO: Should the flip be parameterized? Or is it possible to find out automatically?
+  // Correct, when reading old, existing FITS files
+  // NOTE: ImageJ and Gimp both work this way for normal files.
+  //       -> For INDI/BLOB there must be a different solution.
+  read_rows_internal(fits_file, filename, size.width(), size.height(), 0,
+                     size.height(), &img, num_threads);
+
+  return img;
+}
 
-    if (ss != nullptr) {
-      *ss << "starmath::io::fits::write() writes to file '" << filepath << "'."
-          << std::endl;
+/**
+ * Inflate the complete gzip buffer src into dst and return the inflated
+ * size. dst is only resized if it is too small.
+ *
+ * The buffer is inflated by large inflate() calls instead of the small,
+ * buffered reads CFITSIO uses for gzip-compressed files. The size of the
+ * output is taken from the gzip trailer (ISIZE), so usually no
+ * re-allocation is required. Concatenated gzip members are supported.
+ */
+size_t inflate_gzip(const std::vector<unsigned char> &src,
+                    std::vector<unsigned char> *dst) {
+  if (src.size() < 18) {
+    throw FitsIOException("Invalid gzip file.");
+  }
+
+  // NOTE: ISIZE is the uncompressed size modulo 2^32 (little-endian).
+  const unsigned char *trailer = src.data() + src.size() - 4;
+  size_t expected_size = size_t(trailer[0]) | (size_t(trailer[1]) << 8)
+      | (size_t(trailer[2]) << 16) | (size_t(trailer[3]) << 24);
+
+  if (dst->size() < expected_size + 1) {
+    dst->resize(expected_size + 1);
+  }
+
+  z_stream stream { };
+
+  // NOTE: 15 + 32 = Maximum window size with automatic gzip header detection.
+  if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+    throw FitsIOException("Initializing zlib failed.");
+  }
+
+  // NOTE: avail_in is 32 bit. Larger files are passed in chunks.
+  const unsigned char *next_chunk = src.data();
+  size_t remaining_size = src.size();
+
+  size_t inflated_size = 0;
+  size_t num_members = 0;
+  int result = Z_OK;
+
+  while (true) {
+    if (stream.avail_in == 0 && remaining_size > 0) {
+      size_t chunk_size = std::min<size_t>(remaining_size,
+                                           std::numeric_limits<uInt>::max());
+      stream.next_in = const_cast<unsigned char*>(next_chunk);
+      stream.avail_in = static_cast<uInt>(chunk_size);
+      next_chunk += chunk_size;
+      remaining_size -= chunk_size;
     }
 
-    pFits = std::make_unique < CCfits::FITS
-        > (filepath, USHORT_IMG, naxis, naxes);
+    if (inflated_size == dst->size()) {
+      dst->resize(2 * dst->size());
+    }
 
-    // NOTE: At this point we assume that there is only 1 layer.
-    long nelements = std::accumulate(&naxes[0], &naxes[naxis], 1,
-                                     std::multiplies<>());
+    // NOTE: avail_out is 32 bit.
+    size_t available = std::min<size_t>(dst->size() - inflated_size,
+                                        std::numeric_limits<uInt>::max());
+    stream.next_out = dst->data() + inflated_size;
+    stream.avail_out = static_cast<uInt>(available);
 
-    std::valarray<typename Image::value_type> array(nelements);
+    result = inflate(&stream, Z_NO_FLUSH);
+    inflated_size += available - stream.avail_out;
 
-    cimg_forXY(input_image, x, y)
-    {
-      array[input_image.offset(x, y)] = input_image(x, input_image.height() - y - 1);
+    if (result == Z_STREAM_END) {
+      ++num_members;
+
+      // Continue with the next gzip member, if any.
+      if (stream.avail_in == 0 && remaining_size == 0) {
+        break;
+      }
+      inflateReset(&stream);
+    } else if (result != Z_OK && result != Z_BUF_ERROR) {
+      // NOTE: Some writers pad the file after the last member.
+      if (num_members > 0) {
+        result = Z_STREAM_END;
+      }
+      break;
+    } else if (stream.avail_in == 0 && remaining_size == 0
+        && stream.avail_out != 0) {
+      // Truncated input
+      break;
+    }
+  }
+
+  inflateEnd(&stream);
+
+  if (result != Z_STREAM_END) {
+    std::stringstream ss;
+    ss << "Inflating the gzip file failed (zlib error " << result << ").";
+    throw FitsIOException(ss.str());
+  }
+
+  return inflated_size;
+}
+
+/**
+ * Write all header cards of the current HDU to ss.
+ */
+void write_header(fitsfile *fptr, std::stringstream *ss) {
+  int status = 0;
+  int num_keys = 0;
+
+  fits_get_hdrspace(fptr, &num_keys, nullptr, &status);
+
+  for (int key = 1; key <= num_keys && status == 0; ++key) {
+    char card[FLEN_CARD];
+    fits_read_record(fptr, key, card, &status);
+    *ss << card << std::endl;
+  }
+
+  throw_if_error(status, "Reading the header failed");
+}
+
+/**
+ * Open the file without reading the pixels. The current HDU of the returned
+ * file is the HDU which contains the image.
+ *
+ * A gzip-compressed file is inflated into buffers which are owned by the
+ * returned file (see GzipBuffers) and opened from memory.
+ */
+FitsFilePtr open(const std::string &filename, std::stringstream *ss) {
+  FitsFilePtr fits_file;
+
+  if (is_fits_gz(boost::algorithm::to_lower_copy(filename))) {
+    auto buffers = acquire_gzip_buffers();
+
+    read_file(filename, &buffers->compressed);
+    size_t inflated_size = inflate_gzip(buffers->compressed,
+                                        &buffers->inflated);
+
+    fits_file = open_memory(filename, buffers->inflated.data(),
+                            inflated_size);
+    fits_file.get_deleter().gzip_buffers = std::move(buffers);
+  } else {
+    fitsfile *fptr = nullptr;
+    int status = 0;
+
+    fits_open_file(&fptr, filename.c_str(), READONLY, &status);
+    throw_if_error(status, "Opening '" + filename + "' failed");
+
+    fits_file.reset(fptr);
+  }
+
+  fitsfile *fptr = fits_file.get();
+
+  if (ss != nullptr) {
+    write_header(fptr, ss);
+  }
+
+  move_to_image_hdu(fptr);
+
+  return fits_file;
+}
+}  // namespace detail
+
+Image read(const std::string &filename,
+                            std::stringstream *ss, size_t num_threads) {
+
+  detail::CfitsioLock lock;
+  auto fits_file = detail::open(filename, ss);
+
+  // TODO: Put a check here:   fitsImg.bitpix() <= sizeof(ImageT)
+  // -> When provided image type does not fit, an exception is thrown? Or a warning logged?
+  // Maybe exception is optional i.e. can be configured?
+  return detail::read_image<typename Image::value_type>(&fits_file, filename,
+                                                        num_threads);
+}
+
+Frame read_frame(const std::string &filename, std::stringstream *ss,
+                 size_t num_threads) {
+
+  detail::CfitsioLock lock;
+  auto fits_file = detail::open(filename, ss);
+
+  // NOTE: The "equivalent" type takes BZERO / BSCALE into account. E.g.
+  //       BITPIX = 16 with BZERO = 32768 is unsigned 16 bit data.
+  int image_type = 0;
+  int status = 0;
+  fits_get_img_equivtype(fits_file.get(), &image_type, &status);
+  detail::throw_if_error(status, "Reading the image type failed");
+
+  if (image_type == BYTE_IMG || image_type == USHORT_IMG) {
+    return detail::read_image<uint16_t>(&fits_file, filename, num_threads);
+  }
+  return detail::read_image<float>(&fits_file, filename, num_threads);
+}
+
+Size<int> read_size(const std::string &filename, std::stringstream *ss) {
+
+  detail::CfitsioLock lock;
+  auto fits_file = detail::open(filename, ss);
+
+  return detail::image_size(fits_file.get());
+}
+
+std::vector<Image> read_regions(const std::string &filename,
+                                const std::vector<Rect<int>> &regions,
+                                std::stringstream *ss) {
+
+  detail::CfitsioLock lock;
+  auto fits_file = detail::open(filename, ss);
+
+  Size<int> size = detail::image_size(fits_file.get());
+  std::vector<Image> images;
+
+  images.reserve(regions.size());
+
+  for (const auto &region : regions) {
+    int region_width = static_cast<int>(region.width());
+    int region_height = static_cast<int>(region.height());
+
+    if (region.x() < 0 || region.y() < 0 || region_width < 1
+        || region_height < 1 || region.x() + region_width > size.width()
+        || region.y() + region_height > size.height()) {
+      std::stringstream ss_err;
+      ss_err << "Region " << region << " is not inside the image ("
+             << size.width() << " x " << size.height() << ").";
+      throw FitsIOException(ss_err.str());
+    }
+
+    Image image(region_width, region_height);
+
+    // NOTE: Only the rows (or the tiles of a compressed image) which
+    //       intersect the region are read.
+    detail::read_flipped_rows(fits_file.get(), region_width, size.height(),
+                              region.y(), region_height, image.data(),
+                              region.x());
+
+    images.push_back(std::move(image));
+  }
+
+  return images;
+}
+
+Image read_region(const std::string &filename, const Rect<int> &region,
+                  std::stringstream *ss) {
+  return std::move(read_regions(filename, { region }, ss).front());
+}
+
+namespace detail {
+
+void throw_if_invalid_rows(int first_row, int num_rows, int height) {
+  if (first_row < 0 || num_rows < 1 || first_row + num_rows > height) {
+    std::stringstream ss;
+    ss << "Rows [" << first_row << ", " << first_row + num_rows
+       << ") exceed the image height " << height << ".";
+    throw FitsIOException(ss.str());
+  }
+}
+}  // namespace detail
+
+Image read_rows(const std::string &filename, int first_row, int num_rows,
+                std::stringstream *ss, size_t num_threads) {
+
+  detail::CfitsioLock lock;
+  auto fits_file = detail::open(filename, ss);
+
+  Size<int> size = detail::image_size(fits_file.get());
+
+  detail::throw_if_invalid_rows(first_row, num_rows, size.height());
+
+  Image band(size.width(), num_rows);
+
+  detail::read_rows_internal(&fits_file, filename, size.width(),
+                             size.height(), first_row, num_rows, &band,
+                             num_threads);
+
+  return band;
+}
+
+struct RowReader::Impl {
+  detail::FitsFilePtr fits_file;
+  Size<int> size;
+  std::mutex mutex;
+};
+
+RowReader::RowReader(const std::string &filename)
+    :
+    impl_(std::make_unique<Impl>()) {
+
+  detail::CfitsioLock lock;
+  auto fits_file = detail::open(filename, nullptr);
+  impl_->size = detail::image_size(fits_file.get());
+  impl_->fits_file = std::move(fits_file);
+}
+
+RowReader::~RowReader() {
+  detail::CfitsioLock lock;
+  impl_->fits_file.reset();
+}
+
+Size<int> RowReader::size() const {
+  return impl_->size;
+}
+
+Image RowReader::read_rows(int first_row, int num_rows) const {
+  detail::throw_if_invalid_rows(first_row, num_rows, impl_->size.height());
+
+  Image band(impl_->size.width(), num_rows);
+
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  detail::CfitsioLock cfitsio_lock;
+
+  detail::read_flipped_rows(impl_->fits_file.get(), impl_->size.width(),
+                            impl_->size.height(), first_row, num_rows,
+                            band.data());
+  return band;
+}
+
+namespace detail {
+
+/**
+ * Write the image with the given CFITSIO image type (e.g. USHORT_IMG).
+ *
+ * NOTE: The file is written with CFITSIO directly since the compression
+ *       has to be set before the image is created. CFITSIO then writes an
+ *       empty primary HDU followed by the tile-compressed image.
+ */
+template<typename ImageType>
+void write_internal(const cimg_library::CImg<ImageType> &input_image,
+                    const std::string &filename, int image_type, bool override,
+                    std::stringstream *ss, const WriteOptions &options) {
+  // NOTE: The "!" should automatically override an existing file...
+  //       See https://heasarc.gsfc.nasa.gov/fitsio/ccfits/html/writeimage.html
+  std::string filepath = (override ? "!" : "") + filename;
+
+  if (ss != nullptr) {
+    *ss << "starmath::io::fits::write() writes to file '" << filepath
+        << "' (compression: " << Compression::asStr(options.compression)
+        << ")." << std::endl;
+  }
+
+  CfitsioLock lock;
+  fitsfile *fptr = nullptr;
+  int status = 0;
+
+  fits_create_file(&fptr, filepath.c_str(), &status);
+  throw_if_error(status, "Creating '" + filename + "' failed");
+
+  if (options.compression != Compression::NONE) {
+    fits_set_compression_type(
+        fptr, options.compression == Compression::RICE ? RICE_1 : GZIP_1,
+        &status);
+
+    // NOTE: Float data is quantized unless NO_QUANTIZE is set.
+    if (std::is_floating_point_v<ImageType>) {
+      fits_set_quantize_level(
+          fptr,
+          options.compression == Compression::RICE ?
+              options.quantize_level : NO_QUANTIZE,
+          &status);
     }
+  }
+
+  int width = input_image.width();
+  int height = input_image.height();
+
+  // NOTE: At this point we assume that there is only 1 layer.
+  long naxes[2] = { width, height };
+  fits_create_img(fptr, image_type, 2, naxes, &status);
+
+  // NOTE: The rows are written in file order, i.e. bottom-up, straight from
+  //       the image. With compression, each row is one tile.
+  for (int fits_row = 1; fits_row <= height && status == 0; ++fits_row) {
+    long first_pixel[2] = { 1, fits_row };
 
-    long fpixel(1);
-    pFits->pHDU().write(fpixel, nelements, array);
-  } catch (CCfits::FitsException &exc) {
-    throw FitsIOException(exc.message());
+    fits_write_pix(
+        fptr, fits_data_type<ImageType>(), first_pixel, width,
+        const_cast<ImageType*>(input_image.data(0, height - fits_row)),
+        &status);
   }
+
+  if (status != 0) {
+    int delete_status = 0;
+    fits_delete_file(fptr, &delete_status);
+  } else {
+    fits_close_file(fptr, &status);
+  }
+
+  throw_if_error(status, "Writing '" + filename + "' failed");
+}
+}  // namespace detail
+
+/**
+ *
+ */
+void write(const cimg_library::CImg<uint16_t> &input_image, const std::string &filename, bool override,
+           std::stringstream *ss, const WriteOptions &options) {
+  detail::write_internal(input_image, filename, USHORT_IMG, override, ss,
+                         options);
+}
+
+/**
+ *
+ */
+void write(const Image &input_image, const std::string &filename, bool override,
+           std::stringstream *ss, const WriteOptions &options) {
+  detail::write_internal(input_image, filename, FLOAT_IMG, override, ss,
+                         options);
 }
 
 }  // starmathpp::io::fits
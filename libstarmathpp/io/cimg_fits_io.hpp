@@ -28,17 +28,69 @@
 
 #include <memory>
 #include <sstream>
+#include <vector>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 
+#include <libstarmathpp/enum_helper.hpp>
 #include <libstarmathpp/exception.hpp>
+#include <libstarmathpp/frame.hpp>
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/rect.hpp>
+#include <libstarmathpp/size.hpp>
 
 namespace starmathpp::io::fits {
 
 DEF_Exception(FitsIO);
 
+/**
+ * CFITSIO tile compression of a written image. Each image row is one tile.
+ *
+ * RICE     - Lossless for 16 bit data. Float data is quantized
+ *            (see WriteOptions::quantize_level).
+ * GZIP     - Lossless for 16 bit and float data.
+ */
+struct Compression {
+  enum TypeE {
+    NONE,
+    RICE,
+    GZIP,
+    _Count
+  };
+
+  static const char* asStr(const TypeE &inType) {
+    switch (inType) {
+      case NONE:
+        return "NONE";
+      case RICE:
+        return "RICE";
+      case GZIP:
+        return "GZIP";
+      default:
+        return "<?>";
+    }
+  }
+
+  MAC_AS_TYPE(Type, E, _Count)
+  ;
+};
+
+/**
+ * Options of the FITS writer.
+ */
+struct WriteOptions {
+  Compression::TypeE compression = Compression::NONE;
+
+  /**
+   * Quantization level of float data compressed with RICE. The quantization
+   * step is the noise of a tile divided by this value, i.e. a larger value
+   * keeps more precision. See the CFITSIO documentation of
+   * fits_set_quantize_level().
+   */
+  float quantize_level = 16.0F;
+};
+
 /**
  * @param filepath_lower
  * @return
@@ -56,11 +108,114 @@ bool is_fits_gz(const std::string &filepath_lower);
  * CCfits helper function
  * See http://heasarc.gsfc.nasa.gov/fitsio/ccfits/html/cookbook.html
  *
+ * The image is read from the primary HDU or, if the primary HDU is empty,
+ * from the first (tile-compressed) image extension. The tiles of a
+ * compressed image are decompressed by up to num_threads threads.
+ *
+ * NOTE: num_threads defaults to 1 since read() is usually called by several
+ *       threads of a pipeline already (e.g. by views::read_ahead()). More
+ *       threads only pay off if a single large compressed file is read.
+ *
+ * A gzip-compressed file (.fit.gz) is inflated in one pass into a buffer
+ * which is reused for the next file read by the same thread. The FITS data
+ * is then parsed from memory.
+ *
+ * NOTE: Each reading thread keeps up to 256 MB of gzip buffers for the next
+ *       file. These are not part of the memory budget of
+ *       views::read_ahead().
+ *
+ * NOTE: Files can be read concurrently by several threads (e.g. by
+ *       views::read_ahead()) if CFITSIO is built reentrant. Otherwise, all
+ *       calls into CFITSIO are serialised.
+ *
  * TODO: Add/adapt unit tests? -> Load, save and load -> compare...
  * TODO: Improve error handling?
  */
 Image
-read(const std::string &filename, std::stringstream *ss = nullptr);
+read(const std::string &filename, std::stringstream *ss = nullptr,
+     size_t num_threads = 1);
+
+/**
+ * Same as read(), but the pixel type depends on the data in the file:
+ * 8 and 16 bit unsigned integer data is returned as Image16. All other
+ * data is returned as (float) Image.
+ */
+Frame
+read_frame(const std::string &filename, std::stringstream *ss = nullptr,
+           size_t num_threads = 1);
+
+/**
+ * Read the width and height of the primary image without reading
+ * the pixels.
+ */
+Size<int>
+read_size(const std::string &filename, std::stringstream *ss = nullptr);
+
+/**
+ * Read num_rows rows of the primary image starting at first_row. The rows
+ * are counted like in the image returned by read(), i.e. row 0 is the top
+ * row. Only the requested rows are read from an uncompressed file.
+ *
+ * NOTE: A gzip-compressed file is inflated completely.
+ * NOTE: See read() for num_threads.
+ */
+Image
+read_rows(const std::string &filename, int first_row, int num_rows,
+          std::stringstream *ss = nullptr, size_t num_threads = 1);
+
+/**
+ * Keeps a FITS file open to read rows of its image repeatedly (e.g. the
+ * bands of a frame, see io::FileBandReader). In contrast to read_rows(), the
+ * file is opened and its header is parsed only once.
+ *
+ * read_rows() may be called concurrently. The calls are serialized since
+ * a fitsfile must not be used by several threads at the same time.
+ *
+ * NOTE: A gzip-compressed file is inflated once and is held in memory
+ *       until the reader is destroyed.
+ */
+class RowReader {
+ public:
+  explicit RowReader(const std::string &filename);
+  ~RowReader();
+
+  RowReader(const RowReader&) = delete;
+  RowReader& operator=(const RowReader&) = delete;
+
+  [[nodiscard]] Size<int> size() const;
+
+  /**
+   * Same as fits::read_rows().
+   */
+  [[nodiscard]] Image read_rows(int first_row, int num_rows) const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * Read the region of the primary image. The region is given in the
+ * coordinates of the image returned by read(), i.e. y = 0 is the top row.
+ * Only the rows of an uncompressed file (or the tiles of a tile-compressed
+ * file) which intersect the region are read.
+ *
+ * Throws FitsIOException if the region is not inside the image.
+ *
+ * NOTE: A gzip-compressed file is inflated completely.
+ */
+Image
+read_region(const std::string &filename, const Rect<int> &region,
+            std::stringstream *ss = nullptr);
+
+/**
+ * Same as read_region(), but for many regions (e.g. the windows around
+ * known star positions). The file is opened only once. The images are
+ * returned in the order of the regions.
+ */
+std::vector<Image>
+read_regions(const std::string &filename, const std::vector<Rect<int>> &regions,
+             std::stringstream *ss = nullptr);
 
 /**
  * CCfits helper function
@@ -73,7 +228,15 @@ read(const std::string &filename, std::stringstream *ss = nullptr);
  */
 void
 write(const cimg_library::CImg<uint16_t> &input_image, const std::string &filename, bool override = false,
-      std::stringstream *ss = nullptr);
+      std::stringstream *ss = nullptr, const WriteOptions &options = WriteOptions());
+
+/**
+ * Write the image as 32 bit floating point FITS image (BITPIX = -32).
+ * In contrast to io::write(), the pixel values are stored unchanged.
+ */
+void
+write(const Image &input_image, const std::string &filename, bool override = false,
+      std::stringstream *ss = nullptr, const WriteOptions &options = WriteOptions());
 
 }
 ;
@@ -0,0 +1,870 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_IO_FILE_SCANNER_HPP_
+#define STARMATHPP_IO_FILE_SCANNER_HPP_ STARMATHPP_IO_FILE_SCANNER_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <libstarmathpp/exception.hpp>
+#include <libstarmathpp/thread_pool.hpp>
+
+namespace starmathpp::io {
+
+DEF_Exception(FileScanner);
+
+/**
+ * Selects files by their name (without the directory). The pattern is
+ * compiled once - matching a name does not allocate.
+ *
+ * glob()        - Shell-like pattern: '*' matches any sequence, '?' any
+ *                 single character, [abc], [a-z] and [!a-z] match a
+ *                 character of a set. '\' escapes the next character.
+ * extensions()  - The name ends with one of the extensions, e.g.
+ *                 { ".fit", ".fits", ".fit.gz" }. Case-insensitive.
+ *
+ * A default constructed matcher matches every file.
+ */
+class FileMatcher {
+ public:
+  FileMatcher()
+      :
+      type_(ALL),
+      case_sensitive_(true),
+      key_("all") {
+  }
+
+  static FileMatcher glob(const std::string &pattern,
+                          bool case_sensitive = false) {
+    FileMatcher matcher;
+    matcher.type_ = GLOB;
+    matcher.case_sensitive_ = case_sensitive;
+    matcher.key_ = std::string(case_sensitive ? "glob:" : "iglob:") + pattern;
+
+    for (size_t i = 0; i < pattern.size(); ++i) {
+      GlobToken token;
+      char c = pattern[i];
+
+      if (c == '*') {
+        // Consecutive '*' are equivalent to one
+        if (!matcher.tokens_.empty()
+            && matcher.tokens_.back().kind == GlobToken::ANY_SEQUENCE) {
+          continue;
+        }
+        token.kind = GlobToken::ANY_SEQUENCE;
+      } else if (c == '?') {
+        token.kind = GlobToken::ANY_CHAR;
+      } else if (c == '[' && parse_set(pattern, i, token)) {
+        token.kind = GlobToken::SET;
+      } else {
+        if (c == '\\' && i + 1 < pattern.size()) {
+          c = pattern[++i];
+        }
+        token.kind = GlobToken::CHAR;
+        token.c = c;
+      }
+
+      if (!case_sensitive) {
+        token.c = fold(token.c);
+
+        for (auto &range : token.ranges) {
+          range = {fold(range.first), fold(range.second)};
+        }
+      }
+      matcher.tokens_.push_back(std::move(token));
+    }
+    return matcher;
+  }
+
+  static FileMatcher extensions(const std::vector<std::string> &extensions) {
+    FileMatcher matcher;
+    matcher.type_ = EXTENSIONS;
+    matcher.case_sensitive_ = false;
+
+    for (const auto &extension : extensions) {
+      std::string ext = (extension.empty() || extension[0] != '.') ?
+          "." + extension : extension;
+      std::transform(ext.begin(), ext.end(), ext.begin(), fold);
+      matcher.extensions_.push_back(std::move(ext));
+    }
+    std::sort(matcher.extensions_.begin(), matcher.extensions_.end());
+
+    matcher.key_ = "extensions:";
+    for (const auto &ext : matcher.extensions_) {
+      matcher.key_ += ext + ";";
+    }
+    return matcher;
+  }
+
+  /**
+   * Check the file name (not the complete path).
+   */
+  [[nodiscard]] bool operator()(const std::string &filename) const {
+    switch (type_) {
+      case GLOB:
+        return match_glob(filename);
+      case EXTENSIONS:
+        return match_extensions(filename);
+      default:
+        return true;
+    }
+  }
+
+  /**
+   * Unique description of the matcher, e.g. "iglob:*.fit".
+   */
+  [[nodiscard]] const std::string& key() const {
+    return key_;
+  }
+
+ private:
+  enum MatcherType {
+    ALL,
+    GLOB,
+    EXTENSIONS
+  };
+
+  struct GlobToken {
+    enum Kind {
+      CHAR,
+      ANY_CHAR,
+      ANY_SEQUENCE,
+      SET
+    };
+
+    Kind kind = CHAR;
+    char c = 0;
+    bool negated = false;
+    std::vector<std::pair<char, char>> ranges;
+
+    [[nodiscard]] bool matches(char ch) const {
+      switch (kind) {
+        case CHAR:
+          return ch == c;
+        case SET: {
+          bool in_set = std::any_of(ranges.begin(), ranges.end(),
+                                    [ch](const auto &range) {
+                                      return ch >= range.first
+                                          && ch <= range.second;
+                                    });
+          return in_set != negated;
+        }
+        default:
+          return true;
+      }
+    }
+  };
+
+  MatcherType type_;
+  bool case_sensitive_;
+  std::string key_;
+  std::vector<GlobToken> tokens_;
+  std::vector<std::string> extensions_;
+
+  static char fold(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  }
+
+  /**
+   * Parse the set starting at pattern[pos] == '['. On success, pos is moved
+   * to the closing ']'. Without a closing ']', the '[' is a literal.
+   */
+  static bool parse_set(const std::string &pattern, size_t &pos,
+                        GlobToken &token) {
+    size_t i = pos + 1;
+
+    if (i < pattern.size() && (pattern[i] == '!' || pattern[i] == '^')) {
+      token.negated = true;
+      ++i;
+    }
+
+    // A ']' directly after '[' or '[!' is part of the set
+    size_t first = i;
+
+    for (; i < pattern.size(); ++i) {
+      if (pattern[i] == ']' && i > first) {
+        pos = i;
+        return true;
+      }
+
+      if (i + 2 < pattern.size() && pattern[i + 1] == '-'
+          && pattern[i + 2] != ']') {
+        token.ranges.emplace_back(pattern[i], pattern[i + 2]);
+        i += 2;
+      } else {
+        token.ranges.emplace_back(pattern[i], pattern[i]);
+      }
+    }
+
+    token.ranges.clear();
+    token.negated = false;
+    return false;
+  }
+
+  /**
+   * Iterative matching. On a mismatch, the last '*' is extended by one
+   * character, which avoids exponential backtracking.
+   */
+  [[nodiscard]] bool match_glob(const std::string &filename) const {
+    const size_t npos = std::string::npos;
+    size_t t = 0;
+    size_t s = 0;
+    size_t star_t = npos;
+    size_t star_s = 0;
+
+    while (s < filename.size()) {
+      char ch = case_sensitive_ ? filename[s] : fold(filename[s]);
+
+      if (t < tokens_.size() && tokens_[t].kind == GlobToken::ANY_SEQUENCE) {
+        star_t = t++;
+        star_s = s;
+      } else if (t < tokens_.size() && tokens_[t].matches(ch)) {
+        ++t;
+        ++s;
+      } else if (star_t != npos) {
+        t = star_t + 1;
+        s = ++star_s;
+      } else {
+        return false;
+      }
+    }
+
+    while (t < tokens_.size() && tokens_[t].kind == GlobToken::ANY_SEQUENCE) {
+      ++t;
+    }
+    return t == tokens_.size();
+  }
+
+  [[nodiscard]] bool match_extensions(const std::string &filename) const {
+    return std::any_of(extensions_.begin(), extensions_.end(),
+                       [&filename](const std::string &ext) {
+                         if (filename.size() <= ext.size()) {
+                           return false;
+                         }
+                         size_t offset = filename.size() - ext.size();
+
+                         for (size_t i = 0; i < ext.size(); ++i) {
+                           if (fold(filename[offset + i]) != ext[i]) {
+                             return false;
+                           }
+                         }
+                         return true;
+                       });
+  }
+};
+
+/**
+ * Natural order of two names: runs of digits are compared by their
+ * numeric value ("light_9.fit" < "light_10.fit") and letters are compared
+ * case-insensitively. A path separator is lower than every other
+ * character, so complete paths are ordered directory by directory.
+ *
+ * Returns < 0, 0 or > 0. Names which only differ in leading zeros or case
+ * compare equal - natural_less() breaks these ties.
+ */
+inline int natural_compare(const std::string &a, const std::string &b) {
+  auto is_digit = [](char c) {
+    return c >= '0' && c <= '9';
+  };
+  auto rank = [](char c) {
+    if (c == '/' || c == std::filesystem::path::preferred_separator) {
+      return 0;
+    }
+    return std::tolower(static_cast<unsigned char>(c)) + 1;
+  };
+
+  size_t i = 0;
+  size_t j = 0;
+
+  while (i < a.size() && j < b.size()) {
+    if (is_digit(a[i]) && is_digit(b[j])) {
+      while (i < a.size() && a[i] == '0') {
+        ++i;
+      }
+      while (j < b.size() && b[j] == '0') {
+        ++j;
+      }
+
+      size_t end_i = i;
+      size_t end_j = j;
+
+      while (end_i < a.size() && is_digit(a[end_i])) {
+        ++end_i;
+      }
+      while (end_j < b.size() && is_digit(b[end_j])) {
+        ++end_j;
+      }
+
+      // More significant digits - larger number
+      if (end_i - i != end_j - j) {
+        return end_i - i < end_j - j ? -1 : 1;
+      }
+
+      int result = a.compare(i, end_i - i, b, j, end_j - j);
+
+      if (result != 0) {
+        return result < 0 ? -1 : 1;
+      }
+
+      i = end_i;
+      j = end_j;
+      continue;
+    }
+
+    int rank_a = rank(a[i]);
+    int rank_b = rank(b[j]);
+
+    if (rank_a != rank_b) {
+      return rank_a < rank_b ? -1 : 1;
+    }
+    ++i;
+    ++j;
+  }
+
+  if (i < a.size()) {
+    return 1;
+  }
+  return j < b.size() ? -1 : 0;
+}
+
+/**
+ * Strict total order based on natural_compare().
+ */
+inline bool natural_less(const std::string &a, const std::string &b) {
+  int result = natural_compare(a, b);
+  return result != 0 ? result < 0 : a < b;
+}
+
+/**
+ *
+ */
+struct ScanOptions {
+  /**
+   * Descend into sub-directories.
+   */
+  bool recursive = true;
+
+  /**
+   * Descend into symbolically linked directories. Links to files are
+   * always listed. A directory reached through several paths is listed
+   * once (see scan_files()).
+   */
+  bool follow_symlinks = false;
+
+  /**
+   * Number of threads listing directories. They are started once per
+   * scan_files() call, not per tree level.
+   */
+  size_t num_threads = default_num_workers();
+
+  /**
+   * If set, the listing is stored in this file and re-used as long as no
+   * scanned directory was modified. The file must be outside of the
+   * scanned tree.
+   */
+  std::filesystem::path cache_file;
+};
+
+namespace detail {
+
+struct DirectoryListing {
+  std::vector<std::filesystem::path> files;
+  std::vector<std::filesystem::path> directories;
+};
+
+/**
+ * List a single directory. The file type is taken from the directory entry
+ * (which is filled by readdir()). Only symbolic links require a stat().
+ */
+inline DirectoryListing list_directory(const std::filesystem::path &directory,
+                                       const FileMatcher &matcher,
+                                       const ScanOptions &options) {
+  namespace fs = std::filesystem;
+
+  DirectoryListing listing;
+  std::error_code ec;
+  fs::directory_iterator it(directory,
+                            fs::directory_options::skip_permission_denied, ec);
+
+  if (ec) {
+    std::stringstream ss;
+    ss << "Unable to list directory '" << directory.string() << "': "
+       << ec.message();
+    throw FileScannerException(ss.str());
+  }
+
+  for (; it != fs::directory_iterator(); it.increment(ec)) {
+    const fs::directory_entry &entry = *it;
+    std::error_code type_ec;
+
+    if (entry.is_directory(type_ec)) {
+      if (options.recursive
+          && (options.follow_symlinks || !entry.is_symlink(type_ec))) {
+        listing.directories.push_back(entry.path());
+      }
+    } else if (matcher(entry.path().filename().string())
+        && entry.is_regular_file(type_ec)) {
+      listing.files.push_back(entry.path());
+    }
+  }
+
+  if (ec) {
+    std::stringstream ss;
+    ss << "Error listing directory '" << directory.string() << "': "
+       << ec.message();
+    throw FileScannerException(ss.str());
+  }
+
+  return listing;
+}
+
+/**
+ * Call fun(index) for each index in [0, num_indices) on the workers of
+ * thread_pool and the calling thread. The threads pick the next index when
+ * they are done - directories differ a lot in size. If thread_pool is
+ * nullptr, the calling thread processes all indices.
+ */
+template<typename Fun>
+void parallel_for_each_index(ThreadPool *thread_pool, size_t num_indices,
+                             Fun &&fun) {
+  if (thread_pool == nullptr) {
+    for (size_t idx = 0; idx < num_indices; ++idx) {
+      fun(idx);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next_index { 0 };
+
+  parallel_for(*thread_pool, 0, std::min(thread_pool->size() + 1, num_indices),
+               [&](size_t, size_t) {
+                 for (size_t idx = next_index++; idx < num_indices;
+                     idx = next_index++) {
+                   fun(idx);
+                 }
+               });
+}
+
+/**
+ * The calling thread lists directories as well. Therefore, the pool has
+ * num_threads - 1 workers. No pool is needed for a single thread.
+ */
+inline std::unique_ptr<ThreadPool> make_scan_thread_pool(
+    const ScanOptions &options) {
+  if (options.num_threads <= 1) {
+    return nullptr;
+  }
+  return std::make_unique<ThreadPool>(options.num_threads - 1);
+}
+
+inline int64_t modification_time(const std::filesystem::path &path,
+                                 std::error_code &ec) {
+  return static_cast<int64_t>(std::filesystem::last_write_time(path, ec)
+      .time_since_epoch().count());
+}
+
+/**
+ * Directories modified within this interval before a scan are not trusted
+ * by the cache.
+ */
+constexpr std::chrono::seconds RACY_INTERVAL { 2 };
+
+/**
+ * Stored instead of the modification time of a directory which has to be
+ * listed again.
+ */
+constexpr int64_t RACY_MTIME = std::numeric_limits<int64_t>::min();
+
+/**
+ * A directory and its modification time when it was listed. Adding,
+ * removing or renaming an entry changes the modification time.
+ */
+struct ScannedDirectory {
+  std::filesystem::path path;
+  int64_t mtime;
+};
+
+struct FileListing {
+  std::vector<ScannedDirectory> directories;
+  std::vector<std::filesystem::path> files;
+};
+
+/**
+ * Remove the directories of the level which were visited before. This is
+ * only required if symbolic links are followed: a link may point to a
+ * directory which is listed anyway, or to one of its own parents, which
+ * would be a cycle. Directories are identified by their canonical path.
+ *
+ * The level is sorted first, so that the same one of several paths to a
+ * directory is kept in every scan.
+ */
+inline void remove_visited_directories(
+    ThreadPool *thread_pool, std::vector<std::filesystem::path> &level,
+    std::set<std::filesystem::path> &visited) {
+
+  std::sort(level.begin(), level.end(),
+            [](const std::filesystem::path &a, const std::filesystem::path &b) {
+              return natural_less(a.native(), b.native());
+            });
+
+  std::vector<std::filesystem::path> canonical_paths(level.size());
+
+  parallel_for_each_index(thread_pool, level.size(), [&](size_t idx) {
+    std::error_code ec;
+    canonical_paths[idx] = std::filesystem::canonical(level[idx], ec);
+
+    if (ec) {
+      // NOTE: list_directory() reports the error
+      canonical_paths[idx] = level[idx];
+    }
+  });
+
+  std::vector<std::filesystem::path> unvisited;
+  unvisited.reserve(level.size());
+
+  for (size_t idx = 0; idx < level.size(); ++idx) {
+    if (visited.insert(std::move(canonical_paths[idx])).second) {
+      unvisited.push_back(std::move(level[idx]));
+    }
+  }
+
+  level = std::move(unvisited);
+}
+
+/**
+ * Scan the tree level by level. The directories of one level are listed
+ * in parallel by the threads of thread_pool (and the calling thread).
+ */
+inline FileListing scan_tree(ThreadPool *thread_pool,
+                             const std::filesystem::path &root,
+                             const FileMatcher &matcher,
+                             const ScanOptions &options) {
+  FileListing result;
+  std::vector<std::filesystem::path> level { root };
+  std::set<std::filesystem::path> visited;
+
+  const int64_t racy_mtime_limit = static_cast<int64_t>(
+      (std::filesystem::file_time_type::clock::now() - RACY_INTERVAL)
+          .time_since_epoch().count());
+
+  while (!level.empty()) {
+    if (options.follow_symlinks) {
+      remove_visited_directories(thread_pool, level, visited);
+    }
+
+    std::vector<DirectoryListing> listings(level.size());
+    std::vector<int64_t> mtimes(level.size(), 0);
+
+    parallel_for_each_index(thread_pool, level.size(),
+                            [&](size_t idx) {
+                              std::error_code ec;
+                              // NOTE: The time is taken before listing. A
+                              //       change while listing invalidates the cache.
+                              int64_t mtime = modification_time(level[idx], ec);
+                              mtimes[idx] = (ec || mtime > racy_mtime_limit) ?
+                                  RACY_MTIME : mtime;
+                              listings[idx] = list_directory(level[idx], matcher,
+                                                             options);
+                            });
+
+    std::vector<std::filesystem::path> next_level;
+
+    for (size_t idx = 0; idx < level.size(); ++idx) {
+      result.directories.push_back( { std::move(level[idx]), mtimes[idx] });
+
+      auto &listing = listings[idx];
+      std::move(listing.files.begin(), listing.files.end(),
+                std::back_inserter(result.files));
+      std::move(listing.directories.begin(), listing.directories.end(),
+                std::back_inserter(next_level));
+    }
+
+    level = std::move(next_level);
+  }
+
+  std::sort(result.files.begin(), result.files.end(),
+            [](const std::filesystem::path &a, const std::filesystem::path &b) {
+              return natural_less(a.native(), b.native());
+            });
+
+  return result;
+}
+
+/**
+ * Description of everything the listing depends on. Stored in the first
+ * lines of the cache file.
+ */
+inline std::string listing_key(const std::filesystem::path &root,
+                               const FileMatcher &matcher,
+                               const ScanOptions &options) {
+  std::stringstream ss;
+  ss << "starmathpp file listing 1\n" << "root=" << root.string() << '\n'
+     << "matcher=" << matcher.key() << '\n' << "recursive="
+     << options.recursive << ";follow_symlinks=" << options.follow_symlinks
+     << '\n';
+  return ss.str();
+}
+
+/**
+ * Read the cached listing. Returns false if there is no cache, the key
+ * differs or a scanned directory was modified since.
+ */
+inline bool read_cached_listing(ThreadPool *thread_pool,
+                                const std::string &key,
+                                const ScanOptions &options,
+                                std::vector<std::filesystem::path> &files) {
+  std::ifstream ifs(options.cache_file);
+
+  if (!ifs) {
+    return false;
+  }
+
+  std::stringstream key_ss;
+  std::string line;
+
+  for (size_t i = 0; i < 4 && std::getline(ifs, line); ++i) {
+    key_ss << line << '\n';
+  }
+
+  size_t num_directories = 0;
+
+  if (key_ss.str() != key || !(ifs >> num_directories)) {
+    return false;
+  }
+
+  std::vector<ScannedDirectory> directories(num_directories);
+
+  for (auto &directory : directories) {
+    std::string path;
+
+    if (!(ifs >> directory.mtime) || ifs.get() != ' '
+        || !std::getline(ifs, path)) {
+      return false;
+    }
+    directory.path = path;
+  }
+
+  std::atomic<bool> modified { false };
+
+  parallel_for_each_index(thread_pool, directories.size(),
+                          [&](size_t idx) {
+                            std::error_code ec;
+                            int64_t mtime = modification_time(directories[idx].path, ec);
+
+                            if (ec || mtime != directories[idx].mtime
+                                || mtime == RACY_MTIME) {
+                              modified = true;
+                            }
+                          });
+
+  size_t num_files = 0;
+
+  if (modified || !(ifs >> num_files) || ifs.get() != '\n') {
+    return false;
+  }
+
+  std::vector<std::filesystem::path> cached_files;
+  cached_files.reserve(num_files);
+
+  for (size_t i = 0; i < num_files && std::getline(ifs, line); ++i) {
+    cached_files.emplace_back(line);
+  }
+
+  if (cached_files.size() != num_files) {
+    return false;
+  }
+
+  files = std::move(cached_files);
+  return true;
+}
+
+/**
+ * Store the listing. The file is written to a temporary file and renamed.
+ * The cache is an optimization only - failures are ignored.
+ */
+inline void write_cached_listing(const std::string &key,
+                                 const ScanOptions &options,
+                                 const FileListing &listing) {
+  auto has_newline = [](const std::filesystem::path &path) {
+    return path.native().find('\n') != std::string::npos;
+  };
+
+  if (std::any_of(listing.files.begin(), listing.files.end(), has_newline)) {
+    return;
+  }
+
+  std::stringstream temp_name;
+  temp_name << options.cache_file.filename().string() << ".tmp"
+            << std::chrono::steady_clock::now().time_since_epoch().count();
+
+  const std::filesystem::path temp_path = options.cache_file.parent_path()
+      / temp_name.str();
+  std::error_code ec;
+
+  {
+    std::ofstream ofs(temp_path);
+
+    ofs << key << listing.directories.size() << '\n';
+
+    for (const auto &directory : listing.directories) {
+      ofs << directory.mtime << ' ' << directory.path.string() << '\n';
+    }
+
+    ofs << listing.files.size() << '\n';
+
+    for (const auto &file : listing.files) {
+      ofs << file.string() << '\n';
+    }
+
+    if (!ofs) {
+      ofs.close();
+      std::filesystem::remove(temp_path, ec);
+      return;
+    }
+  }
+
+  std::filesystem::rename(temp_path, options.cache_file, ec);
+
+  if (ec) {
+    std::filesystem::remove(temp_path, ec);
+  }
+}
+
+/**
+ * Writing the cache file changes the modification time of its directory.
+ * Inside of the scanned tree, the cache would never be valid.
+ */
+inline void check_cache_location(const std::filesystem::path &root,
+                                 const ScanOptions &options) {
+  namespace fs = std::filesystem;
+
+  std::error_code cache_ec;
+  std::error_code root_ec;
+  fs::path relative = fs::weakly_canonical(options.cache_file, cache_ec)
+      .lexically_relative(fs::weakly_canonical(root, root_ec));
+
+  if (cache_ec || root_ec || relative.empty() || *relative.begin() == "..") {
+    return;
+  }
+
+  size_t depth = std::distance(relative.begin(), relative.end());
+
+  if (options.recursive || depth == 1) {
+    std::stringstream ss;
+    ss << "Cache file '" << options.cache_file.string()
+       << "' must not be inside of the scanned directory '" << root.string()
+       << "'.";
+    throw FileScannerException(ss.str());
+  }
+}
+
+}  // namespace detail
+
+/**
+ * List the regular files below root whose name matches the matcher.
+ *
+ * In contrast to a std::filesystem::recursive_directory_iterator:
+ * - The directories of each tree level are listed in parallel.
+ * - With ScanOptions::follow_symlinks, each directory is listed once, even
+ *   if several links point to it or a link points to one of its parents.
+ * - The file type is taken from the directory entries - there is no stat()
+ *   per file.
+ * - The result is sorted in natural order (see natural_compare()). Hence,
+ *   the order of the files and everything derived from it (e.g. a stack)
+ *   does not depend on the file system.
+ *
+ * With ScanOptions::cache_file set, the listing is stored and re-used until
+ * a scanned directory is modified. Checking the cache only requires one
+ * stat() per directory instead of listing all files.
+ *
+ * NOTE: A file added right after the listing may not change the (coarse)
+ *       modification time of its directory. Therefore, directories which
+ *       were modified less than RACY_INTERVAL before the scan are listed
+ *       again the next time.
+ *
+ * Usage:
+ *
+ * ScanOptions options;
+ * options.cache_file = "archive.files";
+ *
+ * auto lights = scan_files("archive/lights",
+ *                          FileMatcher::extensions({ ".fit", ".fit.gz" }),
+ *                          options);
+ */
+inline std::vector<std::filesystem::path> scan_files(
+    const std::filesystem::path &root, const FileMatcher &matcher =
+        FileMatcher(),
+    const ScanOptions &options = ScanOptions()) {
+
+  if (!std::filesystem::is_directory(root)) {
+    std::stringstream ss;
+    ss << "'" << root.string() << "' is not a directory.";
+    throw FileScannerException(ss.str());
+  }
+
+  std::string key;
+  std::unique_ptr<ThreadPool> thread_pool = detail::make_scan_thread_pool(
+      options);
+
+  if (!options.cache_file.empty()) {
+    detail::check_cache_location(root, options);
+
+    key = detail::listing_key(root, matcher, options);
+    std::vector<std::filesystem::path> cached_files;
+
+    if (detail::read_cached_listing(thread_pool.get(), key, options,
+                                    cached_files)) {
+      return cached_files;
+    }
+  }
+
+  detail::FileListing listing = detail::scan_tree(thread_pool.get(), root,
+                                                  matcher, options);
+
+  if (!options.cache_file.empty()) {
+    detail::write_cached_listing(key, options, listing);
+  }
+
+  return std::move(listing.files);
+}
+
+}  // namespace starmathpp::io
+
+#endif // STARMATHPP_IO_FILE_SCANNER_HPP_
@@ -0,0 +1,317 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "file scanner unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/io/file_scanner.hpp>
+
+BOOST_AUTO_TEST_SUITE (file_scanner_tests)
+
+using namespace starmathpp::io;
+
+namespace fs = std::filesystem;
+
+/**
+ * Temporary directory which is removed at the end of the test.
+ */
+class TempDir {
+ public:
+  TempDir()
+      :
+      path_(
+          fs::temp_directory_path() / fs::path("file_scanner_test")) {
+    fs::remove_all(path_);
+    fs::create_directories(path_);
+  }
+
+  ~TempDir() {
+    fs::remove_all(path_);
+  }
+
+  [[nodiscard]] const fs::path& path() const {
+    return path_;
+  }
+
+ private:
+  fs::path path_;
+};
+
+static void create_file(const fs::path &filepath) {
+  fs::create_directories(filepath.parent_path());
+  std::ofstream ofs(filepath);
+  ofs << "data";
+}
+
+/**
+ * Move the modification time of all directories into the past. Otherwise,
+ * the cache does not trust them (see RACY_INTERVAL).
+ */
+static void age_directories(const fs::path &root) {
+  auto past = fs::file_time_type::clock::now() - std::chrono::hours(1);
+
+  fs::last_write_time(root, past);
+
+  for (const auto &entry : fs::recursive_directory_iterator(root)) {
+    if (entry.is_directory()) {
+      fs::last_write_time(entry.path(), past);
+    }
+  }
+}
+
+/**
+ * Tree with files in several levels, numbered names and other extensions.
+ */
+static void create_test_tree(const fs::path &root) {
+  for (const char *name : { "light_10.fit", "light_9.fit", "light_1.FIT",
+      "light_2.fit.gz", "dark_1.fit", "notes.txt", "night2/light_3.fit",
+      "night10/light_1.fit", "night2/deep/light_2.fits", "night2/readme" }) {
+    create_file(root / name);
+  }
+}
+
+static std::vector<std::string> relative_names(
+    const std::vector<fs::path> &filepaths, const fs::path &root) {
+  std::vector<std::string> names;
+
+  for (const auto &filepath : filepaths) {
+    names.push_back(filepath.lexically_relative(root).generic_string());
+  }
+  return names;
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(file_matcher_glob_test)
+{
+  auto light_matcher = FileMatcher::glob("light_*.fit*");
+
+  BOOST_TEST(light_matcher("light_001.fit"));
+  BOOST_TEST(light_matcher("LIGHT_1.FIT.GZ"));
+  BOOST_TEST(!light_matcher("dark_001.fit"));
+  BOOST_TEST(!light_matcher("light_001.tif"));
+
+  BOOST_TEST(!FileMatcher::glob("light_*.fit", true /*case_sensitive*/)("LIGHT_1.fit"));
+
+  auto set_matcher = FileMatcher::glob("frame_[0-4]?.[!t]*");
+
+  BOOST_TEST(set_matcher("frame_07.fit"));
+  BOOST_TEST(!set_matcher("frame_57.fit"));
+  BOOST_TEST(!set_matcher("frame_07.tif"));
+  BOOST_TEST(!set_matcher("frame_7.fit"));
+
+  // Escaped and unterminated special characters are literals
+  BOOST_TEST(FileMatcher::glob("a\\*b")("a*b"));
+  BOOST_TEST(!FileMatcher::glob("a\\*b")("axb"));
+  BOOST_TEST(FileMatcher::glob("a[b")("a[b"));
+
+  // Many stars must not backtrack exponentially
+  BOOST_TEST(!FileMatcher::glob("*a*a*a*a*a*a*a*a*b")(std::string(200, 'a')));
+
+  BOOST_TEST(FileMatcher()("anything"));
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(file_matcher_extensions_test)
+{
+  auto matcher = FileMatcher::extensions( { ".fit", "fits", ".fit.gz" });
+
+  BOOST_TEST(matcher("a.fit"));
+  BOOST_TEST(matcher("a.FITS"));
+  BOOST_TEST(matcher("a.Fit.gz"));
+  BOOST_TEST(!matcher("a.gz"));
+  BOOST_TEST(!matcher("a.fit.bak"));
+  BOOST_TEST(!matcher(".fit"));
+
+  // The key does not depend on the order of the extensions
+  BOOST_TEST(matcher.key()
+      == FileMatcher::extensions( { ".FIT.GZ", ".fit", ".fits" }).key());
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(natural_order_test)
+{
+  std::vector<std::string> names { "light_10.fit", "light_9.fit",
+      "Light_2.fit", "light_010.fit", "light_1.fit", "light.fit" };
+
+  std::sort(names.begin(), names.end(), natural_less);
+
+  const std::vector<std::string> expected_names { "light.fit", "light_1.fit",
+      "Light_2.fit", "light_9.fit", "light_010.fit", "light_10.fit" };
+
+  BOOST_TEST(names == expected_names, boost::test_tools::per_element());
+
+  // Directory contents are kept together
+  BOOST_TEST(natural_less("night/b.fit", "night.fit"));
+  BOOST_TEST(natural_less("night2/z.fit", "night10/a.fit"));
+}
+
+/**
+ * The result is the same for any number of threads.
+ */
+BOOST_AUTO_TEST_CASE(scan_files_recursive_test)
+{
+  TempDir temp_dir;
+  create_test_tree(temp_dir.path());
+
+  auto matcher = FileMatcher::extensions( { ".fit", ".fits", ".fit.gz" });
+
+  const std::vector<std::string> expected_names { "dark_1.fit", "light_1.FIT",
+      "light_2.fit.gz", "light_9.fit", "light_10.fit", "night2/deep/light_2.fits",
+      "night2/light_3.fit", "night10/light_1.fit" };
+
+  for (size_t num_threads : { 1, 2, 8 }) {
+    ScanOptions options;
+    options.num_threads = num_threads;
+
+    auto names = relative_names(scan_files(temp_dir.path(), matcher, options),
+                                temp_dir.path());
+
+    BOOST_TEST(names == expected_names, boost::test_tools::per_element());
+  }
+
+  ScanOptions non_recursive_options;
+  non_recursive_options.recursive = false;
+
+  auto names = relative_names(
+      scan_files(temp_dir.path(), FileMatcher::glob("light_*"),
+                 non_recursive_options),
+      temp_dir.path());
+
+  const std::vector<std::string> expected_top_level_names { "light_1.FIT",
+      "light_2.fit.gz", "light_9.fit", "light_10.fit" };
+
+  BOOST_TEST(names == expected_top_level_names, boost::test_tools::per_element());
+
+  BOOST_CHECK_THROW((void ) scan_files(temp_dir.path() / "does_not_exist"),
+                    FileScannerException);
+}
+
+/**
+ * The cached listing is used until a scanned directory changes.
+ */
+BOOST_AUTO_TEST_CASE(scan_files_cache_test)
+{
+  TempDir temp_dir;
+  const fs::path root = temp_dir.path() / "archive";
+  create_test_tree(root);
+  age_directories(root);
+
+  ScanOptions options;
+  options.cache_file = temp_dir.path() / "archive.files";
+
+  auto matcher = FileMatcher::glob("*.fit");
+  auto filepaths = scan_files(root, matcher, options);
+
+  BOOST_TEST(fs::is_regular_file(options.cache_file));
+  BOOST_TEST(scan_files(root, matcher, options) == filepaths,
+             boost::test_tools::per_element());
+
+  // Proof that the cache is read: A file created without changing the
+  // modification time of its directory is not listed.
+  auto night10_mtime = fs::last_write_time(root / "night10");
+  create_file(root / "night10" / "light_2.fit");
+  fs::last_write_time(root / "night10", night10_mtime);
+
+  BOOST_TEST(scan_files(root, matcher, options).size() == filepaths.size());
+
+  // A modified directory invalidates the cache
+  fs::last_write_time(root / "night10",
+                      night10_mtime + std::chrono::seconds(10));
+
+  auto updated_filepaths = scan_files(root, FileMatcher::glob("*.fit"), options);
+
+  BOOST_TEST(updated_filepaths.size() == filepaths.size() + 1);
+  BOOST_TEST(
+      (std::find(updated_filepaths.begin(), updated_filepaths.end(),
+                 root / "night10" / "light_2.fit") != updated_filepaths.end()));
+
+  // A different matcher does not use the cached listing
+  BOOST_TEST(scan_files(root, FileMatcher::glob("*.txt"), options).size() == 1);
+
+  // The cache file must be outside of the scanned tree
+  ScanOptions inside_options;
+  inside_options.cache_file = root / "night2" / "archive.files";
+
+  BOOST_CHECK_THROW((void ) scan_files(root, matcher, inside_options),
+                    FileScannerException);
+}
+
+/**
+ * With follow_symlinks, a link to a parent directory does not lead to an
+ * endless scan and a directory reached through a link is listed once.
+ */
+BOOST_AUTO_TEST_CASE(scan_files_symlink_cycle_test)
+{
+  TempDir temp_dir;
+  create_test_tree(temp_dir.path());
+
+  fs::create_directory_symlink(temp_dir.path(),
+                               temp_dir.path() / "night2" / "deep" / "root");
+  fs::create_directory_symlink(temp_dir.path() / "night2",
+                               temp_dir.path() / "night2_link");
+
+  auto matcher = FileMatcher::extensions( { ".fit", ".fits" });
+
+  const std::vector<std::string> expected_names { "dark_1.fit", "light_1.FIT",
+      "light_9.fit", "light_10.fit", "night2/deep/light_2.fits",
+      "night2/light_3.fit", "night10/light_1.fit" };
+
+  for (size_t num_threads : { 1, 4 }) {
+    ScanOptions options;
+    options.follow_symlinks = true;
+    options.num_threads = num_threads;
+
+    auto names = relative_names(scan_files(temp_dir.path(), matcher, options),
+                                temp_dir.path());
+
+    BOOST_TEST(names == expected_names, boost::test_tools::per_element());
+  }
+
+  // Without follow_symlinks, the links are not listed at all
+  auto names = relative_names(scan_files(temp_dir.path(), matcher),
+                              temp_dir.path());
+
+  BOOST_TEST(names == expected_names, boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,98 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_IO_FILENAME_SEQUENCER_HPP_
+#define STARMATHPP_IO_FILENAME_SEQUENCER_HPP_ STARMATHPP_IO_FILENAME_SEQUENCER_HPP_
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <utility>
+
+#include <libstarmathpp/exception.hpp>
+
+namespace starmathpp::io {
+
+DEF_Exception(FilenameSequencer);
+
+/**
+ * Composes numbered filenames from a printf-style pattern like
+ * "img_%03d.fit". Each call of next() returns the filename with the next
+ * index. The index is incremented atomically. Therefore, next() may be
+ * called concurrently and each index is used exactly once.
+ *
+ * NOTE: With C++20, the filename can be easily composed like:
+ * std::string filename = std::format(imageFilenamePattern, counter++);
+ * The template looks slightly different: "img_{:03}.fit"
+ * See https://stackoverflow.com/questions/2342162/stdstring-formatting-like-sprintf
+ */
+class FilenameSequencer {
+ public:
+  explicit FilenameSequencer(std::string pattern, unsigned int first_index = 0)
+      :
+      pattern_(std::move(pattern)),
+      next_index_(first_index) {
+  }
+
+  FilenameSequencer(const FilenameSequencer&) = delete;
+  FilenameSequencer& operator=(const FilenameSequencer&) = delete;
+
+  /**
+   * Returns the filename for the next index.
+   */
+  std::string next() {
+    return compose(next_index_.fetch_add(1));
+  }
+
+  /**
+   * Returns the filename for the given index. The length of the filename
+   * is not limited.
+   */
+  [[nodiscard]] std::string compose(unsigned int index) const {
+    int length = std::snprintf(nullptr, 0, pattern_.c_str(), index);
+
+    if (length < 0) {
+      throw FilenameSequencerException(
+          "Invalid filename pattern '" + pattern_ + "'.");
+    }
+
+    std::string filename((size_t) length, '\0');
+    std::snprintf(filename.data(), filename.size() + 1, pattern_.c_str(), index);
+
+    return filename;
+  }
+
+  [[nodiscard]] const std::string& pattern() const {
+    return pattern_;
+  }
+
+ private:
+  std::string pattern_;
+  std::atomic<unsigned int> next_index_;
+};
+
+}  // namespace starmathpp::io
+
+#endif // STARMATHPP_IO_FILENAME_SEQUENCER_HPP_
@@ -0,0 +1,118 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "filename sequencer unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/io/filename_sequencer.hpp>
+
+BOOST_AUTO_TEST_SUITE (filename_sequencer_tests)
+
+using namespace starmathpp::io;
+
+/**
+ * Test that the filenames are numbered consecutively.
+ */
+BOOST_AUTO_TEST_CASE(filename_sequencer_next_test)
+{
+  FilenameSequencer sequencer("img_%03d.fit");
+
+  BOOST_TEST(sequencer.next() == "img_000.fit");
+  BOOST_TEST(sequencer.next() == "img_001.fit");
+  BOOST_TEST(sequencer.next() == "img_002.fit");
+}
+
+/**
+ * Test that each sequencer has its own counter.
+ */
+BOOST_AUTO_TEST_CASE(filename_sequencer_independent_counters_test)
+{
+  FilenameSequencer sequencer_1("a_%d.fit");
+  FilenameSequencer sequencer_2("b_%d.fit", 10);
+
+  sequencer_1.next();
+
+  BOOST_TEST(sequencer_1.next() == "a_1.fit");
+  BOOST_TEST(sequencer_2.next() == "b_10.fit");
+}
+
+/**
+ * Test that filenames are not truncated.
+ */
+BOOST_AUTO_TEST_CASE(filename_sequencer_long_filename_test)
+{
+  std::string prefix(300, 'x');
+  FilenameSequencer sequencer(prefix + "_%05d.fit");
+
+  BOOST_TEST(sequencer.next() == prefix + "_00000.fit");
+}
+
+/**
+ * Test that each index is used exactly once if next() is called
+ * concurrently.
+ */
+BOOST_AUTO_TEST_CASE(filename_sequencer_concurrent_test)
+{
+  const size_t num_threads = 8;
+  const size_t num_filenames_per_thread = 1000;
+
+  FilenameSequencer sequencer("img_%05d.fit");
+  std::vector<std::vector<std::string>> filenames(num_threads);
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < num_filenames_per_thread; ++i) {
+        filenames[t].push_back(sequencer.next());
+      }
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::set<std::string> unique_filenames;
+
+  for (const auto &thread_filenames : filenames) {
+    unique_filenames.insert(thread_filenames.begin(), thread_filenames.end());
+  }
+
+  BOOST_TEST(unique_filenames.size() == num_threads * num_filenames_per_thread);
+  BOOST_TEST(*unique_filenames.begin() == "img_00000.fit");
+  BOOST_TEST(*unique_filenames.rbegin() == "img_07999.fit");
+}
+
+BOOST_AUTO_TEST_SUITE_END();
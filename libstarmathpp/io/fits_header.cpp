@@ -0,0 +1,270 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+
+#include <boost/algorithm/string.hpp>
+
+#include <libstarmathpp/io/cimg_fits_io.hpp>
+#include <libstarmathpp/io/fits_header.hpp>
+
+namespace starmathpp::io::fits {
+
+namespace detail {
+
+/**
+ * Copy of the string without trailing blanks.
+ */
+std::string trim_right(const std::string &str) {
+  return str.substr(0, str.find_last_not_of(' ') + 1);
+}
+
+/**
+ * Value of a "KEYWORD = value / comment" card without the comment. The
+ * quotes of a string value are removed ('' is an escaped quote).
+ */
+std::string card_value(const char *card) {
+  std::string field(card + 10, FitsHeader::CARD_SIZE - 10);
+  size_t begin = field.find_first_not_of(' ');
+
+  if (begin == std::string::npos) {
+    return "";
+  }
+
+  if (field[begin] != '\'') {
+    return trim_right(field.substr(begin, field.find('/', begin) - begin));
+  }
+
+  std::string value;
+
+  for (size_t i = begin + 1; i < field.size(); ++i) {
+    if (field[i] == '\'') {
+      if (i + 1 < field.size() && field[i + 1] == '\'') {
+        value += '\'';
+        ++i;
+      } else {
+        break;
+      }
+    } else {
+      value += field[i];
+    }
+  }
+
+  // NOTE: Trailing blanks of a string value are not significant.
+  return trim_right(value);
+}
+
+/**
+ * Source of consecutive header blocks. Returns false at the end of the file.
+ */
+using ReadBlockFunc = std::function<bool(char *block)>;
+
+/**
+ * Read the header of one HDU. Returns false if the end of the file is
+ * reached before the END card.
+ */
+bool read_hdu_header(const ReadBlockFunc &read_block, FitsHeader *header) {
+  char block[FitsHeader::BLOCK_SIZE];
+
+  while (read_block(block)) {
+    for (size_t offset = 0; offset < FitsHeader::BLOCK_SIZE; offset +=
+        FitsHeader::CARD_SIZE) {
+      if (!header->add_card(block + offset)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * Header of the image stored in a tile-compressed extension. The structural
+ * keywords of the extension (BITPIX, NAXISn, ...) describe the binary table
+ * which holds the compressed tiles. They are replaced by the ones of the
+ * image (ZBITPIX, ZNAXISn) and the other table keywords are dropped.
+ */
+FitsHeader compressed_image_header(const FitsHeader &extension_header) {
+  static const std::string TABLE_KEYWORDS[] = { "XTENSION", "BITPIX", "NAXIS",
+      "PCOUNT", "GCOUNT", "TFIELDS", "THEAP" };
+
+  // Keywords followed by an axis or column number, e.g. NAXIS1 or TFORM1
+  static const std::string INDEXED_TABLE_KEYWORDS[] = { "NAXIS", "TTYPE",
+      "TFORM", "TUNIT", "TDIM", "TSCAL", "TZERO", "TNULL" };
+
+  auto is_indexed = [](const std::string &keyword, const std::string &prefix) {
+    return keyword.size() > prefix.size()
+        && keyword.compare(0, prefix.size(), prefix) == 0
+        && std::all_of(keyword.begin() + (long) prefix.size(), keyword.end(),
+                       [](char c) {
+                         return std::isdigit(static_cast<unsigned char>(c)) != 0;
+                       });
+  };
+
+  auto is_table_keyword = [&](const std::string &keyword) {
+    return std::find(std::begin(TABLE_KEYWORDS), std::end(TABLE_KEYWORDS),
+                     keyword) != std::end(TABLE_KEYWORDS)
+        || std::any_of(std::begin(INDEXED_TABLE_KEYWORDS),
+                       std::end(INDEXED_TABLE_KEYWORDS),
+                       [&](const std::string &prefix) {
+                         return is_indexed(keyword, prefix);
+                       });
+  };
+
+  FitsHeader image_header;
+
+  for (const auto& [keyword, value] : extension_header.keywords()) {
+    if (!is_table_keyword(keyword)) {
+      image_header.set(keyword, value);
+    }
+  }
+
+  // NOTE: ZBITPIX, ZNAXIS and ZNAXISn hold the keywords of the image.
+  for (const auto& [keyword, value] : extension_header.keywords()) {
+    if (keyword == "ZBITPIX" || keyword == "ZNAXIS" || is_indexed(keyword, "ZNAXIS")) {
+      image_header.set(keyword.substr(1), value);
+    }
+  }
+
+  return image_header;
+}
+
+FitsHeader read_header_internal(const std::string &filename,
+                                const ReadBlockFunc &read_block) {
+  FitsHeader header;
+
+  if (!read_hdu_header(read_block, &header) || !header.contains("SIMPLE")) {
+    throw FitsHeaderException(
+        "'" + filename + "' is not a FITS file or the header is incomplete.");
+  }
+
+  // NOTE: A primary HDU without image has no data unit. Hence, the header
+  //       of the first extension follows immediately.
+  if (header.contains("NAXIS") && header.number("NAXIS") == 0) {
+    FitsHeader extension_header;
+
+    if (read_hdu_header(read_block, &extension_header)
+        && extension_header.contains("ZIMAGE")
+        && extension_header.value("ZIMAGE") == "T") {
+      header.merge(compressed_image_header(extension_header));
+    }
+  }
+
+  return header;
+}
+
+}  // namespace detail
+
+bool FitsHeader::add_card(const char *card) {
+  std::string keyword = detail::trim_right(std::string(card, 8));
+
+  if (keyword == "END") {
+    return false;
+  }
+
+  // NOTE: Only cards with "= " in column 9 and 10 have a value.
+  if (!keyword.empty() && card[8] == '=' && card[9] == ' ') {
+    keywords_[keyword] = detail::card_value(card);
+  }
+  return true;
+}
+
+void FitsHeader::set(const std::string &keyword, const std::string &value) {
+  keywords_[boost::algorithm::to_upper_copy(keyword)] = value;
+}
+
+void FitsHeader::merge(const FitsHeader &other) {
+  for (const auto& [keyword, value] : other.keywords_) {
+    keywords_[keyword] = value;
+  }
+}
+
+bool FitsHeader::contains(const std::string &keyword) const {
+  return keywords_.count(boost::algorithm::to_upper_copy(keyword)) > 0;
+}
+
+const std::string& FitsHeader::value(const std::string &keyword) const {
+  auto it = keywords_.find(boost::algorithm::to_upper_copy(keyword));
+
+  if (it == keywords_.end()) {
+    throw FitsHeaderException("Header keyword " + keyword + " not found.");
+  }
+  return it->second;
+}
+
+double FitsHeader::number(const std::string &keyword) const {
+  std::string str = value(keyword);
+
+  // FITS allows 'D' as exponent character.
+  std::replace(str.begin(), str.end(), 'D', 'E');
+
+  char *end = nullptr;
+  double number = std::strtod(str.c_str(), &end);
+
+  if (str.empty() || end != str.c_str() + str.size()) {
+    throw FitsHeaderException(
+        "Value '" + value(keyword) + "' of header keyword " + keyword
+            + " is not a number.");
+  }
+  return number;
+}
+
+FitsHeader read_header(const std::string &filename) {
+
+  if (is_fits_gz(boost::algorithm::to_lower_copy(filename))) {
+    std::unique_ptr<gzFile_s, decltype(&gzclose)> file(
+        gzopen(filename.c_str(), "rb"), &gzclose);
+
+    if (!file) {
+      throw FitsHeaderException("Unable to open '" + filename + "'.");
+    }
+
+    // NOTE: The header is inflated block by block. The inflation stops at
+    //       the end of the header.
+    return detail::read_header_internal(filename, [&file](char *block) {
+      return gzread(file.get(), block, FitsHeader::BLOCK_SIZE)
+          == (int) FitsHeader::BLOCK_SIZE;
+    });
+  }
+
+  std::ifstream file(filename, std::ios::binary);
+
+  if (!file) {
+    throw FitsHeaderException("Unable to open '" + filename + "'.");
+  }
+
+  return detail::read_header_internal(filename, [&file](char *block) {
+    return static_cast<bool>(file.read(block, FitsHeader::BLOCK_SIZE));
+  });
+}
+
+}  // namespace starmathpp::io::fits
@@ -0,0 +1,105 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_IO_FITS_HEADER_HPP_
+#define STARMATHPP_IO_FITS_HEADER_HPP_ STARMATHPP_IO_FITS_HEADER_HPP_
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+#include <libstarmathpp/exception.hpp>
+
+namespace starmathpp::io::fits {
+
+DEF_Exception(FitsHeader);
+
+/**
+ * Keywords and values of a FITS header.
+ *
+ * String values are stored without quotes and trailing blanks. All other
+ * values (numbers, logical values T / F) are stored as they appear in
+ * the card. Cards without a value (COMMENT, HISTORY, ...) are ignored.
+ * Keywords are looked up case-insensitively.
+ */
+class FitsHeader {
+ public:
+  static constexpr size_t CARD_SIZE = 80;
+  static constexpr size_t BLOCK_SIZE = 2880;
+
+  /**
+   * Add the keyword and the value of the 80 character header card.
+   * Returns false if the card is the END card.
+   */
+  bool add_card(const char *card);
+
+  void set(const std::string &keyword, const std::string &value);
+
+  /**
+   * Add all keywords of the other header. Existing values are replaced.
+   */
+  void merge(const FitsHeader &other);
+
+  [[nodiscard]] bool contains(const std::string &keyword) const;
+
+  /**
+   * Throws FitsHeaderException if the keyword does not exist.
+   */
+  [[nodiscard]] const std::string& value(const std::string &keyword) const;
+
+  /**
+   * Throws FitsHeaderException if the keyword does not exist or if the
+   * value is not a number.
+   */
+  [[nodiscard]] double number(const std::string &keyword) const;
+
+  [[nodiscard]] const std::map<std::string, std::string>& keywords() const {
+    return keywords_;
+  }
+
+ private:
+  std::map<std::string, std::string> keywords_;
+};
+
+/**
+ * Read the header of the primary HDU without reading the pixels. If the
+ * primary HDU contains no image (e.g. a tile-compressed file), the header
+ * of the following compressed image extension is merged into the result.
+ * In that case, BITPIX and NAXISn describe the compressed image (taken from
+ * ZBITPIX and ZNAXISn), not the binary table which stores it.
+ *
+ * Only the header blocks are read. A gzip-compressed file (.fit.gz) is
+ * only inflated up to the end of the header. Hence, classifying thousands
+ * of files (e.g. lights / darks by IMAGETYP) costs a few kilobytes of I/O
+ * per file.
+ *
+ * Throws FitsHeaderException if the file cannot be read or is no FITS
+ * file.
+ */
+FitsHeader read_header(const std::string &filename);
+
+}  // namespace starmathpp::io::fits
+
+#endif // STARMATHPP_IO_FITS_HEADER_HPP_
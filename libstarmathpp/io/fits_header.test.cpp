@@ -0,0 +1,264 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "fits header unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/data/test_case.hpp>
+
+#include <libstarmathpp/io/cimg_fits_io.hpp>
+#include <libstarmathpp/io/fits_header.hpp>
+
+BOOST_AUTO_TEST_SUITE (fits_header_tests)
+
+using namespace starmathpp::io::fits;
+
+namespace bdata = boost::unit_test::data;
+
+/**
+ * Temporary directory which is removed at the end of the test.
+ */
+class TempDir {
+ public:
+  TempDir()
+      :
+      path_(
+          std::filesystem::temp_directory_path()
+              / std::filesystem::path("fits_header_test")) {
+    std::filesystem::remove_all(path_);
+    std::filesystem::create_directories(path_);
+  }
+
+  ~TempDir() {
+    std::filesystem::remove_all(path_);
+  }
+
+  [[nodiscard]] const std::filesystem::path& path() const {
+    return path_;
+  }
+
+ private:
+  std::filesystem::path path_;
+};
+
+/**
+ * Header card padded to 80 characters.
+ */
+static std::string card(const std::string &text) {
+  return text + std::string(80 - text.size(), ' ');
+}
+
+/**
+ * Write the header cards padded to a complete header block.
+ */
+static void write_header(const std::filesystem::path &filepath,
+                         std::string header) {
+  header.resize((header.size() / 2880 + 1) * 2880, ' ');
+
+  std::ofstream file(filepath, std::ios::binary);
+  file.write(header.data(), header.size());
+}
+
+/**
+ * The header of uncompressed and gzip-compressed files.
+ */
+BOOST_DATA_TEST_CASE(fits_header_read_test,
+    bdata::make(
+        std::vector<std::string> {
+          "test_data/image_reader/test_image_fits_496x380.fit",
+          "test_data/image_reader/test_image_fits_496x380.fit.gz",
+          "test_data/image_reader/test_image_fits_496x380.FITS.GZ"
+        }),
+    image_filename)
+{
+  FitsHeader header = read_header(image_filename);
+
+  BOOST_TEST(header.number("BITPIX") == 16);
+  BOOST_TEST(header.number("NAXIS1") == 496);
+  BOOST_TEST(header.number("NAXIS2") == 380);
+  BOOST_TEST(header.number("EXPTIME") == 600.001);
+  BOOST_TEST(header.number("CCD-TEMP") == -15.0);
+  BOOST_TEST(header.value("INSTRUME") == "ATIK-383L: fw rev 3.27");
+  BOOST_TEST(header.value("filter") == "Position 5");
+  BOOST_TEST(header.value("SIMPLE") == "T");
+  BOOST_TEST(!header.contains("IMAGETYP"));
+}
+
+/**
+ * Only the header of a gzip-compressed file is inflated. A file which is
+ * truncated after the header can still be scanned.
+ */
+BOOST_AUTO_TEST_CASE(fits_header_partial_inflation_test)
+{
+  TempDir temp_dir;
+  auto filepath = temp_dir.path() / "truncated.fit.gz";
+
+  std::ifstream input("test_data/image_reader/test_image_fits_496x380.fit.gz",
+                      std::ios::binary);
+  std::vector<char> data((std::istreambuf_iterator<char>(input)),
+                         std::istreambuf_iterator<char>());
+
+  std::ofstream(filepath, std::ios::binary).write(data.data(), 1000);
+
+  FitsHeader header = read_header(filepath.string());
+
+  BOOST_TEST(header.number("NAXIS1") == 496);
+  BOOST_TEST(header.value("FILTER") == "Position 5");
+}
+
+/**
+ * String values, comments and cards without value.
+ */
+BOOST_AUTO_TEST_CASE(fits_header_card_test)
+{
+  TempDir temp_dir;
+  auto filepath = temp_dir.path() / "header.fits";
+
+  write_header(
+      filepath,
+      card("SIMPLE  =                    T / conforms to FITS standard")
+          + card("BITPIX  =                  -32")
+          + card("NAXIS   =                    0")
+          + card("IMAGETYP= 'Dark Frame'         / type of image")
+          + card("OBJECT  = 'O''Brien / test'")
+          + card("GAIN    =              1.5D+02")
+          + card("EMPTY   = ''")
+          + card("COMMENT   IMAGETYP = 'Light Frame'")
+          + card("HISTORY processed") + card("END"));
+
+  FitsHeader header = read_header(filepath.string());
+
+  BOOST_TEST(header.value("IMAGETYP") == "Dark Frame");
+  BOOST_TEST(header.value("OBJECT") == "O'Brien / test");
+  BOOST_TEST(header.number("GAIN") == 150.0);
+  BOOST_TEST(header.value("EMPTY") == "");
+  BOOST_TEST(!header.contains("COMMENT"));
+  BOOST_TEST(!header.contains("HISTORY"));
+
+  BOOST_CHECK_THROW((void) header.number("IMAGETYP"), FitsHeaderException);
+  BOOST_CHECK_THROW((void) header.value("EXPTIME"), FitsHeaderException);
+}
+
+/**
+ * The keywords of a tile-compressed image are read from the extension
+ * following the empty primary HDU.
+ */
+BOOST_AUTO_TEST_CASE(fits_header_compressed_image_test)
+{
+  TempDir temp_dir;
+  auto filepath = temp_dir.path() / "compressed.fits";
+
+  std::string primary_header = card("SIMPLE  =                    T")
+      + card("BITPIX  =                   16") + card("NAXIS   =                    0")
+      + card("EXTEND  =                    T") + card("END");
+  primary_header.resize(2880, ' ');
+
+  write_header(
+      filepath,
+      primary_header + card("XTENSION= 'BINTABLE'")
+          + card("BITPIX  =                    8")
+          + card("NAXIS   =                    2")
+          + card("NAXIS1  =                    8")
+          + card("NAXIS2  =                  480")
+          + card("TFIELDS =                    1")
+          + card("TTYPE1  = 'COMPRESSED_DATA'")
+          + card("ZIMAGE  =                    T")
+          + card("ZBITPIX =                   16")
+          + card("ZNAXIS  =                    2")
+          + card("ZNAXIS1 =                  640")
+          + card("ZNAXIS2 =                  480")
+          + card("IMAGETYP= 'Flat Field'") + card("END"));
+
+  FitsHeader header = read_header(filepath.string());
+
+  BOOST_TEST(header.number("ZNAXIS1") == 640);
+  BOOST_TEST(header.value("IMAGETYP") == "Flat Field");
+
+  // The structural keywords describe the image, not the binary table
+  BOOST_TEST(header.number("BITPIX") == 16);
+  BOOST_TEST(header.number("NAXIS") == 2);
+  BOOST_TEST(header.number("NAXIS1") == 640);
+  BOOST_TEST(header.number("NAXIS2") == 480);
+  BOOST_TEST(!header.contains("TFIELDS"));
+  BOOST_TEST(!header.contains("TTYPE1"));
+  BOOST_TEST(!header.contains("XTENSION"));
+}
+
+/**
+ * Same for a RICE-compressed file written by CFITSIO.
+ */
+BOOST_AUTO_TEST_CASE(fits_header_rice_compressed_file_test)
+{
+  TempDir temp_dir;
+  auto filepath = temp_dir.path() / "rice.fits";
+
+  WriteOptions options;
+  options.compression = Compression::RICE;
+
+  write(cimg_library::CImg<uint16_t>(64, 48, 1, 1, 1000), filepath.string(),
+        true /*override*/, nullptr, options);
+
+  FitsHeader header = read_header(filepath.string());
+
+  BOOST_TEST(header.number("BITPIX") == 16);
+  BOOST_TEST(header.number("NAXIS") == 2);
+  BOOST_TEST(header.number("NAXIS1") == 64);
+  BOOST_TEST(header.number("NAXIS2") == 48);
+  BOOST_TEST(!header.contains("TFIELDS"));
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(fits_header_invalid_file_test)
+{
+  TempDir temp_dir;
+  auto filepath = temp_dir.path() / "no_fits.fits";
+
+  std::ofstream(filepath) << "This is not a FITS file.";
+
+  BOOST_CHECK_THROW(read_header(filepath.string()), FitsHeaderException);
+  BOOST_CHECK_THROW(read_header((temp_dir.path() / "missing.fits").string()),
+                    FitsHeaderException);
+
+  // END card missing
+  auto incomplete_filepath = temp_dir.path() / "incomplete.fits";
+  write_header(incomplete_filepath, card("SIMPLE  =                    T"));
+
+  BOOST_CHECK_THROW(read_header(incomplete_filepath.string()),
+                    FitsHeaderException);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
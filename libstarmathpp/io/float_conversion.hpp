@@ -0,0 +1,206 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_IO_FLOAT_CONVERSION_HPP_
+#define STARMATHPP_IO_FLOAT_CONVERSION_HPP_ STARMATHPP_IO_FLOAT_CONVERSION_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+
+#include <libstarmathpp/enum_helper.hpp>
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/thread_pool.hpp>
+
+namespace starmathpp::io {
+
+/**
+ * Conversion of a float image to 16 bit when it is written.
+ *
+ * NONE       - The float values are stored unchanged (FITS: BITPIX = -32).
+ *              This is lossless and intended for intermediate products
+ *              like master frames.
+ * NORMALIZE  - The range min..max of the image is mapped to 0..65535.
+ * CLIP       - The values are rounded and clipped to 0..65535.
+ * SCALE      - value * scale + offset, rounded and clipped to 0..65535.
+ *
+ * Non-finite values (NaN) are mapped to 0 and ignored by NORMALIZE.
+ */
+struct FloatConversion {
+  enum TypeE {
+    NONE,
+    NORMALIZE,
+    CLIP,
+    SCALE,
+    _Count
+  };
+
+  static const char* asStr(const TypeE &inType) {
+    switch (inType) {
+      case NONE:
+        return "NONE";
+      case NORMALIZE:
+        return "NORMALIZE";
+      case CLIP:
+        return "CLIP";
+      case SCALE:
+        return "SCALE";
+      default:
+        return "<?>";
+    }
+  }
+
+  MAC_AS_TYPE(Type, E, _Count)
+  ;
+};
+
+/**
+ * Conversion of a float image to 16 bit, i.e. the FloatConversion type and
+ * its parameters. It is used by to_uint16() and by io::write() (see
+ * WriteOptions::float_conversion).
+ *
+ * Since the constructor is implicit, a plain FloatConversion type can be
+ * passed wherever options are expected, e.g. to_uint16(img, FloatConversion::CLIP).
+ */
+struct FloatConversionOptions {
+  FloatConversionOptions(FloatConversion::TypeE type = FloatConversion::NORMALIZE,
+                         float scale = 1.0F, float offset = 0.0F)
+      :
+      type(type),
+      scale(scale),
+      offset(offset) {
+  }
+
+  FloatConversion::TypeE type;
+
+  /**
+   * Used by FloatConversion::SCALE: value * scale + offset.
+   */
+  float scale;
+  float offset;
+};
+
+namespace detail {
+
+/**
+ * Minimum and maximum of the finite pixel values. If there is no finite
+ * value, min > max is returned.
+ */
+template<typename ImageType>
+std::pair<float, float> finite_min_max(const cimg_library::CImg<ImageType> &img,
+                                       size_t num_threads) {
+  float min = std::numeric_limits<float>::max();
+  float max = std::numeric_limits<float>::lowest();
+  std::mutex mutex;
+  const ImageType *pixels = img.data();
+
+  for_each_row_chunk(img.size(), static_cast<size_t>(img.width()), [&](size_t begin, size_t end) {
+    float chunk_min = std::numeric_limits<float>::max();
+    float chunk_max = std::numeric_limits<float>::lowest();
+
+    for (size_t idx = begin; idx < end; ++idx) {
+      float value = static_cast<float>(pixels[idx]);
+
+      if (std::isfinite(value)) {
+        chunk_min = std::min(chunk_min, value);
+        chunk_max = std::max(chunk_max, value);
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    min = std::min(min, chunk_min);
+    max = std::max(max, chunk_max);
+  }, num_threads);
+
+  return {min, max};
+}
+
+}  // namespace detail
+
+/**
+ * Convert the image to 16 bit in a single pass (plus a min / max pass for
+ * NORMALIZE). Each pixel is scaled, rounded and clipped and written
+ * straight into the result. The rows are distributed over num_threads
+ * threads.
+ *
+ * NOTE: num_threads defaults to 1 since images are usually written by
+ *       several threads of a pipeline already (e.g. write_behind() or
+ *       parallel_transform()).
+ *
+ * This replaces img.get_normalize(0, 65535).quantize(65536) followed by a
+ * conversion to CImg<uint16_t>, which took four passes over the image and
+ * allocated two temporary float images.
+ *
+ * NONE is not a conversion to 16 bit and is treated like CLIP.
+ */
+template<typename ImageType>
+cimg_library::CImg<uint16_t> to_uint16(
+    const cimg_library::CImg<ImageType> &img,
+    const FloatConversionOptions &conversion = FloatConversionOptions(),
+    size_t num_threads = 1) {
+
+  cimg_library::CImg<uint16_t> uint16_image(img.width(), img.height(),
+                                            img.depth(), img.spectrum());
+
+  if (img.is_empty()) {
+    return uint16_image;
+  }
+
+  float scale = 1.0F;
+  float offset = 0.0F;
+
+  if (conversion.type == FloatConversion::NORMALIZE) {
+    auto [min, max] = detail::finite_min_max(img, num_threads);
+
+    // NOTE: Like CImg::normalize(), a constant image becomes 0.
+    scale = (max > min ? 65535.0F / (max - min) : 0.0F);
+    offset = (max > min ? -min * scale : 0.0F);
+  } else if (conversion.type == FloatConversion::SCALE) {
+    scale = conversion.scale;
+    offset = conversion.offset;
+  }
+
+  const ImageType *src = img.data();
+  uint16_t *dst = uint16_image.data();
+
+  for_each_row_chunk(img.size(), static_cast<size_t>(img.width()), [=](size_t begin, size_t end) {
+    // NOTE: Branch-free loop over contiguous memory which is vectorized
+    //       by the compiler. The comparisons are false for NaN, which
+    //       is therefore mapped to 0.
+    for (size_t idx = begin; idx < end; ++idx) {
+      float value = static_cast<float>(src[idx]) * scale + offset;
+      float clipped = (value > 0.0F ? (value < 65535.0F ? value : 65535.0F) : 0.0F);
+      dst[idx] = static_cast<uint16_t>(clipped + 0.5F);
+    }
+  }, num_threads);
+
+  return uint16_image;
+}
+
+}  // namespace starmathpp::io
+
+#endif // STARMATHPP_IO_FLOAT_CONVERSION_HPP_
@@ -0,0 +1,143 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "float conversion unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/io/float_conversion.hpp>
+
+BOOST_AUTO_TEST_SUITE (float_conversion_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::io;
+
+/**
+ * Image with the given values in one row.
+ */
+static Image make_image(std::initializer_list<float> values) {
+  Image image((int) values.size(), 1, 1, 1, 0);
+  int x = 0;
+
+  for (float value : values) {
+    image(x++, 0) = value;
+  }
+  return image;
+}
+
+/**
+ * The range min..max is mapped to 0..65535. NaN is ignored and becomes 0.
+ */
+BOOST_AUTO_TEST_CASE(float_conversion_normalize_test)
+{
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  auto uint16_image = to_uint16(make_image( { -10.0F, 0.0F, 10.0F, nan }),
+                                FloatConversion::NORMALIZE);
+
+  BOOST_TEST(uint16_image.width() == 4);
+  BOOST_TEST(uint16_image(0, 0) == 0);
+  BOOST_TEST(uint16_image(1, 0) == 32768);
+  BOOST_TEST(uint16_image(2, 0) == 65535);
+  BOOST_TEST(uint16_image(3, 0) == 0);
+
+  // Like CImg::normalize(), a constant image becomes 0.
+  auto constant_image = to_uint16(Image(3, 3, 1, 1, 42.0F));
+  BOOST_TEST(constant_image(1, 1) == 0);
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(float_conversion_clip_test)
+{
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  auto uint16_image = to_uint16(
+      make_image( { -5.0F, 1.4F, 1.6F, 65534.7F, 70000.0F, nan }),
+      FloatConversion::CLIP);
+
+  BOOST_TEST(uint16_image(0, 0) == 0);
+  BOOST_TEST(uint16_image(1, 0) == 1);
+  BOOST_TEST(uint16_image(2, 0) == 2);
+  BOOST_TEST(uint16_image(3, 0) == 65535);
+  BOOST_TEST(uint16_image(4, 0) == 65535);
+  BOOST_TEST(uint16_image(5, 0) == 0);
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(float_conversion_scale_test)
+{
+  auto uint16_image = to_uint16(make_image( { 0.0F, 0.25F, 1.0F, -1.0F }),
+                                { FloatConversion::SCALE, 1000.0F, 100.0F });
+
+  BOOST_TEST(uint16_image(0, 0) == 100);
+  BOOST_TEST(uint16_image(1, 0) == 350);
+  BOOST_TEST(uint16_image(2, 0) == 1100);
+  BOOST_TEST(uint16_image(3, 0) == 0);
+}
+
+/**
+ * The result must not depend on the number of threads. All channels are
+ * converted.
+ */
+BOOST_AUTO_TEST_CASE(float_conversion_deterministic_test)
+{
+  Image image(517, 389, 1, 3, 0);
+
+  cimg_forXYC(image, x, y, c)
+  {
+    image(x, y, 0, c) = -300.0F + 0.37F * (float) ((x * 31 + y * 17 + c * 7) % 997);
+  }
+
+  auto expected_image = to_uint16(image, FloatConversion::NORMALIZE, 1);
+
+  BOOST_TEST(expected_image.spectrum() == 3);
+
+  for (size_t num_threads : { 2, 3, 8 }) {
+    auto uint16_image = to_uint16(image, FloatConversion::NORMALIZE,
+                                  num_threads);
+
+    BOOST_TEST((uint16_image == expected_image));
+  }
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(float_conversion_empty_test)
+{
+  BOOST_TEST(to_uint16(Image()).is_empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -23,12 +23,17 @@
  *
  ****************************************************************************/
 
+#include <cstdint>
+
+#include <tiffio.h>
+
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 
 #include <libstarmathpp/io/image_reader.hpp>
 
 #include <libstarmathpp/io/cimg_fits_io.hpp>
+#include <libstarmathpp/instrumentation.hpp>
 
 namespace starmathpp::io {
 
@@ -67,24 +72,195 @@ auto read_fits(const std::string &filepath) {
   }
 }
 
+/**
+ *
+ * @param filepath
+ * @return
+ */
+Frame read_fits_frame(const std::string &filepath) {
+
+  std::stringstream debugSs;
+
+  try {
+    // NOTE: Throws FitsIOExceptionT
+    return io::fits::read_frame(filepath, &debugSs);
+
+  } catch (fits::FitsIOException &exc) {
+    std::stringstream ss;
+    ss << "FitsIO exception occurred: " << exc.what();
+    ss << "Details: " << debugSs.str();
+    throw ImageReaderException(ss.str());
+  }
+}
+
+/**
+ *
+ * @param filepath
+ * @param rois
+ * @return
+ */
+std::vector<Image> read_fits_regions(const std::string &filepath,
+                                     const std::vector<Rect<int>> &rois) {
+
+  std::stringstream debugSs;
+
+  try {
+    // NOTE: Throws FitsIOExceptionT
+    return io::fits::read_regions(filepath, rois, &debugSs);
+
+  } catch (fits::FitsIOException &exc) {
+    std::stringstream ss;
+    ss << "FitsIO exception occurred: " << exc.what();
+    ss << "Details: " << debugSs.str();
+    throw ImageReaderException(ss.str());
+  }
+}
+
+/**
+ * Number of pixels of all images.
+ */
+size_t total_num_pixels(const std::vector<Image> &images) {
+  size_t num_pixels = 0;
+
+  for (const auto &image : images) {
+    num_pixels += image.size();
+  }
+  return num_pixels;
+}
+
+/**
+ * Check if the first image of the TIFF file has unsigned integer samples
+ * with at most 16 bits. Only the header is read.
+ */
+bool is_uint16_tiff(const std::string &filepath) {
+  TIFF *tiff = TIFFOpen(filepath.c_str(), "r");
+
+  if (tiff == nullptr) {
+    return false;
+  }
+
+  uint16_t bits_per_sample = 0;
+  uint16_t sample_format = SAMPLEFORMAT_UINT;
+
+  TIFFGetFieldDefaulted(tiff, TIFFTAG_BITSPERSAMPLE, &bits_per_sample);
+  TIFFGetFieldDefaulted(tiff, TIFFTAG_SAMPLEFORMAT, &sample_format);
+  TIFFClose(tiff);
+
+  return (sample_format == SAMPLEFORMAT_UINT && bits_per_sample <= 16);
+}
+
 /**
  *
  */
 Image read(const std::filesystem::path &filepath) {
 
+  STARMATHPP_INSTRUMENT_SCOPE("io::read");
+
   check_filepath(filepath);
 
   const std::string filepath_lower = boost::algorithm::to_lower_copy(
       filepath.string());
 
+  Image image;
+
   // TODO: This code may be moved to a sep. "factory", later.
   if (starmathpp::io::fits::is_fits(filepath_lower)
       || starmathpp::io::fits::is_fits_gz(filepath_lower)) {
 
-    return std::move(read_fits(filepath.string()));
+    image = read_fits(filepath.string());
   } else {
     // TODO: Catch CImg exception and convert to ImageReaderException... -> Unit tests
-    return std::move(Image(filepath.string().c_str()));
+    image = Image(filepath.string().c_str());
+  }
+
+  STARMATHPP_INSTRUMENT_PIXELS(image.size());
+
+  return image;
+}
+
+/**
+ *
+ */
+Frame read_frame(const std::filesystem::path &filepath) {
+
+  STARMATHPP_INSTRUMENT_SCOPE("io::read");
+
+  check_filepath(filepath);
+
+  const std::string filepath_lower = boost::algorithm::to_lower_copy(
+      filepath.string());
+
+  Frame frame;
+
+  if (starmathpp::io::fits::is_fits(filepath_lower)
+      || starmathpp::io::fits::is_fits_gz(filepath_lower)) {
+
+    frame = read_fits_frame(filepath.string());
+  } else if ((boost::algorithm::ends_with(filepath_lower, ".tif")
+      || boost::algorithm::ends_with(filepath_lower, ".tiff"))
+      && is_uint16_tiff(filepath.string())) {
+
+    frame = Image16(filepath.string().c_str());
+  } else {
+    frame = Image(filepath.string().c_str());
+  }
+
+  STARMATHPP_INSTRUMENT_PIXELS(num_pixels(frame));
+
+  return frame;
+}
+/**
+ *
+ */
+Image read(const std::filesystem::path &filepath, const Rect<int> &roi) {
+  return std::move(read(filepath, std::vector<Rect<int>> { roi }).front());
+}
+
+/**
+ *
+ */
+std::vector<Image> read(const std::filesystem::path &filepath,
+                        const std::vector<Rect<int>> &rois) {
+
+  STARMATHPP_INSTRUMENT_SCOPE("io::read");
+
+  check_filepath(filepath);
+
+  const std::string filepath_lower = boost::algorithm::to_lower_copy(
+      filepath.string());
+
+  std::vector<Image> images;
+
+  if (starmathpp::io::fits::is_fits(filepath_lower)
+      || starmathpp::io::fits::is_fits_gz(filepath_lower)) {
+
+    images = read_fits_regions(filepath.string(), rois);
+  } else {
+    Image image(filepath.string().c_str());
+
+    images.reserve(rois.size());
+
+    for (const auto &roi : rois) {
+      int roi_width = static_cast<int>(roi.width());
+      int roi_height = static_cast<int>(roi.height());
+
+      if (roi.x() < 0 || roi.y() < 0 || roi_width < 1 || roi_height < 1
+          || roi.x() + roi_width > image.width()
+          || roi.y() + roi_height > image.height()) {
+        std::stringstream ss;
+        ss << "Region " << roi << " is not inside the image ("
+           << image.width() << " x " << image.height() << ").";
+        throw ImageReaderException(ss.str());
+      }
+
+      images.push_back(
+          image.get_crop(roi.x(), roi.y(), roi.x() + roi_width - 1,
+                         roi.y() + roi_height - 1));
+    }
   }
+
+  STARMATHPP_INSTRUMENT_PIXELS(total_num_pixels(images));
+
+  return images;
 }
 }  // namespace starmathpp
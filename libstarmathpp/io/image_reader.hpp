@@ -27,10 +27,13 @@
 #define STARMATHPP_IMAGE_READER_H STARMATHPP_IMAGE_READER_H
 
 #include <memory>
+#include <vector>
 
 #include <libstarmathpp/io/filesystem_wrapper.hpp>
 #include <libstarmathpp/exception.hpp>
+#include <libstarmathpp/frame.hpp>
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/rect.hpp>
 
 namespace starmathpp::io {
 /**
@@ -45,6 +48,32 @@ DEF_Exception(ImageReader);
  * @return
  */
 Image read(const std::filesystem::path &filepath);
+
+/**
+ * Same as read(), but the pixel type of the returned frame depends on the
+ * file: FITS files with 8 or 16 bit unsigned integer data (BITPIX / BZERO)
+ * and TIFF files with up to 16 bit unsigned integer samples are returned as
+ * Image16. All other files are returned as (float) Image.
+ */
+Frame read_frame(const std::filesystem::path &filepath);
+
+/**
+ * Read the region of interest of the image. The region is given in the
+ * coordinates of the image returned by read(). For FITS files only the
+ * rows (or tiles) which intersect the region are read. All other files
+ * are read completely and cropped.
+ *
+ * Throws ImageReaderException if the region is not inside the image.
+ */
+Image read(const std::filesystem::path &filepath, const Rect<int> &roi);
+
+/**
+ * Same as read(filepath, roi), but for many regions of the same image
+ * (e.g. the windows around known star positions). The file is opened only
+ * once. The images are returned in the order of the regions.
+ */
+std::vector<Image> read(const std::filesystem::path &filepath,
+                        const std::vector<Rect<int>> &rois);
 }  // namespace starmathpp
 
 #endif // STARMATHPP_IMAGE_READER_H
@@ -29,6 +29,9 @@
 #define BOOST_TEST_MAIN
 #define BOOST_TEST_DYN_LINK
 
+#include <thread>
+#include <vector>
+
 #include <boost/test/unit_test.hpp>
 #include <boost/test/data/test_case.hpp>
 
@@ -83,3 +86,120 @@ BOOST_DATA_TEST_CASE(fits_image_reader_test,
   BOOST_TEST(img.height() == image_height);
   BOOST_CHECK_CLOSE(img(pos_x, pos_y), pixel_value, 0.001F);
 }
+
+/**
+ * 16 bit data keeps its pixel type. Floating point data is read as float.
+ */
+BOOST_DATA_TEST_CASE(image_reader_read_frame_test,
+    bdata::make(
+        std::vector<std::string> {
+          "test_data/image_reader/test_image_fits_496x380.fit",
+          "test_data/image_reader/test_image_fits_496x380.fit.gz",
+          "test_data/image_reader/test_image_16bit_100x100.tif",
+          "test_data/image_reader/test_image_32bit_120x120.tif"
+        }) ^
+    bdata::make(
+        // exp. pixel type, pixel x pos, pixel y pos, exp. pixel value
+        std::vector< std::tuple<starmathpp::PixelType::TypeE, int, int, float> > {
+          { starmathpp::PixelType::UINT16, 431, 203, 65535.0F},
+          { starmathpp::PixelType::UINT16, 431, 203, 65535.0F},
+          { starmathpp::PixelType::UINT16, 0, 0, 65535.0F},
+          { starmathpp::PixelType::FLOAT32, 0, 0, 0.5F},
+        }),
+    image_filename, expected_pixel_type, pos_x, pos_y, pixel_value)
+{
+  auto frame = starmathpp::io::read_frame(image_filename);
+  auto img = starmathpp::io::read(image_filename);
+
+  BOOST_TEST(starmathpp::pixel_type(frame) == expected_pixel_type);
+
+  // Same pixels as read()
+  auto promoted_img = starmathpp::to_image(std::move(frame));
+
+  BOOST_TEST(promoted_img.width() == img.width());
+  BOOST_TEST(promoted_img.height() == img.height());
+  BOOST_CHECK_CLOSE(promoted_img(pos_x, pos_y), pixel_value, 0.001F);
+  BOOST_TEST((promoted_img == img));
+}
+
+/**
+ * gzip-compressed files are inflated in per-thread buffers. Reading them
+ * concurrently from several threads must give the same image as reading
+ * the uncompressed file.
+ */
+BOOST_AUTO_TEST_CASE(image_reader_concurrent_gzip_test)
+{
+  const size_t num_threads = 4;
+  const size_t num_reads_per_thread = 3;
+
+  auto expected_img = starmathpp::io::read(
+      "test_data/image_reader/test_image_fits_496x380.fit");
+
+  std::vector<int> num_mismatches(num_threads, 0);
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < num_reads_per_thread; ++i) {
+        auto img = starmathpp::io::read(
+            "test_data/image_reader/test_image_fits_496x380.fit.gz");
+
+        if (!(img == expected_img)) {
+          ++num_mismatches[t];
+        }
+      }
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int num_mismatch : num_mismatches) {
+    BOOST_TEST(num_mismatch == 0);
+  }
+}
+
+/**
+ * A region of interest must contain the same pixels as the region of the
+ * complete image - in particular, the rows must be flipped like by read().
+ */
+BOOST_DATA_TEST_CASE(image_reader_read_roi_test,
+    bdata::make(
+        std::vector<std::string> {
+          "test_data/image_reader/test_image_fits_496x380.fit",
+          "test_data/image_reader/test_image_fits_496x380.fit.gz",
+          "test_data/image_reader/test_image_16bit_100x100.tif"
+        }),
+    image_filename)
+{
+  auto img = starmathpp::io::read(image_filename);
+
+  const std::vector<starmathpp::Rect<int>> rois {
+    starmathpp::Rect<int>(0, 0, 1, 1),
+    starmathpp::Rect<int>(10, 3, 21, 17),
+    starmathpp::Rect<int>(img.width() - 30, img.height() - 7, 30, 7)
+  };
+
+  auto roi_imgs = starmathpp::io::read(image_filename, rois);
+
+  BOOST_TEST(roi_imgs.size() == rois.size());
+
+  for (size_t i = 0; i < rois.size(); ++i) {
+    const auto &roi = rois[i];
+    auto expected_img = img.get_crop(roi.x(), roi.y(),
+                                     roi.x() + (int) roi.width() - 1,
+                                     roi.y() + (int) roi.height() - 1);
+
+    BOOST_TEST((roi_imgs[i] == expected_img));
+  }
+
+  auto roi_img = starmathpp::io::read(image_filename, rois[1]);
+  BOOST_TEST((roi_img == roi_imgs[1]));
+
+  // Region not inside the image
+  BOOST_CHECK_THROW(
+      starmathpp::io::read(image_filename,
+                           starmathpp::Rect<int>(img.width() - 5, 0, 10, 10)),
+      starmathpp::io::ImageReaderException);
+}
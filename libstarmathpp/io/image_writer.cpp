@@ -25,10 +25,12 @@
 
 #include <iostream> // TODO: Remove
 #include <memory>
+#include <type_traits>
 
 #include <libstarmathpp/io/filesystem_wrapper.hpp>
 #include <libstarmathpp/io/image_writer.hpp>
 #include <libstarmathpp/io/cimg_fits_io.hpp>
+#include <libstarmathpp/instrumentation.hpp>
 
 namespace starmathpp::io {
 
@@ -65,14 +67,16 @@ void check_filepath(const std::filesystem::path &filepath, bool override) {
  * @param filepath
  * @param image
  */
+template<typename ImageType>
 void write_fits(const std::string &filepath,
-                const cimg_library::CImg<uint16_t> &img, bool override) {
+                const cimg_library::CImg<ImageType> &img, bool override,
+                const fits::WriteOptions &options) {
 
   std::stringstream debugSs;
 
   try {
     // NOTE: Throws FitsIOException
-    starmathpp::io::fits::write(img, filepath, override, &debugSs);
+    starmathpp::io::fits::write(img, filepath, override, &debugSs, options);
   } catch (starmathpp::io::fits::FitsIOException &exc) {
     std::stringstream ss;
     ss << "Error writing image to '" << filepath
@@ -90,7 +94,10 @@ namespace detail {
  */
 template<typename ImageType>
 void write_internal(const cimg_library::CImg<ImageType> &&img, const std::filesystem::path &filepath,
-                    bool override) {
+                    bool override, const WriteOptions &options) {
+  STARMATHPP_INSTRUMENT_SCOPE("io::write");
+  STARMATHPP_INSTRUMENT_PIXELS(img.size());
+
   check_filepath(filepath, override);
 
   const std::string filepath_lower = boost::algorithm::to_lower_copy(
@@ -98,7 +105,13 @@ void write_internal(const cimg_library::CImg<ImageType> &&img, const std::filesy
 
   if (starmathpp::io::fits::is_fits(filepath_lower)
       || starmathpp::io::fits::is_fits_gz(filepath_lower)) {
-    write_fits(filepath.string(), img, override);
+    if constexpr (std::is_same_v<ImageType, uint8_t>) {
+      // NOTE: The FITS writer supports 16 bit and float images only.
+      write_fits(filepath.string(), cimg_library::CImg<uint16_t>(img),
+                 override, options.fits);
+    } else {
+      write_fits(filepath.string(), img, override, options.fits);
+    }
   } else {
     img.save(filepath.string().c_str());
   }
@@ -110,33 +123,43 @@ void write_internal(const cimg_library::CImg<ImageType> &&img, const std::filesy
  * TODO: Use template specialization here...
  */
 void write(const Image &&img, const std::filesystem::path &filepath,
-           bool override) {
-  // NOTE: Storing a float image as TIFF or FITS image results in an
-  // image which is probably correct, but which has a range from 0..1
-  // and NO program (not even ImageJ) or ImageMagick can display it
-  // correctly. Therefore, the float image is converted to a 16 bit
-  // image before storing it.
-  //
-  cimg_library::CImg<uint16_t> uint16_image = img.get_normalize(0, 65535)
-      .quantize(65536);
-
-  detail::write_internal(std::move(uint16_image), filepath, override);
+           bool override, const WriteOptions &options) {
+  if (options.float_conversion.type == FloatConversion::NONE) {
+    detail::write_internal(std::move(img), filepath, override, options);
+    return;
+  }
+
+  detail::write_internal(
+      to_uint16(img, options.float_conversion, options.num_threads),
+      filepath, override, options);
 }
 
 /**
  *
  */
 void write(const cimg_library::CImg<uint8_t> &&img,
-           const std::filesystem::path &filepath, bool override) {
-  detail::write_internal(std::move(img), filepath, override);
+           const std::filesystem::path &filepath, bool override,
+           const WriteOptions &options) {
+  detail::write_internal(std::move(img), filepath, override, options);
 }
 
 /**
  *
  */
 void write(const cimg_library::CImg<uint16_t> &&img,
-           const std::filesystem::path &filepath, bool override) {
-  detail::write_internal(std::move(img), filepath, override);
+           const std::filesystem::path &filepath, bool override,
+           const WriteOptions &options) {
+  detail::write_internal(std::move(img), filepath, override, options);
+}
+
+/**
+ *
+ */
+void write(Frame &&frame, const std::filesystem::path &filepath,
+           bool override, const WriteOptions &options) {
+  visit_frame([&](auto &&img) {
+    write(std::move(img), filepath, override, options);
+  }, std::move(frame));
 }
 
 }
@@ -26,7 +26,10 @@
 #ifndef STARMATHPP_IMAGE_WRITER_H
 #define STARMATHPP_IMAGE_WRITER_H STARMATHPP_IMAGE_WRITER_H
 
+#include <libstarmathpp/io/cimg_fits_io.hpp>
 #include <libstarmathpp/io/filesystem_wrapper.hpp>
+#include <libstarmathpp/io/float_conversion.hpp>
+#include <libstarmathpp/frame.hpp>
 #include <libstarmathpp/image.hpp>
 #include <libstarmathpp/exception.hpp>
 
@@ -38,17 +41,53 @@ namespace starmathpp::io {
 DEF_Exception(ImageWriter);
 
 /**
- * TODO: Document...
+ * Options of the image writer.
+ */
+struct WriteOptions {
+  /**
+   * By default, a float image is normalized to the range 0..65535 and
+   * stored as 16 bit image (see write()). FloatConversion::NONE stores
+   * the float values unchanged.
+   */
+  FloatConversionOptions float_conversion;
+
+  /**
+   * Number of threads converting a float image to 16 bit (see to_uint16()).
+   */
+  size_t num_threads = 1;
+
+  /**
+   * Tile compression and quantization of FITS files. Ignored for all
+   * other file formats.
+   */
+  fits::WriteOptions fits;
+};
+
+/**
+ * NOTE: Storing a float image as TIFF or FITS image results in an image
+ * which is probably correct, but which has a range from 0..1 and NO
+ * program (not even ImageJ) or ImageMagick can display it correctly.
+ * Therefore, the float image is by default converted to a 16 bit image
+ * before storing it (see WriteOptions::float_conversion).
+ *
  * TODO: Use template specialization for float only...
  */
 void write(const Image &&img, const std::filesystem::path &filepath,
-           bool override = true);
+           bool override = true, const WriteOptions &options = WriteOptions());
 
 void write(const cimg_library::CImg<uint8_t> &&img,
-           const std::filesystem::path &filepath, bool override = true);
+           const std::filesystem::path &filepath, bool override = true,
+           const WriteOptions &options = WriteOptions());
 
 void write(const cimg_library::CImg<uint16_t> &&img,
-           const std::filesystem::path &filepath, bool override = true);
+           const std::filesystem::path &filepath, bool override = true,
+           const WriteOptions &options = WriteOptions());
+
+/**
+ * Write the frame with its pixel type.
+ */
+void write(Frame &&frame, const std::filesystem::path &filepath,
+           bool override = true, const WriteOptions &options = WriteOptions());
 }
 
 #endif // STARMATHPP_IMAGE_WRITER_H
@@ -33,7 +33,9 @@
 #include <boost/test/data/test_case.hpp>
 
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/io/cimg_fits_io.hpp>
 #include <libstarmathpp/io/filesystem_wrapper.hpp>
+#include <libstarmathpp/io/image_reader.hpp>
 #include <libstarmathpp/io/image_writer.hpp>
 
 namespace bdata = boost::unit_test::data;
@@ -60,3 +62,102 @@ BOOST_DATA_TEST_CASE(fits_image_writer_test,
   BOOST_TEST(file_was_written == true);
   BOOST_TEST(fileSize == expected_file_size);
 }
+
+/**
+ * Smooth test image with values outside of the 16 bit range.
+ */
+static starmathpp::Image generate_float_test_image() {
+  starmathpp::Image image(64, 48, 1, 1, 0);
+
+  cimg_forXY(image, x, y)
+  {
+    image(x, y) = -1000.5F + 3.25F * (float) x + 1700.125F * (float) y;
+  }
+  return image;
+}
+
+/**
+ * A float image is stored unchanged with FloatConversion::NONE.
+ */
+BOOST_DATA_TEST_CASE(fits_image_writer_float_test,
+    bdata::make(
+        std::vector<std::tuple<std::string, starmathpp::io::fits::Compression::TypeE>> {
+          { "image_float.fits", starmathpp::io::fits::Compression::NONE },
+          { "image_float_gzip.fits", starmathpp::io::fits::Compression::GZIP }
+        }),
+    image_filename, compression)
+{
+  starmathpp::Image image = generate_float_test_image();
+
+  starmathpp::io::WriteOptions options;
+  options.float_conversion = starmathpp::io::FloatConversion::NONE;
+  options.fits.compression = compression;
+
+  starmathpp::io::write(starmathpp::Image(image), image_filename,
+                        true /*override*/, options);
+
+  starmathpp::Image read_image = starmathpp::io::read(image_filename);
+
+  BOOST_TEST((read_image == image));
+}
+
+/**
+ * Tile-compressed 16 bit images are lossless and smaller than uncompressed
+ * images.
+ */
+BOOST_AUTO_TEST_CASE(fits_image_writer_rice_test)
+{
+  cimg_library::CImg<uint16_t> image(256, 200, 1, 1, 0);
+
+  cimg_forXY(image, x, y)
+  {
+    image(x, y) = (uint16_t) (1000 + x + 3 * y);
+  }
+
+  starmathpp::io::WriteOptions options;
+  options.fits.compression = starmathpp::io::fits::Compression::RICE;
+
+  starmathpp::io::write(cimg_library::CImg<uint16_t>(image),
+                        "image_uint16.fits", true /*override*/);
+  starmathpp::io::write(cimg_library::CImg<uint16_t>(image),
+                        "image_uint16_rice.fits", true /*override*/, options);
+
+  BOOST_TEST(
+      fs::file_size("image_uint16_rice.fits")
+          < fs::file_size("image_uint16.fits"));
+
+  starmathpp::Frame frame = starmathpp::io::read_frame(
+      "image_uint16_rice.fits");
+
+  BOOST_TEST(starmathpp::pixel_type(frame) == starmathpp::PixelType::UINT16);
+  BOOST_TEST((std::get<starmathpp::Image16>(frame) == image));
+}
+
+
+/**
+ * A tile-compressed image which is decompressed by several threads is the
+ * same as the image decompressed by one thread.
+ */
+BOOST_AUTO_TEST_CASE(fits_image_reader_parallel_decompression_test)
+{
+  cimg_library::CImg<uint16_t> image(128, 400, 1, 1, 0);
+
+  cimg_forXY(image, x, y)
+  {
+    image(x, y) = (uint16_t) (100 + 7 * x + y);
+  }
+
+  starmathpp::io::fits::WriteOptions options;
+  options.compression = starmathpp::io::fits::Compression::RICE;
+
+  starmathpp::io::fits::write(image, "image_uint16_parallel_rice.fits",
+                              true /*override*/, nullptr, options);
+
+  starmathpp::Image single_thread_image = starmathpp::io::fits::read(
+      "image_uint16_parallel_rice.fits", nullptr, 1 /*num_threads*/);
+  starmathpp::Image multi_thread_image = starmathpp::io::fits::read(
+      "image_uint16_parallel_rice.fits", nullptr, 4 /*num_threads*/);
+
+  BOOST_TEST((single_thread_image == starmathpp::Image(image)));
+  BOOST_TEST((multi_thread_image == single_thread_image));
+}
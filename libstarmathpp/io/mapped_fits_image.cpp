@@ -0,0 +1,338 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include <libstarmathpp/io/fits_header.hpp>
+#include <libstarmathpp/io/mapped_fits_image.hpp>
+
+namespace starmathpp::io::fits {
+
+namespace detail {
+
+/**
+ * Big-endian FITS sample at the given position converted to double.
+ */
+template<int BITPIX>
+double read_sample(const unsigned char *p) {
+  if constexpr (BITPIX == 8) {
+    return p[0];
+  } else if constexpr (BITPIX == 16) {
+    return static_cast<int16_t>((uint16_t(p[0]) << 8) | uint16_t(p[1]));
+  } else if constexpr (BITPIX == 32 || BITPIX == -32) {
+    uint32_t bits = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16)
+        | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+
+    if constexpr (BITPIX == 32) {
+      return static_cast<int32_t>(bits);
+    } else {
+      float value;
+      std::memcpy(&value, &bits, sizeof(value));
+      return value;
+    }
+  } else {
+    uint64_t bits = 0;
+
+    for (int i = 0; i < 8; ++i) {
+      bits = (bits << 8) | uint64_t(p[i]);
+    }
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+}
+
+template<int BITPIX>
+void decode_samples(const unsigned char *src, float *dst, int num_pixels,
+                    double bzero, double bscale) {
+  constexpr size_t BYTES_PER_PIXEL = std::abs(BITPIX) / 8;
+
+  for (int i = 0; i < num_pixels; ++i, src += BYTES_PER_PIXEL) {
+    dst[i] = static_cast<float>(bzero + bscale * read_sample<BITPIX>(src));
+  }
+}
+
+}  // namespace detail
+
+MappedImage::MappedImage(const std::filesystem::path &filepath)
+    :
+    mapping_(nullptr),
+    mapping_size_(0),
+    width_(0),
+    height_(0),
+    bitpix_(0),
+    bzero_(0.0),
+    bscale_(1.0),
+    data_offset_(0),
+    cached_row_(-1) {
+
+  int fd = ::open(filepath.c_str(), O_RDONLY);
+
+  if (fd < 0) {
+    std::stringstream ss;
+    ss << "Unable to open '" << filepath.string() << "': "
+       << std::strerror(errno);
+    throw MappedImageException(ss.str());
+  }
+
+  struct stat file_stat;
+
+  if (::fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+    ::close(fd);
+    throw MappedImageException(
+        "Unable to determine size of '" + filepath.string() + "'.");
+  }
+
+  mapping_size_ = static_cast<size_t>(file_stat.st_size);
+  void *mapping = ::mmap(nullptr, mapping_size_, PROT_READ, MAP_PRIVATE, fd,
+                         0);
+  ::close(fd);
+
+  if (mapping == MAP_FAILED) {
+    std::stringstream ss;
+    ss << "Unable to map '" << filepath.string() << "': "
+       << std::strerror(errno);
+    throw MappedImageException(ss.str());
+  }
+
+  mapping_ = static_cast<const unsigned char*>(mapping);
+
+  // The header and the rows are usually accessed front to back. This lets
+  // the kernel read ahead (MADV_RANDOM would fault in one page at a time).
+  ::madvise(mapping, mapping_size_, MADV_SEQUENTIAL);
+
+  try {
+    const char *header = reinterpret_cast<const char*>(mapping_);
+
+    if (mapping_size_ < FitsHeader::BLOCK_SIZE
+        || std::strncmp(header, "SIMPLE  =", 9) != 0) {
+      throw MappedImageException(
+          "'" + filepath.string() + "' is not an uncompressed FITS file.");
+    }
+
+    FitsHeader fits_header;
+    size_t offset = 0;
+    bool end_found = false;
+
+    for (; offset + FitsHeader::CARD_SIZE <= mapping_size_; offset +=
+        FitsHeader::CARD_SIZE) {
+      if (!fits_header.add_card(header + offset)) {
+        end_found = true;
+        break;
+      }
+    }
+
+    if (!end_found) {
+      throw MappedImageException(
+          "No END card found in '" + filepath.string() + "'.");
+    }
+
+    int naxis = static_cast<int>(fits_header.number("NAXIS"));
+    bitpix_ = static_cast<int>(fits_header.number("BITPIX"));
+
+    if (naxis >= 2) {
+      width_ = static_cast<int>(fits_header.number("NAXIS1"));
+      height_ = static_cast<int>(fits_header.number("NAXIS2"));
+    }
+    if (fits_header.contains("BZERO")) {
+      bzero_ = fits_header.number("BZERO");
+    }
+    if (fits_header.contains("BSCALE")) {
+      bscale_ = fits_header.number("BSCALE");
+    }
+
+    if (bitpix_ != 8 && bitpix_ != 16 && bitpix_ != 32 && bitpix_ != -32
+        && bitpix_ != -64) {
+      std::stringstream ss;
+      ss << "Unsupported BITPIX " << bitpix_ << " in '" << filepath.string()
+         << "'.";
+      throw MappedImageException(ss.str());
+    }
+
+    if (naxis < 2 || width_ <= 0 || height_ <= 0) {
+      throw MappedImageException(
+          "'" + filepath.string() + "' contains no 2D image.");
+    }
+
+    // The data unit starts at the block following the END card.
+    data_offset_ = (offset / FitsHeader::BLOCK_SIZE + 1)
+        * FitsHeader::BLOCK_SIZE;
+
+    size_t data_size = static_cast<size_t>(width_)
+        * static_cast<size_t>(height_) * (std::abs(bitpix_) / 8);
+
+    if (data_offset_ + data_size > mapping_size_) {
+      throw MappedImageException(
+          "'" + filepath.string() + "' is truncated.");
+    }
+  } catch (const FitsHeaderException &exc) {
+    unmap();
+    throw MappedImageException(
+        "Invalid header in '" + filepath.string() + "': " + exc.what());
+  } catch (...) {
+    unmap();
+    throw;
+  }
+}
+
+MappedImage::~MappedImage() {
+  unmap();
+}
+
+MappedImage::MappedImage(MappedImage &&other) noexcept
+    :
+    mapping_(std::exchange(other.mapping_, nullptr)),
+    mapping_size_(std::exchange(other.mapping_size_, 0)),
+    width_(other.width_),
+    height_(other.height_),
+    bitpix_(other.bitpix_),
+    bzero_(other.bzero_),
+    bscale_(other.bscale_),
+    data_offset_(other.data_offset_),
+    row_buffer_(std::move(other.row_buffer_)),
+    cached_row_(std::exchange(other.cached_row_, -1)) {
+}
+
+MappedImage& MappedImage::operator=(MappedImage &&other) noexcept {
+  if (this != &other) {
+    unmap();
+    mapping_ = std::exchange(other.mapping_, nullptr);
+    mapping_size_ = std::exchange(other.mapping_size_, 0);
+    width_ = other.width_;
+    height_ = other.height_;
+    bitpix_ = other.bitpix_;
+    bzero_ = other.bzero_;
+    bscale_ = other.bscale_;
+    data_offset_ = other.data_offset_;
+    row_buffer_ = std::move(other.row_buffer_);
+    cached_row_ = std::exchange(other.cached_row_, -1);
+  }
+  return *this;
+}
+
+void MappedImage::unmap() {
+  if (mapping_ != nullptr) {
+    ::munmap(const_cast<unsigned char*>(mapping_), mapping_size_);
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+  }
+}
+
+const float* MappedImage::row(int y) const {
+  if (y < 0 || y >= height_) {
+    std::stringstream ss;
+    ss << "Row " << y << " out of range [0, " << height_ << ").";
+    throw MappedImageException(ss.str());
+  }
+
+  if (y != cached_row_) {
+    // NOTE: The buffer is only allocated once. All rows are decoded into it.
+    row_buffer_.resize(width_);
+    decode_row(y, row_buffer_.data());
+    cached_row_ = y;
+  }
+  return row_buffer_.data();
+}
+
+void MappedImage::decode_row(int y, float *dst, int x, int num_pixels) const {
+  if (num_pixels < 0) {
+    num_pixels = width_ - x;
+  }
+
+  if (y < 0 || y >= height_ || x < 0 || x + num_pixels > width_) {
+    std::stringstream ss;
+    ss << "Pixels (" << x << ", " << y << ") + " << num_pixels
+       << " out of image bounds (" << width_ << ", " << height_ << ").";
+    throw MappedImageException(ss.str());
+  }
+
+  // FITS stores the bottom row first.
+  size_t bytes_per_pixel = std::abs(bitpix_) / 8;
+  size_t fits_row = static_cast<size_t>(height_ - 1 - y);
+  const unsigned char *src = mapping_ + data_offset_
+      + (fits_row * width_ + x) * bytes_per_pixel;
+
+  switch (bitpix_) {
+    case 8:
+      detail::decode_samples<8>(src, dst, num_pixels, bzero_, bscale_);
+      break;
+    case 16:
+      detail::decode_samples<16>(src, dst, num_pixels, bzero_, bscale_);
+      break;
+    case 32:
+      detail::decode_samples<32>(src, dst, num_pixels, bzero_, bscale_);
+      break;
+    case -32:
+      detail::decode_samples<-32>(src, dst, num_pixels, bzero_, bscale_);
+      break;
+    default:
+      detail::decode_samples<-64>(src, dst, num_pixels, bzero_, bscale_);
+      break;
+  }
+}
+
+Image MappedImage::crop(const Rect<int> &region) const {
+  int region_width = static_cast<int>(region.width());
+  int region_height = static_cast<int>(region.height());
+
+  if (region.x() < 0 || region.y() < 0 || region_width <= 0
+      || region_height <= 0 || region.x() + region_width > width_
+      || region.y() + region_height > height_) {
+    std::stringstream ss;
+    ss << "Region " << region << " not inside image bounds (" << width_
+       << ", " << height_ << ").";
+    throw MappedImageException(ss.str());
+  }
+
+  Image image(region_width, region_height, 1, 1);
+
+  for (int y = 0; y < region_height; ++y) {
+    decode_row(region.y() + y, image.data(0, y), region.x(), region_width);
+  }
+  return image;
+}
+
+Image MappedImage::to_image() const {
+  return crop(Rect<int>(0, 0, static_cast<unsigned int>(width_),
+                        static_cast<unsigned int>(height_)));
+}
+
+void MappedImage::release_rows() {
+  row_buffer_ = std::vector<float>();
+  cached_row_ = -1;
+}
+
+}  // namespace starmathpp::io::fits
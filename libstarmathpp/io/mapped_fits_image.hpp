@@ -0,0 +1,150 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_IO_MAPPED_FITS_IMAGE_HPP_
+#define STARMATHPP_IO_MAPPED_FITS_IMAGE_HPP_ STARMATHPP_IO_MAPPED_FITS_IMAGE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include <libstarmathpp/exception.hpp>
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/rect.hpp>
+
+namespace starmathpp::io::fits {
+
+DEF_Exception(MappedImage);
+
+/**
+ * Read-only, zero-copy access to the primary image of an uncompressed FITS
+ * file.
+ *
+ * The file is memory-mapped. Only the header is parsed when the image is
+ * opened. The pixels are decoded (byte swap, BZERO / BSCALE and conversion
+ * to float) when a row is accessed for the first time. Rows which are never
+ * touched are never read from disk. Hence, scanning e.g. the statistics or
+ * a few star cutouts of many frames is not limited by allocating and
+ * copying complete frames.
+ *
+ * The rows are counted like in the image returned by read(), i.e. row 0
+ * is the top row.
+ *
+ * Supported are BITPIX 8, 16, 32, -32 and -64. Only the first plane of the
+ * data unit is accessed. Compressed files (e.g. .fit.gz) cannot be mapped.
+ *
+ * NOTE: row() and operator() decode into one row buffer and are not
+ *       thread-safe. decode_row() does not use the buffer and may be
+ *       called concurrently.
+ *
+ * Usage:
+ *
+ * MappedImage image("light_001.fit");
+ *
+ * double sum = 0;
+ * for (int y = 0; y < image.height(); ++y) {
+ *   const float *row = image.row(y);
+ *   ...
+ * }
+ * Image star = image.crop(Rect<int>(100, 200, 21, 21));
+ */
+class MappedImage {
+ public:
+  explicit MappedImage(const std::filesystem::path &filepath);
+  ~MappedImage();
+
+  MappedImage(MappedImage &&other) noexcept;
+  MappedImage& operator=(MappedImage &&other) noexcept;
+
+  MappedImage(const MappedImage&) = delete;
+  MappedImage& operator=(const MappedImage&) = delete;
+
+  [[nodiscard]] int width() const {
+    return width_;
+  }
+
+  [[nodiscard]] int height() const {
+    return height_;
+  }
+
+  [[nodiscard]] int bitpix() const {
+    return bitpix_;
+  }
+
+  /**
+   * Decoded row y. The row is decoded into a buffer which is reused for
+   * all rows, i.e. the pointer stays valid until row() is called for a
+   * different row (or release_rows() is called). Accessing the same row
+   * again does not decode it again.
+   */
+  const float* row(int y) const;
+
+  float operator()(int x, int y) const {
+    return row(y)[x];
+  }
+
+  /**
+   * Decode the pixels [x, x + num_pixels) of row y into dst without
+   * caching them.
+   */
+  void decode_row(int y, float *dst, int x = 0, int num_pixels = -1) const;
+
+  /**
+   * Decode the region. Only the rows and columns of the region are read.
+   * The region must be inside the image.
+   */
+  [[nodiscard]] Image crop(const Rect<int> &region) const;
+
+  /**
+   * Decode the complete image.
+   */
+  [[nodiscard]] Image to_image() const;
+
+  /**
+   * Release the row buffer.
+   */
+  void release_rows();
+
+ private:
+  const unsigned char *mapping_;
+  size_t mapping_size_;
+
+  int width_;
+  int height_;
+  int bitpix_;
+  double bzero_;
+  double bscale_;
+  size_t data_offset_;
+
+  mutable std::vector<float> row_buffer_;
+  mutable int cached_row_;
+
+  void unmap();
+};
+
+}  // namespace starmathpp::io::fits
+
+#endif // STARMATHPP_IO_MAPPED_FITS_IMAGE_HPP_
@@ -0,0 +1,249 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "mapped fits image unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/io/image_reader.hpp>
+#include <libstarmathpp/io/mapped_fits_image.hpp>
+
+BOOST_AUTO_TEST_SUITE (mapped_fits_image_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::io::fits;
+
+/**
+ * Temporary directory which is removed at the end of the test.
+ */
+class TempDir {
+ public:
+  TempDir()
+      :
+      path_(
+          std::filesystem::temp_directory_path()
+              / std::filesystem::path("mapped_fits_image_test")) {
+    std::filesystem::remove_all(path_);
+    std::filesystem::create_directories(path_);
+  }
+
+  ~TempDir() {
+    std::filesystem::remove_all(path_);
+  }
+
+  [[nodiscard]] const std::filesystem::path& path() const {
+    return path_;
+  }
+
+ private:
+  std::filesystem::path path_;
+};
+
+/**
+ * Header card padded to 80 characters.
+ */
+static std::string card(const std::string &text) {
+  return text + std::string(80 - text.size(), ' ');
+}
+
+/**
+ * Write a minimal FITS file. The samples are passed big-endian and
+ * bottom row first as stored in the file.
+ */
+static void write_fits(const std::filesystem::path &filepath, int bitpix,
+                       int width, int height,
+                       const std::vector<unsigned char> &data,
+                       const std::string &extra_cards = "") {
+  std::string header = card("SIMPLE  =                    T")
+      + card("BITPIX  = " + std::to_string(bitpix)) + card("NAXIS   =  2")
+      + card("NAXIS1  = " + std::to_string(width))
+      + card("NAXIS2  = " + std::to_string(height)) + extra_cards
+      + card("END");
+
+  header.resize((header.size() / 2880 + 1) * 2880, ' ');
+
+  std::vector<unsigned char> padded_data(data);
+  padded_data.resize((data.size() / 2880 + 1) * 2880, 0);
+
+  std::ofstream file(filepath, std::ios::binary);
+  file.write(header.data(), header.size());
+  file.write(reinterpret_cast<const char*>(padded_data.data()),
+             padded_data.size());
+}
+
+/**
+ * 16 bit samples with BZERO are decoded to unsigned values and the rows
+ * are flipped.
+ */
+BOOST_AUTO_TEST_CASE(mapped_fits_image_16bit_test)
+{
+  TempDir temp_dir;
+  auto filepath = temp_dir.path() / "image.fit";
+
+  // Bottom row: -32768, -32767, top row: 0, 32767
+  write_fits(filepath, 16, 2, 2, { 0x80, 0x00, 0x80, 0x01, 0x00, 0x00, 0x7F,
+                 0xFF },
+             card("BZERO   =                32768")
+                 + card("BSCALE  =                    1 / scale"));
+
+  MappedImage image(filepath);
+
+  BOOST_TEST(image.width() == 2);
+  BOOST_TEST(image.height() == 2);
+  BOOST_TEST(image.bitpix() == 16);
+
+  BOOST_TEST(image(0, 0) == 32768.0F);
+  BOOST_TEST(image(1, 0) == 65535.0F);
+  BOOST_TEST(image(0, 1) == 0.0F);
+  BOOST_TEST(image(1, 1) == 1.0F);
+
+  // All rows are decoded into the same buffer.
+  const float *top_row = image.row(0);
+  BOOST_TEST(image.row(1) == top_row);
+  BOOST_TEST(image.row(0)[1] == 65535.0F);
+}
+
+/**
+ * 32 bit float samples.
+ */
+BOOST_AUTO_TEST_CASE(mapped_fits_image_float_test)
+{
+  TempDir temp_dir;
+  auto filepath = temp_dir.path() / "image.fits";
+
+  std::vector<float> values { 1.5F, -2.25F, 1000.0F };
+  std::vector<unsigned char> data;
+
+  for (float value : values) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      data.push_back(static_cast<unsigned char>(bits >> shift));
+    }
+  }
+
+  write_fits(filepath, -32, 3, 1, data);
+
+  MappedImage image(filepath);
+
+  BOOST_TEST(image.bitpix() == -32);
+  BOOST_TEST(image(0, 0) == 1.5F);
+  BOOST_TEST(image(1, 0) == -2.25F);
+  BOOST_TEST(image(2, 0) == 1000.0F);
+}
+
+/**
+ * The mapped image must match the image read by CFITSIO.
+ */
+BOOST_AUTO_TEST_CASE(mapped_fits_image_read_compare_test)
+{
+  std::filesystem::path filepath =
+      "test_data/image_reader/test_image_fits_496x380.fit";
+
+  Image expected_image = starmathpp::io::read(filepath);
+  MappedImage image(filepath);
+
+  BOOST_TEST(image.width() == expected_image.width());
+  BOOST_TEST(image.height() == expected_image.height());
+
+  Image image_copy = image.to_image();
+  BOOST_TEST((image_copy == expected_image));
+
+  Image cutout = image.crop(Rect<int>(100, 50, 21, 17));
+
+  BOOST_TEST(cutout.width() == 21);
+  BOOST_TEST(cutout.height() == 17);
+  BOOST_TEST(cutout(0, 0) == expected_image(100, 50));
+  BOOST_TEST(cutout(20, 16) == expected_image(120, 66));
+  BOOST_TEST(image(495, 379) == expected_image(495, 379));
+
+  image.release_rows();
+  BOOST_TEST(image(3, 7) == expected_image(3, 7));
+}
+
+/**
+ * The image can be moved, e.g. into a container.
+ */
+BOOST_AUTO_TEST_CASE(mapped_fits_image_move_test)
+{
+  TempDir temp_dir;
+  auto filepath = temp_dir.path() / "image.fit";
+
+  write_fits(filepath, 8, 2, 1, { 7, 200 });
+
+  std::vector<MappedImage> images;
+  images.emplace_back(filepath);
+
+  MappedImage image = std::move(images.front());
+  images.clear();
+
+  BOOST_TEST(image(0, 0) == 7.0F);
+  BOOST_TEST(image(1, 0) == 200.0F);
+}
+
+/**
+ * Invalid accesses and unsupported files throw.
+ */
+BOOST_AUTO_TEST_CASE(mapped_fits_image_invalid_test)
+{
+  TempDir temp_dir;
+  auto filepath = temp_dir.path() / "image.fit";
+
+  write_fits(filepath, 8, 2, 2, { 1, 2, 3, 4 });
+
+  MappedImage image(filepath);
+
+  BOOST_CHECK_THROW(image.row(2), MappedImageException);
+  BOOST_CHECK_THROW(image.crop(Rect<int>(1, 1, 2, 1)), MappedImageException);
+
+  // Compressed files cannot be mapped.
+  BOOST_CHECK_THROW(
+      MappedImage("test_data/image_reader/test_image_fits_496x380.fit.gz"),
+      MappedImageException);
+
+  BOOST_CHECK_THROW(MappedImage(temp_dir.path() / "does_not_exist.fit"),
+                    MappedImageException);
+
+  // Data unit shorter than announced in the header.
+  auto truncated_filepath = temp_dir.path() / "truncated.fit";
+  write_fits(truncated_filepath, 16, 2000, 2, { 1, 2 });
+  std::filesystem::resize_file(truncated_filepath, 2 * 2880);
+
+  BOOST_CHECK_THROW(MappedImage { truncated_filepath }, MappedImageException);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,369 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_IO_MASTER_FRAME_CACHE_HPP_
+#define STARMATHPP_IO_MASTER_FRAME_CACHE_HPP_ STARMATHPP_IO_MASTER_FRAME_CACHE_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <libstarmathpp/enum_helper.hpp>
+#include <libstarmathpp/exception.hpp>
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/io/cimg_fits_io.hpp>
+
+namespace starmathpp::io {
+
+DEF_Exception(MasterFrameCache);
+
+/**
+ * Defines how an input file of a master frame is identified.
+ */
+struct FileFingerprint {
+  enum TypeE {
+    SIZE_AND_MTIME,  // Cheap. Changes whenever a file is re-written.
+    CONTENT,         // Reads all files. Survives copying and touching.
+    _Count
+  };
+
+  static const char* asStr(const TypeE &inType) {
+    switch (inType) {
+      case SIZE_AND_MTIME:
+        return "SIZE_AND_MTIME";
+      case CONTENT:
+        return "CONTENT";
+      default:
+        return "<?>";
+    }
+  }
+
+  MAC_AS_TYPE(Type, E, _Count)
+  ;
+};
+
+namespace detail {
+
+/**
+ * 64 bit FNV-1a hash. It is not a cryptographic hash, but stable across
+ * platforms and program runs, which is all a cache key needs.
+ */
+class Fnv1aHash {
+ public:
+  void update(const void *data, size_t size) {
+    const auto *bytes = static_cast<const unsigned char*>(data);
+
+    for (size_t i = 0; i < size; ++i) {
+      hash_ = (hash_ ^ bytes[i]) * PRIME;
+    }
+  }
+
+  void update(const std::string &str) {
+    update(str.data(), str.size());
+  }
+
+  [[nodiscard]] uint64_t value() const {
+    return hash_;
+  }
+
+  [[nodiscard]] std::string hex() const {
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << hash_;
+    return ss.str();
+  }
+
+ private:
+  static constexpr uint64_t OFFSET_BASIS = 14695981039346656037ULL;
+  static constexpr uint64_t PRIME = 1099511628211ULL;
+
+  uint64_t hash_ = OFFSET_BASIS;
+};
+
+inline std::string hash_file_content(const std::filesystem::path &filepath) {
+  std::ifstream ifs(filepath, std::ios::binary);
+
+  if (!ifs) {
+    std::stringstream ss;
+    ss << "Unable to read '" << filepath.string() << "'.";
+    throw MasterFrameCacheException(ss.str());
+  }
+
+  Fnv1aHash hash;
+  std::vector<char> buffer(1 << 16);
+
+  while (ifs) {
+    ifs.read(buffer.data(), (std::streamsize) buffer.size());
+    hash.update(buffer.data(), (size_t) ifs.gcount());
+  }
+  return hash.hex();
+}
+
+}  // namespace detail
+
+/**
+ * Identifies a master frame by everything it is calculated from: the input
+ * files and the processing parameters.
+ *
+ * The input files are sorted by path. Hence, the order in which the
+ * directory is listed does not change the key. Parameters are compared by
+ * name and value in the order they were added. Floating point values are
+ * stored with full precision.
+ *
+ * Usage:
+ *
+ * MasterFrameKey key("dark");
+ * key.add_files(dark_files)
+ *    .add_parameter("bad_pixel_threshold", 500.0F)
+ *    .add_parameter("filter_core_size", 3);
+ */
+class MasterFrameKey {
+ public:
+  explicit MasterFrameKey(std::string name,
+                          FileFingerprint::TypeE fingerprint =
+                              FileFingerprint::SIZE_AND_MTIME)
+      :
+      name_(std::move(name)),
+      fingerprint_(fingerprint) {
+
+    std::stringstream ss;
+    ss << "name=" << name_ << '\n' << "fingerprint="
+       << FileFingerprint::asStr(fingerprint_) << '\n';
+    description_ = ss.str();
+  }
+
+  /**
+   * Add the input files (e.g. the result of files()). Throws
+   * MasterFrameCacheException if a file does not exist.
+   */
+  template<typename Rng = std::vector<std::filesystem::path>>
+  MasterFrameKey& add_files(const Rng &rng) {
+    std::vector<std::filesystem::path> filepaths(std::begin(rng),
+                                                 std::end(rng));
+    std::sort(filepaths.begin(), filepaths.end());
+
+    for (const auto &filepath : filepaths) {
+      add_file(filepath);
+    }
+    return *this;
+  }
+
+  template<typename T>
+  MasterFrameKey& add_parameter(const std::string &name, const T &value) {
+    std::stringstream ss;
+    ss << "parameter:" << name << '=';
+
+    if constexpr (std::is_floating_point_v<T>) {
+      ss << std::setprecision(std::numeric_limits<T>::max_digits10) << value;
+    } else {
+      ss << value;
+    }
+    ss << '\n';
+    description_ += ss.str();
+
+    return *this;
+  }
+
+  [[nodiscard]] const std::string& name() const {
+    return name_;
+  }
+
+  /**
+   * Human readable list of everything the key consists of.
+   */
+  [[nodiscard]] const std::string& description() const {
+    return description_;
+  }
+
+  /**
+   * Hash of the description as 16 hex digits.
+   */
+  [[nodiscard]] std::string digest() const {
+    detail::Fnv1aHash hash;
+    hash.update(description_);
+    return hash.hex();
+  }
+
+ private:
+  std::string name_;
+  FileFingerprint::TypeE fingerprint_;
+  std::string description_;
+
+  void add_file(const std::filesystem::path &filepath) {
+    std::error_code ec;
+    auto file_size = std::filesystem::file_size(filepath, ec);
+
+    if (ec) {
+      std::stringstream ss;
+      ss << "Unable to access input file '" << filepath.string() << "': "
+         << ec.message();
+      throw MasterFrameCacheException(ss.str());
+    }
+
+    std::stringstream ss;
+    ss << "file:" << filepath.lexically_normal().string() << ";size="
+       << file_size;
+
+    if (fingerprint_ == FileFingerprint::CONTENT) {
+      ss << ";content=" << detail::hash_file_content(filepath);
+    } else {
+      ss << ";mtime="
+         << std::filesystem::last_write_time(filepath).time_since_epoch().count();
+    }
+    ss << '\n';
+    description_ += ss.str();
+  }
+};
+
+/**
+ * On-disk cache of master frames (e.g. master dark, dark-flat and flat).
+ *
+ * The masters are stored as 32 bit floating point FITS files named
+ * <name>_<digest>.fit in the cache directory (e.g. next to the input
+ * data). get_or_create() returns the stored master if a master with the
+ * same key exists. Otherwise, the master is created, stored and returned.
+ * Masters of outdated keys are not deleted.
+ *
+ * A master is written to a temporary file first and then renamed. Hence,
+ * an interrupted run never leaves a truncated master behind. A master
+ * which cannot be read is re-created.
+ *
+ * Usage:
+ *
+ * MasterFrameCache cache("lights/.masters");
+ *
+ * MasterFrameKey dark_key("dark");
+ * dark_key.add_files(dark_files).add_parameter("bad_pixel_threshold", 500);
+ *
+ * Image master_dark = cache.get_or_create(dark_key, [&]() {
+ *   return average(dark_files | read() | interpolate_bad_pixels(500, 3));
+ * });
+ */
+class MasterFrameCache {
+ public:
+  explicit MasterFrameCache(std::filesystem::path directory)
+      :
+      directory_(std::move(directory)) {
+  }
+
+  [[nodiscard]] const std::filesystem::path& directory() const {
+    return directory_;
+  }
+
+  [[nodiscard]] std::filesystem::path path_of(const MasterFrameKey &key) const {
+    return directory_ / (key.name() + "_" + key.digest() + ".fit");
+  }
+
+  [[nodiscard]] bool contains(const MasterFrameKey &key) const {
+    return std::filesystem::is_regular_file(path_of(key));
+  }
+
+  /**
+   * Return the cached master of the key. If there is none, create_master()
+   * is called and its result is stored and returned.
+   */
+  template<typename Fun>
+  Image get_or_create(const MasterFrameKey &key, Fun &&create_master) {
+    const std::filesystem::path master_path = path_of(key);
+
+    if (std::filesystem::is_regular_file(master_path)) {
+      try {
+        return fits::read(master_path.string());
+      } catch (fits::FitsIOException&) {
+        // NOTE: The master is re-created below.
+      }
+    }
+
+    Image master(create_master());
+
+    store(master, master_path);
+
+    return master;
+  }
+
+ private:
+  std::filesystem::path directory_;
+
+  void store(const Image &master,
+             const std::filesystem::path &master_path) const {
+    static std::atomic<uint64_t> temp_file_counter { 0 };
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+
+    if (ec) {
+      std::stringstream ss;
+      ss << "Unable to create cache directory '" << directory_.string()
+         << "': " << ec.message();
+      throw MasterFrameCacheException(ss.str());
+    }
+
+    // NOTE: The temporary name is unique per process and call. The
+    //       extension is kept since CFITSIO interprets it.
+    std::stringstream temp_name;
+    temp_name << master_path.stem().string() << ".tmp"
+              << std::chrono::steady_clock::now().time_since_epoch().count()
+              << "_" << temp_file_counter++ << ".fit";
+
+    const std::filesystem::path temp_path = directory_ / temp_name.str();
+
+    try {
+      fits::write(master, temp_path.string(), true /*override*/);
+    } catch (fits::FitsIOException &exc) {
+      std::filesystem::remove(temp_path, ec);
+
+      std::stringstream ss;
+      ss << "Unable to store master '" << master_path.string() << "': "
+         << exc.what();
+      throw MasterFrameCacheException(ss.str());
+    }
+
+    std::filesystem::rename(temp_path, master_path, ec);
+
+    if (ec) {
+      std::stringstream ss;
+      ss << "Unable to store master '" << master_path.string() << "': "
+         << ec.message();
+
+      std::filesystem::remove(temp_path, ec);
+      throw MasterFrameCacheException(ss.str());
+    }
+  }
+};
+
+}  // namespace starmathpp::io
+
+#endif // STARMATHPP_IO_MASTER_FRAME_CACHE_HPP_
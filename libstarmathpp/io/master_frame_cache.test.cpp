@@ -0,0 +1,231 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "master frame cache unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/io/master_frame_cache.hpp>
+#include <libstarmathpp/floating_point_equality.hpp>
+
+BOOST_AUTO_TEST_SUITE (master_frame_cache_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::io;
+
+namespace {
+
+/**
+ * Create an empty test directory.
+ */
+std::filesystem::path create_test_directory(const std::string &name) {
+  auto directory = std::filesystem::temp_directory_path()
+      / ("starmathpp_master_frame_cache_" + name);
+
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+
+  return directory;
+}
+
+void write_file(const std::filesystem::path &filepath,
+                const std::string &content) {
+  std::ofstream(filepath, std::ios::binary | std::ios::trunc) << content;
+}
+
+}  // namespace
+
+/**
+ * The key must change whenever an input or a parameter changes - but not
+ * if the files are listed in a different order.
+ */
+BOOST_AUTO_TEST_CASE(master_frame_key_digest_test)
+{
+  auto directory = create_test_directory("key");
+  write_file(directory / "a.fit", "aaaa");
+  write_file(directory / "b.fit", "bbbb");
+
+  auto digest_of = [&](const std::vector<std::filesystem::path> &files,
+                       float threshold, const std::string &name = "dark") {
+    MasterFrameKey key(name);
+    key.add_files(files).add_parameter("bad_pixel_threshold", threshold);
+    return key.digest();
+  };
+
+  std::string digest = digest_of( { directory / "a.fit", directory / "b.fit" },
+                                 500.0F);
+
+  BOOST_TEST(digest.size() == 16);
+  BOOST_TEST(
+      digest == digest_of( { directory / "b.fit", directory / "a.fit" }, 500.0F));
+  BOOST_TEST(digest != digest_of( { directory / "a.fit" }, 500.0F));
+  BOOST_TEST(
+      digest != digest_of( { directory / "a.fit", directory / "b.fit" }, 500.5F));
+  BOOST_TEST(
+      digest != digest_of( { directory / "a.fit", directory / "b.fit" }, 500.0F, "flat"));
+
+  // A different size changes the key
+  write_file(directory / "b.fit", "bbbbb");
+  BOOST_TEST(
+      digest != digest_of( { directory / "a.fit", directory / "b.fit" }, 500.0F));
+
+  // Filenames as returned by files()
+  std::vector<std::string> filenames = { (directory / "b.fit").string(),
+      (directory / "a.fit").string() };
+  MasterFrameKey string_key("dark");
+  string_key.add_files(filenames);
+
+  MasterFrameKey path_key("dark");
+  path_key.add_files( { directory / "a.fit", directory / "b.fit" });
+
+  BOOST_TEST(string_key.digest() == path_key.digest());
+
+  MasterFrameKey key("dark");
+  BOOST_CHECK_THROW(key.add_files( { directory / "missing.fit" }),
+                    MasterFrameCacheException);
+}
+
+/**
+ * With the CONTENT fingerprint, re-writing a file with the same content
+ * keeps the key.
+ */
+BOOST_AUTO_TEST_CASE(master_frame_key_content_fingerprint_test)
+{
+  auto directory = create_test_directory("content");
+  const auto filepath = directory / "a.fit";
+  write_file(filepath, "aaaa");
+
+  auto digest_of = [&](FileFingerprint::TypeE fingerprint) {
+    MasterFrameKey key("dark", fingerprint);
+    key.add_files( { filepath });
+    return key.digest();
+  };
+
+  std::string content_digest = digest_of(FileFingerprint::CONTENT);
+  std::string mtime_digest = digest_of(FileFingerprint::SIZE_AND_MTIME);
+
+  write_file(filepath, "aaaa");
+  std::filesystem::last_write_time(
+      filepath,
+      std::filesystem::last_write_time(filepath) + std::chrono::seconds(10));
+
+  BOOST_TEST(content_digest == digest_of(FileFingerprint::CONTENT));
+  BOOST_TEST(mtime_digest != digest_of(FileFingerprint::SIZE_AND_MTIME));
+
+  write_file(filepath, "aaab");
+  BOOST_TEST(content_digest != digest_of(FileFingerprint::CONTENT));
+}
+
+/**
+ * The master is only created if it is not in the cache.
+ */
+BOOST_AUTO_TEST_CASE(master_frame_cache_get_or_create_test)
+{
+  auto directory = create_test_directory("get_or_create");
+  write_file(directory / "dark_1.fit", "1111");
+
+  MasterFrameCache cache(directory / ".masters");
+
+  int num_created = 0;
+  Image master(20, 10, 1, 1, 0);
+
+  cimg_forXY(master, x, y)
+  {
+    master(x, y) = 0.25F * (float) (x + 3 * y) + 1000.125F;
+  }
+
+  auto create_master = [&]() {
+    ++num_created;
+    return master;
+  };
+
+  MasterFrameKey key("dark");
+  key.add_files( { directory / "dark_1.fit" }).add_parameter("filter_core_size",
+                                                             3);
+
+  BOOST_TEST(!cache.contains(key));
+
+  Image created_master = cache.get_or_create(key, create_master);
+  Image cached_master = cache.get_or_create(key, create_master);
+
+  BOOST_TEST(num_created == 1);
+  BOOST_TEST(cache.contains(key));
+  BOOST_TEST(cache.path_of(key).filename().string() == "dark_" + key.digest() + ".fit");
+
+  // NOTE: The master is stored as float. The values are not scaled.
+  BOOST_TEST(is_almost_equal(created_master, master, 0.0));
+  BOOST_TEST(is_almost_equal(cached_master, master, 0.0));
+
+  // Only the master is left in the cache directory
+  size_t num_files = std::distance(
+      std::filesystem::directory_iterator(cache.directory()),
+      std::filesystem::directory_iterator());
+  BOOST_TEST(num_files == 1);
+
+  // A changed input file requires a new master
+  write_file(directory / "dark_1.fit", "11111");
+
+  MasterFrameKey changed_key("dark");
+  changed_key.add_files( { directory / "dark_1.fit" }).add_parameter(
+      "filter_core_size", 3);
+
+  cache.get_or_create(changed_key, create_master);
+  BOOST_TEST(num_created == 2);
+}
+
+/**
+ * An unreadable master is re-created.
+ */
+BOOST_AUTO_TEST_CASE(master_frame_cache_corrupt_master_test)
+{
+  auto directory = create_test_directory("corrupt");
+  MasterFrameCache cache(directory);
+
+  MasterFrameKey key("flat");
+  key.add_parameter("target", 1.5);
+
+  write_file(cache.path_of(key), "no FITS file");
+
+  int num_created = 0;
+  Image master = cache.get_or_create(key, [&]() {
+    ++num_created;
+    return Image(4, 4, 1, 1, 7);
+  });
+
+  BOOST_TEST(num_created == 1);
+  BOOST_TEST(master(1, 1) == 7.0F);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
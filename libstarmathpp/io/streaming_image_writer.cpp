@@ -0,0 +1,498 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#include <png.h>
+#include <tiffio.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include <libstarmathpp/io/streaming_image_writer.hpp>
+
+namespace starmathpp::io {
+
+namespace detail {
+
+/**
+ * Largest classic TIFF file. Beyond that, a BigTIFF is written. The margin
+ * covers the directory and the strip / tile offsets.
+ */
+constexpr uint64_t MAX_CLASSIC_TIFF_DATA_SIZE = 0xF0000000ULL;
+
+/**
+ * zlib stream of the block - this is what the TIFF deflate codec stores
+ * per strip / tile.
+ */
+template<typename SampleType>
+std::vector<unsigned char> deflate_block(const std::vector<SampleType> &block,
+                                         int level) {
+  uLong src_size = static_cast<uLong>(block.size() * sizeof(SampleType));
+  uLongf dst_size = compressBound(src_size);
+  std::vector<unsigned char> dst(dst_size);
+
+  int status = compress2(dst.data(), &dst_size,
+                         reinterpret_cast<const Bytef*>(block.data()),
+                         src_size, level);
+
+  if (status != Z_OK) {
+    std::stringstream ss;
+    ss << "Compressing TIFF block failed (zlib status " << status << ").";
+    throw StreamingImageWriterException(ss.str());
+  }
+
+  dst.resize(dst_size);
+  return dst;
+}
+
+template<typename SampleType>
+constexpr int tiff_sample_format() {
+  return std::is_same_v<SampleType, float> ? SAMPLEFORMAT_IEEEFP :
+                                             SAMPLEFORMAT_UINT;
+}
+
+bool is_little_endian() {
+  const uint16_t probe = 1;
+  unsigned char first_byte;
+  std::memcpy(&first_byte, &probe, 1);
+  return first_byte == 1;
+}
+
+/**
+ * libpng reports errors with longjmp(). The functions below contain the
+ * setjmp() and do not create any objects with destructors, which would
+ * be skipped by the longjmp().
+ */
+bool png_start(png_structp png, png_infop info, FILE *file, int width,
+               int height, int bit_depth, int color_type,
+               int compression_level) {
+  if (setjmp(png_jmpbuf(png))) {
+    return false;
+  }
+
+  png_init_io(png, file);
+  png_set_compression_level(png, compression_level);
+  png_set_IHDR(png, info, static_cast<png_uint_32>(width),
+               static_cast<png_uint_32>(height), bit_depth, color_type,
+               PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
+               PNG_FILTER_TYPE_DEFAULT);
+  png_write_info(png, info);
+
+  // PNG stores 16 bit samples big-endian
+  if (bit_depth == 16 && is_little_endian()) {
+    png_set_swap(png);
+  }
+  return true;
+}
+
+bool png_write(png_structp png, const void *row) {
+  if (setjmp(png_jmpbuf(png))) {
+    return false;
+  }
+
+  png_write_row(png, static_cast<png_const_bytep>(row));
+  return true;
+}
+
+bool png_finish(png_structp png, png_infop info) {
+  if (setjmp(png_jmpbuf(png))) {
+    return false;
+  }
+
+  png_write_end(png, info);
+  return true;
+}
+
+}  // namespace detail
+
+/**
+ *
+ */
+template<typename SampleType>
+TiffStreamWriter<SampleType>::TiffStreamWriter(
+    const std::filesystem::path &filepath, int width, int height,
+    int num_channels, const TiffWriteOptions &options)
+    :
+    StreamingImageWriter<SampleType>(width, height, num_channels),
+    options_(options),
+    tiff_(nullptr),
+    band_index_(0),
+    rows_in_band_(0) {
+
+  if (options.layout == TiffLayout::STRIPS) {
+    if (options.rows_per_strip <= 0) {
+      throw StreamingImageWriterException("rows_per_strip must be positive.");
+    }
+    block_width_ = width;
+    block_height_ = std::min(options.rows_per_strip, height);
+    blocks_across_ = 1;
+  } else {
+    if (options.tile_size <= 0 || options.tile_size % 16 != 0) {
+      throw StreamingImageWriterException(
+          "tile_size must be a positive multiple of 16.");
+    }
+    block_width_ = options.tile_size;
+    block_height_ = options.tile_size;
+    blocks_across_ = (width + block_width_ - 1) / block_width_;
+  }
+
+  if (options.compression == TiffCompression::DEFLATE
+      && (options.compression_level < 1 || options.compression_level > 9)) {
+    throw StreamingImageWriterException(
+        "compression_level must be in the range 1..9.");
+  }
+
+  uint64_t data_size = static_cast<uint64_t>(width) * height * num_channels
+      * sizeof(SampleType);
+  const char *mode =
+      data_size > detail::MAX_CLASSIC_TIFF_DATA_SIZE ? "w8" : "w";
+
+  tiff_ = TIFFOpen(filepath.string().c_str(), mode);
+
+  if (tiff_ == nullptr) {
+    std::stringstream ss;
+    ss << "Unable to open '" << filepath << "' for writing.";
+    throw StreamingImageWriterException(ss.str());
+  }
+
+  // NOTE: 16 bit tags are passed as int (default argument promotion)
+  bool ok = TIFFSetField(tiff_, TIFFTAG_IMAGEWIDTH, static_cast<uint32_t>(width))
+      && TIFFSetField(tiff_, TIFFTAG_IMAGELENGTH, static_cast<uint32_t>(height))
+      && TIFFSetField(tiff_, TIFFTAG_SAMPLESPERPIXEL, num_channels)
+      && TIFFSetField(tiff_, TIFFTAG_BITSPERSAMPLE,
+                      static_cast<int>(8 * sizeof(SampleType)))
+      && TIFFSetField(tiff_, TIFFTAG_SAMPLEFORMAT,
+                      detail::tiff_sample_format<SampleType>())
+      && TIFFSetField(tiff_, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG)
+      && TIFFSetField(tiff_, TIFFTAG_PHOTOMETRIC,
+                      num_channels == 1 ? PHOTOMETRIC_MINISBLACK : PHOTOMETRIC_RGB)
+      && TIFFSetField(tiff_, TIFFTAG_COMPRESSION,
+                      options.compression == TiffCompression::DEFLATE ?
+                          COMPRESSION_ADOBE_DEFLATE : COMPRESSION_NONE);
+
+  if (options.layout == TiffLayout::STRIPS) {
+    ok = ok && TIFFSetField(tiff_, TIFFTAG_ROWSPERSTRIP,
+                            static_cast<uint32_t>(block_height_));
+  } else {
+    ok = ok && TIFFSetField(tiff_, TIFFTAG_TILEWIDTH,
+                            static_cast<uint32_t>(block_width_))
+        && TIFFSetField(tiff_, TIFFTAG_TILELENGTH,
+                        static_cast<uint32_t>(block_height_));
+  }
+
+  if (!ok) {
+    TIFFClose(tiff_);
+    throw StreamingImageWriterException("Unable to set TIFF tags.");
+  }
+
+  band_.resize(static_cast<size_t>(block_height_) * width * num_channels);
+
+  if (options.compression == TiffCompression::DEFLATE
+      && options.num_threads > 1) {
+    thread_pool_ = std::make_unique<ThreadPool>(options.num_threads);
+  }
+}
+
+/**
+ * If close() was not called, the compressions in flight are awaited and
+ * the incomplete file is closed.
+ */
+template<typename SampleType>
+TiffStreamWriter<SampleType>::~TiffStreamWriter() {
+  if (tiff_ == nullptr) {
+    return;
+  }
+
+  for (auto &pending_block : pending_blocks_) {
+    pending_block.second.wait();
+  }
+  pending_blocks_.clear();
+
+  TIFFClose(tiff_);
+}
+
+/**
+ *
+ */
+template<typename SampleType>
+void TiffStreamWriter<SampleType>::write_row_internal(const SampleType *row) {
+  const size_t row_size = static_cast<size_t>(this->width())
+      * this->num_channels();
+
+  std::copy_n(row, row_size, band_.data() + rows_in_band_ * row_size);
+  ++rows_in_band_;
+
+  if (rows_in_band_ == block_height_
+      || this->rows_written() + 1 == this->height()) {
+    flush_band();
+  }
+}
+
+/**
+ * Split the collected rows into strips / tiles and pass them to the
+ * compression.
+ */
+template<typename SampleType>
+void TiffStreamWriter<SampleType>::flush_band() {
+  const size_t row_size = static_cast<size_t>(this->width())
+      * this->num_channels();
+
+  if (options_.layout == TiffLayout::STRIPS) {
+    // The last strip only contains the remaining rows
+    std::vector<SampleType> block(std::move(band_));
+    block.resize(rows_in_band_ * row_size);
+    band_.resize(static_cast<size_t>(block_height_) * row_size);
+
+    submit_block(static_cast<uint32_t>(band_index_), std::move(block));
+  } else {
+    // Tiles at the right and bottom border are padded with zeros
+    const size_t tile_row_size = static_cast<size_t>(block_width_)
+        * this->num_channels();
+
+    for (int tx = 0; tx < blocks_across_; ++tx) {
+      const int x0 = tx * block_width_;
+      const size_t num_samples = static_cast<size_t>(std::min(
+          block_width_, this->width() - x0)) * this->num_channels();
+
+      std::vector<SampleType> block(tile_row_size * block_height_, 0);
+
+      for (int y = 0; y < rows_in_band_; ++y) {
+        std::copy_n(
+            band_.data() + y * row_size
+                + static_cast<size_t>(x0) * this->num_channels(),
+            num_samples, block.data() + y * tile_row_size);
+      }
+
+      submit_block(
+          static_cast<uint32_t>(band_index_ * blocks_across_ + tx),
+          std::move(block));
+    }
+  }
+
+  ++band_index_;
+  rows_in_band_ = 0;
+
+  write_pending_blocks(
+      std::max<size_t>(1, options_.num_threads) * blocks_across_);
+}
+
+/**
+ *
+ */
+template<typename SampleType>
+void TiffStreamWriter<SampleType>::submit_block(
+    uint32_t block_index, std::vector<SampleType> &&block) {
+
+  if (options_.compression == TiffCompression::NONE) {
+    // The file is written in the native byte order
+    write_block(block_index, block.data(), block.size() * sizeof(SampleType));
+  } else if (thread_pool_ == nullptr) {
+    auto encoded = detail::deflate_block(block, options_.compression_level);
+    write_block(block_index, encoded.data(), encoded.size());
+  } else {
+    pending_blocks_.emplace_back(
+        block_index,
+        thread_pool_->submit(
+            [block = std::move(block), level = options_.compression_level]() {
+              return detail::deflate_block(block, level);
+            }));
+  }
+}
+
+/**
+ * Write the compressed blocks in order. Blocks are written as soon as they
+ * are ready. If more than max_pending blocks are in flight, the oldest ones
+ * are awaited.
+ */
+template<typename SampleType>
+void TiffStreamWriter<SampleType>::write_pending_blocks(size_t max_pending) {
+  while (!pending_blocks_.empty()) {
+    auto &front = pending_blocks_.front();
+
+    if (pending_blocks_.size() <= max_pending
+        && front.second.wait_for(std::chrono::seconds(0))
+            != std::future_status::ready) {
+      return;
+    }
+
+    uint32_t block_index = front.first;
+    EncodedBlock encoded = front.second.get();
+    pending_blocks_.pop_front();
+
+    write_block(block_index, encoded.data(), encoded.size());
+  }
+}
+
+/**
+ *
+ */
+template<typename SampleType>
+void TiffStreamWriter<SampleType>::write_block(uint32_t block_index,
+                                               const void *data, size_t size) {
+  // NOTE: libtiff does not modify the data
+  void *raw_data = const_cast<void*>(data);
+  auto raw_size = static_cast<tmsize_t>(size);
+
+  tmsize_t written =
+      options_.layout == TiffLayout::STRIPS ?
+          TIFFWriteRawStrip(tiff_, block_index, raw_data, raw_size) :
+          TIFFWriteRawTile(tiff_, block_index, raw_data, raw_size);
+
+  if (written != raw_size) {
+    std::stringstream ss;
+    ss << "Writing TIFF " << TiffLayout::asStr(options_.layout) << " block "
+       << block_index << " failed.";
+    throw StreamingImageWriterException(ss.str());
+  }
+}
+
+/**
+ *
+ */
+template<typename SampleType>
+void TiffStreamWriter<SampleType>::close_internal() {
+  write_pending_blocks(0);
+
+  bool flushed = TIFFFlush(tiff_) != 0;
+
+  TIFFClose(tiff_);
+  tiff_ = nullptr;
+
+  if (!flushed) {
+    throw StreamingImageWriterException("Writing TIFF directory failed.");
+  }
+}
+
+/**
+ *
+ */
+template<typename SampleType>
+PngStreamWriter<SampleType>::PngStreamWriter(
+    const std::filesystem::path &filepath, int width, int height,
+    int num_channels, const PngWriteOptions &options)
+    :
+    StreamingImageWriter<SampleType>(width, height, num_channels),
+    file_(nullptr),
+    png_(nullptr),
+    info_(nullptr) {
+
+  if (options.compression_level < 0 || options.compression_level > 9) {
+    throw StreamingImageWriterException(
+        "compression_level must be in the range 0..9.");
+  }
+
+  file_ = std::fopen(filepath.string().c_str(), "wb");
+
+  if (file_ == nullptr) {
+    std::stringstream ss;
+    ss << "Unable to open '" << filepath << "' for writing.";
+    throw StreamingImageWriterException(ss.str());
+  }
+
+  png_ = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr,
+                                 nullptr);
+  info_ = png_ != nullptr ? png_create_info_struct(png_) : nullptr;
+
+  if (info_ == nullptr) {
+    release();
+    throw StreamingImageWriterException("Unable to initialize libpng.");
+  }
+
+  if (!detail::png_start(png_, info_, file_, width, height,
+                         8 * sizeof(SampleType),
+                         num_channels == 1 ? PNG_COLOR_TYPE_GRAY : PNG_COLOR_TYPE_RGB,
+                         options.compression_level)) {
+    release();
+    throw StreamingImageWriterException("Writing PNG header failed.");
+  }
+}
+
+/**
+ *
+ */
+template<typename SampleType>
+PngStreamWriter<SampleType>::~PngStreamWriter() {
+  release();
+}
+
+/**
+ *
+ */
+template<typename SampleType>
+void PngStreamWriter<SampleType>::release() {
+  if (png_ != nullptr) {
+    png_destroy_write_struct(&png_, info_ != nullptr ? &info_ : nullptr);
+    png_ = nullptr;
+    info_ = nullptr;
+  }
+
+  if (file_ != nullptr) {
+    std::fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+/**
+ *
+ */
+template<typename SampleType>
+void PngStreamWriter<SampleType>::write_row_internal(const SampleType *row) {
+  if (!detail::png_write(png_, row)) {
+    throw StreamingImageWriterException("Writing PNG row failed.");
+  }
+}
+
+/**
+ *
+ */
+template<typename SampleType>
+void PngStreamWriter<SampleType>::close_internal() {
+  if (!detail::png_finish(png_, info_)) {
+    throw StreamingImageWriterException("Writing PNG end failed.");
+  }
+
+  png_destroy_write_struct(&png_, &info_);
+  png_ = nullptr;
+  info_ = nullptr;
+
+  int status = std::fclose(file_);
+  file_ = nullptr;
+
+  if (status != 0) {
+    throw StreamingImageWriterException("Closing PNG file failed.");
+  }
+}
+
+template class TiffStreamWriter<uint8_t>;
+template class TiffStreamWriter<uint16_t>;
+template class TiffStreamWriter<float>;
+
+template class PngStreamWriter<uint8_t>;
+template class PngStreamWriter<uint16_t>;
+
+}  // namespace starmathpp::io
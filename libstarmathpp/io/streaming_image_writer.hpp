@@ -0,0 +1,375 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_IO_STREAMING_IMAGE_WRITER_HPP_
+#define STARMATHPP_IO_STREAMING_IMAGE_WRITER_HPP_ STARMATHPP_IO_STREAMING_IMAGE_WRITER_HPP_
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <libstarmathpp/enum_helper.hpp>
+#include <libstarmathpp/exception.hpp>
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/thread_pool.hpp>
+
+// Forward declarations of the libtiff and libpng handles
+struct tiff;
+struct png_struct_def;
+struct png_info_def;
+
+namespace starmathpp::io {
+
+DEF_Exception(StreamingImageWriter);
+
+/**
+ * Base class of the writers which receive an image row by row, from top
+ * to bottom. The image does not have to be resident in memory - a
+ * producer (e.g. a stretch which processes the image in bands) may pass
+ * each band as soon as it is computed.
+ *
+ * A row consists of width() * num_channels() samples. The channels are
+ * interleaved (RGBRGB...).
+ *
+ * close() must be called after the last row. Otherwise, the file is
+ * incomplete.
+ */
+template<typename SampleType>
+class StreamingImageWriter {
+ public:
+  StreamingImageWriter(int width, int height, int num_channels)
+      :
+      width_(width),
+      height_(height),
+      num_channels_(num_channels),
+      rows_written_(0),
+      closed_(false) {
+
+    if (width <= 0 || height <= 0) {
+      throw StreamingImageWriterException("Invalid image size.");
+    }
+    if (num_channels != 1 && num_channels != 3) {
+      throw StreamingImageWriterException(
+          "Only 1 (gray) and 3 (RGB) channels are supported.");
+    }
+  }
+
+  virtual ~StreamingImageWriter() = default;
+
+  StreamingImageWriter(const StreamingImageWriter&) = delete;
+  StreamingImageWriter& operator=(const StreamingImageWriter&) = delete;
+
+  [[nodiscard]] int width() const {
+    return width_;
+  }
+
+  [[nodiscard]] int height() const {
+    return height_;
+  }
+
+  [[nodiscard]] int num_channels() const {
+    return num_channels_;
+  }
+
+  [[nodiscard]] int rows_written() const {
+    return rows_written_;
+  }
+
+  /**
+   * Write the next row. The samples are copied - the row may be reused
+   * after the call.
+   */
+  void write_row(const SampleType *row) {
+    if (closed_) {
+      throw StreamingImageWriterException("Writer is already closed.");
+    }
+    if (rows_written_ >= height_) {
+      throw StreamingImageWriterException("All rows are already written.");
+    }
+
+    write_row_internal(row);
+    ++rows_written_;
+  }
+
+  /**
+   * Write all rows of the passed band. The band must have the width and
+   * the number of channels (spectrum) of the written image. The channels
+   * are interleaved and the values are converted to SampleType. They must
+   * be in the range of SampleType - to_uint16() converts a float image.
+   */
+  template<typename ImageType>
+  void write_rows(const cimg_library::CImg<ImageType> &rows) {
+    if (rows.width() != width_ || rows.spectrum() != num_channels_) {
+      throw StreamingImageWriterException(
+          "Band width or number of channels does not match the image.");
+    }
+
+    if constexpr (std::is_same_v<ImageType, SampleType>) {
+      if (num_channels_ == 1) {
+        for (int y = 0; y < rows.height(); ++y) {
+          write_row(rows.data(0, y));
+        }
+        return;
+      }
+    }
+
+    row_buffer_.resize(static_cast<size_t>(width_) * num_channels_);
+
+    for (int y = 0; y < rows.height(); ++y) {
+      SampleType *dst = row_buffer_.data();
+
+      for (int x = 0; x < width_; ++x) {
+        for (int c = 0; c < num_channels_; ++c) {
+          *dst++ = static_cast<SampleType>(rows(x, y, 0, c));
+        }
+      }
+      write_row(row_buffer_.data());
+    }
+  }
+
+  /**
+   * Finish the file. Throws if not all rows were written.
+   */
+  void close() {
+    if (closed_) {
+      return;
+    }
+    if (rows_written_ != height_) {
+      throw StreamingImageWriterException(
+          "Cannot close writer - not all rows were written.");
+    }
+
+    close_internal();
+    closed_ = true;
+  }
+
+ protected:
+  [[nodiscard]] bool is_closed() const {
+    return closed_;
+  }
+
+  virtual void write_row_internal(const SampleType *row) = 0;
+  virtual void close_internal() = 0;
+
+ private:
+  int width_;
+  int height_;
+  int num_channels_;
+  int rows_written_;
+  bool closed_;
+  std::vector<SampleType> row_buffer_;
+};
+
+/**
+ * Data layout of a TIFF file.
+ *
+ * STRIPS   - Bands of TiffWriteOptions::rows_per_strip complete rows.
+ * TILES    - Square tiles of TiffWriteOptions::tile_size pixels. Viewers
+ *            may load a part of a large image without decoding complete
+ *            rows.
+ */
+struct TiffLayout {
+  enum TypeE {
+    STRIPS,
+    TILES,
+    _Count
+  };
+
+  static const char* asStr(const TypeE &inType) {
+    switch (inType) {
+      case STRIPS:
+        return "STRIPS";
+      case TILES:
+        return "TILES";
+      default:
+        return "<?>";
+    }
+  }
+
+  MAC_AS_TYPE(Type, E, _Count)
+  ;
+};
+
+/**
+ * Compression of the TIFF strips / tiles.
+ */
+struct TiffCompression {
+  enum TypeE {
+    NONE,
+    DEFLATE,
+    _Count
+  };
+
+  static const char* asStr(const TypeE &inType) {
+    switch (inType) {
+      case NONE:
+        return "NONE";
+      case DEFLATE:
+        return "DEFLATE";
+      default:
+        return "<?>";
+    }
+  }
+
+  MAC_AS_TYPE(Type, E, _Count)
+  ;
+};
+
+/**
+ *
+ */
+struct TiffWriteOptions {
+  TiffLayout::TypeE layout = TiffLayout::STRIPS;
+
+  int rows_per_strip = 64;
+
+  /**
+   * Tile width and height. Must be a multiple of 16.
+   */
+  int tile_size = 256;
+
+  TiffCompression::TypeE compression = TiffCompression::NONE;
+
+  /**
+   * zlib compression level (1 - 9).
+   */
+  int compression_level = 6;
+
+  /**
+   * Number of threads compressing strips / tiles. The strips / tiles of
+   * one band are compressed while the producer computes the next band.
+   */
+  size_t num_threads = default_num_workers();
+};
+
+/**
+ * Streaming TIFF writer for 8 bit, 16 bit and float (IEEE) samples.
+ *
+ * The rows are collected until a strip (or a row of tiles) is complete.
+ * Then the strip / tiles are compressed by a thread pool and written in
+ * order with TIFFWriteRawStrip() / TIFFWriteRawTile(). At most one
+ * strip (or row of tiles) per thread is pending, so the memory does not
+ * depend on the image height.
+ *
+ * Usage:
+ *
+ * TiffWriteOptions options;
+ * options.compression = TiffCompression::DEFLATE;
+ *
+ * TiffStreamWriter<uint16_t> writer("stacked.tif", width, height, 1, options);
+ *
+ * for (int y = 0; y < height; y += band_height) {
+ *   writer.write_rows(to_uint16(stretch(band(y))));
+ * }
+ * writer.close();
+ */
+template<typename SampleType>
+class TiffStreamWriter : public StreamingImageWriter<SampleType> {
+  static_assert(std::is_same_v<SampleType, uint8_t>
+                || std::is_same_v<SampleType, uint16_t>
+                || std::is_same_v<SampleType, float>,
+                "TIFF samples must be uint8_t, uint16_t or float.");
+
+ public:
+  TiffStreamWriter(const std::filesystem::path &filepath, int width,
+                   int height, int num_channels = 1,
+                   const TiffWriteOptions &options = TiffWriteOptions());
+  ~TiffStreamWriter() override;
+
+ protected:
+  void write_row_internal(const SampleType *row) override;
+  void close_internal() override;
+
+ private:
+  using EncodedBlock = std::vector<unsigned char>;
+
+  TiffWriteOptions options_;
+  tiff *tiff_;
+
+  int block_width_;
+  int block_height_;
+  int blocks_across_;
+  int band_index_;
+  int rows_in_band_;
+  std::vector<SampleType> band_;
+
+  std::unique_ptr<ThreadPool> thread_pool_;
+  std::deque<std::pair<uint32_t, std::future<EncodedBlock>>> pending_blocks_;
+
+  void flush_band();
+  void submit_block(uint32_t block_index, std::vector<SampleType> &&block);
+  void write_pending_blocks(size_t max_pending);
+  void write_block(uint32_t block_index, const void *data, size_t size);
+};
+
+/**
+ *
+ */
+struct PngWriteOptions {
+  /**
+   * zlib compression level (0 - 9).
+   */
+  int compression_level = 6;
+};
+
+/**
+ * Streaming PNG writer for 8 and 16 bit samples. Each row is passed to
+ * libpng, which filters and compresses it immediately.
+ *
+ * NOTE: PNG is one zlib stream, the compression is not parallelized.
+ */
+template<typename SampleType>
+class PngStreamWriter : public StreamingImageWriter<SampleType> {
+  static_assert(std::is_same_v<SampleType, uint8_t>
+                || std::is_same_v<SampleType, uint16_t>,
+                "PNG samples must be uint8_t or uint16_t.");
+
+ public:
+  PngStreamWriter(const std::filesystem::path &filepath, int width,
+                  int height, int num_channels = 1,
+                  const PngWriteOptions &options = PngWriteOptions());
+  ~PngStreamWriter() override;
+
+ protected:
+  void write_row_internal(const SampleType *row) override;
+  void close_internal() override;
+
+ private:
+  FILE *file_;
+  png_struct_def *png_;
+  png_info_def *info_;
+
+  void release();
+};
+
+}  // namespace starmathpp::io
+
+#endif // STARMATHPP_IO_STREAMING_IMAGE_WRITER_HPP_
@@ -0,0 +1,248 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "streaming image writer unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/io/streaming_image_writer.hpp>
+
+BOOST_AUTO_TEST_SUITE (streaming_image_writer_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::io;
+
+/**
+ * Temporary directory which is removed at the end of the test.
+ */
+class TempDir {
+ public:
+  TempDir()
+      :
+      path_(
+          std::filesystem::temp_directory_path()
+              / std::filesystem::path("streaming_image_writer_test")) {
+    std::filesystem::remove_all(path_);
+    std::filesystem::create_directories(path_);
+  }
+
+  ~TempDir() {
+    std::filesystem::remove_all(path_);
+  }
+
+  [[nodiscard]] const std::filesystem::path& path() const {
+    return path_;
+  }
+
+ private:
+  std::filesystem::path path_;
+};
+
+/**
+ * Image with a different value for each pixel and channel.
+ */
+template<typename ImageType>
+static cimg_library::CImg<ImageType> generate_test_image(int width, int height,
+                                                         int num_channels) {
+  cimg_library::CImg<ImageType> image(width, height, 1, num_channels, 0);
+
+  cimg_forXYC(image, x, y, c)
+  {
+    image(x, y, 0, c) = static_cast<ImageType>((x * 31 + y * 17 + c * 101)
+        % 251);
+  }
+  return image;
+}
+
+/**
+ * Pass the image in bands of band_height rows like a producer would.
+ */
+template<typename SampleType, typename ImageType>
+static void write_in_bands(StreamingImageWriter<SampleType> &writer,
+                           const cimg_library::CImg<ImageType> &image,
+                           int band_height) {
+  for (int y = 0; y < image.height(); y += band_height) {
+    int last_row = std::min(image.height(), y + band_height) - 1;
+    writer.write_rows(image.get_crop(0, y, image.width() - 1, last_row));
+  }
+  writer.close();
+}
+
+/**
+ * Strips and tiles, compressed by one or several threads. The image size is
+ * not a multiple of the strip / tile size.
+ */
+BOOST_AUTO_TEST_CASE(tiff_stream_writer_uint16_test)
+{
+  TempDir temp_dir;
+
+  for (int num_channels : { 1, 3 }) {
+    auto image = generate_test_image<uint16_t>(301, 203, num_channels);
+
+    for (auto layout : { TiffLayout::STRIPS, TiffLayout::TILES }) {
+      for (auto compression : { TiffCompression::NONE, TiffCompression::DEFLATE }) {
+        for (size_t num_threads : { 1, 4 }) {
+          TiffWriteOptions options;
+          options.layout = layout;
+          options.rows_per_strip = 16;
+          options.tile_size = 64;
+          options.compression = compression;
+          options.num_threads = num_threads;
+
+          auto filepath = temp_dir.path() / "image_uint16.tif";
+
+          TiffStreamWriter<uint16_t> writer(filepath, image.width(),
+                                            image.height(), num_channels,
+                                            options);
+          write_in_bands(writer, image, 37);
+
+          BOOST_TEST(writer.rows_written() == image.height());
+          BOOST_TEST((cimg_library::CImg<uint16_t>(filepath.string().c_str()) == image));
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Float samples are stored as IEEE floating point.
+ */
+BOOST_AUTO_TEST_CASE(tiff_stream_writer_float_test)
+{
+  TempDir temp_dir;
+
+  Image image = generate_test_image<float>(130, 70, 1) * 0.37F;
+  auto filepath = temp_dir.path() / "image_float.tif";
+
+  TiffWriteOptions options;
+  options.compression = TiffCompression::DEFLATE;
+
+  TiffStreamWriter<float> writer(filepath, image.width(), image.height(), 1,
+                                 options);
+  write_in_bands(writer, image, 9);
+
+  BOOST_TEST((Image(filepath.string().c_str()) == image));
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(png_stream_writer_test)
+{
+  TempDir temp_dir;
+
+  for (int num_channels : { 1, 3 }) {
+    cimg_library::CImg<uint16_t> image16 =
+        generate_test_image<uint16_t>(97, 45, num_channels) * 200;
+    auto image8 = generate_test_image<uint8_t>(97, 45, num_channels);
+
+    auto filepath16 = temp_dir.path() / "image16.png";
+    auto filepath8 = temp_dir.path() / "image8.png";
+
+    PngStreamWriter<uint16_t> writer16(filepath16, image16.width(),
+                                       image16.height(), num_channels);
+    write_in_bands(writer16, image16, 10);
+
+    PngStreamWriter<uint8_t> writer8(filepath8, image8.width(),
+                                     image8.height(), num_channels);
+    write_in_bands(writer8, image8, 45);
+
+    BOOST_TEST((cimg_library::CImg<uint16_t>(filepath16.string().c_str()) == image16));
+    BOOST_TEST((cimg_library::CImg<uint8_t>(filepath8.string().c_str()) == image8));
+  }
+}
+
+/**
+ * Rows are written one by one from a plain buffer.
+ */
+BOOST_AUTO_TEST_CASE(stream_writer_write_row_test)
+{
+  TempDir temp_dir;
+
+  auto image = generate_test_image<uint16_t>(40, 30, 1);
+  auto filepath = temp_dir.path() / "image_rows.tif";
+
+  TiffStreamWriter<uint16_t> writer(filepath, image.width(), image.height());
+  std::vector<uint16_t> row(image.width());
+
+  for (int y = 0; y < image.height(); ++y) {
+    std::copy_n(image.data(0, y), image.width(), row.begin());
+    writer.write_row(row.data());
+  }
+  writer.close();
+
+  BOOST_TEST((cimg_library::CImg<uint16_t>(filepath.string().c_str()) == image));
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(stream_writer_invalid_use_test)
+{
+  TempDir temp_dir;
+  auto filepath = temp_dir.path() / "invalid.png";
+
+  // Unsupported number of channels
+  BOOST_CHECK_THROW(PngStreamWriter<uint8_t>(filepath, 10, 10, 2),
+                    StreamingImageWriterException);
+
+  // Tile size must be a multiple of 16
+  TiffWriteOptions options;
+  options.layout = TiffLayout::TILES;
+  options.tile_size = 100;
+
+  BOOST_CHECK_THROW(
+      TiffStreamWriter<uint16_t>(temp_dir.path() / "invalid.tif", 10, 10, 1, options),
+      StreamingImageWriterException);
+
+  PngStreamWriter<uint8_t> writer(filepath, 10, 10);
+
+  // Band width does not match
+  BOOST_CHECK_THROW(writer.write_rows(cimg_library::CImg<uint8_t>(11, 2, 1, 1, 0)),
+                    StreamingImageWriterException);
+
+  // Not all rows written
+  writer.write_rows(cimg_library::CImg<uint8_t>(10, 5, 1, 1, 0));
+  BOOST_CHECK_THROW(writer.close(), StreamingImageWriterException);
+
+  // Too many rows
+  BOOST_CHECK_THROW(writer.write_rows(cimg_library::CImg<uint8_t>(10, 6, 1, 1, 0)),
+                    StreamingImageWriterException);
+  BOOST_TEST(writer.rows_written() == 10);
+
+  writer.close();
+}
+
+BOOST_AUTO_TEST_SUITE_END();
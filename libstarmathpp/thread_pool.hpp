@@ -0,0 +1,401 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_THREAD_POOL_HPP_
+#define STARMATHPP_THREAD_POOL_HPP_ STARMATHPP_THREAD_POOL_HPP_
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <libstarmathpp/exception.hpp>
+
+namespace starmathpp {
+
+DEF_Exception(ThreadPool);
+
+/**
+ * Returns the number of worker threads used if nothing else is specified.
+ * std::thread::hardware_concurrency() may return 0 if the value is not
+ * computable. In that case one worker is used.
+ */
+static inline size_t default_num_workers() {
+  return std::max(1U, std::thread::hardware_concurrency());
+}
+
+/**
+ * Simple, fixed size pool of worker threads which execute the submitted
+ * tasks in FIFO order.
+ *
+ * Usage:
+ *
+ * ThreadPool thread_pool(4);
+ * std::future<double> result = thread_pool.submit([]() { return 42.0; });
+ * result.get();
+ *
+ * Exceptions thrown by a task are stored in the returned future and are
+ * re-thrown by future::get(). The destructor waits until all tasks which
+ * were submitted before have been executed.
+ */
+class ThreadPool {
+ public:
+  /**
+   *
+   */
+  explicit ThreadPool(size_t num_workers = default_num_workers())
+      :
+      stop_(false) {
+
+    if (num_workers < 1) {
+      throw ThreadPoolException("At least one worker thread is required.");
+    }
+
+    workers_.reserve(num_workers);
+
+    for (size_t i = 0; i < num_workers; ++i) {
+      workers_.emplace_back([this]() {
+        run_worker();
+      });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   *
+   */
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+
+    condition_.notify_all();
+
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+  }
+
+  [[nodiscard]] size_t size() const {
+    return workers_.size();
+  }
+
+  /**
+   * Enqueue the passed function. The function is executed by the next
+   * free worker thread. The result (or the exception) can be obtained
+   * from the returned future.
+   */
+  template<typename Fun>
+  auto submit(Fun &&fun) {
+    using result_type = std::invoke_result_t<std::decay_t<Fun>&>;
+
+    // NOTE: std::function requires a copyable target, std::packaged_task is
+    //       move-only. Therefore, the task is shared.
+    auto task = std::make_shared<std::packaged_task<result_type()>>(
+        std::forward<Fun>(fun));
+
+    std::future<result_type> future = task->get_future();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      if (stop_) {
+        throw ThreadPoolException("Cannot submit task to stopped thread pool.");
+      }
+
+      tasks_.emplace([task]() {
+        (*task)();
+      });
+    }
+
+    condition_.notify_one();
+
+    return future;
+  }
+
+ private:
+  std::vector<std::thread> workers_;
+  std::queue<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool stop_;
+
+  /**
+   * Worker loop. A worker only terminates if the pool is stopped and
+   * there are no pending tasks left.
+   */
+  void run_worker() {
+    while (true) {
+      std::function<void()> task;
+
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        condition_.wait(lock, [this]() {
+          return stop_ || !tasks_.empty();
+        });
+
+        if (stop_ && tasks_.empty()) {
+          return;
+        }
+
+        task = std::move(tasks_.front());
+        tasks_.pop();
+      }
+
+      task();
+    }
+  }
+};
+
+namespace detail {
+
+/**
+ * Number of chunks of at least min_chunk_size indices (but at least one)
+ * into which parallel_for() splits the index range [begin, end).
+ */
+inline size_t num_chunks(size_t begin, size_t end, size_t num_threads,
+                         size_t min_chunk_size) {
+  size_t num_indices = (end > begin ? end - begin : 0);
+  size_t max_num_chunks = num_indices / std::max<size_t>(1, min_chunk_size);
+
+  return std::max<size_t>(
+      1, std::min(std::max<size_t>(1, num_threads), max_num_chunks));
+}
+
+/**
+ * Call fun(chunk, chunk_begin, chunk_end) for each of the num_chunks
+ * contiguous chunks of [begin, end). The chunk boundaries only depend on
+ * the passed arguments.
+ */
+template<typename Fun>
+void for_each_chunk(size_t begin, size_t end, size_t num_chunks, Fun &&fun) {
+  size_t num_indices = (end > begin ? end - begin : 0);
+  size_t chunk_size = num_indices / num_chunks;
+  size_t remainder = num_indices % num_chunks;
+
+  size_t chunk_begin = begin;
+
+  for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+    // NOTE: The first chunks take one additional index each to distribute the remainder.
+    size_t chunk_end = chunk_begin + chunk_size + (chunk < remainder ? 1 : 0);
+
+    fun(chunk, chunk_begin, chunk_end);
+
+    chunk_begin = chunk_end;
+  }
+}
+
+inline void rethrow_first(const std::vector<std::exception_ptr> &exceptions) {
+  for (const auto &exception : exceptions) {
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+}
+
+}  // namespace detail
+
+/**
+ * Split the index range [begin, end) into at most num_threads contiguous
+ * chunks of at least min_chunk_size indices and call fun(chunk_begin, chunk_end)
+ * for each chunk concurrently. The calling thread processes the last chunk.
+ * The function returns when all chunks are processed.
+ *
+ * The chunk boundaries only depend on the passed arguments. Therefore, the
+ * work assigned to each chunk is deterministic.
+ *
+ * If fun throws, the exception of the first failing chunk is re-thrown after
+ * all chunks have finished.
+ *
+ * NOTE: A thread is started for each chunk. If this is called repeatedly
+ *       (e.g. for each frame), use the ThreadPool overload below.
+ */
+template<typename Fun>
+void parallel_for(size_t begin, size_t end, Fun &&fun, size_t num_threads =
+                      default_num_workers(),
+                  size_t min_chunk_size = 1) {
+
+  size_t num_chunks = detail::num_chunks(begin, end, num_threads,
+                                         min_chunk_size);
+
+  if (num_chunks == 1) {
+    fun(begin, end);
+    return;
+  }
+
+  std::vector<std::thread> threads;
+  std::vector<std::exception_ptr> exceptions(num_chunks);
+
+  threads.reserve(num_chunks - 1);
+
+  detail::for_each_chunk(begin, end, num_chunks, [&](size_t chunk,
+                                                     size_t chunk_begin,
+                                                     size_t chunk_end) {
+    auto run_chunk = [&fun, &exceptions, chunk, chunk_begin, chunk_end]() {
+      try {
+        fun(chunk_begin, chunk_end);
+      } catch (...) {
+        exceptions[chunk] = std::current_exception();
+      }
+    };
+
+    if (chunk + 1 < num_chunks) {
+      threads.emplace_back(run_chunk);
+    } else {
+      run_chunk();
+    }
+  });
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  detail::rethrow_first(exceptions);
+}
+
+/**
+ * Same as above, but the chunks are executed by the workers of thread_pool
+ * and the calling thread instead of by new threads. The range is split into
+ * at most thread_pool.size() + 1 chunks.
+ *
+ * NOTE: Must not be called by a worker of the same pool. The worker would
+ *       wait for chunks which may never be executed.
+ */
+template<typename Fun>
+void parallel_for(ThreadPool &thread_pool, size_t begin, size_t end,
+                  Fun &&fun, size_t min_chunk_size = 1) {
+
+  size_t num_chunks = detail::num_chunks(begin, end, thread_pool.size() + 1,
+                                         min_chunk_size);
+
+  if (num_chunks == 1) {
+    fun(begin, end);
+    return;
+  }
+
+  std::vector<std::future<void>> futures;
+  std::vector<std::exception_ptr> exceptions(num_chunks);
+
+  futures.reserve(num_chunks - 1);
+
+  detail::for_each_chunk(begin, end, num_chunks, [&](size_t chunk,
+                                                     size_t chunk_begin,
+                                                     size_t chunk_end) {
+    if (chunk + 1 < num_chunks) {
+      futures.push_back(thread_pool.submit([&fun, chunk_begin, chunk_end]() {
+        fun(chunk_begin, chunk_end);
+      }));
+    } else {
+      try {
+        fun(chunk_begin, chunk_end);
+      } catch (...) {
+        exceptions[chunk] = std::current_exception();
+      }
+    }
+  });
+
+  // NOTE: All chunks refer to fun. Therefore, all of them must have
+  //       finished before an exception is re-thrown.
+  for (size_t chunk = 0; chunk < futures.size(); ++chunk) {
+    try {
+      futures[chunk].get();
+    } catch (...) {
+      exceptions[chunk] = std::current_exception();
+    }
+  }
+
+  detail::rethrow_first(exceptions);
+}
+
+/**
+ * Minimum number of pixels processed by one thread of a per-pixel loop.
+ * Smaller chunks do not amortize the cost of handing them to a thread.
+ */
+constexpr size_t MIN_PIXELS_PER_THREAD = 65536;
+
+namespace detail {
+
+inline size_t min_rows_per_thread(size_t row_length) {
+  return std::max<size_t>(1, MIN_PIXELS_PER_THREAD / std::max<size_t>(1, row_length));
+}
+
+}  // namespace detail
+
+/**
+ * Split the num_pixels pixels of an image with rows of row_length pixels
+ * into chunks of complete rows (at least MIN_PIXELS_PER_THREAD pixels each)
+ * and call fun(pixel_begin, pixel_end) for each chunk concurrently (see
+ * parallel_for()).
+ */
+template<typename Fun>
+void for_each_row_chunk(size_t num_pixels, size_t row_length, Fun &&fun,
+                        size_t num_threads = default_num_workers()) {
+  row_length = std::max<size_t>(1, row_length);
+
+  parallel_for(0, num_pixels / row_length,
+               [&fun, row_length](size_t row_begin, size_t row_end) {
+                 fun(row_begin * row_length, row_end * row_length);
+               },
+               num_threads, detail::min_rows_per_thread(row_length));
+}
+
+/**
+ * Same as above, but the chunks are executed by the workers of thread_pool
+ * and the calling thread. If thread_pool is nullptr, the calling thread
+ * processes all pixels at once.
+ */
+template<typename Fun>
+void for_each_row_chunk(ThreadPool *thread_pool, size_t num_pixels,
+                        size_t row_length, Fun &&fun) {
+  row_length = std::max<size_t>(1, row_length);
+
+  size_t num_rows = num_pixels / row_length;
+
+  if (thread_pool == nullptr) {
+    fun(0, num_rows * row_length);
+    return;
+  }
+
+  parallel_for(*thread_pool, 0, num_rows,
+               [&fun, row_length](size_t row_begin, size_t row_end) {
+                 fun(row_begin * row_length, row_end * row_length);
+               },
+               detail::min_rows_per_thread(row_length));
+}
+
+}  // namespace starmathpp
+
+#endif // STARMATHPP_THREAD_POOL_HPP_
@@ -0,0 +1,185 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "thread pool unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/thread_pool.hpp>
+
+BOOST_AUTO_TEST_SUITE (thread_pool_tests)
+
+using namespace starmathpp;
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(thread_pool_submit_test)
+{
+  ThreadPool thread_pool(4);
+
+  std::vector<std::future<int>> futures;
+
+  for (int i = 0; i < 100; ++i) {
+    futures.push_back(thread_pool.submit([i]() {
+      return i * i;
+    }));
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    BOOST_TEST(futures.at(i).get() == i * i);
+  }
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(thread_pool_exception_test)
+{
+  ThreadPool thread_pool(2);
+
+  auto future = thread_pool.submit([]() -> int {
+    throw std::runtime_error("Task failed.");
+  });
+
+  BOOST_CHECK_THROW(future.get(), std::runtime_error);
+}
+
+/**
+ * The destructor waits until all pending tasks are executed.
+ */
+BOOST_AUTO_TEST_CASE(thread_pool_destructor_drains_tasks_test)
+{
+  std::atomic<int> counter { 0 };
+
+  {
+    ThreadPool thread_pool(3);
+
+    for (int i = 0; i < 50; ++i) {
+      thread_pool.submit([&counter]() {
+        ++counter;
+      });
+    }
+  }
+
+  BOOST_TEST(counter.load() == 50);
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(thread_pool_no_workers_test)
+{
+  BOOST_CHECK_THROW(ThreadPool(0), ThreadPoolException);
+}
+
+/**
+ * parallel_for() on a thread pool covers each index exactly once and can
+ * be called repeatedly with the same pool.
+ */
+BOOST_AUTO_TEST_CASE(thread_pool_parallel_for_test)
+{
+  ThreadPool thread_pool(3);
+
+  for (int run = 0; run < 10; ++run) {
+    std::vector<int> counts(1000, 0);
+
+    parallel_for(thread_pool, 0, counts.size(),
+                 [&counts](size_t begin, size_t end) {
+                   for (size_t idx = begin; idx < end; ++idx) {
+                     ++counts[idx];
+                   }
+                 }, 10 /*min chunk size*/);
+
+    BOOST_TEST(std::count(counts.begin(), counts.end(), 1) == 1000);
+  }
+}
+
+/**
+ * An exception of a chunk is re-thrown after all chunks have finished.
+ */
+BOOST_AUTO_TEST_CASE(thread_pool_parallel_for_exception_test)
+{
+  ThreadPool thread_pool(2);
+  std::atomic<int> num_finished_chunks { 0 };
+
+  BOOST_CHECK_THROW(
+      parallel_for(thread_pool, 0, 3, [&num_finished_chunks](size_t begin, size_t) {
+        ++num_finished_chunks;
+        if (begin == 0) {
+          throw std::runtime_error("Chunk failed.");
+        }
+      }),
+      std::runtime_error);
+
+  BOOST_TEST(num_finished_chunks.load() == 3);
+}
+
+/**
+ * for_each_row_chunk() only passes chunks of complete rows and covers
+ * every pixel once, with new threads, with a pool and without a pool.
+ */
+BOOST_AUTO_TEST_CASE(thread_pool_for_each_row_chunk_test)
+{
+  const size_t row_length = 1000;
+  const size_t num_pixels = 500 * row_length;
+
+  ThreadPool thread_pool(3);
+
+  for (ThreadPool *pool : { (ThreadPool*) nullptr, &thread_pool }) {
+    std::vector<int> counts(num_pixels, 0);
+    std::atomic<int> num_chunks { 0 };
+
+    auto count_pixels = [&](size_t begin, size_t end) {
+      BOOST_TEST(begin % row_length == 0);
+      BOOST_TEST(end % row_length == 0);
+      BOOST_TEST((end - begin >= MIN_PIXELS_PER_THREAD));
+
+      ++num_chunks;
+
+      for (size_t idx = begin; idx < end; ++idx) {
+        ++counts[idx];
+      }
+    };
+
+    for_each_row_chunk(pool, num_pixels, row_length, count_pixels);
+    BOOST_TEST(num_chunks.load() == (pool == nullptr ? 1 : 4));
+
+    for_each_row_chunk(num_pixels, row_length, count_pixels, 4);
+    BOOST_TEST(std::count(counts.begin(), counts.end(), 2) == (long) num_pixels);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -32,11 +32,16 @@
 #include <libstarmathpp/views/divide_by.hpp>
 #include <libstarmathpp/views/center_on_star.hpp>
 #include <libstarmathpp/views/files.hpp>
+#include <libstarmathpp/views/instrument.hpp>
 #include <libstarmathpp/views/interpolate_bad_pixels.hpp>
+#include <libstarmathpp/views/parallel_transform.hpp>
 #include <libstarmathpp/views/scale.hpp>
 #include <libstarmathpp/views/stretch.hpp>
 #include <libstarmathpp/views/subtract_background.hpp>
+#include <libstarmathpp/views/tile.hpp>
+#include <libstarmathpp/views/where_header.hpp>
 #include <libstarmathpp/views/read.hpp>
 #include <libstarmathpp/views/write.hpp>
+#include <libstarmathpp/views/write_behind.hpp>
 
 #endif /* LIBSTARMATHPP_VIEW_HPP_ */
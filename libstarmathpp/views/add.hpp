@@ -39,15 +39,8 @@ struct AddTraits {
     return "add";
   }
 
-  static auto calculate(
-      const cimg_library::CImg<ImageType>&& img1,
-      const cimg_library::CImg<ImageType>& img2) {
-    return img1 + img2;
-  }
-
-  static auto calculate(
-      const cimg_library::CImg<ImageType>&& img1, ImageType scalar_value) {
-    return img1 + scalar_value;
+  static ImageType apply(ImageType a, ImageType b) {
+    return a + b;
   }
 };
 
@@ -59,6 +52,26 @@ auto add(const Image& image_to_add) {
   return arithmetic_function_tmpl<AddTraits, ImageType>(image_to_add);
 }
 
+/**
+ * Same as above, but the image is moved instead of copied
+ * (e.g. add(average(...))).
+ */
+template<typename ImageType = float>
+auto add(Image &&image_to_add) {
+  return arithmetic_function_tmpl<AddTraits, ImageType>(
+      std::move(image_to_add));
+}
+
+/**
+ * Same as above, but the image is shared with the caller, i.e. it is
+ * never copied.
+ */
+template<typename ImageType = float>
+auto add(SharedImage<ImageType> image_to_add) {
+  return arithmetic_function_tmpl<AddTraits, ImageType>(
+      std::move(image_to_add));
+}
+
 /**
  *
  */
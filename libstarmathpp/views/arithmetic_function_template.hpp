@@ -26,13 +26,34 @@
 #ifndef STARMATHPP_PIPELINE_VIEW_ARITHMETIC_FUNCTION_TEMPLATE_H_
 #define STARMATHPP_PIPELINE_VIEW_ARITHMETIC_FUNCTION_TEMPLATE_H_ STARMATHPP_PIPELINE_VIEW_ARITHMETIC_FUNCTION_TEMPLATE_H_
 
+#include <memory>
+#include <sstream>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <range/v3/view/all.hpp>
 #include <range/v3/view/transform.hpp>
+#include <range/v3/view/view.hpp>
 
+#include <libstarmathpp/frame.hpp>
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/image_cutout.hpp>
 #include <libstarmathpp/inconsistent_image_dimensions_exception.hpp>
+#include <libstarmathpp/instrumentation.hpp>
+#include <libstarmathpp/thread_pool.hpp>
 
 #define STARMATHPP_PIPELINE_ARITHMETIC_FUNCTION_DEBUG 0
 
+/**
+ * Number of threads used to evaluate a chain of arithmetic operations on
+ * one image. Images are usually processed in parallel already (see
+ * parallel_transform()). Therefore, the default is 1.
+ */
+#ifndef STARMATHPP_PIPELINE_ARITHMETIC_FUNCTION_NUM_THREADS
+#define STARMATHPP_PIPELINE_ARITHMETIC_FUNCTION_NUM_THREADS 1
+#endif
+
 namespace starmathpp::pipeline::views {
 
 //  TODO: Idea -> Rename this to ImagePipelineException... - use it in all pipeline functions!
@@ -42,22 +63,234 @@ namespace detail {
 
 template<typename ImageType = float>
 void throw_if_inconsistent_image_dimensions(
-    const cimg_library::CImg<ImageType> &&img1,
+    const cimg_library::CImg<ImageType> &img1,
     const cimg_library::CImg<ImageType> &img2) {
 
+  // NOTE: The arithmetic operations are evaluated pixel by pixel. Therefore,
+  //       also the number of slices and channels must match.
   if (img1.width() != img2.width()
-      || img1.height() != img2.height()) {
+      || img1.height() != img2.height()
+      || img1.depth() != img2.depth()
+      || img1.spectrum() != img2.spectrum()) {
     std::stringstream ss;
 
     ss << "Inconsistent images dimensions. Initial image dimension: " << "("
-        << img1.width() << ", " << img1.height() << "), "
+        << img1.width() << ", " << img1.height() << ", " << img1.depth() << ", "
+        << img1.spectrum() << "), "
         << "new image dimension: (" << img2.width() << ", "
-        << img2.height() << ").";
+        << img2.height() << ", " << img2.depth() << ", " << img2.spectrum() << ").";
 
     throw InconsistentImageDimensionsException(ss.str());
   }
 }
 
+/**
+ * Image operand of an arithmetic operation (e.g. the master dark frame
+ * in subtract(master_dark)).
+ *
+ * NOTE: The image is held through a shared, immutable handle. Views and
+ *       view closures are copied frequently by range-v3. Copying the
+ *       operand just copies the handle, not the image. Since the image is
+ *       never modified, it is safe to share it between pipelines and
+ *       threads.
+ */
+template<template<typename> class ArithmeticFunctionTraits, typename ImageType>
+class image_operand {
+ public:
+  explicit image_operand(SharedImage<ImageType> image)
+      :
+      image_(std::move(image)),
+      pixels_(image_->data()) {
+  }
+
+  void check(const cimg_library::CImg<ImageType> &image) const {
+    throw_if_inconsistent_image_dimensions<ImageType>(image, *image_);
+  }
+
+  ImageType operator()(ImageType value, size_t idx) const {
+    return ArithmeticFunctionTraits<ImageType>::apply(value, pixels_[idx]);
+  }
+
+ private:
+  SharedImage<ImageType> image_;
+  const ImageType *pixels_;
+};
+
+/**
+ * Scalar operand of an arithmetic operation (e.g. the factor in
+ * multiply_by(2.0F)).
+ */
+template<template<typename> class ArithmeticFunctionTraits, typename ImageType>
+class scalar_operand {
+ public:
+  explicit scalar_operand(ImageType scalar_value)
+      :
+      scalar_value_(scalar_value) {
+  }
+
+  void check(const cimg_library::CImg<ImageType>& /*image*/) const {
+  }
+
+  ImageType operator()(ImageType value, size_t /*idx*/) const {
+    return ArithmeticFunctionTraits<ImageType>::apply(value, scalar_value_);
+  }
+
+ private:
+  ImageType scalar_value_;
+};
+
+/**
+ * Evaluates a chain of arithmetic operations on an image in a single pass.
+ * Each pixel is loaded once, all operations are applied in order and the
+ * result is stored once in the same place. The loop body is a fold over the operations which
+ * are known at compile time. Therefore, the compiler can inline and
+ * vectorize it.
+ *
+ * NOTE: The operations are shared by all copies of the evaluator, i.e.
+ *       copying the evaluator (which range-v3 does frequently) does not
+ *       copy the image operands.
+ */
+template<typename ImageType, typename ... Ops>
+class arithmetic_evaluator {
+ public:
+  arithmetic_evaluator() = default;
+
+  explicit arithmetic_evaluator(std::tuple<Ops...> ops)
+      :
+      ops_(std::make_shared<const std::tuple<Ops...>>(std::move(ops))) {
+  }
+
+  const std::tuple<Ops...>& ops() const {
+    return *ops_;
+  }
+
+  /**
+   * NOTE: The image is taken by value and the result is calculated in place.
+   *       If the image is moved into the evaluator (which is the case in a
+   *       pipeline), no additional image is allocated.
+   */
+  cimg_library::CImg<ImageType> operator()(
+      cimg_library::CImg<ImageType> image) const {
+
+    STARMATHPP_INSTRUMENT_SCOPE("views::arithmetic");
+    STARMATHPP_INSTRUMENT_PIXELS(image.size());
+
+    std::apply([&](const auto &... op) {
+      (op.check(image), ...);
+    }, *ops_);
+
+    DEBUG_IMAGE_DISPLAY(image, "arithmetic_function_image_in",
+                        STARMATHPP_PIPELINE_ARITHMETIC_FUNCTION_DEBUG);
+
+    evaluate(image.data(), image.size(), static_cast<size_t>(image.width()));
+
+    DEBUG_IMAGE_DISPLAY(image, "arithmetic_function_image_out",
+                        STARMATHPP_PIPELINE_ARITHMETIC_FUNCTION_DEBUG);
+
+    return image;
+  }
+
+  /**
+   * A frame is promoted to ImageType first. If it already has this pixel
+   * type, the image is moved out of the frame.
+   */
+  template<typename FrameType, typename = std::enable_if_t<
+      std::is_same_v<std::decay_t<FrameType>, Frame>>>
+  cimg_library::CImg<ImageType> operator()(FrameType &&frame) const {
+    return (*this)(to_image<ImageType>(std::forward<FrameType>(frame)));
+  }
+
+ private:
+  std::shared_ptr<const std::tuple<Ops...>> ops_;
+
+  void evaluate(ImageType *pixels, size_t num_pixels, size_t row_length) const {
+    for_each_row_chunk(num_pixels, row_length, [&](size_t begin, size_t end) {
+      std::apply([&](const auto &... op) {
+        for (size_t idx = begin; idx < end; ++idx) {
+          ImageType value = pixels[idx];
+          ((value = op(value, idx)), ...);
+          pixels[idx] = value;
+        }
+      }, *ops_);
+    }, STARMATHPP_PIPELINE_ARITHMETIC_FUNCTION_NUM_THREADS);
+  }
+};
+
+/**
+ * View which applies a chain of arithmetic operations to each image of
+ * the underlying range. In addition to a plain transform view, it keeps
+ * the operations, so that a subsequent arithmetic operation can be appended
+ * to the chain instead of creating another full-size intermediate image.
+ */
+template<typename Rng, typename ImageType, typename ... Ops>
+class arithmetic_view : public ranges::transform_view<Rng,
+    arithmetic_evaluator<ImageType, Ops...>> {
+
+  using evaluator_type = arithmetic_evaluator<ImageType, Ops...>;
+  using base_type = ranges::transform_view<Rng, evaluator_type>;
+
+ public:
+  using image_type = ImageType;
+
+  arithmetic_view() = default;
+
+  arithmetic_view(Rng rng, evaluator_type evaluator)
+      :
+      base_type(std::move(rng), evaluator),
+      evaluator_(evaluator) {
+  }
+
+  const evaluator_type& evaluator() const {
+    return evaluator_;
+  }
+
+ private:
+  evaluator_type evaluator_;
+};
+
+/**
+ * True, if T is an arithmetic_view which operates on images of ImageType.
+ */
+template<typename T, typename ImageType>
+struct is_arithmetic_view : std::false_type {
+};
+
+template<typename Rng, typename ImageType, typename ... Ops>
+struct is_arithmetic_view<arithmetic_view<Rng, ImageType, Ops...>, ImageType> : std::true_type {
+};
+
+template<typename ImageType, typename ... Ops>
+auto make_arithmetic_evaluator(std::tuple<Ops...> ops) {
+  return arithmetic_evaluator<ImageType, Ops...>(std::move(ops));
+}
+
+template<typename Rng, typename ImageType, typename ... Ops>
+auto make_arithmetic_view_from(Rng rng,
+                               arithmetic_evaluator<ImageType, Ops...> evaluator) {
+  return arithmetic_view<Rng, ImageType, Ops...>(std::move(rng),
+                                                 std::move(evaluator));
+}
+
+/**
+ * Apply the arithmetic operation op to each image of rng. If rng itself is
+ * a chain of arithmetic operations, op is appended to that chain. This way,
+ * e.g. subtract(dark) | divide_by(flat) | multiply_by(k) reads and writes
+ * each image only once.
+ */
+template<typename ImageType, typename Op, typename Rng>
+auto make_arithmetic_view(Rng &&rng, const Op &op) {
+  if constexpr (is_arithmetic_view<std::decay_t<Rng>, ImageType>::value) {
+    return make_arithmetic_view_from(
+        rng.base(),
+        make_arithmetic_evaluator<ImageType>(
+            std::tuple_cat(rng.evaluator().ops(), std::make_tuple(op))));
+  } else {
+    return make_arithmetic_view_from(
+        ranges::views::all(std::forward<Rng>(rng)),
+        make_arithmetic_evaluator<ImageType>(std::make_tuple(op)));
+  }
+}
+
 }  // namespace detail
 
 /**
@@ -65,25 +298,34 @@ void throw_if_inconsistent_image_dimensions(
  */
 template<template<typename ImageType = float> class ArithmeticFunctionTraits,
     typename ImageType = float>
-auto arithmetic_function_tmpl(const Image &image_op) {
-  return ranges::views::transform(
-      [=](const cimg_library::CImg<ImageType> &&image) {
-
-        detail::throw_if_inconsistent_image_dimensions<ImageType>(
-            std::move(image), image_op);
-
-        DEBUG_IMAGE_DISPLAY(image, "arithmetic_function_image_in",
-                            STARMATHPP_PIPELINE_ARITHMETIC_FUNCTION_DEBUG);
-
-        auto result_image = ArithmeticFunctionTraits<ImageType>::calculate(
-            std::move(image), image_op);
+auto arithmetic_function_tmpl(SharedImage<ImageType> image_op) {
+  return ranges::make_view_closure(
+      [op = detail::image_operand<ArithmeticFunctionTraits, ImageType>(
+          std::move(image_op))](auto &&rng) {
+        return detail::make_arithmetic_view<ImageType>(
+            std::forward<decltype(rng)>(rng), op);
+      });
+}
 
-        DEBUG_IMAGE_DISPLAY(result_image, "arithmetic_function_image_out",
-                            STARMATHPP_PIPELINE_ARITHMETIC_FUNCTION_DEBUG);
+/**
+ * Same as above. The image is moved into a shared handle, i.e. it is
+ * not copied (e.g. subtract(average(...))).
+ */
+template<template<typename ImageType = float> class ArithmeticFunctionTraits,
+    typename ImageType = float>
+auto arithmetic_function_tmpl(cimg_library::CImg<ImageType> &&image_op) {
+  return arithmetic_function_tmpl<ArithmeticFunctionTraits, ImageType>(
+      make_shared_image(std::move(image_op)));
+}
 
-        return result_image;
-      }
-  );
+/**
+ * Same as above. The image is copied once into a shared handle.
+ */
+template<template<typename ImageType = float> class ArithmeticFunctionTraits,
+    typename ImageType = float>
+auto arithmetic_function_tmpl(const cimg_library::CImg<ImageType> &image_op) {
+  return arithmetic_function_tmpl<ArithmeticFunctionTraits, ImageType>(
+      make_shared_image(cimg_library::CImg<ImageType>(image_op)));
 }
 
 /**
@@ -92,21 +334,12 @@ auto arithmetic_function_tmpl(const Image &image_op) {
 template<template<typename ImageType> class ArithmeticFunctionTraits,
     typename ImageType = float>
 auto arithmetic_function_tmpl(ImageType scalar_value) {
-  return ranges::views::transform(
-      [=](const cimg_library::CImg<ImageType> &&image) {
-
-        DEBUG_IMAGE_DISPLAY(*image, "arithmetic_function_scalar_in",
-                            STARMATHPP_PIPELINE_ARITHMETIC_FUNCTION_DEBUG);
-
-        auto result_image = ArithmeticFunctionTraits<ImageType>::calculate(
-            std::move(image), scalar_value);
-
-        DEBUG_IMAGE_DISPLAY(result_image, "arithmetic_function_scalar_out",
-                            STARMATHPP_PIPELINE_ARITHMETIC_FUNCTION_DEBUG);
-
-        return result_image;
-      }
-  );
+  return ranges::make_view_closure(
+      [op = detail::scalar_operand<ArithmeticFunctionTraits, ImageType>(scalar_value)](
+          auto &&rng) {
+        return detail::make_arithmetic_view<ImageType>(
+            std::forward<decltype(rng)>(rng), op);
+      });
 }
 
 }  // namespace starmathpp::pipeline::views
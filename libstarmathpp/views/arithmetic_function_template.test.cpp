@@ -0,0 +1,144 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "pipeline view arithmetic function template unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <tuple>
+#include <type_traits>
+
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/single.hpp>
+#include <range/v3/view/move.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/views/add.hpp>
+#include <libstarmathpp/views/subtract.hpp>
+#include <libstarmathpp/views/multiply_by.hpp>
+#include <libstarmathpp/views/divide_by.hpp>
+#include <libstarmathpp/inconsistent_image_dimensions_exception.hpp>
+
+BOOST_AUTO_TEST_SUITE (pipeline_arithmetic_function_template_tests)
+
+using namespace starmathpp;
+using namespace ranges;
+
+/**
+ * Test if a chain of arithmetic operations results in the expected
+ * pixel values, i.e. the operations are applied in the given order.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_arithmetic_chain_test)
+{
+  std::vector<Image> input_images = {
+    Image(5, 5, 1, 1, 13),  // 5x5 - All pixels have value 13
+    Image(5, 5, 1, 1, 7)    // 5x5 - All pixels have value 7
+  };
+
+  Image dark(5, 5, 1, 1, 3);
+  Image flat(5, 5, 1, 1, 2);
+
+  // (13 - 3) / 2 * 3 + 1 = 16, (7 - 3) / 2 * 3 + 1 = 7
+  std::vector<Image> expected_result_images = {
+    Image(5, 5, 1, 1, 16),
+    Image(5, 5, 1, 1, 7)
+  };
+
+  auto result_images = input_images
+      | ranges::views::move
+      | pipeline::views::subtract(dark)
+      | pipeline::views::divide_by(flat)
+      | pipeline::views::multiply_by(3.0F)
+      | pipeline::views::add(1.0F)
+      | to<std::vector>();
+
+  BOOST_TEST(result_images.size() == 2);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result_images.begin(), result_images.end(),
+      expected_result_images.begin(), expected_result_images.end());
+}
+
+/**
+ * Test if consecutive arithmetic operations are fused into one view
+ * which evaluates all operations in a single pass.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_arithmetic_chain_is_fused_test)
+{
+  std::vector<Image> input_images = { Image(5, 5, 1, 1, 13) };
+
+  auto result_view = input_images
+      | ranges::views::move
+      | pipeline::views::subtract(Image(5, 5, 1, 1, 3))
+      | pipeline::views::divide_by(2.0F)
+      | pipeline::views::multiply_by(3.0F);
+
+  using view_type = std::decay_t<decltype(result_view)>;
+
+  BOOST_TEST((pipeline::views::detail::is_arithmetic_view<view_type, float>::value));
+  BOOST_TEST(std::tuple_size_v<std::decay_t<decltype(result_view.evaluator().ops())>> == 3);
+}
+
+/**
+ * Test if a chain which is interrupted by a non-arithmetic view still
+ * results in the expected pixel values.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_arithmetic_chain_with_other_view_test)
+{
+  std::vector<Image> input_images = { Image(5, 5, 1, 1, 13) };
+
+  auto result_images = input_images
+      | ranges::views::move
+      | pipeline::views::subtract(3.0F)
+      | ranges::views::transform([](const Image &image) {
+          return Image(image.width(), image.height(), 1, 1, image(0, 0) * 2);
+        })
+      | pipeline::views::add(1.0F)
+      | to<std::vector>();
+
+  BOOST_TEST(result_images.size() == 1);
+  BOOST_TEST(result_images.at(0) == Image(5, 5, 1, 1, 21));
+}
+
+/**
+ * Test if an image operand with different dimensions somewhere in the
+ * chain fails with an exception.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_arithmetic_chain_different_image_sizes_test)
+{
+  Image image_5x5_value9(5, 5, 1, 1, 9);
+  Image image_4x4_value2(4, 4, 1, 1, 2);
+
+  BOOST_CHECK_THROW(ranges::views::single(image_5x5_value9)
+      | ranges::views::move
+      | pipeline::views::subtract(1.0F)
+      | pipeline::views::divide_by(image_4x4_value2)
+      | to<std::vector>(),
+      starmathpp::InconsistentImageDimensionsException);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
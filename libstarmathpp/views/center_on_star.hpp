@@ -27,6 +27,7 @@
 #define STARMATHPP_PIPELINE_VIEW_CENTER_ON_STAR_HPP_ STARMATHPP_PIPELINE_VIEW_CENTER_ON_STAR_HPP_
 
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/instrumentation.hpp>
 #include <libstarmathpp/rect.hpp>
 
 #include <libstarmathpp/algorithm/centroid/centroider.hpp>
@@ -45,7 +46,10 @@ template<typename ImageType = float>
 auto center_on_star(
     const starmathpp::algorithm::Centroider<ImageType> &centroider) {
   return ranges::views::transform(
-      [&](const cimg_library::CImg<ImageType> &&input_image) {
+      [&](const cimg_library::CImg<ImageType> &input_image) {
+
+        STARMATHPP_INSTRUMENT_SCOPE("views::center_on_star");
+        STARMATHPP_INSTRUMENT_PIXELS(input_image.size());
 
         auto opt_centroid = centroider.calculate_centroid(input_image);
 
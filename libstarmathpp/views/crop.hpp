@@ -31,6 +31,8 @@
 #include <range/v3/view/join.hpp>
 
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/image_cutout.hpp>
+#include <libstarmathpp/instrumentation.hpp>
 #include <libstarmathpp/point.hpp>
 #include <libstarmathpp/rect.hpp>
 #include <libstarmathpp/size.hpp>
@@ -46,11 +48,13 @@ namespace detail {
 template<typename CropRegionRng, typename ImageType = float>
 static auto
 crop_internal(const CropRegionRng crop_regions,
-              const cimg_library::CImg<ImageType> &&image) {
+              const cimg_library::CImg<ImageType> &image) {
 
+  // NOTE: The crop regions are evaluated immediately. Therefore, the image
+  //       can be captured by reference instead of copying it.
   return crop_regions
       | ranges::view::transform(
-          [=](const auto &crop_region) {
+          [&](const auto &crop_region) {
 
             // See https://github.com/GreycLab/CImg/issues/110
             return image.get_crop(
@@ -63,29 +67,26 @@ crop_internal(const CropRegionRng crop_regions,
 }
 }  // namespace detail
 
+/**
+ * Crop the stars detected by detect_stars(). Per frame, a std::vector
+ * of ImageCutout (one per star) is returned.
+ */
 template<typename ImageType = float>
 auto
 crop() {
   return ranges::view::transform(
       [=](const auto &imageRectsPair) {
-        auto img = imageRectsPair.first;
-        //const std::vector<RectT<int>> & cropRects = imageRectsPair->second;
-
-        // TODO: Fix below...
-//	      				return cropInternal(cropRects, img); // std::vector<std::unique_ptr<cimg_library::CImg<ImageType>>>
+        const SharedImage<ImageType> &img = imageRectsPair.first;
 
+        // NOTE: The cutouts just refer to the shared frame. The pixels are
+        //       only copied when a cutout is materialized, i.e. when it is
+        //       passed to the next view. The frame is released as soon as the
+        //       last of its cutouts was materialized.
         return imageRectsPair.second
             | ranges::view::transform(
-                [=](const auto &crop_region) {
-
-                  //LOG(debug) << "Cropping region " << crop_region << std::endl;
-
-                  // See https://github.com/GreycLab/CImg/issues/110
-                  return img.get_crop(
-                          crop_region.x() /*x0*/, crop_region.y() /*y0*/,
-                          crop_region.x() + crop_region.width() - 1/*x1*/,
-                          crop_region.y() + crop_region.height() - 1/*y1*/
-                          );
+                [&](const auto &crop_region) {
+                  return ImageCutout<ImageType>(
+                      img, crop_region.template to<int>());
                 }
             ) | ranges::to<std::vector>();
 
@@ -98,8 +99,8 @@ crop() {
 template<typename CropRegionRng, typename ImageType = float>
 auto crop(const CropRegionRng &crop_regions) {
   return ranges::view::transform(
-      [=](const cimg_library::CImg<ImageType> &&image) {
-        return detail::crop_internal(crop_regions, std::move(image));
+      [=](const cimg_library::CImg<ImageType> &image) {
+        return detail::crop_internal(crop_regions, image);
       });
 }
 
@@ -109,9 +110,9 @@ auto crop(const CropRegionRng &crop_regions) {
 template<typename ImageType = float>
 auto crop(const Rect<int> &crop_region) {
   return ranges::view::transform(
-      [=](const cimg_library::CImg<ImageType> &&image) {
+      [=](const cimg_library::CImg<ImageType> &image) {
         return detail::crop_internal(ranges::view::single(crop_region),
-                                     std::move(image)).at(0);
+                                     image).at(0);
       });
 }
 
@@ -121,7 +122,10 @@ auto crop(const Rect<int> &crop_region) {
 template<typename ImageType = float>
 auto crop_from_center(const Size<int> &crop_region) {
   return ranges::view::transform(
-      [&](const cimg_library::CImg<ImageType> &&image) {
+      [=](const cimg_library::CImg<ImageType> &image) {
+
+        STARMATHPP_INSTRUMENT_SCOPE("views::crop_from_center");
+        STARMATHPP_INSTRUMENT_PIXELS(image.size());
 
         DEBUG_IMAGE_DISPLAY(image, "crop_from_center_in",
                             STARMATHPP_PIPELINE_CROP_DEBUG);
@@ -164,4 +164,39 @@ BOOST_AUTO_TEST_CASE(pipeline_crop_on_image_test)
   BOOST_TEST(is_almost_equal(cropped_images.at(2), expected_result_image_3, 0.00001));
 }
 
+/**
+ * range<pair<frame, rects>>  -->  crop()  --> range < vector <cutout> >
+ *
+ * Test if crop() returns cutouts which refer to the shared frame (as
+ * returned by detect_stars()) and if the frame is released as soon as
+ * the last cutout was materialized.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_crop_detected_stars_test)
+{
+  auto frame = make_shared_image(
+      generate_test_image(25, 25, 5, 5, 250, 65535.0F));
+  std::weak_ptr<const Image> weak_frame = frame;
+
+  std::vector<Rect<unsigned int>> rects = { Rect<unsigned int>(0, 0, 9, 9),
+      Rect<unsigned int>(11, 11, 9, 9) };
+
+  auto cutouts_per_frame = view::single(std::make_pair(std::move(frame), rects))
+      | ranges::views::move
+      | crop()
+      | to<std::vector>();
+
+  BOOST_TEST(cutouts_per_frame.size() == 1);
+  BOOST_TEST(cutouts_per_frame.at(0).size() == 2);
+  BOOST_TEST(!weak_frame.expired());
+
+  Image cropped_image_1 = std::move(cutouts_per_frame.at(0).at(0));
+  BOOST_TEST(!weak_frame.expired());
+
+  Image cropped_image_2 = std::move(cutouts_per_frame.at(0).at(1));
+  BOOST_TEST(weak_frame.expired());
+
+  BOOST_TEST(is_almost_equal(cropped_image_1, generate_test_image(9, 9, 5, 5, 250, 65535.0F), 0.00001));
+  BOOST_TEST(is_almost_equal(cropped_image_2, generate_test_image(9, 9, 5, 5, 250, 250), 0.00001));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
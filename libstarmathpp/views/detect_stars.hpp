@@ -30,6 +30,8 @@
 #include <range/v3/view/transform.hpp>
 
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/image_cutout.hpp>
+#include <libstarmathpp/instrumentation.hpp>
 
 #include <libstarmathpp/algorithm/star_cluster_algorithm.hpp>
 #include <libstarmathpp/algorithm/threshold/thresholder.hpp>
@@ -41,7 +43,11 @@
 namespace starmathpp::pipeline::views {
 
 /**
+ * Detect the stars of each image. The image is moved into the returned
+ * pair of image and star regions (see crop()).
  *
+ * NOTE: Since the image is taken by value, a moved frame is consumed by the
+ *       first read. Read each element once (see scale()).
  */
 template<typename ImageType = float>
 auto detect_stars(
@@ -50,14 +56,17 @@ auto detect_stars(
     unsigned int border) {
 
   return ranges::views::transform(
-      [=, &thresholder](const cimg_library::CImg<ImageType> &&image) {
+      [=, &thresholder](cimg_library::CImg<ImageType> image) {
+
+        STARMATHPP_INSTRUMENT_SCOPE("views::detect_stars");
+        STARMATHPP_INSTRUMENT_PIXELS(image.size());
 
         DEBUG_IMAGE_DISPLAY(image, "detect_stars_in",
                             STARMATHPP_PIPELINE_DETECT_STARS_DEBUG);
 
         // TODO: Do not hardcode bit depth 16.... make it part of ImageT?
         float threshold = std::ceil(
-            thresholder.calculate_threshold(std::move(image)));
+            thresholder.calculate_threshold(image));
 
         // NOTE: CImg threshold function uses >=
         auto binary_img = image.get_threshold(threshold + 1.0F);
@@ -74,7 +83,11 @@ auto detect_stars(
               return pixel_cluster.get_bounds().expand_to_square().grow(border);
             }) | ranges::to<std::vector>();
 
-        return std::make_pair(std::move(image), rects_vec);
+        // NOTE: The frame is passed on as shared, immutable handle. This way,
+        //       the cutouts of the stars (see crop()) refer to this frame
+        //       instead of copying it.
+        return std::make_pair(make_shared_image(std::move(image)),
+                              std::move(rects_vec));
       }
   );
 }
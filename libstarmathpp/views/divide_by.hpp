@@ -39,17 +39,8 @@ struct DivideByTraits {
     return "divide";
   }
 
-  static auto calculate(
-      const cimg_library::CImg<ImageType>&& img1,
-      const cimg_library::CImg<ImageType>& img2) {
-
-    return img1.get_div(img2);
-  }
-
-  static auto calculate(
-      const cimg_library::CImg<ImageType>&& img1,
-      ImageType scalar_value) {
-    return img1 / scalar_value;
+  static ImageType apply(ImageType a, ImageType b) {
+    return a / b;
   }
 };
 
@@ -61,6 +52,26 @@ auto divide_by(const Image &image_divisor_ptr) {
   return arithmetic_function_tmpl<DivideByTraits, ImageType>(image_divisor_ptr);
 }
 
+/**
+ * Same as above, but the image is moved instead of copied
+ * (e.g. divide_by(average(...))).
+ */
+template<typename ImageType = float>
+auto divide_by(Image &&image_divisor) {
+  return arithmetic_function_tmpl<DivideByTraits, ImageType>(
+      std::move(image_divisor));
+}
+
+/**
+ * Same as above, but the image is shared with the caller, i.e. it is
+ * never copied.
+ */
+template<typename ImageType = float>
+auto divide_by(SharedImage<ImageType> image_divisor) {
+  return arithmetic_function_tmpl<DivideByTraits, ImageType>(
+      std::move(image_divisor));
+}
+
 /**
  *
  */
@@ -73,6 +73,29 @@ BOOST_AUTO_TEST_CASE(pipeline_divide_by_image_test)
       expected_result_images.begin(), expected_result_images.end());
 }
 
+/**
+ * Test if 16 bit frames are promoted to float before they are divided.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_divide_by_frame_test)
+{
+  std::vector<Frame> input_frames = {
+    Frame(Image16(5, 5, 1, 1, 13)),  // 5x5 - 16 bit, all pixels have value 13
+    Frame(Image(5, 5, 1, 1, -10))    // 5x5 - float, all pixels have value -10
+  };
+
+  std::vector<Image> expected_result_images = { Image(5, 5, 1, 1, 6.5F),
+      Image(5, 5, 1, 1, -5) };
+
+  auto result_images = input_frames
+      | ranges::views::move
+      | pipeline::views::divide_by(Image(5, 5, 1, 1, 2))
+      | to<std::vector>();
+
+  BOOST_TEST(result_images.size() == 2);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result_images.begin(), result_images.end(),
+      expected_result_images.begin(), expected_result_images.end());
+}
+
 /**
  * Test if dividing an image by a scalar value works.
  */
@@ -26,12 +26,15 @@
 #ifndef STARMATHPP_PIPELINE_VIEW_FILES_HPP_
 #define STARMATHPP_PIPELINE_VIEW_FILES_HPP_ STARMATHPP_PIPELINE_VIEW_FILES_HPP_
 
+#include <memory>
 #include <regex>
 
 #include <range/v3/view/filter.hpp>
+#include <range/v3/view/iota.hpp>
 #include <range/v3/view/transform.hpp>
 #include <range/v3/iterator_range.hpp>
 
+#include <libstarmathpp/io/file_scanner.hpp>
 #include <libstarmathpp/io/filesystem_wrapper.hpp>
 
 namespace starmathpp::pipeline::views {
@@ -72,6 +75,21 @@ auto files_internal(const std::string &root_path,
       });
 }
 
+/**
+ * The scanned list is shared by all copies of the view.
+ */
+inline auto scanned_files_internal(const std::string &root_path,
+                                   const io::FileMatcher &matcher,
+                                   const io::ScanOptions &options) {
+  auto filepaths = std::make_shared<const std::vector<fs::path>>(
+      io::scan_files(root_path, matcher, options));
+
+  return ranges::views::iota(size_t(0), filepaths->size())
+      | ranges::views::transform([filepaths](size_t idx) {
+        return (*filepaths)[idx].string();
+      });
+}
+
 }
 
 /**
@@ -97,6 +115,33 @@ auto files(const std::string &root_path,
   return detail::files_internal(root_path, extension_regex);
 }
 
+/**
+ * Return the filenames of all files in each root path (and, by default,
+ * all sub-directories) whose name matches the matcher. The directories
+ * are scanned in parallel and the filenames are returned in natural order
+ * (see io::scan_files()).
+ *
+ * Usage:
+ *
+ * auto images = files("lights", io::FileMatcher::glob("light_*.fit*"))
+ *     | read();
+ */
+inline auto files(const io::FileMatcher &matcher,
+                  const io::ScanOptions &options = io::ScanOptions()) {
+  return ranges::views::transform([=](const std::string &root_path) {
+    return detail::scanned_files_internal(root_path, matcher, options);
+  });
+}
+
+/**
+ *
+ */
+inline auto files(const std::string &root_path,
+                  const io::FileMatcher &matcher,
+                  const io::ScanOptions &options = io::ScanOptions()) {
+  return detail::scanned_files_internal(root_path, matcher, options);
+}
+
 }  // namespace starmathpp::pipeline::views
 
 #endif // STARMATHPP_PIPELINE_VIEW_FILES_HPP_
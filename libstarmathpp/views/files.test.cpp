@@ -30,6 +30,8 @@
 #define BOOST_TEST_DYN_LINK
 
 #include <set>
+#include <string>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -183,4 +185,43 @@ BOOST_AUTO_TEST_CASE(pipeline_files_rootpath_and_extension_test)
     BOOST_TEST(diff.empty());
 }
 
+/**
+ * The scanner descends into sub-directories and returns the files in
+ * natural order.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_files_scanner_test)
+{
+    const std::vector<std::string> expectedFilenames {
+            "test_data/pipeline/files/folder1/tiff_file_3.tiff",
+            "test_data/pipeline/files/tiff_file_1.tiff",
+            "test_data/pipeline/files/tiff_file_2.tiff"
+    };
+
+    const std::vector<std::string> filePaths { "test_data/pipeline/files" };
+
+    auto results =
+            filePaths
+              | starmathpp::pipeline::views::files(io::FileMatcher::extensions({ ".tiff" }))
+              | ranges::views::join
+              | to<std::vector>();
+
+    BOOST_TEST(results == expectedFilenames, boost::test_tools::per_element());
+
+    io::ScanOptions options;
+    options.recursive = false;
+
+    auto topLevelResults =
+              starmathpp::pipeline::views::files("test_data/pipeline/files",
+                                                 io::FileMatcher::glob("fits file*"),
+                                                 options)
+              | to<std::vector>();
+
+    const std::vector<std::string> expectedTopLevelFilenames {
+            "test_data/pipeline/files/fits file with spaces 1.fits",
+            "test_data/pipeline/files/fits file with spaces 2.fits"
+    };
+
+    BOOST_TEST(topLevelResults == expectedTopLevelFilenames, boost::test_tools::per_element());
+}
+
 BOOST_AUTO_TEST_SUITE_END();
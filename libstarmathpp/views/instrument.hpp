@@ -0,0 +1,174 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_PIPELINE_VIEW_INSTRUMENT_HPP_
+#define STARMATHPP_PIPELINE_VIEW_INSTRUMENT_HPP_ STARMATHPP_PIPELINE_VIEW_INSTRUMENT_HPP_
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <range/v3/view/all.hpp>
+#include <range/v3/view/facade.hpp>
+#include <range/v3/view/view.hpp>
+
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/instrumentation.hpp>
+
+namespace starmathpp::pipeline::views {
+
+namespace detail {
+
+/**
+ * Number of pixels of an element which passes an instrument() view.
+ * Elements which are not images are counted as 0 pixels.
+ */
+template<typename T>
+size_t num_pixels(const T& /*element*/) {
+  return 0;
+}
+
+template<typename ImageType>
+size_t num_pixels(const cimg_library::CImg<ImageType> &image) {
+  return image.size();
+}
+
+#if STARMATHPP_INSTRUMENTATION_ENABLED
+
+/**
+ * View which records one event per element of the underlying range.
+ *
+ * The event covers the evaluation of the element, i.e. the time spent
+ * in all lazy views (read(), subtract(), ...) in front of this view.
+ */
+template<typename Rng>
+class instrument_view : public ranges::view_facade<instrument_view<Rng>,
+    ranges::unknown> {
+
+  friend ranges::range_access;
+
+  using reference = ranges::range_reference_t<Rng>;
+
+  struct cursor {
+    using single_pass = std::bool_constant<!ranges::forward_range<Rng>>;
+
+    ranges::iterator_t<Rng> it_;
+    ranges::sentinel_t<Rng> end_;
+    std::shared_ptr<const std::string> name_;
+
+    // Set after the current element was recorded. A view in front of this
+    // one (e.g. a filter) may dereference the same element again.
+    mutable bool recorded_ = false;
+
+    reference read() const {
+      if (recorded_) {
+        return *it_;
+      }
+      recorded_ = true;
+
+      STARMATHPP_INSTRUMENT_SCOPE(*name_);
+
+      reference element = *it_;
+
+      STARMATHPP_INSTRUMENT_PIXELS(num_pixels(element));
+
+      if constexpr (std::is_reference_v<reference>) {
+        return static_cast<reference>(element);
+      } else {
+        return element;
+      }
+    }
+
+    void next() {
+      ++it_;
+      recorded_ = false;
+    }
+
+    [[nodiscard]] bool equal(ranges::default_sentinel_t) const {
+      return it_ == end_;
+    }
+
+    [[nodiscard]] bool equal(const cursor &other) const {
+      return it_ == other.it_;
+    }
+  };
+
+  Rng base_;
+  std::shared_ptr<const std::string> name_;
+
+  cursor begin_cursor() {
+    return cursor { ranges::begin(base_), ranges::end(base_), name_ };
+  }
+
+ public:
+  instrument_view() = default;
+
+  instrument_view(Rng base, std::string name)
+      :
+      base_(std::move(base)),
+      name_(std::make_shared<const std::string>(std::move(name))) {
+  }
+};
+
+#endif
+
+}  // namespace detail
+
+/**
+ * Record the wall time, the number of pixels, the allocated bytes and the
+ * thread of each element which passes this view. The recorded events are
+ * available through starmathpp::instrumentation::Recorder.
+ *
+ * NOTE: The measured time includes all lazy views in front of this view
+ *       up to the previous instrument() view (inclusive).
+ * NOTE: If instrumentation is disabled (INSTRUMENTATION_SWITCH not defined),
+ *       the elements are passed through unchanged and nothing is recorded.
+ *
+ * Usage:
+ *
+ * auto images = files("lights", "(.*\\.fit\\.gz)")
+ *               | read()
+ *               | instrument("read")
+ *               | subtract(master_dark)
+ *               | instrument("calibrate")
+ *               | to<std::vector>();
+ */
+inline auto instrument(std::string name) {
+  return ranges::make_view_closure([name = std::move(name)](auto &&rng) {
+    using Rng = decltype(rng);
+
+#if STARMATHPP_INSTRUMENTATION_ENABLED
+    return detail::instrument_view<ranges::views::all_t<Rng>>(
+        ranges::views::all(std::forward<Rng>(rng)), name);
+#else
+    return ranges::views::all(std::forward<Rng>(rng));
+#endif
+  });
+}
+
+}  // namespace starmathpp::pipeline::views
+
+#endif // STARMATHPP_PIPELINE_VIEW_INSTRUMENT_HPP_
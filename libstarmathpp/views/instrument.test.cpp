@@ -0,0 +1,134 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "pipeline view instrument unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+// NOTE: The instrumentation is tested independent of the build option.
+#ifndef INSTRUMENTATION_SWITCH
+#define INSTRUMENTATION_SWITCH
+#endif
+
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/move.hpp>
+
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/instrumentation.hpp>
+#include <libstarmathpp/views/instrument.hpp>
+#include <libstarmathpp/views/add.hpp>
+#include <libstarmathpp/floating_point_equality.hpp>
+
+BOOST_AUTO_TEST_SUITE (pipeline_views_instrument_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::pipeline::views;
+using namespace starmathpp::instrumentation;
+using namespace ranges;
+
+/**
+ * Test that instrument() passes the elements through and records one
+ * event per element. The built-in probe of add() is recorded as well.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_instrument_test)
+{
+  Recorder::instance().clear();
+
+  std::vector<Image> images = { Image(10, 10, 1, 1, 1.0F), Image(10, 10, 1, 1,
+                                                                 2.0F) };
+
+  auto result_images = images
+      | ranges::views::move
+      | add(Image(10, 10, 1, 1, 1.0F))
+      | instrument("calibrate")
+      | to<std::vector>();
+
+  BOOST_TEST(result_images.size() == 2);
+  BOOST_TEST(is_almost_equal(result_images.at(0), Image(10, 10, 1, 1, 2.0F), 0.00001));
+  BOOST_TEST(is_almost_equal(result_images.at(1), Image(10, 10, 1, 1, 3.0F), 0.00001));
+
+  size_t num_calibrate_events = 0;
+  size_t num_arithmetic_events = 0;
+
+  for (const auto &event : Recorder::instance().events()) {
+    if (event.name == "calibrate") {
+      ++num_calibrate_events;
+      BOOST_TEST(event.num_pixels == 100);
+    } else if (event.name == "views::arithmetic") {
+      ++num_arithmetic_events;
+    }
+  }
+
+  BOOST_TEST(num_calibrate_events == 2);
+  BOOST_TEST(num_arithmetic_events == 2);
+}
+
+/**
+ * Test that elements which are referenced by the underlying range are
+ * not copied by instrument().
+ */
+BOOST_AUTO_TEST_CASE(pipeline_instrument_reference_test)
+{
+  Recorder::instance().clear();
+
+  std::vector<Image> images = { Image(10, 10, 1, 1, 1.0F) };
+
+  auto instrumented = images | instrument("reference");
+
+  BOOST_TEST(&(*ranges::begin(instrumented)) == &images.at(0));
+  BOOST_TEST(Recorder::instance().events().size() == 1);
+}
+
+/**
+ * Test that dereferencing the same element more than once records only
+ * one event per element.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_instrument_repeated_read_test)
+{
+  Recorder::instance().clear();
+
+  std::vector<Image> images = { Image(10, 10, 1, 1, 1.0F), Image(10, 10, 1, 1,
+                                                                 2.0F) };
+
+  auto instrumented = images | instrument("repeated");
+
+  auto it = ranges::begin(instrumented);
+  BOOST_TEST((*it)(0, 0) == 1.0F);
+  BOOST_TEST((*it)(0, 0) == 1.0F);
+  BOOST_TEST(Recorder::instance().events().size() == 1);
+
+  ++it;
+  BOOST_TEST((*it)(0, 0) == 2.0F);
+  BOOST_TEST((*it)(0, 0) == 2.0F);
+  BOOST_TEST(Recorder::instance().events().size() == 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -29,6 +29,7 @@
 #include <range/v3/view/transform.hpp>
 
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/instrumentation.hpp>
 #include <libstarmathpp/algorithm/bad_pixel_median_interpolator.hpp>
 
 #define STARMATHPP_INTERPOLATE_BAD_PIXELS_DEBUG 0
@@ -60,7 +61,10 @@ auto interpolate_bad_pixels(
     starmathpp::algorithm::BadPixelMedianInterpolator::ThresholdDirection::TypeE threshold_direction =
         starmathpp::algorithm::BadPixelMedianInterpolator::ThresholdDirection::BOTH) {
   return ranges::views::transform(
-      [=](const cimg_library::CImg<ImageType>&& image) {
+      [=](const cimg_library::CImg<ImageType> &image) {
+
+        STARMATHPP_INSTRUMENT_SCOPE("views::interpolate_bad_pixels");
+        STARMATHPP_INSTRUMENT_PIXELS(image.size());
 
         DEBUG_IMAGE_DISPLAY(image, "interpolate_bad_pixels_in",
                             STARMATHPP_INTERPOLATE_BAD_PIXELS_DEBUG);
@@ -69,9 +73,9 @@ auto interpolate_bad_pixels(
             absolute_detection_threshold, filter_core_size,
             threshold_direction);
 
-        auto result_image = bad_pixel_median_interpolator.interpolate(std::move(image));
+        auto result_image = bad_pixel_median_interpolator.interpolate(image);
 
-        DEBUG_IMAGE_DISPLAY(*result_image, "interpolate_bad_pixels_out",
+        DEBUG_IMAGE_DISPLAY(result_image, "interpolate_bad_pixels_out",
                             STARMATHPP_INTERPOLATE_BAD_PIXELS_DEBUG);
 
         return result_image;
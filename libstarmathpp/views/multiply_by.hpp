@@ -39,16 +39,8 @@ struct MultiplyByTraits {
     return "multiply";
   }
 
-  static auto calculate(
-      const cimg_library::CImg<ImageType>&& img1,
-      const cimg_library::CImg<ImageType>& img2) {
-    return img1.get_mul(img2);
-  }
-
-  static auto calculate(
-      const cimg_library::CImg<ImageType> &img1,
-      ImageType scalar_value) {
-    return img1 * scalar_value;
+  static ImageType apply(ImageType a, ImageType b) {
+    return a * b;
   }
 };
 
@@ -61,6 +53,26 @@ auto multiply_by(const Image& image_to_multiply_by) {
       image_to_multiply_by);
 }
 
+/**
+ * Same as above, but the image is moved instead of copied
+ * (e.g. multiply_by(average(...))).
+ */
+template<typename ImageType = float>
+auto multiply_by(Image &&image_to_multiply_by) {
+  return arithmetic_function_tmpl<MultiplyByTraits, ImageType>(
+      std::move(image_to_multiply_by));
+}
+
+/**
+ * Same as above, but the image is shared with the caller, i.e. it is
+ * never copied.
+ */
+template<typename ImageType = float>
+auto multiply_by(SharedImage<ImageType> image_to_multiply_by) {
+  return arithmetic_function_tmpl<MultiplyByTraits, ImageType>(
+      std::move(image_to_multiply_by));
+}
+
 /**
  *
  */
@@ -0,0 +1,375 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_PIPELINE_VIEW_PARALLEL_TRANSFORM_HPP_
+#define STARMATHPP_PIPELINE_VIEW_PARALLEL_TRANSFORM_HPP_ STARMATHPP_PIPELINE_VIEW_PARALLEL_TRANSFORM_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include <range/v3/view/all.hpp>
+#include <range/v3/view/facade.hpp>
+#include <range/v3/view/move.hpp>
+#include <range/v3/view/single.hpp>
+#include <range/v3/view/view.hpp>
+
+#include <libstarmathpp/exception.hpp>
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/thread_pool.hpp>
+
+namespace starmathpp::pipeline::views {
+
+DEF_Exception(ParallelTransform);
+
+namespace detail {
+
+/**
+ * Memory occupied by an element which is held by a parallel_transform_view.
+ * For images only the pixel buffer is taken into account.
+ */
+template<typename T>
+size_t size_in_bytes(const T& /*element*/) {
+  return sizeof(T);
+}
+
+template<typename ImageType>
+size_t size_in_bytes(const cimg_library::CImg<ImageType> &image) {
+  return image.size() * sizeof(ImageType);
+}
+
+/**
+ * View which applies fun to each element of the underlying range on a pool
+ * of worker threads.
+ *
+ * The elements of the underlying range are pulled (and therefore evaluated)
+ * sequentially by the thread which iterates this view. Only fun is executed
+ * concurrently. At most max_in_flight elements are processed or waiting
+ * for processing at the same time. The results are yielded in the order of
+ * the underlying range.
+ *
+ * If max_in_flight_bytes is not 0, a new element is only started if the
+ * results which are held by the view (including the one which is currently
+ * accessed) are expected to fit into that budget. The size of a result is
+ * not known before it was calculated. Therefore, the largest result seen so
+ * far is used as estimate and only one element is started until the first
+ * result is available. Each result counts with at least one byte. At least
+ * one element is always processed.
+ *
+ * NOTE: This is a single-pass (input) view. Each call of begin() starts
+ *       a new iteration of the underlying range.
+ * NOTE: fun is shared between all workers and is called concurrently.
+ *       It must not modify any shared state.
+ */
+template<typename Rng, typename Fun>
+class parallel_transform_view : public ranges::view_facade<
+    parallel_transform_view<Rng, Fun>, ranges::unknown> {
+
+  friend ranges::range_access;
+
+  using element_type = ranges::range_value_t<Rng>;
+  using result_type = std::decay_t<std::invoke_result_t<const Fun&, element_type&&>>;
+
+  /**
+   * The state of one iteration. It is shared by all copies of the cursor.
+   */
+  class iteration_state {
+   public:
+    iteration_state(Rng &base, std::shared_ptr<const Fun> fun,
+                    size_t num_workers, size_t max_in_flight,
+                    size_t max_in_flight_bytes)
+        :
+        it_(ranges::begin(base)),
+        end_(ranges::end(base)),
+        fun_(std::move(fun)),
+        max_in_flight_(max_in_flight),
+        max_in_flight_bytes_(max_in_flight_bytes),
+        max_element_bytes_(0),
+        upstream_failed_(false),
+        thread_pool_(num_workers) {
+      fill();
+    }
+
+    result_type& current() {
+      if (current_exception_) {
+        std::rethrow_exception(current_exception_);
+      }
+
+      if (!current_.has_value()) {
+        try {
+          // NOTE: get() moves the result out of the shared state. It re-throws
+          //       an exception which occurred while processing this element.
+          current_.emplace(in_flight_.front().get());
+        } catch (...) {
+          // NOTE: The future is invalid after get(). Further accesses of this
+          //       element re-throw the same exception.
+          current_exception_ = std::current_exception();
+          throw;
+        }
+
+        // NOTE: The size of the results may be known now.
+        fill();
+      }
+      return *current_;
+    }
+
+    void next() {
+      current_.reset();
+      current_exception_ = nullptr;
+      in_flight_.pop_front();
+      fill();
+    }
+
+    [[nodiscard]] bool done() const {
+      return in_flight_.empty();
+    }
+
+   private:
+    ranges::iterator_t<Rng> it_;
+    ranges::sentinel_t<Rng> end_;
+    std::shared_ptr<const Fun> fun_;
+    size_t max_in_flight_;
+    size_t max_in_flight_bytes_;
+    std::atomic<size_t> max_element_bytes_;
+    bool upstream_failed_;
+    std::deque<std::future<result_type>> in_flight_;
+    std::optional<result_type> current_;
+    std::exception_ptr current_exception_;
+
+    // NOTE: Must be the last member. The pool is destroyed first and
+    //       waits for pending tasks which still refer to the members above.
+    ThreadPool thread_pool_;
+
+    /**
+     * Check if another element may be started without exceeding the
+     * number of elements and the memory budget.
+     */
+    [[nodiscard]] bool has_capacity() const {
+      if (in_flight_.size() >= max_in_flight_) {
+        return false;
+      }
+
+      if (max_in_flight_bytes_ == 0 || in_flight_.empty()) {
+        return true;
+      }
+
+      size_t element_bytes = max_element_bytes_.load();
+
+      if (element_bytes == 0) {
+        // NOTE: Size of the results is not known, yet.
+        return false;
+      }
+
+      return (in_flight_.size() + 1) * element_bytes <= max_in_flight_bytes_;
+    }
+
+    /**
+     * Keep track of the largest result which was calculated so far.
+     */
+    void update_max_element_bytes(size_t element_bytes) {
+      size_t current_max = max_element_bytes_.load();
+
+      while (element_bytes > current_max
+          && !max_element_bytes_.compare_exchange_weak(current_max,
+                                                       element_bytes)) {
+      }
+    }
+
+    /**
+     * Pull elements from the underlying range until the window is full.
+     * An exception thrown by the underlying range is stored at the position
+     * where it occurred and the underlying range is not touched afterwards.
+     */
+    void fill() {
+      while (!upstream_failed_ && has_capacity() && it_ != end_) {
+        try {
+          element_type element = *it_;
+          ++it_;
+
+          in_flight_.push_back(
+              thread_pool_.submit(
+                  [this, element = std::move(element)]() mutable {
+                    result_type result((*fun_)(std::move(element)));
+                    // NOTE: An empty result still occupies a slot. Otherwise,
+                    //       the estimate stays 0 and only one element is started.
+                    update_max_element_bytes(
+                        std::max<size_t>(1, size_in_bytes(result)));
+                    return result;
+                  }));
+        } catch (...) {
+          std::promise<result_type> failed;
+          failed.set_exception(std::current_exception());
+          in_flight_.push_back(failed.get_future());
+          upstream_failed_ = true;
+        }
+      }
+    }
+  };
+
+  /**
+   *
+   */
+  struct cursor {
+    using single_pass = std::true_type;
+
+    std::shared_ptr<iteration_state> state_;
+
+    result_type&& read() const {
+      return std::move(state_->current());
+    }
+
+    void next() {
+      state_->next();
+    }
+
+    [[nodiscard]] bool equal(ranges::default_sentinel_t) const {
+      return state_->done();
+    }
+  };
+
+  Rng base_;
+  std::shared_ptr<const Fun> fun_;
+  size_t num_workers_ = 1;
+  size_t max_in_flight_ = 1;
+  size_t max_in_flight_bytes_ = 0;
+
+  cursor begin_cursor() {
+    return cursor { std::make_shared<iteration_state>(base_, fun_, num_workers_,
+                                                      max_in_flight_,
+                                                      max_in_flight_bytes_) };
+  }
+
+ public:
+  parallel_transform_view() = default;
+
+  parallel_transform_view(Rng base, Fun fun, size_t num_workers,
+                          size_t max_in_flight, size_t max_in_flight_bytes = 0)
+      :
+      base_(std::move(base)),
+      fun_(std::make_shared<const Fun>(std::move(fun))),
+      num_workers_(num_workers),
+      max_in_flight_(max_in_flight),
+      max_in_flight_bytes_(max_in_flight_bytes) {
+
+    if (num_workers_ < 1) {
+      throw ParallelTransformException("At least one worker is required.");
+    }
+
+    if (max_in_flight_ < 1) {
+      throw ParallelTransformException(
+          "At least one element must be allowed to be in flight.");
+    }
+  }
+};
+
+}  // namespace detail
+
+/**
+ * Evaluate fun for each element on a pool of num_workers threads while
+ * keeping the order of the elements. At most max_in_flight elements are
+ * processed at the same time. This bounds the memory consumption to
+ * max_in_flight images. If max_in_flight is 0, twice the number of workers
+ * is used. In addition, the memory held by the results can be limited to
+ * max_in_flight_bytes (0 = no limit).
+ *
+ * An exception thrown by fun is re-thrown when the corresponding element
+ * is accessed.
+ *
+ * Usage:
+ *
+ * auto images = filenames
+ *               | parallel_transform([](const std::string &filename) {
+ *                   return starmathpp::io::read(filename);
+ *                 }, 4)
+ *               | to<std::vector>();
+ */
+template<typename Fun>
+auto parallel_transform(Fun fun, size_t num_workers = default_num_workers(),
+                        size_t max_in_flight = 0,
+                        size_t max_in_flight_bytes = 0) {
+
+  size_t window = (max_in_flight == 0 ? 2 * num_workers : max_in_flight);
+
+  return ranges::make_view_closure([=](auto &&rng) {
+    using Rng = decltype(rng);
+
+    return detail::parallel_transform_view<ranges::views::all_t<Rng>, Fun>(
+        ranges::views::all(std::forward<Rng>(rng)), fun, num_workers, window,
+        max_in_flight_bytes);
+  });
+}
+
+/**
+ * Run an existing pipeline of 1:1 views (e.g. read(), subtract(),
+ * interpolate_bad_pixels(), ...) for each element on a pool of num_workers
+ * threads. Each element is sent through its own instance of the pipeline.
+ *
+ * Usage:
+ *
+ * auto light_frames = files("lights", "(.*\\.fit\\.gz)")
+ *                     | parallel(read()
+ *                                | interpolate_bad_pixels()
+ *                                | subtract(master_dark)
+ *                                | divide_by(master_flat), 4)
+ *                     | to<std::vector>();
+ *
+ * NOTE: The pipeline must yield exactly one element per input element.
+ *       Views which drop elements (e.g. filter) must be applied after
+ *       parallel().
+ */
+template<typename ViewClosure>
+auto parallel(ViewClosure pipeline, size_t num_workers = default_num_workers(),
+              size_t max_in_flight = 0) {
+  return parallel_transform(
+      [pipeline](auto &&element) {
+        auto results = pipeline(
+            ranges::views::single(std::forward<decltype(element)>(element))
+                | ranges::views::move);
+
+        auto it = ranges::begin(results);
+
+        if (it == ranges::end(results)) {
+          throw ParallelTransformException(
+              "Pipeline did not yield a result for the element.");
+        }
+
+        // NOTE: The pipeline instance is used for this element only. Hence,
+        //       its result can be moved out.
+        std::decay_t<decltype(*it)> result(std::move(*it));
+
+        return result;
+      },
+      num_workers, max_in_flight);
+}
+
+}  // namespace starmathpp::pipeline::views
+
+#endif // STARMATHPP_PIPELINE_VIEW_PARALLEL_TRANSFORM_HPP_
@@ -0,0 +1,291 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "pipeline view parallel_transform unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <atomic>
+#include <stdexcept>
+#include <chrono>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/iota.hpp>
+#include <range/v3/view/move.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <libstarmathpp/views/parallel_transform.hpp>
+#include <libstarmathpp/views/subtract.hpp>
+#include <libstarmathpp/views/multiply_by.hpp>
+#include <libstarmathpp/algorithm/average.hpp>
+#include <libstarmathpp/floating_point_equality.hpp>
+
+BOOST_AUTO_TEST_SUITE (pipeline_parallel_transform_tests)
+
+using namespace starmathpp;
+using namespace ranges;
+
+/**
+ * Elements which are finished first (small sleep time) must still be
+ * returned in the order of the input range.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_parallel_transform_preserves_order_test)
+{
+  auto results = ranges::views::ints(0, 20)
+      | pipeline::views::parallel_transform([](int i) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(20 - i));
+          return 2 * i;
+        }, 4 /*num workers*/)
+      | to<std::vector>();
+
+  auto expected_results = ranges::views::ints(0, 20)
+      | ranges::views::transform([](int i) { return 2 * i; })
+      | to<std::vector>();
+
+  BOOST_TEST(results == expected_results);
+}
+
+/**
+ * Not more than max_in_flight elements may be processed at the same time.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_parallel_transform_bounded_window_test)
+{
+  std::atomic<int> num_active { 0 };
+  std::atomic<int> max_num_active { 0 };
+
+  auto results = ranges::views::ints(0, 50)
+      | pipeline::views::parallel_transform([&](int i) {
+          int active = ++num_active;
+          int expected = max_num_active.load();
+
+          while (active > expected && !max_num_active.compare_exchange_weak(expected, active)) {
+          }
+
+          std::this_thread::sleep_for(std::chrono::milliseconds(2));
+          --num_active;
+          return i;
+        }, 8 /*num workers*/, 3 /*max in flight*/)
+      | to<std::vector>();
+
+  BOOST_TEST(results.size() == 50);
+  BOOST_TEST(max_num_active.load() <= 3);
+}
+
+/**
+ * Not more results than fit into the memory budget may be held at the same
+ * time. Each image below has 100x100 float pixels, i.e. 40000 bytes.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_parallel_transform_memory_budget_test)
+{
+  std::atomic<int> num_active { 0 };
+  std::atomic<int> max_num_active { 0 };
+
+  auto results = ranges::views::ints(0, 20)
+      | pipeline::views::parallel_transform([&](int i) {
+          int active = ++num_active;
+          int expected = max_num_active.load();
+
+          while (active > expected && !max_num_active.compare_exchange_weak(expected, active)) {
+          }
+
+          std::this_thread::sleep_for(std::chrono::milliseconds(2));
+          --num_active;
+          return Image(100, 100, 1, 1, (float) i);
+        }, 8 /*num workers*/, 8 /*max in flight*/, 2 * 40000 /*max in flight bytes*/)
+      | ranges::views::transform([](const auto &img) { return img(0, 0); })
+      | to<std::vector>();
+
+  BOOST_TEST(results.size() == 20);
+  BOOST_TEST(results.back() == 19.0F);
+  BOOST_TEST(max_num_active.load() <= 2);
+}
+
+/**
+ * Empty results have a size of 0 bytes. They must not block the window at
+ * a single element.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_parallel_transform_memory_budget_empty_results_test)
+{
+  std::atomic<int> num_active { 0 };
+  std::atomic<int> max_num_active { 0 };
+
+  auto results = ranges::views::ints(0, 20)
+      | pipeline::views::parallel_transform([&](int) {
+          int active = ++num_active;
+          int expected = max_num_active.load();
+
+          while (active > expected && !max_num_active.compare_exchange_weak(expected, active)) {
+          }
+
+          std::this_thread::sleep_for(std::chrono::milliseconds(5));
+          --num_active;
+          return Image();
+        }, 8 /*num workers*/, 8 /*max in flight*/, 3 /*max in flight bytes*/)
+      | to<std::vector>();
+
+  BOOST_TEST(results.size() == 20);
+  BOOST_TEST(max_num_active.load() >= 2);
+  BOOST_TEST(max_num_active.load() <= 3);
+}
+
+/**
+ * An exception thrown while processing an element is re-thrown
+ * when the element is accessed.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_parallel_transform_exception_test)
+{
+  BOOST_CHECK_THROW(ranges::views::ints(0, 10)
+      | pipeline::views::parallel_transform([](int i) {
+          if (i == 5) {
+            throw std::runtime_error("Element 5 failed.");
+          }
+          return i;
+        }, 2 /*num workers*/)
+      | to<std::vector>(),
+      std::runtime_error);
+}
+
+/**
+ * Accessing a failed element again must re-throw the same exception (and
+ * not fail because the result was already taken).
+ */
+BOOST_AUTO_TEST_CASE(pipeline_parallel_transform_repeated_exception_test)
+{
+  auto failing_view = ranges::views::ints(0, 3)
+      | pipeline::views::parallel_transform([](int i) {
+          if (i == 0) {
+            throw std::runtime_error("Element 0 failed.");
+          }
+          return i;
+        }, 2 /*num workers*/);
+
+  auto it = ranges::begin(failing_view);
+
+  BOOST_CHECK_THROW((void ) *it, std::runtime_error);
+  BOOST_CHECK_THROW((void ) *it, std::runtime_error);
+
+  ++it;
+  BOOST_TEST(*it == 1);
+}
+
+/**
+ * Counts the copies of an element.
+ */
+struct CopyCounter {
+  static std::atomic<int> num_copies;
+
+  CopyCounter() = default;
+  CopyCounter(CopyCounter&&) = default;
+  CopyCounter& operator=(CopyCounter&&) = default;
+
+  CopyCounter(const CopyCounter&) {
+    ++num_copies;
+  }
+
+  CopyCounter& operator=(const CopyCounter&) {
+    ++num_copies;
+    return *this;
+  }
+};
+
+std::atomic<int> CopyCounter::num_copies { 0 };
+
+/**
+ * The results are moved from the workers to the consumer.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_parallel_transform_no_copy_test)
+{
+  CopyCounter::num_copies = 0;
+
+  auto results = ranges::views::ints(0, 10)
+      | pipeline::views::parallel_transform([](int) {
+          return CopyCounter();
+        }, 3 /*num workers*/)
+      | to<std::vector>();
+
+  auto pipeline_results = ranges::views::ints(0, 10)
+      | pipeline::views::parallel(ranges::views::transform([](int) {
+          return CopyCounter();
+        }), 3 /*num workers*/)
+      | to<std::vector>();
+
+  BOOST_TEST(results.size() == 10);
+  BOOST_TEST(pipeline_results.size() == 10);
+  BOOST_TEST(CopyCounter::num_copies.load() == 0);
+}
+
+/**
+ * Existing 1:1 pipeline views can be executed in parallel.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_parallel_existing_views_test)
+{
+  std::vector<Image> input_images = {
+    Image(5, 5, 1, 1, 13),  // 5x5 - All pixels have value 13
+    Image(5, 5, 1, 1, 10),  // 5x5 - All pixels have value 10
+    Image(5, 5, 1, 1, -10)  // 5x5 - All pixels have value -10
+  };
+
+  std::vector<Image> expected_result_images = {
+    Image(5, 5, 1, 1, 8),   // 5x5 - All pixels have value (13 - 9) * 2
+    Image(5, 5, 1, 1, 2),   // 5x5 - All pixels have value (10 - 9) * 2
+    Image(5, 5, 1, 1, -38)  // 5x5 - All pixels have value (-10 - 9) * 2
+  };
+
+  Image image_to_subtract(5, 5, 1, 1, 9);
+
+  auto result_images = input_images
+      | ranges::views::move
+      | pipeline::views::parallel(
+          pipeline::views::subtract(image_to_subtract)
+          | pipeline::views::multiply_by(2.0F), 2 /*num workers*/)
+      | to<std::vector>();
+
+  BOOST_TEST(result_images.size() == 3);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result_images.begin(), result_images.end(),
+      expected_result_images.begin(), expected_result_images.end());
+}
+
+/**
+ * The (single-pass) result of parallel_transform() can be averaged.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_parallel_transform_average_test)
+{
+  auto average_image = algorithm::average(
+      ranges::views::ints(1, 4)
+      | pipeline::views::parallel_transform([](int i) {
+          return Image(5, 5, 1, 1, (float) i);
+        }, 3 /*num workers*/));
+
+  Image expected_image(5, 5, 1, 1, 2);  // 5x5 - All pixels have value (1 + 2 + 3) / 3
+
+  BOOST_TEST(is_almost_equal(average_image, expected_image, 0.00001));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
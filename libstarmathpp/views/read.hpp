@@ -26,9 +26,13 @@
 #ifndef STARMATH_PIPELINE_IO_READ_H_
 #define STARMATH_PIPELINE_IO_READ_H_ STARMATH_PIPELINE_IO_READ_H_
 
+#include <algorithm>
+
 #include <range/v3/view/transform.hpp>
 
 #include <libstarmathpp/io/image_reader.hpp>
+#include <libstarmathpp/io/mapped_fits_image.hpp>
+#include <libstarmathpp/views/parallel_transform.hpp>
 
 #define STARMATHPP_PIPELINE_READ_DEBUG 0
 
@@ -49,6 +53,89 @@ namespace starmathpp::pipeline::views {
         }
     );
   }
+
+  /**
+   * Same as read(), but each image is returned as Frame with the pixel type
+   * of the file (see io::read_frame()). This way, 16 bit images need half
+   * the memory. Stages which need floating point values (e.g. divide_by())
+   * promote the frames automatically.
+   *
+   * Usage:
+   *
+   * Image master_dark = average(files("darks", "(.*\\.fit)") | read_frames());
+   */
+  inline auto read_frames() {
+    return ranges::views::transform([](const std::string &image_filename) {
+
+          auto loaded_frame = starmathpp::io::read_frame(image_filename);
+
+          return loaded_frame;
+        }
+    );
+  }
+
+  /**
+   * Same as read(), but each file is memory-mapped instead of being read
+   * (see io::fits::MappedImage). Only the header is parsed. The pixels are
+   * decoded when they are accessed. Hence, stages which only touch a part of
+   * each frame (e.g. the statistics of a region or a few star cutouts) do
+   * not read and allocate complete frames.
+   *
+   * NOTE: Only uncompressed FITS files are supported. Others throw a
+   *       MappedImageException.
+   *
+   * Usage:
+   *
+   * auto background_levels = files("lights", "(.*\\.fit)")
+   *                          | read_mapped()
+   *                          | ranges::views::transform([&](const auto &image) {
+   *                              return image.crop(background_region).median();
+   *                            })
+   *                          | to<std::vector>();
+   */
+  inline auto read_mapped() {
+    return ranges::views::transform([](const std::string &image_filename) {
+          return starmathpp::io::fits::MappedImage(image_filename);
+        }
+    );
+  }
+
+  /**
+   * Same as read(), but the next max_prefetch_files images are read and
+   * decoded by background threads while the current image is processed
+   * by the subsequent pipeline stages. This hides disk latency and the
+   * decompression of e.g. gzip-compressed FITS files.
+   *
+   * The memory held by prefetched images (including the current one) can
+   * be limited to max_prefetch_bytes (0 = no limit). At least the current
+   * image is always read. By default one worker per prefetched file is used.
+   * NOTE: max_prefetch_bytes only counts the decoded images. Each worker
+   * additionally keeps its gzip buffers (see io::fits::read()).
+   *
+   * An exception thrown while reading a file (ImageReaderException) is
+   * re-thrown at the position of that file in the sequence.
+   *
+   * Usage:
+   *
+   * auto images = files("lights", "(.*\\.fit\\.gz)")
+   *               | read_ahead(4, 1024 * 1024 * 1024) // max. 4 files or 1 GB
+   *               | interpolate_bad_pixels()
+   *               | ...
+   */
+  inline auto read_ahead(size_t max_prefetch_files = 2, size_t max_prefetch_bytes = 0,
+                  size_t num_workers = 0) {
+    return parallel_transform(
+        [](const std::string &image_filename) {
+
+          auto loaded_image = starmathpp::io::read(image_filename);
+
+          DEBUG_IMAGE_DISPLAY(loaded_image, "read_ahead_out", STARMATHPP_PIPELINE_READ_DEBUG);
+
+          return loaded_image;
+        },
+        (num_workers == 0 ? std::max<size_t>(1, max_prefetch_files) : num_workers),
+        max_prefetch_files + 1 /*current image*/, max_prefetch_bytes);
+  }
 }  // namespace starmathpp::pipeline:::views
 
 #endif // STARMATH_PIPELINE_IO_READ_H_
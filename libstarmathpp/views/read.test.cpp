@@ -69,4 +69,115 @@ BOOST_AUTO_TEST_CASE(pipeline_read_images_test)
     BOOST_TEST(img_dimensions == expected_image_dimensions);
 }
 
+/**
+ * read_frames() must yield the same pixels as read().
+ */
+BOOST_AUTO_TEST_CASE(pipeline_read_frames_test)
+{
+    const std::vector<std::string> image_filenames {
+        "test_data/pipeline/read/test_image_tiff_1_65x85.tiff",
+        "test_data/pipeline/read/test_image_fits_1_45x47.fits"
+    };
+
+    auto images = image_filenames | pipeline::views::read() | to<std::vector>();
+    auto frames = image_filenames | pipeline::views::read_frames() | to<std::vector>();
+
+    BOOST_TEST(frames.size() == images.size());
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        BOOST_TEST((to_image(frames[i]) == images[i]));
+    }
+}
+
+/**
+ * A metric computed on memory-mapped images must be the same as on the
+ * images returned by read().
+ */
+BOOST_AUTO_TEST_CASE(pipeline_read_mapped_test)
+{
+    const std::vector<std::string> image_filenames {
+        "test_data/pipeline/read/test_image_fits_1_45x47.fits",
+        "test_data/pipeline/read/test_image_fits_2_45x47.fits"
+    };
+
+    const Rect<int> region(10, 5, 20, 30);
+
+    auto metric = [&](const auto &image) {
+        double sum = 0;
+
+        for (int y = region.y(); y < region.y() + (int) region.height(); ++y) {
+            for (int x = region.x(); x < region.x() + (int) region.width(); ++x) {
+                sum += image(x, y);
+            }
+        }
+        return sum;
+    };
+
+    auto expected_sums = image_filenames
+                            | pipeline::views::read()
+                            | views::transform(metric)
+                            | to<std::vector>();
+
+    auto sums = image_filenames
+                            | pipeline::views::read_mapped()
+                            | views::transform(metric)
+                            | to<std::vector>();
+
+    BOOST_TEST(sums == expected_sums);
+}
+
+/**
+ * read_ahead() must yield the same images in the same order as read().
+ */
+BOOST_AUTO_TEST_CASE(pipeline_read_ahead_images_test)
+{
+    const std::vector<std::string> image_filenames {
+        "test_data/pipeline/read/test_image_tiff_1_65x85.tiff",
+        "test_data/pipeline/read/test_image_fits_1_45x47.fits",
+        "test_data/pipeline/read/test_image_tiff_2_65x85.tiff",
+        "test_data/pipeline/read/test_image_fits_2_45x47.fits"
+    };
+
+    const std::vector< std::pair<int, int> > expected_image_dimensions {
+            std::make_pair(65, 85),
+            std::make_pair(45, 47),
+            std::make_pair(65, 85),
+            std::make_pair(45, 47)
+    };
+
+    auto img_dimensions = image_filenames
+                            | pipeline::views::read_ahead(2 /*files*/, 65 * 85 * sizeof(float) /*bytes*/)
+                            | views::transform(
+                                    [](const auto & img) {
+                                        return std::make_pair(img.width(), img.height());
+                                    })
+                            | to<std::vector>();
+
+    BOOST_TEST(img_dimensions == expected_image_dimensions);
+}
+
+/**
+ * An error while reading a file is reported when the consumer reaches
+ * that file - not earlier.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_read_ahead_error_position_test)
+{
+    const std::vector<std::string> image_filenames {
+        "test_data/pipeline/read/test_image_fits_2_45x47.fits",
+        "test_data/pipeline/read/does_not_exist.fits",
+        "test_data/pipeline/read/test_image_fits_2_45x47.fits"
+    };
+
+    size_t num_images_read = 0;
+
+    BOOST_CHECK_THROW(
+        for (const auto & img : image_filenames | pipeline::views::read_ahead(2)) {
+            BOOST_TEST(img.width() == 45);
+            ++num_images_read;
+        },
+        starmathpp::io::ImageReaderException);
+
+    BOOST_TEST(num_images_read == 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
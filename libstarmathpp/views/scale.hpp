@@ -30,6 +30,7 @@
 
 #include <libstarmathpp/image.hpp>
 #include <libstarmathpp/enum_helper.hpp>
+#include <libstarmathpp/instrumentation.hpp>
 
 #define STARMATHPP_PIPELINE_SCALE_DEBUG 0
 
@@ -147,6 +148,14 @@ struct InterpolationType {
 };
 
 /**
+ * The image is taken by value and resized in place. Behind
+ * ranges::views::move, the frame is moved in and no copy is made.
+ *
+ * NOTE: Each element must then be read only once. A second read (e.g. by
+ *       ranges::views::filter, which reads each element for the predicate
+ *       and again for the result) moves from the already moved frame and
+ *       yields an empty image without an error. Put ranges::views::cache1
+ *       in front of such a view.
  *
  * @tparam ImageType
  * @param scaleType
@@ -157,24 +166,27 @@ template<typename ImageType = float>
 auto scale(ScaleDirection::TypeE scale_type, float scale_factor,
            InterpolationType::TypeE interpolation_type) {
   return ranges::views::transform(
-      [=](const cimg_library::CImg<ImageType> &&image) {
+      [=](cimg_library::CImg<ImageType> image) {
 
-        DEBUG_IMAGE_DISPLAY(image, "scale_in", STARMATHPP_PIPELINE_SCALE_DEBUG);
+        STARMATHPP_INSTRUMENT_SCOPE("views::scale");
+        STARMATHPP_INSTRUMENT_PIXELS(image.size());
 
-        auto scaled_image = cimg_library::CImg<ImageType>(image);
+        DEBUG_IMAGE_DISPLAY(image, "scale_in", STARMATHPP_PIPELINE_SCALE_DEBUG);
 
         float factor = (
             scale_type == ScaleDirection::UP ?
                 scale_factor : 1.0F / scale_factor);
 
-        scaled_image.resize((int) (factor * (float) image.width()),
+        // NOTE: The image is owned by this stage. Therefore, it is
+        //       resized in place instead of resizing a copy.
+        image.resize((int) (factor * (float) image.width()),
                             (int) (factor * (float) image.height()), -100, -100,
                             InterpolationType::asInt(interpolation_type));
 
-        DEBUG_IMAGE_DISPLAY(scaled_image, "scale_out",
+        DEBUG_IMAGE_DISPLAY(image, "scale_out",
                             STARMATHPP_PIPELINE_SCALE_DEBUG);
 
-        return scaled_image;
+        return image;
       }
   );
 }
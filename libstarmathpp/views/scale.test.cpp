@@ -32,6 +32,8 @@
 #include <vector>
 
 #include <range/v3/range/conversion.hpp>
+#include <range/v3/view/cache1.hpp>
+#include <range/v3/view/filter.hpp>
 #include <range/v3/view/single.hpp>
 #include <range/v3/view/move.hpp>
 
@@ -122,4 +124,36 @@ BOOST_AUTO_TEST_CASE(pipeline_scale_down_test)
   BOOST_TEST(is_almost_equal(result_image, expected_result_image, 0.00001));
 }
 
+/**
+ * scale() takes the frame by value. Behind views::move, the frame is
+ * consumed by the first read. views::filter reads each element twice.
+ * Therefore, cache1 is required - otherwise, the second read moves from
+ * the already moved frame and the result is empty.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_scale_moved_frame_read_twice_test)
+{
+  std::vector<Image> input_images { Image(5, 5, 1, 1, 250), Image(5, 5, 1, 1, 250) };
+
+  auto scaled_images = input_images
+      | ranges::views::move
+      | scale_up(2.0F)
+      | ranges::views::cache1
+      | ranges::views::filter([](const Image &image) { return !image.is_empty(); })
+      | to<std::vector>();
+
+  BOOST_TEST(scaled_images.size() == 2);
+  BOOST_TEST(scaled_images.at(1).width() == 10);
+
+  std::vector<Image> uncached_input_images { Image(5, 5, 1, 1, 250) };
+
+  auto uncached_images = uncached_input_images
+      | ranges::views::move
+      | scale_up(2.0F)
+      | ranges::views::filter([](const Image &image) { return !image.is_empty(); })
+      | to<std::vector>();
+
+  BOOST_TEST(uncached_images.size() == 1);
+  BOOST_TEST(uncached_images.at(0).is_empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -29,6 +29,7 @@
 #include <range/v3/view/transform.hpp> // ranges::views::transform
 
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/instrumentation.hpp>
 #include <libstarmathpp/algorithm/stretch/stretcher.hpp>
 
 #define STARMATHPP_PIPELINE_STRETCHER_DEBUG 0
@@ -45,7 +46,10 @@ namespace starmathpp::pipeline::views {
 template<typename ImageType = float>
 auto stretch(const starmathpp::algorithm::Stretcher &stretcher) {
   return ranges::views::transform(
-      [&](const cimg_library::CImg<ImageType>&& input_image) {
+      [&](const cimg_library::CImg<ImageType> &input_image) {
+
+        STARMATHPP_INSTRUMENT_SCOPE("views::stretch");
+        STARMATHPP_INSTRUMENT_PIXELS(input_image.size());
 
         DEBUG_IMAGE_DISPLAY(input_image, "pipeline_view_stretcher_in",
                             STARMATHPP_PIPELINE_STRETCHER_DEBUG);
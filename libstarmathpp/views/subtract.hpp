@@ -39,16 +39,8 @@ struct SubtractTraits {
     return "subtract";
   }
 
-  static auto calculate(
-      const cimg_library::CImg<ImageType> &&img1,
-      const cimg_library::CImg<ImageType> &img2) {
-    return img1 - img2;
-  }
-
-  static auto calculate(
-      const cimg_library::CImg<ImageType> &&img1,
-      ImageType scalar_value) {
-    return img1 - scalar_value;
+  static ImageType apply(ImageType a, ImageType b) {
+    return a - b;
   }
 };
 
@@ -61,6 +53,26 @@ auto subtract(const Image &image_to_subtract) {
       image_to_subtract);
 }
 
+/**
+ * Same as above, but the image is moved instead of copied
+ * (e.g. subtract(average(...))).
+ */
+template<typename ImageType = float>
+auto subtract(Image &&image_to_subtract) {
+  return arithmetic_function_tmpl<SubtractTraits, ImageType>(
+      std::move(image_to_subtract));
+}
+
+/**
+ * Same as above, but the image is shared with the caller, i.e. it is
+ * never copied.
+ */
+template<typename ImageType = float>
+auto subtract(SharedImage<ImageType> image_to_subtract) {
+  return arithmetic_function_tmpl<SubtractTraits, ImageType>(
+      std::move(image_to_subtract));
+}
+
 /**
  *
  */
@@ -29,6 +29,7 @@
 #include <range/v3/view/transform.hpp>
 
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/instrumentation.hpp>
 #include <libstarmathpp/algorithm/threshold/thresholder.hpp>
 
 #define STARMATHPP_PIPELINE_SUBTRACT_BACKGROUND_DEBUG 0
@@ -38,32 +39,40 @@
  */
 namespace starmathpp::pipeline::views {
 
-  /**
-   *
-   */
+/**
+ * Subtract the threshold of the thresholder from each pixel (clipped at 0).
+ * The image is taken by value and modified in place.
+ *
+ * NOTE: Like scale(), the stage consumes a moved frame. Behind
+ *       ranges::views::move, each element must be read only once (see
+ *       ranges::views::cache1).
+ */
 template<typename ImageType = float>
 auto subtract_background(const starmathpp::algorithm::Thresholder<ImageType> &thresholder) {
   return ranges::views::transform(
-      [&](const cimg_library::CImg<ImageType>&& input_image) {
+      [&](cimg_library::CImg<ImageType> input_image) {
+
+        STARMATHPP_INSTRUMENT_SCOPE("views::subtract_background");
+        STARMATHPP_INSTRUMENT_PIXELS(input_image.size());
 
         DEBUG_IMAGE_DISPLAY(input_image, "subtract_background_in",
                             STARMATHPP_PIPELINE_SUBTRACT_BACKGROUND_DEBUG);
 
-        float threshold = thresholder.calculate_threshold(std::move(input_image));
-
-        cimg_library::CImg<ImageType> sub_image(input_image, "xy");
+        float threshold = thresholder.calculate_threshold(input_image);
 
+        // NOTE: The image is owned by this stage. Therefore, the background
+        //       is subtracted in place.
         cimg_forXY(input_image, x, y)
         {
-          sub_image(x, y) = (
+          input_image(x, y) = (
               input_image(x, y) < threshold ?
                   0 : input_image(x, y) - threshold);
         }
 
-        DEBUG_IMAGE_DISPLAY(sub_image, "subtract_background_out",
+        DEBUG_IMAGE_DISPLAY(input_image, "subtract_background_out",
                             STARMATHPP_PIPELINE_SUBTRACT_BACKGROUND_DEBUG);
 
-        return sub_image;
+        return input_image;
       }
   );
 }
@@ -0,0 +1,480 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_PIPELINE_VIEW_TILE_HPP_
+#define STARMATHPP_PIPELINE_VIEW_TILE_HPP_ STARMATHPP_PIPELINE_VIEW_TILE_HPP_
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <type_traits>
+#include <utility>
+
+#include <range/v3/view/all.hpp>
+#include <range/v3/view/facade.hpp>
+#include <range/v3/view/move.hpp>
+#include <range/v3/view/single.hpp>
+#include <range/v3/view/view.hpp>
+
+#include <libstarmathpp/exception.hpp>
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/rect.hpp>
+#include <libstarmathpp/size.hpp>
+#include <libstarmathpp/thread_pool.hpp>
+#include <libstarmathpp/views/parallel_transform.hpp>
+
+namespace starmathpp::pipeline::views {
+
+DEF_Exception(Tile);
+
+/**
+ * Part of a frame as produced by tile().
+ *
+ * image covers the region of the tile plus a halo of neighbouring pixels
+ * on each side (as far as the frame extends). bounds is the position of
+ * image in the frame. Only the pixels inside region are copied back into
+ * the frame by untile().
+ */
+template<typename ImageType = float>
+struct Tile {
+  cimg_library::CImg<ImageType> image;
+  Rect<int> region;
+  Rect<int> bounds;
+  Size<int> frame_size;
+  size_t index;
+  size_t num_tiles;
+};
+
+namespace detail {
+
+/**
+ * Split a frame into tiles of tile_size (the tiles in the last column and
+ * row may be smaller). The tiles are numbered row by row.
+ */
+class TileGrid {
+ public:
+  TileGrid(const Size<int> &frame_size, const Size<int> &tile_size, int halo)
+      :
+      frame_size_(frame_size),
+      tile_size_(tile_size),
+      halo_(halo),
+      num_cols_(num_tiles_along(frame_size.width(), tile_size.width())),
+      num_rows_(num_tiles_along(frame_size.height(), tile_size.height())) {
+  }
+
+  [[nodiscard]] size_t size() const {
+    return num_cols_ * num_rows_;
+  }
+
+  [[nodiscard]] Rect<int> region(size_t index) const {
+    int x = (int) (index % num_cols_) * tile_size_.width();
+    int y = (int) (index / num_cols_) * tile_size_.height();
+
+    return Rect<int>(x, y,
+                     (unsigned int) std::min(tile_size_.width(),
+                                             frame_size_.width() - x),
+                     (unsigned int) std::min(tile_size_.height(),
+                                             frame_size_.height() - y));
+  }
+
+  /**
+   * Region grown by the halo and clipped to the frame.
+   */
+  [[nodiscard]] Rect<int> bounds(size_t index) const {
+    auto tile_region = region(index);
+
+    int x0 = std::max(0, tile_region.x() - halo_);
+    int y0 = std::max(0, tile_region.y() - halo_);
+    int x1 = std::min(frame_size_.width(),
+                      tile_region.x() + (int) tile_region.width() + halo_);
+    int y1 = std::min(frame_size_.height(),
+                      tile_region.y() + (int) tile_region.height() + halo_);
+
+    return Rect<int>(x0, y0, (unsigned int) (x1 - x0),
+                     (unsigned int) (y1 - y0));
+  }
+
+ private:
+  Size<int> frame_size_;
+  Size<int> tile_size_;
+  int halo_;
+  size_t num_cols_;
+  size_t num_rows_;
+
+  static size_t num_tiles_along(int frame_length, int tile_length) {
+    return (frame_length <= 0 ?
+        0 : (size_t) ((frame_length + tile_length - 1) / tile_length));
+  }
+};
+
+/**
+ * View which yields the tiles of all frames of the underlying range.
+ *
+ * NOTE: This is a single-pass (input) view.
+ */
+template<typename Rng>
+class tile_view : public ranges::view_facade<tile_view<Rng>, ranges::unknown> {
+
+  friend ranges::range_access;
+
+  using frame_type = ranges::range_value_t<Rng>;
+  using pixel_type = typename frame_type::value_type;
+  using tile_type = Tile<pixel_type>;
+
+  /**
+   * The state of one iteration. It is shared by all copies of the cursor.
+   */
+  class iteration_state {
+   public:
+    iteration_state(Rng &base, const Size<int> &tile_size, int halo)
+        :
+        it_(ranges::begin(base)),
+        end_(ranges::end(base)),
+        tile_size_(tile_size),
+        halo_(halo),
+        tile_index_(0) {
+      load_frame();
+    }
+
+    [[nodiscard]] tile_type current() const {
+      auto bounds = grid_->bounds(tile_index_);
+
+      return tile_type { frame_->get_crop(
+          bounds.x(), bounds.y(), bounds.x() + (int) bounds.width() - 1,
+          bounds.y() + (int) bounds.height() - 1), grid_->region(tile_index_),
+          bounds, Size<int>(frame_->width(), frame_->height()), tile_index_,
+          grid_->size() };
+    }
+
+    void next() {
+      if (++tile_index_ >= grid_->size()) {
+        ++it_;
+        load_frame();
+      }
+    }
+
+    [[nodiscard]] bool done() const {
+      return !frame_.has_value();
+    }
+
+   private:
+    ranges::iterator_t<Rng> it_;
+    ranges::sentinel_t<Rng> end_;
+    Size<int> tile_size_;
+    int halo_;
+    std::optional<frame_type> frame_;
+    std::optional<TileGrid> grid_;
+    size_t tile_index_;
+
+    /**
+     * Move on to the next frame which has at least one pixel.
+     */
+    void load_frame() {
+      frame_.reset();
+      tile_index_ = 0;
+
+      for (; it_ != end_; ++it_) {
+        frame_.emplace(*it_);
+        grid_.emplace(Size<int>(frame_->width(), frame_->height()),
+                      tile_size_, halo_);
+
+        if (grid_->size() > 0) {
+          return;
+        }
+        frame_.reset();
+      }
+    }
+  };
+
+  struct cursor {
+    using single_pass = std::true_type;
+
+    std::shared_ptr<iteration_state> state_;
+
+    tile_type read() const {
+      return state_->current();
+    }
+
+    void next() {
+      state_->next();
+    }
+
+    [[nodiscard]] bool equal(ranges::default_sentinel_t) const {
+      return state_->done();
+    }
+  };
+
+  Rng base_;
+  Size<int> tile_size_;
+  int halo_ = 0;
+
+  cursor begin_cursor() {
+    return cursor { std::make_shared<iteration_state>(base_, tile_size_, halo_) };
+  }
+
+ public:
+  tile_view() = default;
+
+  tile_view(Rng base, const Size<int> &tile_size, int halo)
+      :
+      base_(std::move(base)),
+      tile_size_(tile_size),
+      halo_(halo) {
+
+    if (tile_size_.width() < 1 || tile_size_.height() < 1) {
+      throw TileException("Tile size must be at least 1x1.");
+    }
+
+    if (halo_ < 0) {
+      throw TileException("Halo must not be negative.");
+    }
+  }
+};
+
+/**
+ * View which stitches the regions of consecutive tiles back into frames.
+ *
+ * NOTE: This is a single-pass (input) view.
+ */
+template<typename Rng>
+class untile_view : public ranges::view_facade<untile_view<Rng>,
+    ranges::unknown> {
+
+  friend ranges::range_access;
+
+  using tile_type = ranges::range_value_t<Rng>;
+  using frame_type = std::decay_t<decltype(std::declval<tile_type>().image)>;
+
+  /**
+   * The state of one iteration. It is shared by all copies of the cursor.
+   */
+  class iteration_state {
+   public:
+    explicit iteration_state(Rng &base)
+        :
+        it_(ranges::begin(base)),
+        end_(ranges::end(base)) {
+    }
+
+    frame_type& current() {
+      if (!current_.has_value()) {
+        assemble();
+      }
+      return *current_;
+    }
+
+    void next() {
+      if (!current_.has_value()) {
+        assemble();
+      }
+      current_.reset();
+    }
+
+    [[nodiscard]] bool done() const {
+      return !current_.has_value() && it_ == end_;
+    }
+
+   private:
+    ranges::iterator_t<Rng> it_;
+    ranges::sentinel_t<Rng> end_;
+    std::optional<frame_type> current_;
+
+    /**
+     * Pull the tiles of the next frame and copy their regions into it.
+     */
+    void assemble() {
+      for (size_t expected_index = 0;; ++expected_index) {
+        if (it_ == end_) {
+          throw TileException("Range ended before all tiles of a frame were received.");
+        }
+
+        tile_type tile = *it_;
+        ++it_;
+
+        if (tile.index != expected_index) {
+          std::stringstream ss;
+          ss << "Expected tile " << expected_index << " but received tile "
+             << tile.index << ".";
+          throw TileException(ss.str());
+        }
+
+        if (tile.image.width() != (int) tile.bounds.width()
+            || tile.image.height() != (int) tile.bounds.height()) {
+          std::stringstream ss;
+          ss << "Size of tile " << tile.index << " was changed from "
+             << tile.bounds.width() << "x" << tile.bounds.height() << " to "
+             << tile.image.width() << "x" << tile.image.height() << ".";
+          throw TileException(ss.str());
+        }
+
+        if (tile.index == 0) {
+          current_.emplace(tile.frame_size.width(), tile.frame_size.height(),
+                           tile.image.depth(), tile.image.spectrum());
+        }
+
+        copy_region(tile);
+
+        if (tile.index + 1 == tile.num_tiles) {
+          return;
+        }
+      }
+    }
+
+    void copy_region(const tile_type &tile) {
+      int offset_x = tile.region.x() - tile.bounds.x();
+      int offset_y = tile.region.y() - tile.bounds.y();
+
+      for (int c = 0; c < tile.image.spectrum(); ++c) {
+        for (int z = 0; z < tile.image.depth(); ++z) {
+          for (int y = 0; y < (int) tile.region.height(); ++y) {
+            const auto *src = tile.image.data(offset_x, offset_y + y, z, c);
+
+            std::copy(
+                src, src + tile.region.width(),
+                current_->data(tile.region.x(), tile.region.y() + y, z, c));
+          }
+        }
+      }
+    }
+  };
+
+  struct cursor {
+    using single_pass = std::true_type;
+
+    std::shared_ptr<iteration_state> state_;
+
+    frame_type&& read() const {
+      return std::move(state_->current());
+    }
+
+    void next() {
+      state_->next();
+    }
+
+    [[nodiscard]] bool equal(ranges::default_sentinel_t) const {
+      return state_->done();
+    }
+  };
+
+  Rng base_;
+
+  cursor begin_cursor() {
+    return cursor { std::make_shared<iteration_state>(base_) };
+  }
+
+ public:
+  untile_view() = default;
+
+  explicit untile_view(Rng base)
+      :
+      base_(std::move(base)) {
+  }
+};
+
+}  // namespace detail
+
+/**
+ * Split each frame into tiles of tile_size pixels. Each tile carries a
+ * halo of up to halo pixels of the neighbouring tiles. At the border of
+ * the frame, the halo is clipped. Therefore, an algorithm sees the same
+ * frame border in a tile as in the whole frame.
+ *
+ * A tile of 256x256 float pixels (256 KB) typically fits into the L2 cache.
+ *
+ * NOTE: The halo must be at least the radius of the neighbourhood which is
+ *       used by the stages applied to the tiles (e.g. 2 for a 5x5 filter).
+ *       Otherwise, the result differs from processing the whole frame.
+ */
+inline auto tile(const Size<int> &tile_size, int halo = 0) {
+  return ranges::make_view_closure([=](auto &&rng) {
+    using Rng = decltype(rng);
+
+    return detail::tile_view<ranges::views::all_t<Rng>>(
+        ranges::views::all(std::forward<Rng>(rng)), tile_size, halo);
+  });
+}
+
+/**
+ * Stitch the tiles produced by tile() back into frames. Only the region of
+ * each tile (without halo) is copied. The tiles of a frame must arrive in
+ * the order they were produced by tile().
+ */
+inline auto untile() {
+  return ranges::make_view_closure([](auto &&rng) {
+    using Rng = decltype(rng);
+
+    return detail::untile_view<ranges::views::all_t<Rng>>(
+        ranges::views::all(std::forward<Rng>(rng)));
+  });
+}
+
+/**
+ * Run an existing pipeline of 1:1 image views (e.g. interpolate_bad_pixels())
+ * for each tile on a pool of num_workers threads. The order of the tiles is
+ * kept.
+ *
+ * Usage:
+ *
+ * auto frames = files("lights", "(.*\\.fit\\.gz)")
+ *               | read()
+ *               | tile(Size<int>(256, 256), 4)
+ *               | on_tiles(interpolate_bad_pixels(500, 9), 8)
+ *               | untile()
+ *               | to<std::vector>();
+ *
+ * NOTE: The pipeline must keep the size of the tile images.
+ *
+ * NOTE: Only stages which work on a local neighbourhood of each pixel give
+ *       the same result as on the whole frame (given enough tile overlap).
+ *       Stages which compute global statistics (e.g. the threshold of
+ *       subtract_background()) compute them per tile instead.
+ */
+template<typename ViewClosure>
+auto on_tiles(ViewClosure pipeline, size_t num_workers = default_num_workers(),
+              size_t max_in_flight = 0) {
+  return parallel_transform(
+      [pipeline](auto &&tile) {
+        auto results = pipeline(
+            ranges::views::single(std::move(tile.image)) | ranges::views::move);
+
+        auto it = ranges::begin(results);
+
+        if (it == ranges::end(results)) {
+          throw TileException("Pipeline did not yield a result for the tile.");
+        }
+
+        std::decay_t<decltype(*it)> result_image = *it;
+
+        return Tile<typename decltype(result_image)::value_type> {
+            std::move(result_image), tile.region, tile.bounds, tile.frame_size,
+            tile.index, tile.num_tiles };
+      },
+      num_workers, max_in_flight);
+}
+
+}  // namespace starmathpp::pipeline::views
+
+#endif // STARMATHPP_PIPELINE_VIEW_TILE_HPP_
@@ -0,0 +1,207 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "pipeline view tile unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <libstarmathpp/views/tile.hpp>
+#include <libstarmathpp/views/interpolate_bad_pixels.hpp>
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/floating_point_equality.hpp>
+
+BOOST_AUTO_TEST_SUITE (pipeline_tile_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::pipeline::views;
+using namespace ranges;
+
+/**
+ * Image with a different value for each pixel and some hot pixels.
+ */
+static Image generate_test_image(int width, int height) {
+  Image image(width, height, 1, 1, 0);
+
+  cimg_forXY(image, x, y)
+  {
+    image(x, y) = (float) ((x * 7 + y * 13) % 50);
+  }
+
+  image(0, 0) = 65535;
+  image(17, 9) = 65535;
+  image(31, 31) = 65535;
+  image(width - 1, height - 1) = 65535;
+
+  return image;
+}
+
+/**
+ * 3x3 mean filter. Pixels outside the image are replaced by the nearest
+ * pixel inside the image.
+ */
+static auto box_filter() {
+  return ranges::views::transform([](const Image &image) {
+    Image result(image.width(), image.height(), 1, 1, 0);
+
+    cimg_forXY(image, x, y)
+    {
+      float sum = 0;
+
+      for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+          sum += image(std::clamp(x + dx, 0, image.width() - 1),
+                       std::clamp(y + dy, 0, image.height() - 1));
+        }
+      }
+      result(x, y) = sum / 9.0F;
+    }
+    return result;
+  });
+}
+
+/**
+ * Test that the tiles cover the frame and that the halo is clipped at the
+ * border of the frame.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_tile_regions_test)
+{
+  std::vector<Image> frames = { generate_test_image(100, 70) };
+
+  auto tiles = frames
+      | tile(Size<int>(32, 32), 3 /*halo*/)
+      | to<std::vector>();
+
+  BOOST_TEST(tiles.size() == 4 * 3);
+
+  // First tile: Halo only to the right and to the bottom
+  BOOST_TEST(tiles.at(0).region == Rect<int>(0, 0, 32, 32));
+  BOOST_TEST(tiles.at(0).bounds == Rect<int>(0, 0, 35, 35));
+  BOOST_TEST(tiles.at(0).image.width() == 35);
+
+  // Interior tile
+  BOOST_TEST(tiles.at(5).region == Rect<int>(32, 32, 32, 32));
+  BOOST_TEST(tiles.at(5).bounds == Rect<int>(29, 29, 38, 38));
+
+  // Last tile: Smaller region at the border of the frame
+  BOOST_TEST(tiles.at(11).region == Rect<int>(96, 64, 4, 6));
+  BOOST_TEST(tiles.at(11).bounds == Rect<int>(93, 61, 7, 9));
+  BOOST_TEST(tiles.at(11).index == 11);
+  BOOST_TEST(tiles.at(11).num_tiles == 12);
+}
+
+/**
+ * Test that tile() followed by untile() reproduces the frames.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_tile_untile_test)
+{
+  std::vector<Image> frames = { generate_test_image(100, 70),
+      generate_test_image(20, 20), generate_test_image(64, 64) };
+
+  auto result_frames = frames
+      | tile(Size<int>(32, 32), 3 /*halo*/)
+      | untile()
+      | to<std::vector>();
+
+  BOOST_TEST(result_frames.size() == frames.size());
+
+  for (size_t idx = 0; idx < frames.size(); ++idx) {
+    BOOST_TEST(is_almost_equal(result_frames.at(idx), frames.at(idx), 0.00001));
+  }
+}
+
+/**
+ * Test that a neighbourhood filter which is applied to the tiles in
+ * parallel produces exactly the same frame as the filter applied to the
+ * whole frame.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_on_tiles_box_filter_test)
+{
+  std::vector<Image> frames = { generate_test_image(100, 70),
+      generate_test_image(37, 53) };
+
+  auto expected_frames = frames | box_filter() | to<std::vector>();
+
+  auto result_frames = frames
+      | tile(Size<int>(16, 16), 1 /*halo*/)
+      | on_tiles(box_filter(), 4 /*num_workers*/)
+      | untile()
+      | to<std::vector>();
+
+  BOOST_TEST(result_frames.size() == expected_frames.size());
+
+  for (size_t idx = 0; idx < frames.size(); ++idx) {
+    BOOST_TEST((result_frames.at(idx) == expected_frames.at(idx)));
+  }
+}
+
+/**
+ * Same as above for the bad pixel interpolation with a 5x5 filter core
+ * which requires a halo of 2 pixels.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_on_tiles_interpolate_bad_pixels_test)
+{
+  std::vector<Image> frames = { generate_test_image(100, 70) };
+
+  auto expected_frames = frames
+      | interpolate_bad_pixels(500, 5)
+      | to<std::vector>();
+
+  auto result_frames = frames
+      | tile(Size<int>(16, 16), 2 /*halo*/)
+      | on_tiles(interpolate_bad_pixels(500, 5), 4 /*num_workers*/)
+      | untile()
+      | to<std::vector>();
+
+  BOOST_TEST(result_frames.size() == 1);
+  BOOST_TEST((result_frames.at(0) == expected_frames.at(0)));
+}
+
+/**
+ * Test that untile() rejects tiles whose size was changed.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_untile_changed_tile_size_test)
+{
+  std::vector<Image> frames = { generate_test_image(64, 64) };
+
+  auto shrink = ranges::views::transform([](const Image&) {
+    return Image(1, 1, 1, 1, 0);
+  });
+
+  BOOST_CHECK_THROW(
+      frames | tile(Size<int>(32, 32), 1) | on_tiles(shrink, 1) | untile() | to<std::vector>(),
+      TileException);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
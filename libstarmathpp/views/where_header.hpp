@@ -0,0 +1,88 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_PIPELINE_VIEW_WHERE_HEADER_HPP_
+#define STARMATHPP_PIPELINE_VIEW_WHERE_HEADER_HPP_ STARMATHPP_PIPELINE_VIEW_WHERE_HEADER_HPP_
+
+#include <string>
+#include <type_traits>
+
+#include <boost/algorithm/string.hpp>
+
+#include <range/v3/view/filter.hpp>
+
+#include <libstarmathpp/io/cimg_fits_io.hpp>
+#include <libstarmathpp/io/fits_header.hpp>
+
+namespace starmathpp::pipeline::views {
+
+/**
+ * Only keep the FITS files for which pred(header) returns true. Only the
+ * header of each file is read (see io::fits::read_header()). Files which are
+ * no FITS files (by extension) are dropped.
+ *
+ * Usage:
+ *
+ * auto long_darks = files("darks", "(.*\\.fit)")
+ *     | where_header([](const io::fits::FitsHeader &header) {
+ *         return header.contains("EXPTIME") && header.number("EXPTIME") >= 60.0;
+ *       })
+ *     | read();
+ */
+template<typename Pred, typename = std::enable_if_t<
+    std::is_invocable_r_v<bool, Pred, const io::fits::FitsHeader&>>>
+auto where_header(Pred pred) {
+  return ranges::views::filter([pred](const std::string &filename) {
+    const std::string filename_lower = boost::algorithm::to_lower_copy(
+        filename);
+
+    if (!io::fits::is_fits(filename_lower)
+        && !io::fits::is_fits_gz(filename_lower)) {
+      return false;
+    }
+    return static_cast<bool>(pred(io::fits::read_header(filename)));
+  });
+}
+
+/**
+ * Only keep the FITS files whose header contains the keyword with the
+ * given value. String values are compared without quotes and trailing
+ * blanks.
+ *
+ * Usage:
+ *
+ * auto darks = files("session_1", "(.*\\.fit)")
+ *     | where_header("IMAGETYP", "Dark Frame")
+ *     | read();
+ */
+inline auto where_header(const std::string &keyword, const std::string &value) {
+  return where_header([keyword, value](const io::fits::FitsHeader &header) {
+    return header.contains(keyword) && header.value(keyword) == value;
+  });
+}
+
+}  // namespace starmathpp::pipeline::views
+
+#endif // STARMATHPP_PIPELINE_VIEW_WHERE_HEADER_HPP_
@@ -0,0 +1,141 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "pipeline view where_header unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <range/v3/range/conversion.hpp>
+
+#include <libstarmathpp/views/where_header.hpp>
+
+BOOST_AUTO_TEST_SUITE(pipeline_where_header_tests)
+
+using namespace starmathpp;
+using namespace ranges;
+
+/**
+ * Temporary directory which is removed at the end of the test.
+ */
+class TempDir {
+ public:
+  TempDir()
+      :
+      path_(
+          std::filesystem::temp_directory_path()
+              / std::filesystem::path("where_header_test")) {
+    std::filesystem::remove_all(path_);
+    std::filesystem::create_directories(path_);
+  }
+
+  ~TempDir() {
+    std::filesystem::remove_all(path_);
+  }
+
+  [[nodiscard]] std::string file(const std::string &filename) const {
+    return (path_ / filename).string();
+  }
+
+ private:
+  std::filesystem::path path_;
+};
+
+/**
+ * Write a FITS header with the given image type and exposure time.
+ */
+static void write_header(const std::string &filepath,
+                         const std::string &image_type, double exposure_time) {
+  auto card = [](const std::string &text) {
+    return text + std::string(80 - text.size(), ' ');
+  };
+
+  std::string header = card("SIMPLE  =                    T")
+      + card("BITPIX  =                   16") + card("NAXIS   =                    0")
+      + card("IMAGETYP= '" + image_type + "'")
+      + card("EXPTIME =  " + std::to_string(exposure_time)) + card("END");
+  header.resize(2880, ' ');
+
+  std::ofstream(filepath, std::ios::binary).write(header.data(), header.size());
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(pipeline_where_header_value_test)
+{
+  TempDir temp_dir;
+
+  write_header(temp_dir.file("light_1.fit"), "Light Frame", 120.0);
+  write_header(temp_dir.file("dark_1.fit"), "Dark Frame", 120.0);
+  write_header(temp_dir.file("dark_2.fits"), "Dark Frame", 30.0);
+  std::ofstream(temp_dir.file("notes.txt")) << "Dark Frame";
+
+  const std::vector<std::string> filenames { temp_dir.file("light_1.fit"),
+      temp_dir.file("dark_1.fit"), temp_dir.file("notes.txt"), temp_dir.file(
+          "dark_2.fits") };
+
+  auto darks = filenames
+      | pipeline::views::where_header("IMAGETYP", "Dark Frame")
+      | to<std::vector>();
+
+  BOOST_TEST(
+      (darks
+          == std::vector<std::string> { temp_dir.file("dark_1.fit"),
+              temp_dir.file("dark_2.fits") }));
+}
+
+/**
+ *
+ */
+BOOST_AUTO_TEST_CASE(pipeline_where_header_predicate_test)
+{
+  TempDir temp_dir;
+
+  write_header(temp_dir.file("dark_1.fit"), "Dark Frame", 120.0);
+  write_header(temp_dir.file("dark_2.fit"), "Dark Frame", 30.0);
+
+  const std::vector<std::string> filenames { temp_dir.file("dark_1.fit"),
+      temp_dir.file("dark_2.fit") };
+
+  auto long_darks = filenames
+      | pipeline::views::where_header([](const io::fits::FitsHeader &header) {
+          return header.number("EXPTIME") >= 60.0;
+        })
+      | to<std::vector>();
+
+  BOOST_TEST(
+      (long_darks == std::vector<std::string> { temp_dir.file("dark_1.fit") }));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -26,12 +26,13 @@
 #ifndef STARMATHPP_PIPELINE_VIEW_WRITE_H_
 #define STARMATHPP_PIPELINE_VIEW_WRITE_H_ STARMATHPP_PIPELINE_VIEW_WRITE_H_
 
-#include <cstdio>
 #include <filesystem>
+#include <memory>
 
 #include <range/v3/view/transform.hpp>
 
 #include <libstarmathpp/image.hpp>
+#include <libstarmathpp/io/filename_sequencer.hpp>
 #include <libstarmathpp/io/image_writer.hpp>
 
 #define STARMATHPP_PIPELINE_VIEW_WRITE_DEBUG 0
@@ -39,33 +40,22 @@
 namespace starmathpp::pipeline::views {
 
 /**
- * NOTE: With C++20, the filename can be easily composed like:
- * std::string filename = std::format(imageFilenamePattern, counter++);
- * The template looks slightly different: "img_{:03}.fit"
- * See https://stackoverflow.com/questions/2342162/stdstring-formatting-like-sprintf
- *
- * #include <format>
- *
- * TODO: Compose filename from internal, static counter... ? Better idea? How to reset?
- */
-static std::string compose_filename_from_pattern(const std::string &pattern) {
-  char buffer[100];
-
-  static unsigned int counter = 0;
-
-  std::snprintf(buffer, sizeof(buffer), pattern.c_str(), counter++);
-
-  return std::string(buffer);
-}
-
-/**
+ * Write each image synchronously. The filename is composed from the
+ * printf-style pattern and an index which is counted per pipeline.
  *
+ * See write_behind() to write the images on background threads.
  */
 template<typename ImageType=float>
 auto
 write(const std::filesystem::path &directory,
            const std::string &image_filename_pattern = "img_%03d.fit",
            bool allow_override = true) {
+
+  // NOTE: The filenames are numbered per pipeline. All copies of the view
+  //       share the same counter.
+  auto sequencer = std::make_shared<starmathpp::io::FilenameSequencer>(
+      image_filename_pattern);
+
   return ranges::views::transform(
       [=](auto && image /*cimg_library::CImg<ImageType>*/) {
 
@@ -73,12 +63,14 @@ write(const std::filesystem::path &directory,
                             STARMATHPP_PIPELINE_VIEW_WRITE_DEBUG);
 
         std::filesystem::path filepath = directory
-            / compose_filename_from_pattern(image_filename_pattern);
+            / sequencer->next();
 
         starmathpp::io::write(std::move(image), filepath, allow_override);
 
 
-        return std::move(image); // TODO / FIXME: Does this work? Dereferencing the unique_ptr is not what should b done...
+        // NOTE: An image which is owned by the pipeline is moved on. An image
+        //       which is referenced (e.g. an element of a container) is copied.
+        return std::forward<decltype(image)>(image);
       }
   );
 }
@@ -0,0 +1,255 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+#ifndef STARMATHPP_PIPELINE_VIEW_WRITE_BEHIND_HPP_
+#define STARMATHPP_PIPELINE_VIEW_WRITE_BEHIND_HPP_ STARMATHPP_PIPELINE_VIEW_WRITE_BEHIND_HPP_
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <range/v3/view/all.hpp>
+#include <range/v3/view/facade.hpp>
+#include <range/v3/view/view.hpp>
+
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/image_cutout.hpp>
+#include <libstarmathpp/io/async_image_writer.hpp>
+#include <libstarmathpp/io/filename_sequencer.hpp>
+
+#define STARMATHPP_PIPELINE_VIEW_WRITE_BEHIND_DEBUG 0
+
+namespace starmathpp::pipeline::views {
+
+namespace detail {
+
+/**
+ * View which passes the images of the underlying range on unchanged and
+ * hands each image over to an AsyncImageWriter. The image is shared with
+ * the writer, i.e. the view yields const references and the pixels are not
+ * copied (unless the underlying range yields references, then the image is
+ * copied once).
+ *
+ * When the end of the underlying range is reached, the view waits until
+ * all images have been written and re-throws the first error which
+ * occurred while writing. If the iteration stops early (e.g. by take()),
+ * the view waits when the iteration ends. Errors are kept until flush()
+ * is called.
+ *
+ * NOTE: This is a single-pass (input) view.
+ */
+template<typename Rng, typename ImageType>
+class write_behind_view : public ranges::view_facade<
+    write_behind_view<Rng, ImageType>, ranges::unknown> {
+
+  friend ranges::range_access;
+
+  using element_type = cimg_library::CImg<ImageType>;
+
+  /**
+   * Settings and writer of one pipeline. Shared by all copies of the view.
+   */
+  struct writer_state {
+    std::filesystem::path directory;
+    bool allow_override;
+    std::shared_ptr<io::FilenameSequencer> sequencer;
+    io::AsyncImageWriter writer;
+
+    writer_state(std::filesystem::path dir, bool override,
+                 std::shared_ptr<io::FilenameSequencer> seq,
+                 size_t num_workers, size_t max_pending)
+        :
+        directory(std::move(dir)),
+        allow_override(override),
+        sequencer(std::move(seq)),
+        writer(num_workers, max_pending) {
+    }
+  };
+
+  /**
+   * The state of one iteration. It is shared by all copies of the cursor.
+   */
+  class iteration_state {
+   public:
+    iteration_state(Rng &base, std::shared_ptr<writer_state> writer_state)
+        :
+        it_(ranges::begin(base)),
+        end_(ranges::end(base)),
+        writer_state_(std::move(writer_state)) {
+    }
+
+    iteration_state(const iteration_state&) = delete;
+    iteration_state& operator=(const iteration_state&) = delete;
+
+    ~iteration_state() {
+      // NOTE: The images which were handed over are written before the
+      //       iteration ends, also if it ended early. Errors cannot be
+      //       thrown here. They are re-thrown by write_behind_view::flush().
+      writer_state_->writer.wait();
+    }
+
+    const element_type& current() {
+      if (current_ == nullptr) {
+        current_ = make_shared_image(element_type(*it_));
+
+        DEBUG_IMAGE_DISPLAY(*current_, "pipeline_view_write_behind_in",
+                            STARMATHPP_PIPELINE_VIEW_WRITE_BEHIND_DEBUG);
+
+        // NOTE: The encoding and the disk I/O happen in the background.
+        writer_state_->writer.write(
+            current_,
+            writer_state_->directory / writer_state_->sequencer->next(),
+            writer_state_->allow_override);
+      }
+      return *current_;
+    }
+
+    void next() {
+      if (current_ == nullptr) {
+        // NOTE: Elements which are skipped without being accessed are
+        //       written as well.
+        current();
+      }
+      current_ = nullptr;
+      ++it_;
+    }
+
+    [[nodiscard]] bool done() {
+      if (it_ == end_) {
+        writer_state_->writer.flush();
+        return true;
+      }
+      return false;
+    }
+
+   private:
+    ranges::iterator_t<Rng> it_;
+    ranges::sentinel_t<Rng> end_;
+    std::shared_ptr<writer_state> writer_state_;
+    SharedImage<ImageType> current_;
+  };
+
+  /**
+   *
+   */
+  struct cursor {
+    using single_pass = std::true_type;
+
+    std::shared_ptr<iteration_state> state_;
+
+    const element_type& read() const {
+      return state_->current();
+    }
+
+    void next() {
+      state_->next();
+    }
+
+    [[nodiscard]] bool equal(ranges::default_sentinel_t) const {
+      return state_->done();
+    }
+  };
+
+  Rng base_;
+  std::shared_ptr<writer_state> writer_state_;
+
+  cursor begin_cursor() {
+    return cursor { std::make_shared<iteration_state>(base_, writer_state_) };
+  }
+
+ public:
+  write_behind_view() = default;
+
+  write_behind_view(Rng base, std::filesystem::path directory,
+                    bool allow_override,
+                    std::shared_ptr<io::FilenameSequencer> sequencer,
+                    size_t num_workers, size_t max_pending)
+      :
+      base_(std::move(base)),
+      writer_state_(
+          std::make_shared<writer_state>(std::move(directory), allow_override,
+                                         std::move(sequencer), num_workers,
+                                         max_pending)) {
+  }
+
+  /**
+   * Wait until all images handed over so far have been written and
+   * re-throw the first error which occurred while writing.
+   *
+   * NOTE: Only needed if the range was not iterated to its end. All copies
+   *       of the view share the same writer.
+   */
+  void flush() {
+    writer_state_->writer.flush();
+  }
+};
+
+}  // namespace detail
+
+/**
+ * Same as write(), but the images are encoded and written by num_workers
+ * background threads while the subsequent stages already process the next
+ * image. At most max_pending images are waiting to be written (0 = twice
+ * the number of workers). If the writers fall behind, the pipeline is
+ * slowed down instead of buffering an unlimited number of images.
+ *
+ * The filenames are numbered per pipeline, i.e. each write_behind() has
+ * its own counter which starts at 0.
+ *
+ * When the end of the range is reached, the view waits until all images
+ * have been written. An error which occurred while writing is re-thrown
+ * there (or when the next image is handed over to the writer). If the
+ * range is not iterated to its end, call flush() on the view to observe
+ * errors.
+ *
+ * Usage:
+ *
+ * auto star_images = cutouts
+ *                    | write_behind<float>("stars", "star_%04d.fit", true, 2)
+ *                    | to<std::vector>();
+ */
+template<typename ImageType = float>
+auto write_behind(const std::filesystem::path &directory,
+                  const std::string &image_filename_pattern = "img_%03d.fit",
+                  bool allow_override = true, size_t num_workers = 1,
+                  size_t max_pending = 0) {
+
+  auto sequencer = std::make_shared<io::FilenameSequencer>(
+      image_filename_pattern);
+
+  return ranges::make_view_closure([=](auto &&rng) {
+    using Rng = decltype(rng);
+
+    return detail::write_behind_view<ranges::views::all_t<Rng>, ImageType>(
+        ranges::views::all(std::forward<Rng>(rng)), directory, allow_override,
+        sequencer, num_workers, max_pending);
+  });
+}
+
+}  // namespace starmathpp::pipeline::views
+
+#endif // STARMATHPP_PIPELINE_VIEW_WRITE_BEHIND_HPP_
@@ -0,0 +1,160 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "pipeline view write_behind unit test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <range/v3/range/conversion.hpp>
+#include <range/v3/view/move.hpp>
+#include <range/v3/view/take.hpp>
+
+#include <libstarmathpp/views/write_behind.hpp>
+#include <libstarmathpp/io/filesystem_wrapper.hpp>
+
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/floating_point_equality.hpp>
+
+BOOST_AUTO_TEST_SUITE (pipeline_write_behind_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::pipeline::views;
+using namespace ranges;
+
+/**
+ * Test that the images are passed on and that all files exist as soon as
+ * the pipeline was evaluated.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_write_behind_images_test)
+{
+  std::vector<Image> images_to_write { Image(20, 20, 1, 3, 0), Image(400, 400,
+                                                                     1, 3, 0),
+      Image(200, 450, 1, 3, 0) };
+
+  std::vector<std::tuple<std::string, std::uintmax_t>> expected_results = { {
+      "wb_img_000.fit", 5760 }, { "wb_img_001.fit", 325440 }, {
+      "wb_img_002.fit", 184320 } };
+
+  auto written_images = images_to_write
+      | write_behind<float>(".", "wb_img_%03d.fit", true /*allow_override*/,
+                            2 /*num_workers*/)
+      | to<std::vector>();
+
+  BOOST_TEST(written_images.size() == images_to_write.size());
+  BOOST_TEST(is_almost_equal(written_images.at(1), images_to_write.at(1), 0.00001));
+
+  for (const auto &result : expected_results) {
+    std::string filename = std::get<0>(result);
+    std::uintmax_t file_size = std::get<1>(result);
+
+    BOOST_TEST(std::filesystem::exists(filename) == true);
+    BOOST_TEST(fs::file_size(filename) == file_size);
+  }
+}
+
+/**
+ * Test that each pipeline numbers its files independently.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_write_behind_per_pipeline_counter_test)
+{
+  std::vector<Image> images { Image(20, 20, 1, 1, 0), Image(20, 20, 1, 1, 0) };
+
+  auto pipeline_1 = images
+      | write_behind<float>(".", "wb_a_%03d.fit")
+      | to<std::vector>();
+  auto pipeline_2 = images
+      | write_behind<float>(".", "wb_b_%03d.fit")
+      | to<std::vector>();
+
+  BOOST_TEST(std::filesystem::exists("wb_a_001.fit") == true);
+  BOOST_TEST(std::filesystem::exists("wb_b_000.fit") == true);
+  BOOST_TEST(std::filesystem::exists("wb_b_001.fit") == true);
+}
+
+/**
+ * Test that an error which occurred in the background is re-thrown when
+ * the pipeline is evaluated.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_write_behind_error_test)
+{
+  std::vector<Image> images { Image(20, 20, 1, 1, 0) };
+
+  // NOTE: A filename without extension is rejected by the image writer.
+  BOOST_CHECK_THROW(
+      images | ranges::views::move | write_behind<float>(".", "wb_no_extension_%d") | to<std::vector>(),
+      starmathpp::io::ImageWriterException);
+}
+
+/**
+ * Test that the images which were handed over are written when the
+ * iteration stops before the end of the range is reached.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_write_behind_early_termination_test)
+{
+  std::filesystem::remove("wb_early_000.fit");
+  std::filesystem::remove("wb_early_001.fit");
+
+  std::vector<Image> images { Image(20, 20, 1, 1, 0), Image(20, 20, 1, 1, 0),
+      Image(20, 20, 1, 1, 0) };
+
+  auto written_images = images
+      | write_behind<float>(".", "wb_early_%03d.fit", true /*allow_override*/,
+                            2 /*num_workers*/)
+      | ranges::views::take(1)
+      | to<std::vector>();
+
+  BOOST_TEST(written_images.size() == 1);
+  BOOST_TEST(std::filesystem::exists("wb_early_000.fit") == true);
+  BOOST_TEST(std::filesystem::exists("wb_early_001.fit") == false);
+}
+
+/**
+ * Test that an error is re-thrown by flush() if the range was not iterated
+ * to its end.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_write_behind_early_termination_error_test)
+{
+  std::vector<Image> images { Image(20, 20, 1, 1, 0), Image(20, 20, 1, 1, 0) };
+
+  // NOTE: A filename without extension is rejected by the image writer.
+  auto write_behind_view = images
+      | write_behind<float>(".", "wb_early_no_extension_%d");
+
+  auto written_images = write_behind_view
+      | ranges::views::take(1)
+      | to<std::vector>();
+
+  BOOST_TEST(written_images.size() == 1);
+  BOOST_CHECK_THROW(write_behind_view.flush(),
+                    starmathpp::io::ImageWriterException);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
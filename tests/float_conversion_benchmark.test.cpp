@@ -0,0 +1,136 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "float conversion benchmark integration test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/thread_pool.hpp>
+#include <libstarmathpp/io/float_conversion.hpp>
+
+/**
+ * Compare the fused float to 16 bit conversion of the image writer with
+ * the previous conversion get_normalize(0, 65535).quantize(65536) followed
+ * by a conversion to CImg<uint16_t> on a 60 MP frame.
+ *
+ * The timings are reported with --log_level=message. Only the results are
+ * checked since the timings depend on the machine.
+ */
+BOOST_AUTO_TEST_SUITE (float_conversion_benchmark_integration_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::io;
+
+namespace {
+
+// 9504 x 6336 = 60.2 MP (full frame 60 MP sensor)
+const int FRAME_WIDTH = 9504;
+const int FRAME_HEIGHT = 6336;
+
+/**
+ * Float frame with a gradient and values outside of the 16 bit range.
+ */
+Image generate_frame() {
+  Image frame(FRAME_WIDTH, FRAME_HEIGHT, 1, 1, 0);
+
+  cimg_forXY(frame, x, y)
+  {
+    frame(x, y) = -200.25F + 7.125F * (float) ((x * 13 + y * 7) % 11000);
+  }
+  return frame;
+}
+
+/**
+ * Previous conversion in io::write().
+ */
+cimg_library::CImg<uint16_t> previous_conversion(const Image &frame) {
+  return frame.get_normalize(0, 65535).quantize(65536);
+}
+
+template<typename Fun>
+double measure_ms(Fun &&fun) {
+  auto start = std::chrono::steady_clock::now();
+  fun();
+  return std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(float_conversion_benchmark_normalize_test)
+{
+  Image frame = generate_frame();
+
+  cimg_library::CImg<uint16_t> previous_result;
+  cimg_library::CImg<uint16_t> single_thread_result;
+  cimg_library::CImg<uint16_t> multi_thread_result;
+
+  double previous_ms = measure_ms([&]() {
+    previous_result = previous_conversion(frame);
+  });
+
+  double single_thread_ms = measure_ms([&]() {
+    single_thread_result = to_uint16(frame, FloatConversion::NORMALIZE, 1);
+  });
+
+  double multi_thread_ms = measure_ms([&]() {
+    multi_thread_result = to_uint16(frame, FloatConversion::NORMALIZE,
+                                    default_num_workers());
+  });
+
+  BOOST_TEST_MESSAGE(
+      "Converting a " << FRAME_WIDTH << "x" << FRAME_HEIGHT << " float frame to 16 bit:");
+  BOOST_TEST_MESSAGE("  normalize + quantize (previous): " << previous_ms << " ms");
+  BOOST_TEST_MESSAGE("  to_uint16(), 1 thread:           " << single_thread_ms << " ms");
+  BOOST_TEST_MESSAGE("  to_uint16(), " << default_num_workers() << " threads:          " << multi_thread_ms << " ms");
+
+  // The result does not depend on the number of threads.
+  BOOST_TEST((single_thread_result == multi_thread_result));
+
+  // NOTE: The previous conversion truncated twice (quantize() and the
+  //       conversion to uint16_t). to_uint16() rounds once.
+  int max_difference = 0;
+
+  for (size_t idx = 0; idx < frame.size(); ++idx) {
+    max_difference = std::max(
+        max_difference,
+        std::abs((int) previous_result[idx] - (int) multi_thread_result[idx]));
+  }
+
+  BOOST_TEST_MESSAGE("  max. difference: " << max_difference);
+  BOOST_TEST(max_difference <= 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
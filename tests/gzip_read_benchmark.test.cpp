@@ -0,0 +1,161 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "gzip read benchmark integration test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <fitsio.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/io/cimg_fits_io.hpp>
+#include <libstarmathpp/io/image_writer.hpp>
+
+/**
+ * Compare fits::read() of a gzip-compressed FITS file (inflated in one pass
+ * into reused buffers and parsed from memory) with reading the same file
+ * through the gzip support of CFITSIO on a 24 MP frame.
+ *
+ * The timings are reported with --log_level=message. Only the results are
+ * checked since the timings depend on the machine.
+ */
+BOOST_AUTO_TEST_SUITE (gzip_read_benchmark_integration_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::io;
+
+namespace {
+
+// 6000 x 4000 = 24 MP (APS-C sensor)
+const int FRAME_WIDTH = 6000;
+const int FRAME_HEIGHT = 4000;
+const int NUM_READS = 5;
+
+const std::string FILENAME = "gzip_read_benchmark.fits.gz";
+
+/**
+ * 16 bit frame with a gradient and some noise-like structure, so that the
+ * file does not compress to almost nothing.
+ */
+cimg_library::CImg<uint16_t> generate_frame() {
+  cimg_library::CImg<uint16_t> frame(FRAME_WIDTH, FRAME_HEIGHT, 1, 1, 0);
+
+  cimg_forXY(frame, x, y)
+  {
+    frame(x, y) = (uint16_t) (1000 + x / 4 + y / 3 + ((x * 7919 + y * 104729) % 97));
+  }
+  return frame;
+}
+
+/**
+ * Read the file through the gzip support of CFITSIO (small, buffered
+ * reads). The rows are returned bottom-up as stored in the file.
+ */
+std::vector<float> read_with_cfitsio(const std::string &filename) {
+  fitsfile *fptr = nullptr;
+  int status = 0;
+
+  fits_open_file(&fptr, filename.c_str(), READONLY, &status);
+
+  long naxes[2] = { 0, 0 };
+  fits_get_img_size(fptr, 2, naxes, &status);
+
+  std::vector<float> pixels((size_t) naxes[0] * (size_t) naxes[1]);
+  long first_pixel[2] = { 1, 1 };
+  int any_null = 0;
+
+  fits_read_pix(fptr, TFLOAT, first_pixel, (LONGLONG) pixels.size(), nullptr,
+                pixels.data(), &any_null, &status);
+  fits_close_file(fptr, &status);
+
+  BOOST_REQUIRE(status == 0);
+
+  return pixels;
+}
+
+template<typename Fun>
+double measure_ms(Fun &&fun) {
+  auto start = std::chrono::steady_clock::now();
+  fun();
+  return std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(gzip_read_benchmark_test)
+{
+  io::write(generate_frame(), FILENAME, true /*override*/);
+
+  std::vector<float> cfitsio_pixels;
+  Image image;
+
+  double cfitsio_ms = measure_ms([&]() {
+    for (int i = 0; i < NUM_READS; ++i) {
+      cfitsio_pixels = read_with_cfitsio(FILENAME);
+    }
+  });
+
+  double read_ms = measure_ms([&]() {
+    for (int i = 0; i < NUM_READS; ++i) {
+      image = fits::read(FILENAME);
+    }
+  });
+
+  BOOST_TEST_MESSAGE(
+      "Reading a gzip-compressed " << FRAME_WIDTH << "x" << FRAME_HEIGHT << " frame "
+      << NUM_READS << " times (" << std::filesystem::file_size(FILENAME) << " bytes):");
+  BOOST_TEST_MESSAGE("  CFITSIO gzip support: " << cfitsio_ms / NUM_READS << " ms per frame");
+  BOOST_TEST_MESSAGE("  fits::read():         " << read_ms / NUM_READS << " ms per frame");
+
+  // Both must return the same pixels. FITS stores the bottom row first.
+  BOOST_TEST(image.width() == FRAME_WIDTH);
+  BOOST_TEST(image.height() == FRAME_HEIGHT);
+
+  size_t num_differences = 0;
+
+  cimg_forXY(image, x, y)
+  {
+    if (image(x, y) != cfitsio_pixels[(size_t) (FRAME_HEIGHT - 1 - y) * FRAME_WIDTH + x]) {
+      ++num_differences;
+    }
+  }
+
+  BOOST_TEST(num_differences == 0);
+
+  std::filesystem::remove(FILENAME);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -52,6 +52,7 @@
 #include <libstarmathpp/actions/write.hpp>
 
 #include <libstarmathpp/io/filesystem_wrapper.hpp>
+#include <libstarmathpp/io/master_frame_cache.hpp>
 
 #include <libstarmathpp/algorithm/average.hpp>
 #include <libstarmathpp/algorithm/stretch/midtone_balance_stretcher.hpp>
@@ -152,4 +153,48 @@ BOOST_AUTO_TEST_CASE(pipeline_standard_image_development_test, * boost::unit_tes
   BOOST_TEST(*diff_image.abs() < 2);
 }
 
+/**
+ * The master dark is only calculated once. Afterwards, it is loaded from
+ * the master frame cache as long as the dark frames and the parameters do
+ * not change.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_master_frame_cache_test)
+{
+  const std::string base_path = "test_data/integration/image_development/";
+
+  auto dark_files = files(base_path + "dark", "(.*\\.fit\\.gz)") | to<std::vector>();
+
+  float BAD_PIXEL_THRESHOLD = 500;
+  float FILTER_CORE_SIZE = 3;
+
+  auto cache_directory = std::filesystem::temp_directory_path()
+      / "starmathpp_image_development_masters";
+  std::filesystem::remove_all(cache_directory);
+
+  MasterFrameCache cache(cache_directory);
+
+  MasterFrameKey dark_key("dark");
+  dark_key.add_files(dark_files)
+          .add_parameter("bad_pixel_threshold", BAD_PIXEL_THRESHOLD)
+          .add_parameter("filter_core_size", FILTER_CORE_SIZE);
+
+  int num_calculated = 0;
+
+  auto calculate_master_dark = [&]() {
+    ++num_calculated;
+
+    return average(dark_files
+        | read()
+        | interpolate_bad_pixels(BAD_PIXEL_THRESHOLD, FILTER_CORE_SIZE));
+  };
+
+  Image master_dark = cache.get_or_create(dark_key, calculate_master_dark);
+  Image cached_master_dark = cache.get_or_create(dark_key, calculate_master_dark);
+
+  BOOST_TEST(num_calculated == 1);
+  BOOST_TEST(is_almost_equal(cached_master_dark, master_dark, 0.0));
+
+  std::filesystem::remove_all(cache_directory);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
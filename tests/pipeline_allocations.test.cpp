@@ -0,0 +1,409 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "pipeline allocations integration test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <limits>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <range/v3/view/move.hpp>
+
+#include <libstarmathpp/io/cimg_fits_io.hpp>
+#include <libstarmathpp/views/read.hpp>
+#include <libstarmathpp/views/subtract.hpp>
+#include <libstarmathpp/views/divide_by.hpp>
+#include <libstarmathpp/views/multiply_by.hpp>
+#include <libstarmathpp/views/stretch.hpp>
+
+#include <libstarmathpp/algorithm/stretch/midtone_balance_stretcher.hpp>
+
+/**
+ * Count all allocations of at least min_counted_bytes while
+ * count_allocations is set. This way only (full-frame) image
+ * allocations are counted. Allocations of at least min_large_bytes
+ * are counted separately as well (e.g. float frames among 8 bit frames).
+ */
+namespace {
+std::atomic<bool> count_allocations { false };
+std::atomic<size_t> min_counted_bytes { 0 };
+std::atomic<size_t> min_large_bytes { 0 };
+std::atomic<size_t> num_allocations { 0 };
+std::atomic<size_t> num_large_allocations { 0 };
+
+void* allocate(std::size_t size) {
+  if (count_allocations && size >= min_counted_bytes) {
+    ++num_allocations;
+
+    if (size >= min_large_bytes) {
+      ++num_large_allocations;
+    }
+  }
+
+  void *ptr = std::malloc(size > 0 ? size : 1);
+
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void start_counting_allocations(size_t min_bytes,
+                                size_t min_large_allocation_bytes =
+                                    std::numeric_limits<size_t>::max()) {
+  min_counted_bytes = min_bytes;
+  min_large_bytes = min_large_allocation_bytes;
+  num_allocations = 0;
+  num_large_allocations = 0;
+  count_allocations = true;
+}
+
+size_t stop_counting_allocations() {
+  count_allocations = false;
+  return num_allocations;
+}
+
+/**
+ * Number of counted allocations of at least min_large_allocation_bytes
+ * (see start_counting_allocations()).
+ */
+size_t counted_large_allocations() {
+  return num_large_allocations;
+}
+}  // namespace
+
+void* operator new(std::size_t size) {
+  return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+  return allocate(size);
+}
+
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+BOOST_AUTO_TEST_SUITE (pipeline_allocations_integration_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::pipeline::views;
+
+namespace {
+const int WIDTH = 256;
+const int HEIGHT = 192;
+const size_t NUM_FRAMES = 4;
+
+std::vector<Image> create_frames() {
+  std::vector<Image> frames;
+
+  for (size_t i = 0; i < NUM_FRAMES; ++i) {
+    Image frame(WIDTH, HEIGHT, 1, 1, 0);
+
+    cimg_forXY(frame, x, y)
+    {
+      frame(x, y) = (float) ((x * 31 + y * 17 + i) % 1000) + 100.0F;
+    }
+    frames.push_back(std::move(frame));
+  }
+  return frames;
+}
+
+/**
+ * Temporary directory which is removed at the end of the test.
+ */
+class TempDir {
+ public:
+  TempDir()
+      :
+      path_(
+          std::filesystem::temp_directory_path()
+              / std::filesystem::path("pipeline_allocations_test")) {
+    std::filesystem::remove_all(path_);
+    std::filesystem::create_directories(path_);
+  }
+
+  ~TempDir() {
+    std::filesystem::remove_all(path_);
+  }
+
+  [[nodiscard]] const std::filesystem::path& path() const {
+    return path_;
+  }
+
+ private:
+  std::filesystem::path path_;
+};
+
+/**
+ * Store the frames as uncompressed float FITS files.
+ */
+std::vector<std::string> write_frames(const std::filesystem::path &directory) {
+  std::vector<std::string> filenames;
+  auto frames = create_frames();
+
+  for (size_t i = 0; i < frames.size(); ++i) {
+    std::string filename = (directory
+        / ("frame_" + std::to_string(i) + ".fit")).string();
+
+    io::fits::write(frames[i], filename, true /*override*/);
+    filenames.push_back(filename);
+  }
+  return filenames;
+}
+}  // namespace
+
+/**
+ * Test if a chain of arithmetic operations works on the frames which are
+ * moved into the pipeline without allocating any further frame.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_arithmetic_chain_allocations_test)
+{
+  auto frames = create_frames();
+  Image dark(WIDTH, HEIGHT, 1, 1, 10);
+  Image flat(WIDTH, HEIGHT, 1, 1, 2);
+
+  auto pipeline = frames
+      | ranges::views::move
+      | subtract(dark)
+      | divide_by(flat)
+      | multiply_by(3.0F);
+
+  size_t num_results = 0;
+
+  start_counting_allocations(WIDTH * HEIGHT * sizeof(float));
+
+  for (auto &&result : pipeline) {
+    num_results += (result.width() == WIDTH ? 1 : 0);
+  }
+
+  size_t num_frame_allocations = stop_counting_allocations();
+
+  BOOST_TEST(num_results == NUM_FRAMES);
+  BOOST_TEST(num_frame_allocations == 0);
+}
+
+/**
+ * Test if a subtract | divide_by | stretch chain allocates at most one
+ * frame per frame, i.e. the 8 bit result of the stretch.
+ *
+ * NOTE: The frames are moved into the pipeline from memory. The same chain
+ *       behind read() is tested below.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_calibrate_and_stretch_allocations_test)
+{
+  auto frames = create_frames();
+  Image dark(WIDTH, HEIGHT, 1, 1, 10);
+  Image flat(WIDTH, HEIGHT, 1, 1, 2);
+
+  starmathpp::algorithm::MidtoneBalanceStretcher stretcher(0.25F);
+
+  // NOTE: The stretcher keeps a buffer per thread, which is allocated
+  //       when it is used for the first time.
+  auto warm_up_image = stretcher.stretch(dark);
+
+  auto pipeline = frames
+      | ranges::views::move
+      | subtract(dark)
+      | divide_by(flat)
+      | stretch(stretcher);
+
+  size_t num_results = 0;
+
+  // Count all allocations of at least the size of an 8 bit frame
+  start_counting_allocations(WIDTH * HEIGHT * sizeof(uint8_t));
+
+  for (auto &&result : pipeline) {
+    num_results += (result.width() == WIDTH ? 1 : 0);
+  }
+
+  size_t num_frame_allocations = stop_counting_allocations();
+
+  BOOST_TEST(num_results == NUM_FRAMES);
+  BOOST_TEST(num_frame_allocations <= NUM_FRAMES);
+}
+
+/**
+ * Test if read() allocates exactly one frame per file. The FITS reader
+ * decodes the rows straight into the resulting image, i.e. there is no
+ * temporary full frame buffer.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_read_allocations_test)
+{
+  TempDir temp_dir;
+  auto filenames = write_frames(temp_dir.path());
+
+  auto pipeline = filenames | read();
+
+  size_t num_results = 0;
+
+  // Count all allocations of at least the size of a float frame
+  start_counting_allocations(WIDTH * HEIGHT * sizeof(float));
+
+  for (auto &&result : pipeline) {
+    num_results += (result.width() == WIDTH ? 1 : 0);
+  }
+
+  size_t num_frame_allocations = stop_counting_allocations();
+
+  BOOST_TEST(num_results == NUM_FRAMES);
+  BOOST_TEST(num_frame_allocations == NUM_FRAMES);
+}
+
+/**
+ * Test if a read | subtract | divide_by | stretch chain allocates one
+ * float frame per file: the image decoded by read(), which is then moved
+ * through the arithmetic views. The 8 bit result of the stretch is the
+ * only other full-frame allocation.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_read_calibrate_and_stretch_allocations_test)
+{
+  TempDir temp_dir;
+  auto filenames = write_frames(temp_dir.path());
+
+  Image dark(WIDTH, HEIGHT, 1, 1, 10);
+  Image flat(WIDTH, HEIGHT, 1, 1, 2);
+
+  starmathpp::algorithm::MidtoneBalanceStretcher stretcher(0.25F);
+
+  // NOTE: The stretcher keeps a buffer per thread, which is allocated
+  //       when it is used for the first time.
+  auto warm_up_image = stretcher.stretch(dark);
+
+  auto pipeline = filenames
+      | read()
+      | subtract(dark)
+      | divide_by(flat)
+      | stretch(stretcher);
+
+  size_t num_results = 0;
+
+  // Count all allocations of at least the size of an 8 bit frame and,
+  // separately, those of at least the size of a float frame
+  start_counting_allocations(WIDTH * HEIGHT * sizeof(uint8_t),
+                             WIDTH * HEIGHT * sizeof(float));
+
+  for (auto &&result : pipeline) {
+    num_results += (result.width() == WIDTH ? 1 : 0);
+  }
+
+  size_t num_frame_allocations = stop_counting_allocations();
+  size_t num_float_frame_allocations = counted_large_allocations();
+
+  BOOST_TEST(num_results == NUM_FRAMES);
+  BOOST_TEST(num_float_frame_allocations == NUM_FRAMES);
+  BOOST_TEST(num_frame_allocations - num_float_frame_allocations == NUM_FRAMES);
+}
+
+/**
+ * Test if calibration frames (e.g. master dark and flat) are not copied
+ * when a pipeline is built, copied and iterated.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_calibration_frames_allocations_test)
+{
+  auto frames = create_frames();
+  Image dark(WIDTH, HEIGHT, 1, 1, 10);
+  Image flat(WIDTH, HEIGHT, 1, 1, 2);
+
+  start_counting_allocations(WIDTH * HEIGHT * sizeof(float));
+
+  // NOTE: The dark and the flat are copied exactly once into a shared handle.
+  auto calibrate = subtract(dark) | divide_by(flat);
+
+  // NOTE: Copies of the closure (and of the views) share the frames.
+  auto calibrate_copy_1 = calibrate;
+  auto calibrate_copy_2 = calibrate_copy_1;
+
+  auto pipeline = frames
+      | ranges::views::move
+      | calibrate_copy_2
+      | multiply_by(3.0F);
+
+  auto pipeline_copy = pipeline;
+
+  size_t num_results = 0;
+
+  for (auto &&result : pipeline_copy) {
+    num_results += (result.width() == WIDTH ? 1 : 0);
+  }
+
+  size_t num_frame_allocations = stop_counting_allocations();
+
+  BOOST_TEST(num_results == NUM_FRAMES);
+  BOOST_TEST(num_frame_allocations == 2);
+}
+
+/**
+ * Test if calibration frames which are moved into the pipeline or which
+ * are shared with the caller are never copied.
+ */
+BOOST_AUTO_TEST_CASE(pipeline_shared_calibration_frames_allocations_test)
+{
+  auto frames = create_frames();
+  auto dark = make_shared_image(Image(WIDTH, HEIGHT, 1, 1, 10));
+  Image flat(WIDTH, HEIGHT, 1, 1, 2);
+
+  start_counting_allocations(WIDTH * HEIGHT * sizeof(float));
+
+  auto pipeline = frames
+      | ranges::views::move
+      | subtract(dark)
+      | divide_by(std::move(flat));
+
+  size_t num_results = 0;
+
+  for (auto &&result : pipeline) {
+    num_results += (result.width() == WIDTH ? 1 : 0);
+  }
+
+  size_t num_frame_allocations = stop_counting_allocations();
+
+  BOOST_TEST(num_results == NUM_FRAMES);
+  BOOST_TEST(num_frame_allocations == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,183 @@
+/*****************************************************************************
+ *
+ *  libstarmathpp - A C++ library to process astronomical images
+ *                  based on CImg and range-v3.
+ *
+ *  Copyright(C) 2023 Carsten Schmitt <c [at] lost-infinity.com>
+ *
+ *  More info on https://www.lost-infinity.com
+ *
+ *  This program is free software ; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation ; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY ; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program ; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+ *
+ ****************************************************************************/
+
+// Shared lib
+// This is much faster than the header only variant
+#define BOOST_TEST_MODULE "stacking benchmark integration test"
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <libstarmathpp/image.hpp>
+#include <libstarmathpp/thread_pool.hpp>
+#include <libstarmathpp/algorithm/average_stacker.hpp>
+
+/**
+ * Compare the AverageStacker with the previous implementation of average()
+ * which summed up the frames in a single float image on one thread.
+ *
+ * The timings are reported with --log_level=message. Only the precision
+ * and the determinism are checked since the timings depend on the machine.
+ */
+BOOST_AUTO_TEST_SUITE (stacking_benchmark_integration_tests)
+
+using namespace starmathpp;
+using namespace starmathpp::algorithm;
+
+namespace {
+
+const int FRAME_WIDTH = 2048;
+const int FRAME_HEIGHT = 1536;
+const size_t NUM_DISTINCT_FRAMES = 8;
+const size_t NUM_FRAMES = 400;
+
+/**
+ * 16 bit frames with a bright gradient which exceed the precision of a
+ * float sum when hundreds of them are stacked.
+ */
+std::vector<cimg_library::CImg<uint16_t>> generate_frames() {
+  std::vector<cimg_library::CImg<uint16_t>> frames;
+
+  for (size_t i = 0; i < NUM_DISTINCT_FRAMES; ++i) {
+    cimg_library::CImg<uint16_t> frame(FRAME_WIDTH, FRAME_HEIGHT, 1, 1, 0);
+
+    cimg_forXY(frame, x, y)
+    {
+      frame(x, y) = (uint16_t) (60000 + (x + y + 3 * i) % 5000);
+    }
+    frames.push_back(std::move(frame));
+  }
+  return frames;
+}
+
+/**
+ * Previous implementation of average().
+ */
+Image float_average(const std::vector<cimg_library::CImg<uint16_t>> &frames,
+                    size_t num_frames) {
+  Image sum_image(FRAME_WIDTH, FRAME_HEIGHT, 1, 1, 0);
+
+  for (size_t i = 0; i < num_frames; ++i) {
+    sum_image += frames[i % frames.size()];
+  }
+  sum_image /= num_frames;
+
+  return sum_image;
+}
+
+Image stacker_average(const std::vector<cimg_library::CImg<uint16_t>> &frames,
+                      size_t num_frames, size_t num_threads) {
+  AverageStacker stacker(num_threads);
+
+  for (size_t i = 0; i < num_frames; ++i) {
+    stacker.add(frames[i % frames.size()]);
+  }
+  return stacker.result();
+}
+
+/**
+ * Exact average of the frames (the number of frames is a multiple of
+ * the number of distinct frames).
+ */
+double exact_average(const std::vector<cimg_library::CImg<uint16_t>> &frames,
+                     int x, int y) {
+  double sum = 0;
+
+  for (const auto &frame : frames) {
+    sum += frame(x, y);
+  }
+  return sum / (double) frames.size();
+}
+
+template<typename Fun>
+double measure_ms(Fun &&fun) {
+  auto start = std::chrono::steady_clock::now();
+  fun();
+  return std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(stacking_benchmark_average_test)
+{
+  auto frames = generate_frames();
+
+  Image float_result;
+  Image single_thread_result;
+  Image multi_thread_result;
+
+  double float_ms = measure_ms([&]() {
+    float_result = float_average(frames, NUM_FRAMES);
+  });
+
+  double single_thread_ms = measure_ms([&]() {
+    single_thread_result = stacker_average(frames, NUM_FRAMES, 1);
+  });
+
+  double multi_thread_ms = measure_ms([&]() {
+    multi_thread_result = stacker_average(frames, NUM_FRAMES,
+                                          default_num_workers());
+  });
+
+  BOOST_TEST_MESSAGE(
+      "Stacking " << NUM_FRAMES << " frames of " << FRAME_WIDTH << "x" << FRAME_HEIGHT << " pixels:");
+  BOOST_TEST_MESSAGE("  float sum (previous average()): " << float_ms << " ms");
+  BOOST_TEST_MESSAGE("  AverageStacker, 1 thread:       " << single_thread_ms << " ms");
+  BOOST_TEST_MESSAGE("  AverageStacker, " << default_num_workers() << " threads:      " << multi_thread_ms << " ms");
+
+  // The result does not depend on the number of threads.
+  BOOST_TEST((single_thread_result == multi_thread_result));
+
+  double max_float_error = 0;
+  double max_stacker_error = 0;
+
+  for (int y = 0; y < FRAME_HEIGHT; y += 97) {
+    for (int x = 0; x < FRAME_WIDTH; x += 89) {
+      double expected = exact_average(frames, x, y);
+
+      max_float_error = std::max(max_float_error,
+                                 std::abs(float_result(x, y) - expected));
+      max_stacker_error = std::max(max_stacker_error,
+                                   std::abs(multi_thread_result(x, y) - expected));
+    }
+  }
+
+  BOOST_TEST_MESSAGE("  max. error float sum:     " << max_float_error);
+  BOOST_TEST_MESSAGE("  max. error AverageStacker: " << max_stacker_error);
+
+  // NOTE: Only the conversion of the result to float is inexact.
+  BOOST_TEST(max_stacker_error < 0.01);
+  BOOST_TEST(max_stacker_error <= max_float_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -34,10 +34,12 @@
 #include <range/v3/range/conversion.hpp>
 #include <range/v3/action/join.hpp>
 #include <range/v3/view/move.hpp>
+#include <range/v3/view/cache1.hpp>
 #include <range/v3/view/filter.hpp>
 
 #include <range/v3/core.hpp>   // ranges::front()
 #include <range/v3/algorithm/for_each.hpp>
+#include <range/v3/algorithm/none_of.hpp>
 
 #include <libstarmathpp/algorithm/threshold/otsu_thresholder.hpp>
 #include <libstarmathpp/algorithm/centroid/intensity_weighted_centroider.hpp>
@@ -84,16 +86,30 @@ BOOST_AUTO_TEST_CASE(pipeline_star_recognizer_test) {
             )
           | crop()
           | view::transform(
-              [](const auto &detectedStars) {
-                return detectedStars
+              // NOTE: The cutouts are taken by value. views::move on a
+              //       const reference would copy each cutout and keep its
+              //       reference to the frame.
+              [](auto detectedStars) {
+                auto star_images = detectedStars
                     | ranges::views::move
                     | scale_up(3.0F)
                     | center_on_star(IntensityWeightedCentroider<float>())
                     | scale_down(3.0F)
                     | crop_from_center(Size<int>(21,21))
+                    // NOTE: filter reads each element twice. The moved
+                    //       cutouts must only be materialized once.
+                    | ranges::views::cache1
                     | ranges::views::filter([](const auto& img) { return (img.max() < 65535); })
                     | write<float>(std::filesystem::current_path(), "star_centered_%04d.fit")
                     | to<std::vector>();
+
+                // Each moved cutout released its reference to the frame
+                // when it was materialized.
+                BOOST_TEST(ranges::none_of(detectedStars, [](const auto &cutout) {
+                  return cutout.is_materializable();
+                }));
+
+                return star_images;
               })
           | actions::join
           | to<std::vector>();